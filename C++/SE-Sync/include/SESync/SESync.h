@@ -6,6 +6,9 @@
 
 #pragma once
 
+#include <cstdint>
+#include <memory>
+#include <string>
 #include <vector>
 
 #include <Eigen/Dense>
@@ -35,8 +38,9 @@ struct SESyncOpts {
   /** Stopping criterion based upon the norm of an accepted update step */
   Scalar stepsize_tol = 1e-3;
 
-  /** Maximum permitted number of (outer) iterations of the Riemannian
-   * trust-region method when solving each instance of Problem 9 */
+  /** Maximum permitted number of (outer) iterations of the local solver
+   * (Riemannian trust-region or L-BFGS method) when solving each instance of
+   * Problem 9 */
   size_t max_iterations = 1000;
 
   /** Maximum number of inner (truncated conjugate-gradient) iterations to
@@ -46,6 +50,44 @@ struct SESyncOpts {
   /** Maximum elapsed computation time (in seconds) */
   double max_computation_time = 1800;
 
+  /** The local optimization method to use at each level of the Riemannian
+   * Staircase */
+  LocalSolver local_solver = LocalSolver::TNT;
+
+  /** If nonempty, this overrides local_solver on a per-level basis: the kth
+   * element specifies the local solver to use at level r0 + k of the
+   * Riemannian Staircase, and the last element applies to all subsequent
+   * levels */
+  std::vector<LocalSolver> local_solver_schedule;
+
+  /** The number of curvature pairs retained by the L-BFGS local solver */
+  size_t LBFGS_memory = 10;
+
+  /** If positive, the initial trust-region radius for the first level of the
+   * Riemannian Staircase (e.g. the final radius SESyncResult::
+   * trust_region_radius of a previous solve, when re-solving from its
+   * solution); otherwise, the default radius of the trust-region method is
+   * used */
+  Scalar initial_trust_region_radius = 0;
+
+  /** If true, the trust-region method at each subsequent level of the
+   * Riemannian Staircase is initialized with the final trust-region radius of
+   * the previous level (enlarged, if necessary, to contain the saddle escape
+   * step), rather than with the default radius */
+  bool carry_trust_region_radius = true;
+
+  /** If true, max_computation_time is treated as a hard deadline for the
+   * *entire* SE-Sync solve (including initialization, verification, rounding,
+   * and post-processing, and, when SE-Sync is called with a set of
+   * measurements, autotuning and the construction and factorization of the
+   * problem instance), rather than only for the Riemannian Staircase:
+   * time is reserved for rounding and certifying the current solution, the
+   * optimization and verification at each level of the Staircase are given
+   * correspondingly reduced deadlines, and the best rounded solution found so
+   * far is returned once the budget is exhausted (cf.
+   * SESync/SESyncTimeBudget.h). */
+  bool enforce_deadline = false;
+
   /// These next two parameters define the stopping criteria for the truncated
   /// preconditioned conjugate-gradient solver running in the inner loop --
   /// they control the tradeoff between the quality of the returned
@@ -66,6 +108,17 @@ struct SESyncOpts {
    * algorithm converges q-superlinearly with order (1+theta). */
   Scalar STPCG_theta = .5;
 
+  /** If true, the truncated conjugate-gradient solver recycles Krylov
+   * information across the outer iterations of the trust-region method: a
+   * small deflation space of Ritz vectors of the Hessian from the previous
+   * outer iteration is transported to the current tangent space, and used to
+   * augment the preconditioner with a coarse-space correction (cf.
+   * SESync/SESyncKrylovRecycling.h) */
+  bool recycle_Krylov_subspace = false;
+
+  /** Maximum dimension of the recycled deflation space */
+  size_t Krylov_recycling_dimension = 4;
+
   /** An optional user-supplied function that can be used to instrument/monitor
    * the performance of the internal Riemannian truncated-Newton trust-region
    * optimization algorithm as it runs. */
@@ -82,6 +135,21 @@ struct SESyncOpts {
   /** The maximum level of the Riemannian Staircase to explore */
   size_t rmax = 10;
 
+  /** If true, whenever the Riemannian Staircase ascends from a saddle point
+   * (and again upon termination), the current iterate Y is first rotated and
+   * truncated to its numerical rank (cf. reduce_rank() in SESync_utils.h),
+   * without changing Y^T Y.  In particular, the returned solution Yopt then has
+   * the smallest rank that represents Z = Y^T Y, so that Yopt.rows() may be
+   * passed as r0 when warm-starting subsequent solves from Yopt.  Truncation
+   * does not count against the number of levels:  the Staircase still visits
+   * at most rmax - r0 + 1 levels (and local_solver_schedule is indexed by
+   * level, not by rank). */
+  bool reduce_rank = false;
+
+  /** Relative tolerance for determining the numerical rank of Y: singular
+   * values less than rank_tol times the largest are treated as zero */
+  Scalar rank_tol = 1e-6;
+
   /** Tolerance for accepting the minimum eigenvalue of the
    * certificate matrix as numerically nonnegative; this should be a small
    * positive value e.g. 10^-3 */
@@ -105,6 +173,25 @@ struct SESyncOpts {
    * minimum-eigenpair computation */
   size_t LOBPCG_max_iterations = 100;
 
+  /** The preconditioner to use with LOBPCG during solution verification */
+  VerificationPreconditioner LOBPCG_preconditioner =
+      VerificationPreconditioner::ILDL;
+
+  /** Whether to deflate the known near-nullspace of the certificate matrix
+   * (spanned by the rows of the critical point Y) from the LOBPCG iteration
+   * during solution verification */
+  bool LOBPCG_deflation = false;
+
+  /** The method to use when computing a minimum eigenpair of the certificate
+   * matrix during solution verification */
+  VerificationEigensolver certificate_eigensolver =
+      VerificationEigensolver::LOBPCG;
+
+  /** Degree of the polynomial filter used by Chebyshev-filtered subspace
+   * iteration (only operative when certificate_eigensolver is
+   * VerificationEigensolver::ChebyshevFilter) */
+  size_t Chebyshev_filter_degree = 10;
+
   /** Whether to use the Cholesky or QR factorization when
    * computing the orthogonal projection */
   ProjectionFactorization projection_factorization =
@@ -118,10 +205,47 @@ struct SESyncOpts {
    * preconditioner */
   Scalar reg_Cholesky_precon_max_condition_number = 1e6;
 
+  /** The sparse linear solver backends to use for the orthogonal projection,
+   * the regularized Cholesky preconditioner, and solution verification */
+  SparseSolverOpts sparse_solvers;
+
+  /** If true, SESync() (when called with a set of measurements) replaces the
+   * formulation, preconditioner, projection factorization, initial relaxation
+   * rank r0, and LOBPCG block size and fill parameters specified here with
+   * those predicted for the problem by the autotuner (cf.
+   * SESync/SESyncAutotuner.h).  The formulation and r0 are retained if an
+   * initial iterate Y0 is supplied. */
+  bool autotune = false;
+
+  /** If nonempty, the name of the autotuning table file used by the
+   * autotuner; otherwise, its built-in rules are used */
+  std::string autotuning_table;
+
+  /** If nonzero, a budget (in bytes) for the memory used by the data matrices
+   * and sparse factorizations.  SESync() (when called with a set of
+   * measurements) then estimates the memory required by each factorization
+   * before the problem is constructed, and replaces any that would exceed the
+   * budget with a lower-memory alternative (cf.
+   * SESync/SESyncMemoryGovernor.h); these decisions are reported in
+   * SESyncResult::memory_governor_decisions.  Problems constructed with
+   * prepare_problem() are governed in the same way. */
+  size_t memory_budget_bytes = 0;
+
   /** The initialization method to use for constructing an initial iterate Y0,
    * if none was provided */
   Initialization initialization = Initialization::Chordal;
 
+  /** The pose estimates xhat = [t | R] (a d x (d+1)n matrix) from which to
+   * construct the initial iterate when initialization is
+   * Initialization::FromFile; these are typically the vertex estimates read by
+   * read_g2o_file() */
+  Matrix initial_estimate;
+
+  /** Seed for the (counter-based) random number generator used for random
+   * initialization and for the eigensolvers' starting blocks; for a given
+   * seed, these are identical for any number of threads */
+  uint64_t random_seed = 0;
+
   /** Whether to print output as the algorithm runs */
   bool verbose = false;
 
@@ -130,8 +254,20 @@ struct SESyncOpts {
   bool log_iterates = false;
 
   /** The number of threads to use for parallelization (assuming that SE-Sync is
-   * built using a compiler that supports OpenMP */
-  size_t num_threads = 1;
+   * built using a compiler that supports OpenMP), and for the sparse
+   * factorizations (cf. SESync/SESync_threading.h).  If this is 0, the thread
+   * settings of OpenMP, the BLAS and CHOLMOD are left unchanged. */
+  size_t num_threads = 0;
+
+  /// CHECKPOINTING
+
+  /** If nonempty, the name of a file to which the state of the Riemannian
+   * Staircase is periodically checkpointed (cf. SESync/SESyncCheckpoint.h) */
+  std::string checkpoint_file;
+
+  /** Minimum interval (in seconds) between successive checkpoints written
+   * during the optimization at a single level of the Riemannian Staircase */
+  double checkpoint_interval = 60;
 };
 
 /** These enumerations describe the termination status of the SE-Sync algorithm
@@ -155,7 +291,15 @@ enum SESyncStatus {
 
   /** The algorithm exhausted the allotted total computation time before finding
    * an optimal solution */
-  ElapsedTime
+  ElapsedTime,
+
+  /** The algorithm converged to a first-order critical point at which the
+   * eigensolver found no direction of sufficiently negative curvature, but
+   * the certificate matrix could not be tested for positive-semidefiniteness
+   * by direct factorization (cf. SESyncResult::direct_verification); the
+   * solution is therefore likely, but not certified, to be globally optimal
+   */
+  Uncertified
 };
 
 /** This struct contains the output of the SESync algorithm */
@@ -163,7 +307,8 @@ struct SESyncResult {
 
   /** An estimate of a global minimizer Yopt of the rank-restricted dual
    * semidefinite relaxation Problem 9 in the SE-Sync tech report.  The
-   * corresponding solution of Problem 7 is Z = Y^T Y */
+   * corresponding solution of Problem 7 is Z = Y^T Y.  If
+   * SESyncOpts::reduce_rank is set, Yopt is truncated to its numerical rank */
   Matrix Yopt;
 
   /** The value of the objective F(Y^T Y) = F(Z) attained by the Yopt */
@@ -196,6 +341,29 @@ struct SESyncResult {
   /** The rounded solution xhat = [t | R] in SE(d)^n */
   Matrix xhat;
 
+  /** If the pose IDs in the measurements defining the problem were not
+   * contiguous, the poses were relabeled densely before solving (cf.
+   * SESyncProblem::pose_ids()); in that case, the kth pose in xhat (and Yopt)
+   * is the pose with original ID pose_ids[k].  Otherwise, this is empty. */
+  std::vector<size_t> pose_ids;
+
+  /** If SESyncOpts::memory_budget_bytes was set, the estimated peak memory (in
+   * bytes) required by the data matrices and factorizations under the
+   * configuration actually used (cf. SESync/SESyncMemoryGovernor.h), and a
+   * description of each change that the memory governor made to the requested
+   * configuration in order to respect the budget.  Otherwise, these are 0 and
+   * empty, respectively. */
+  size_t estimated_memory_bytes = 0;
+  std::vector<std::string> memory_governor_decisions;
+
+  /** Whether the positive-semidefiniteness of the certificate matrix was
+   * tested by direct factorization.  This is false if the problem's
+   * SparseSolverOpts::verification backend is PCG (e.g. because the memory
+   * governor replaced the direct factorization to respect the memory budget),
+   * in which case no solution can be certified as globally optimal, and the
+   * status is at best Uncertified. */
+  bool direct_verification = true;
+
   /** Upper bound on the global suboptimality of the recovered estimates
    * xhat; this is equal to F(xhat) - tr(Lambda) */
   Scalar suboptimality_bound;
@@ -226,6 +394,16 @@ struct SESyncResult {
    * Staircase */
   std::vector<std::vector<size_t>> Hessian_vector_products;
 
+  /** A vector containing the sequence of (# additional Hessian-vector
+   * products) spent on Krylov subspace recycling (i.e., on projecting the
+   * Hessian onto the recycled deflation space) during the optimization at each
+   * level of the Riemannian Staircase; its elements correspond one-to-one with
+   * those of Hessian_vector_products (and are zero if recycling is disabled).
+   * The net cost of each outer iteration is therefore the sum of the two, and
+   * the savings due to recycling are the reduction in this sum relative to a
+   * solve without recycling. */
+  std::vector<std::vector<size_t>> recycling_Hessian_vector_products;
+
   /** A vector containing the sequence of norms of the update steps computed
    * during the optimization at each level of the Riemannian Staircase */
   std::vector<std::vector<Scalar>> update_step_norms;
@@ -245,6 +423,19 @@ struct SESyncResult {
    * values and gradients were obtained */
   std::vector<std::vector<double>> elapsed_optimization_times;
 
+  /** A vector containing the local solver used at each level of the Riemannian
+   * Staircase */
+  std::vector<LocalSolver> local_solvers;
+
+  /** A vector containing the number of rejected update steps (i.e., wasted
+   * outer iterations) at each level of the Riemannian Staircase */
+  std::vector<size_t> rejected_steps;
+
+  /** The most recent trust-region radius of the truncated-Newton trust-region
+   * method; this may be used (via SESyncOpts::initial_trust_region_radius) to
+   * warm-start a subsequent re-solve */
+  Scalar trust_region_radius = 0;
+
   /** A vector containing the sequence of curvatures theta := x'*S*x of the
    * certificate matrices S along the computed escape directions x from
    * suboptimal critical points at each level of the Riemannian Staircase
@@ -268,6 +459,41 @@ struct SESyncResult {
   SESyncStatus status;
 };
 
+/** A problem instance constructed by prepare_problem(), together with the
+ * options with which it should be solved */
+struct PreparedProblem {
+  /** The problem instance */
+  std::shared_ptr<SESyncProblem> problem;
+
+  /** The requested options, after autotuning (if enabled) and memory
+   * governance (and with initial_estimate set if the spanning-tree
+   * initialization was selected) */
+  SESyncOpts options;
+
+  /** The estimated peak memory usage and the decisions made by the memory
+   * governor (cf. SESyncResult::estimated_memory_bytes) */
+  size_t estimated_memory_bytes = 0;
+  std::vector<std::string> memory_governor_decisions;
+
+  /** Records the preprocessing performed here in 'result' */
+  void annotate(SESyncResult &result) const;
+};
+
+/** Constructs the problem instance defined by 'measurements' using the passed
+ * options.  Non-contiguous pose IDs are relabeled densely (cf.
+ * SESyncProblem::pose_ids()).  If options.autotune is set, the options are
+ * first autotuned (cf. autotune()); if options.memory_budget_bytes is
+ * nonzero, they are then governed to respect the budget (cf.
+ * govern_memory()), and the problem is constructed with the resulting
+ * factorizations and verification fill cap.
+ * Y0 is the initial iterate that will be passed to SESync() (if any); if it is
+ * empty and the spanning-tree initialization is selected, the initial
+ * estimate is computed here.  The returned problem should be solved with the
+ * returned options. */
+PreparedProblem prepare_problem(const measurements_t &measurements,
+                                const SESyncOpts &options,
+                                const Matrix &Y0 = Matrix());
+
 /** Given an SESyncProblem instance, this function performs synchronization */
 SESyncResult SESync(SESyncProblem &problem,
                     const SESyncOpts &options = SESyncOpts(),
@@ -275,7 +501,9 @@ SESyncResult SESync(SESyncProblem &problem,
 
 /** Given a vector of relative pose measurements specifying a special Euclidean
  * synchronization problem, performs synchronization using the SESync algorithm
- */
+ * (on the problem constructed by prepare_problem()).  Non-contiguous pose IDs
+ * are relabeled densely (cf. SESyncResult::pose_ids); Y0 and
+ * SESyncOpts::initial_estimate then refer to the relabeled poses. */
 SESyncResult SESync(const measurements_t &measurements,
                     const SESyncOpts &options = SESyncOpts(),
                     const Matrix &Y0 = Matrix());
@@ -0,0 +1,178 @@
+/** This file provides a simple autotuner that selects the problem formulation,
+ * preconditioner, projection factorization, initial relaxation rank, and
+ * verification (LOBPCG) parameters for SE-Sync based upon cheap features of the
+ * pose graph.
+ *
+ * The features (cf. ProblemFeatures) are computed directly from the
+ * measurements; in particular, the fill in the Cholesky factor of the pose
+ * graph's Laplacian is estimated using only a symbolic analysis (a
+ * fill-reducing ordering followed by an elimination tree traversal), so no
+ * numerical factorization is performed.  Given these features, a configuration
+ * is predicted using an AutotuningTable:  this records, for each benchmark
+ * problem on which it was calibrated, the features of that problem together
+ * with the fastest configuration found for it, and predicts the configuration
+ * of the nearest benchmark problem in (normalized) feature space.  Tables are
+ * stored as plain-text files, so that they can be (re)calibrated offline, e.g.
+ * by the benchmarking notebook in the examples directory.  If no table is
+ * available, a small set of built-in rules is used instead.
+ *
+ * Copyright (C) 2016 - 2022 by David M. Rosen (dmrosen@mit.edu)
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "SESync/RelativePoseMeasurement.h"
+#include "SESync/SESync.h"
+#include "SESync/SESync_types.h"
+
+namespace SESync {
+
+/** Cheap structural and statistical features of a pose-graph SLAM problem */
+struct ProblemFeatures {
+  /** Number of poses */
+  size_t n = 0;
+
+  /** Number of measurements */
+  size_t m = 0;
+
+  /** Dimension of the estimation problem */
+  size_t d = 0;
+
+  /** Mean degree of the poses in the pose graph */
+  Scalar mean_degree = 0;
+
+  /** Maximum degree of the poses in the pose graph */
+  size_t max_degree = 0;
+
+  /** Coefficient of variation (standard deviation / mean) of the degrees of
+   * the poses in the pose graph */
+  Scalar degree_variation = 0;
+
+  /** Fraction of the measurements that are loop closures (i.e., that do not
+   * connect consecutively-indexed poses) */
+  Scalar loop_closure_ratio = 0;
+
+  /** Spread (log10(max / min)) of the rotational measurement precisions */
+  Scalar kappa_spread = 0;
+
+  /** Spread (log10(max / min)) of the translational measurement precisions */
+  Scalar tau_spread = 0;
+
+  /** Estimated number of nonzeros in the (lower-triangular) Cholesky factor
+   * of the n x n pose-graph Laplacian, under a fill-reducing ordering */
+  size_t factor_nonzeros = 0;
+
+  /** Ratio of factor_nonzeros to the number of nonzeros in the lower triangle
+   * of the pose-graph Laplacian */
+  Scalar factor_fill = 0;
+};
+
+/** Computes the features of the problem defined by the passed measurements */
+ProblemFeatures compute_problem_features(const measurements_t &measurements);
+
+/** The subset of SE-Sync's options selected by the autotuner */
+struct AutotuneConfig {
+  /** The problem formulation (the autotuner selects only between the
+   * Simplified and Explicit formulations of the SE-Sync problem, since these
+   * have the same solutions; a request to solve the SO-Sync problem is never
+   * changed) */
+  Formulation formulation = Formulation::Simplified;
+
+  /** The preconditioner used in the Riemannian trust-region method */
+  Preconditioner preconditioner = Preconditioner::RegularizedCholesky;
+
+  /** The factorization used to compute the orthogonal projection */
+  ProjectionFactorization projection_factorization =
+      ProjectionFactorization::Cholesky;
+
+  /** The initial level of the Riemannian Staircase, relative to the dimension
+   * d of the problem:  r0 = d + r0_offset */
+  size_t r0_offset = 0;
+
+  /** The LOBPCG block size used in solution verification */
+  size_t LOBPCG_block_size = 4;
+
+  /** The fill parameters of the incomplete symmetric indefinite factorization
+   * used to precondition LOBPCG */
+  Scalar LOBPCG_max_fill_factor = 3;
+  Scalar LOBPCG_drop_tol = 1e-3;
+
+  /** Extracts the autotuned subset of the passed options, for a problem of
+   * dimension d */
+  static AutotuneConfig from_options(const SESyncOpts &options, size_t d);
+
+  /** Overwrites the autotuned subset of the passed options with this
+   * configuration, for a problem of dimension d (enlarging rmax if
+   * necessary) */
+  void apply(SESyncOpts &options, size_t d) const;
+};
+
+/** Predicts a configuration for a problem with the passed features using a
+ * small set of built-in rules */
+AutotuneConfig default_autotune_config(const ProblemFeatures &features);
+
+/** A table of benchmark problems, recording the fastest configuration found
+ * for each, that is used to predict configurations for new problems */
+class AutotuningTable {
+public:
+  /** A single benchmark problem */
+  struct Entry {
+    /** A (whitespace-free) name identifying this benchmark problem */
+    std::string name;
+
+    /** The features of this benchmark problem */
+    ProblemFeatures features;
+
+    /** The fastest configuration found for this problem */
+    AutotuneConfig config;
+
+    /** The total computation time (in seconds) required by config */
+    double time = 0;
+  };
+
+private:
+  std::vector<Entry> entries_;
+
+public:
+  /** Construct an empty table */
+  AutotuningTable() {}
+
+  /** Load a table from the passed file (cf. save()) */
+  explicit AutotuningTable(const std::string &filename);
+
+  /** Records that the passed configuration solved the named benchmark problem
+   * in the passed time; this configuration replaces the one previously stored
+   * for that problem (if any) if it is faster */
+  void add_benchmark_result(const std::string &name,
+                            const ProblemFeatures &features,
+                            const AutotuneConfig &config, double time);
+
+  /** Predicts the fastest configuration for a problem with the passed
+   * features, as the configuration of the nearest benchmark problem of the
+   * same dimension; if there is none, this falls back to
+   * default_autotune_config() */
+  AutotuneConfig predict(const ProblemFeatures &features) const;
+
+  /** Writes this table to the passed file, in a plain-text format with one
+   * benchmark problem per line */
+  void save(const std::string &filename) const;
+
+  const std::vector<Entry> &entries() const { return entries_; }
+  size_t size() const { return entries_.size(); }
+  bool empty() const { return entries_.empty(); }
+};
+
+/** Returns a copy of 'options' in which the autotuned subset has been replaced
+ * by the configuration predicted for the problem defined by 'measurements',
+ * using the passed table (if table is null, the table named by
+ * options.autotuning_table is loaded; if there is none, or it is empty, the
+ * built-in rules are used).  The 'autotune' flag of the returned options is
+ * cleared, since they have already been tuned. */
+SESyncOpts autotune(const measurements_t &measurements,
+                    const SESyncOpts &options,
+                    const AutotuningTable *table = nullptr);
+
+} // namespace SESync
@@ -0,0 +1,195 @@
+/** This file provides a batched solver for large numbers of *small* special
+ * Euclidean synchronization problems (e.g. tens of poses) that share the same
+ * number of poses, dimension, and measurement graph topology, and differ only
+ * in their measurement values.
+ *
+ * At this scale the cost of solving a single problem with SESyncProblem and
+ * SESync() is dominated by overhead (dynamic allocation, sparse matrix
+ * bookkeeping, and thread dispatch) rather than arithmetic.  SESyncBatch
+ * instead stores the L problems of a batch in structure-of-arrays form, with
+ * each scalar quantity held as a contiguous row of L values (one per "lane"),
+ * so that every arithmetic operation acts on all L problems at once and is
+ * vectorized by the compiler.  Only the upper triangle of each (symmetric)
+ * data matrix is stored, and the gradient is evaluated so that each stored
+ * element is loaded once per evaluation.  The Riemannian Staircase is run for
+ * all lanes in lockstep, using a Riemannian gradient method with
+ * Barzilai-Borwein stepsizes and a per-lane nonmonotone backtracking
+ * safeguard; lanes that converge (or are certified) early are simply masked.
+ * Each lane is initialized by subspace inverse iteration and certified by a
+ * dense Cholesky factorization (a dense eigensolver is used only to escape
+ * saddle points), and rounded using a dense SVD.
+ *
+ * SESyncBatch performs no internal parallelization:  throughput on a
+ * multicore node is obtained by solving independent batches on separate
+ * threads.
+ *
+ * Copyright (C) 2016 - 2022 by David M. Rosen (dmrosen@mit.edu)
+ */
+
+#pragma once
+
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include "SESync/RelativePoseMeasurement.h"
+#include "SESync/SESync.h"
+#include "SESync/SESync_types.h"
+
+namespace SESync {
+
+/** This struct contains the various parameters that control SESyncBatch */
+struct SESyncBatchOpts {
+  /** Stopping tolerance for the norm of the Riemannian gradient */
+  Scalar grad_norm_tol = 1e-6;
+
+  /** Stopping criterion based upon the relative decrease in function value
+   * between iterations */
+  Scalar rel_func_decrease_tol = 1e-12;
+
+  /** Maximum number of iterations at each level of the Riemannian Staircase */
+  size_t max_iterations = 1000;
+
+  /** Maximum number of stepsize halvings in the backtracking line search */
+  size_t max_backtracks = 30;
+
+  /** The initial level of the Riemannian Staircase */
+  size_t r0 = 4;
+
+  /** The maximum level of the Riemannian Staircase to explore */
+  size_t rmax = 10;
+
+  /** Numerical tolerance for the minimum eigenvalue of the certificate matrix:
+   * a lane is certified if lambda_min(S) >= -min_eig_num_tol */
+  Scalar min_eig_num_tol = 1e-5;
+};
+
+/** This struct contains the output of SESyncBatch for a single problem */
+struct SESyncBatchResult {
+  /** The estimated minimizer of the rank-restricted relaxation */
+  Matrix Yopt;
+
+  /** The value of the rank-restricted relaxation at Yopt */
+  Scalar SDPval;
+
+  /** The minimum eigenvalue of the certificate matrix at Yopt.  This is only
+   * computed if the certificate matrix is not certified positive-semidefinite
+   * by a Cholesky factorization; otherwise (since the certificate matrix
+   * annihilates the rows of Yopt, so that its minimum eigenvalue lies in
+   * [-min_eig_num_tol, 0]) it is reported as 0. */
+  Scalar lambda_min;
+
+  /** The rounded solution xhat = [t | R] in SE(d)^n */
+  Matrix xhat;
+
+  /** The value of the objective at xhat */
+  Scalar Fxhat;
+
+  /** An upper bound on the global suboptimality of xhat (valid if status is
+   * GlobalOpt) */
+  Scalar suboptimality_bound;
+
+  /** The termination status for this problem (one of GlobalOpt, SaddlePoint,
+   * or MaxRank) */
+  SESyncStatus status;
+
+  /** The total number of iterations performed for this problem */
+  size_t iterations;
+};
+
+class SESyncBatch {
+private:
+  /** Structure-of-arrays storage: the kth row holds the kth scalar entry of a
+   * (row-major) matrix for each of the L problems in the batch */
+  typedef Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+      LaneArray;
+
+  /** A row of per-lane scalars */
+  typedef Eigen::Array<Scalar, 1, Eigen::Dynamic> LaneScalars;
+
+  /** Number of problems in the batch */
+  size_t L_;
+
+  /** Number of poses */
+  size_t n_;
+
+  /** Dimensional parameter d for the special Euclidean group SE(d) */
+  size_t d_;
+
+  /** Dimension of the rotational state space N = n * d */
+  size_t N_;
+
+  SESyncBatchOpts options_;
+
+  /** The upper triangles of the (dense, symmetric) data matrices Q of the
+   * simplified formulation of each problem, stored row by row in
+   * structure-of-arrays form */
+  LaneArray Q_;
+
+  /** For each problem, the (N x n) matrix T such that the optimal translations
+   * corresponding to rotational states R are t = R * T */
+  std::vector<Matrix> T_;
+
+  /** For each problem, an upper bound on lambda_max(Q) */
+  LaneScalars Q_norm_;
+
+  /** Returns the data for lane l of the passed array, viewed as a row-major
+   * (rows x cols) matrix */
+  Matrix lane(const LaneArray &A, size_t l, size_t rows, size_t cols) const;
+
+  /** Sets lane l of the passed array to the passed matrix */
+  void set_lane(LaneArray &A, size_t l, const Matrix &X) const;
+
+  /** Returns the (full) data matrix Q of lane l */
+  Matrix data_matrix(size_t l) const;
+
+  /** Computes the Euclidean gradient G = 2 Y Q of the objective at the rank-r
+   * iterates Y */
+  void Euclidean_gradient(const LaneArray &Y, size_t r, LaneArray &G) const;
+
+  /** Computes the symmetric d x d blocks sym(Y_i' G_i) for the iterates Y and
+   * Euclidean gradients G */
+  void symmetric_block_products(const LaneArray &Y, const LaneArray &G,
+                                size_t r, LaneArray &P) const;
+
+  /** Computes the Riemannian gradients at the iterates Y */
+  void Riemannian_gradient(const LaneArray &Y, const LaneArray &G, size_t r,
+                           LaneArray &grad) const;
+
+  /** Retracts (in place) the points X onto the product of Stiefel manifolds
+   * St(d, r)^n by orthonormalizing each block of d columns */
+  void retract(LaneArray &X, size_t r) const;
+
+  /** Orthonormalizes each block of d columns of the passed (dense) matrix */
+  void orthonormalize_blocks(Matrix &Y) const;
+
+  /** Computes the spectral initialization for the problem with data matrix
+   * Q (whose spectral norm is at most Q_norm):  the rounding of the
+   * eigenvectors corresponding to the d smallest eigenvalues of Q */
+  Matrix spectral_initialization(const Matrix &Q, Scalar Q_norm) const;
+
+  /** Rounds the rank-r (dense) iterate Y to an element of SO(d)^n */
+  Matrix round_rotations(const Matrix &Y) const;
+
+public:
+  /** Construct a batch from a set of problems, each described by a vector of
+   * relative pose measurements.  All of the problems must involve the same
+   * number of poses, and the same ordered sequence of measured pairs (i, j);
+   * otherwise an std::invalid_argument exception is thrown. */
+  SESyncBatch(const std::vector<measurements_t> &problems,
+              const SESyncBatchOpts &options = SESyncBatchOpts());
+
+  /** Solves every problem in the batch */
+  std::vector<SESyncBatchResult> solve() const;
+
+  /** Returns the number of problems in the batch */
+  size_t size() const { return L_; }
+
+  /** Returns the number of poses in each problem */
+  size_t num_poses() const { return n_; }
+
+  /** Returns the dimension d of each problem */
+  size_t dimension() const { return d_; }
+};
+
+} // namespace SESync
@@ -0,0 +1,142 @@
+/** This file provides an optional cache of SE-Sync solutions, keyed by a
+ * fingerprint of the measurement set defining each problem (together with the
+ * options used to solve it).
+ *
+ * When a problem is submitted whose (quantized) measurements and
+ * solver-relevant options exactly match a cached entry, the stored
+ * SESyncResult is returned immediately.  When no exact match exists but a
+ * cached problem differs from the submitted one by only a few measurements (a
+ * "near hit"), its solution Yopt (and the corresponding level of the
+ * Riemannian Staircase) is used to warm-start SE-Sync.  The cache is bounded
+ * (in least-recently-used order) both in memory and, optionally, on disk.
+ *
+ * Copyright (C) 2016 - 2022 by David M. Rosen (dmrosen@mit.edu)
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "SESync/RelativePoseMeasurement.h"
+#include "SESync/SESync.h"
+#include "SESync/SESync_types.h"
+
+namespace SESync {
+
+/** This struct contains the parameters controlling an SESyncCache */
+struct SESyncCacheOpts {
+  /** Resolution to which all measurement values (rotations, translations, and
+   * precisions) are quantized before hashing; measurements that agree to
+   * within this resolution are considered identical */
+  Scalar quantization = 1e-9;
+
+  /** Maximum number of measurements that may be added, removed, or modified
+   * relative to a cached problem for it to be used as a warm start */
+  size_t max_edit_distance = 16;
+
+  /** Maximum number of solutions to retain in memory */
+  size_t max_memory_entries = 32;
+
+  /** Directory in which to persist cached solutions; if empty, solutions are
+   * only cached in memory */
+  std::string directory;
+
+  /** Maximum number of solutions to retain on disk */
+  size_t max_disk_entries = 256;
+};
+
+/** The manner in which a solve request was satisfied by the cache */
+enum class SESyncCacheOutcome { Hit, NearHit, Miss };
+
+class SESyncCache {
+private:
+  /** A single cached solution */
+  struct Entry {
+    /** Key of this entry (fingerprint of the quantized measurements, and of
+     * the options with which they were solved) */
+    uint64_t key;
+
+    /** Number of poses, dimension and formulation of the cached problem */
+    size_t n;
+    size_t d;
+    Formulation formulation;
+
+    /** Sorted fingerprints of the individual (quantized) measurements; used
+     * to compute edit distances between measurement sets */
+    std::vector<uint64_t> edge_keys;
+
+    /** The cached solution */
+    SESyncResult result;
+  };
+
+  SESyncCacheOpts opts_;
+
+  /** In-memory entries, most-recently used at the front */
+  std::list<Entry> entries_;
+  std::unordered_map<uint64_t, std::list<Entry>::iterator> index_;
+
+  /** Outcome statistics */
+  size_t hits_ = 0;
+  size_t near_hits_ = 0;
+  size_t misses_ = 0;
+
+  /** Computes the fingerprint of a single quantized measurement */
+  uint64_t edge_key(const RelativePoseMeasurement &measurement) const;
+
+  /** Computes the fingerprint of the options that determine the solution
+   * SE-Sync returns (stopping criteria, local solver, Riemannian Staircase,
+   * verification and initialization settings); options affecting only the
+   * speed of the solve (e.g. preconditioners, linear solver backends, or the
+   * number of threads) are excluded */
+  static uint64_t options_key(const SESyncOpts &options);
+
+  /** Returns the number of measurements that must be added or removed to
+   * transform one sorted set of edge keys into another */
+  static size_t edit_distance(const std::vector<uint64_t> &a,
+                              const std::vector<uint64_t> &b);
+
+  /** Insert an entry at the front of the in-memory cache, evicting the
+   * least-recently used entry if necessary */
+  void insert(Entry &&entry);
+
+  /** Path of the file in which the entry with the given key is persisted */
+  std::string entry_path(uint64_t key) const;
+
+  /** Persist / restore a single entry to / from disk */
+  void write_entry(const Entry &entry) const;
+  bool read_entry(uint64_t key, Entry &entry) const;
+
+  /** Remove the oldest persisted entries in excess of max_disk_entries */
+  void prune_directory() const;
+
+public:
+  explicit SESyncCache(const SESyncCacheOpts &opts = SESyncCacheOpts());
+
+  /** Given a vector of relative pose measurements and a set of SE-Sync
+   * options, this function returns the cached solution if an identical
+   * (quantized) problem has been solved before; otherwise it runs SE-Sync
+   * (warm-started from the nearest cached solution, if one lies within
+   * max_edit_distance of this problem), caches the result, and returns it.
+   * If 'outcome' is non-null, it is set to indicate which of these cases
+   * occurred. */
+  SESyncResult solve(const measurements_t &measurements,
+                     const SESyncOpts &options = SESyncOpts(),
+                     SESyncCacheOutcome *outcome = nullptr);
+
+  /** Remove all in-memory entries (persisted entries are left intact) */
+  void clear();
+
+  /// ACCESSORS
+
+  const SESyncCacheOpts &options() const { return opts_; }
+  size_t size() const { return entries_.size(); }
+  size_t hits() const { return hits_; }
+  size_t near_hits() const { return near_hits_; }
+  size_t misses() const { return misses_; }
+};
+
+} // namespace SESync
@@ -0,0 +1,124 @@
+/** This file provides facilities for checkpointing the state of an
+ * in-progress Riemannian Staircase, and for resuming SE-Sync from such a
+ * checkpoint (e.g. after the process running it has been preempted).
+ *
+ * Checkpointing is enabled by setting SESyncOpts::checkpoint_file; SE-Sync
+ * then periodically (every SESyncOpts::checkpoint_interval seconds, and upon
+ * ascending each level of the Staircase) records its state to that file.
+ * Checkpoints are written asynchronously by a background thread, so that the
+ * solver itself never blocks on I/O.
+ *
+ * Copyright (C) 2016 - 2022 by David M. Rosen (dmrosen@mit.edu)
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+
+#include "SESync/SESync.h"
+#include "SESync/SESyncProblem.h"
+#include "SESync/SESync_types.h"
+
+namespace SESync {
+
+/** This struct contains the state of an in-progress SE-Sync solve */
+struct SESyncCheckpoint {
+  /** Fingerprint of the measurements defining the problem being solved (cf.
+   * SESyncProblem::fingerprint()) */
+  uint64_t fingerprint = 0;
+
+  /** The formulation of the problem being solved */
+  Formulation formulation = Formulation::Simplified;
+
+  /** The current level of the Riemannian Staircase */
+  size_t level = 0;
+
+  /** The current relaxation rank; this is less than level if a saddle point
+   * was truncated to its numerical rank (cf. SESyncOpts::reduce_rank) */
+  size_t r = 0;
+
+  /** The current iterate (an r x (problem columns) matrix) */
+  Matrix Y;
+
+  /** The current trust-region radius of the truncated-Newton trust-region
+   * method */
+  Scalar trust_region_radius = 1;
+
+  /** The number of truncated-Newton trust-region iterations already performed
+   * at the current level */
+  size_t TNT_iterations = 0;
+
+  /** The total computation time consumed by the Riemannian Staircase so far */
+  double elapsed_time = 0;
+
+  /** The results accumulated over all *completed* levels of the Staircase
+   * (the per-level histories, initialization time, and verification
+   * statistics); histories of the level in progress are not recorded, and
+   * neither are logged iterates.  This is shared (rather than copied) by the
+   * checkpoints written during the same level.  If null, no levels have been
+   * completed. */
+  std::shared_ptr<const SESyncResult> result;
+};
+
+/** Returns a copy of the parts of 'result' that are recorded in checkpoints
+ * (cf. SESyncCheckpoint::result); in particular, the (potentially large)
+ * solution matrices and logged iterates are omitted */
+std::shared_ptr<const SESyncResult>
+checkpoint_result(const SESyncResult &result);
+
+/** Write the passed checkpoint to a binary file.  The file is first written
+ * under a temporary name and then renamed, so that an existing checkpoint is
+ * never left partially overwritten. */
+void save_checkpoint(const std::string &filename,
+                     const SESyncCheckpoint &checkpoint);
+
+/** Read a checkpoint written by save_checkpoint().  Throws
+ * std::runtime_error if the file is truncated or malformed (e.g., if a stored
+ * length exceeds the data remaining in the file, or the iterate does not have
+ * r rows). */
+SESyncCheckpoint load_checkpoint(const std::string &filename);
+
+/** This class writes checkpoints to a file asynchronously, using a background
+ * thread.  If a new checkpoint is submitted before the previous one has been
+ * written, only the most recent is kept. */
+class CheckpointWriter {
+private:
+  std::string filename_;
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::optional<SESyncCheckpoint> pending_;
+  bool done_ = false;
+
+  std::thread worker_;
+
+  void run();
+
+public:
+  explicit CheckpointWriter(const std::string &filename);
+
+  CheckpointWriter(const CheckpointWriter &) = delete;
+  CheckpointWriter &operator=(const CheckpointWriter &) = delete;
+
+  /** Queue a checkpoint for writing */
+  void submit(SESyncCheckpoint &&checkpoint);
+
+  /** Writes any pending checkpoint, then stops the background thread */
+  ~CheckpointWriter();
+};
+
+/** Given an SESyncProblem instance and the name of a checkpoint file written
+ * while solving it, this function resumes the Riemannian Staircase from the
+ * recorded state.  Throws an std::invalid_argument exception if the checkpoint
+ * does not match the problem (including if its iterate is not an
+ * r x problem.iterate_columns() matrix). */
+SESyncResult resume(SESyncProblem &problem, const std::string &checkpoint,
+                    const SESyncOpts &options = SESyncOpts());
+
+} // namespace SESync
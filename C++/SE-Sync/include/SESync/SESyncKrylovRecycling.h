@@ -0,0 +1,130 @@
+/** This file provides Krylov subspace recycling for the truncated
+ * preconditioned conjugate-gradient (tCG) method used to solve the
+ * trust-region subproblems in the truncated-Newton trust-region method (TNT).
+ *
+ * Consecutive outer iterations of TNT solve closely related subproblems: the
+ * iterates are nearby, the preconditioner is the same, and the Hessian changes
+ * only slightly.  A KrylovRecycler exploits this by retaining a small
+ * deflation space W of Ritz vectors of the Hessian from the previous outer
+ * iteration.  At each new iterate, these Ritz vectors are transported to the
+ * new tangent space, and the Hessian is projected onto their span; the
+ * resulting coarse-space correction
+ *
+ *   P(V) = M^{-1} V + W (W^T H W)^{-1} W^T V
+ *
+ * is then added to the preconditioner M^{-1} used by tCG, so that the
+ * (smallest positive) part of the Hessian spectrum captured by W is resolved
+ * in the first tCG iteration, rather than being rediscovered by the Krylov
+ * iteration.  Since P is symmetric positive-definite whenever M^{-1} and
+ * W^T H W are, this augmentation requires no modification of the tCG method
+ * itself: the recycler simply wraps the local quadratic model (to observe the
+ * Krylov directions on which tCG applies the Hessian) and the preconditioner.
+ *
+ * Ritz vectors are extracted by the Rayleigh-Ritz procedure applied to the
+ * span of the previous deflation space together with the first few Krylov
+ * directions generated by tCG in the previous outer iteration, and those with
+ * the smallest positive Ritz values are retained; directions of nonpositive
+ * curvature are discarded, so that P remains positive-definite.  Projecting
+ * the Hessian onto the transported deflation space costs one Hessian-vector
+ * product per retained vector at each outer iteration; this overhead is
+ * reported by Hessian_vector_products().
+ *
+ * Copyright (C) 2016 - 2022 by David M. Rosen (dmrosen@mit.edu)
+ */
+
+#pragma once
+
+#include <optional>
+#include <vector>
+
+#include "Optimization/Riemannian/TNT.h"
+
+#include "SESync/SESync_types.h"
+
+namespace SESync {
+
+class KrylovRecycler {
+public:
+  typedef Optimization::Riemannian::LinearOperator<Matrix, Matrix, Matrix>
+      LinearOperator;
+  typedef Optimization::Riemannian::QuadraticModel<Matrix, Matrix, Matrix>
+      QuadraticModel;
+  typedef Optimization::Riemannian::RiemannianMetric<Matrix, Matrix, Scalar,
+                                                     Matrix>
+      RiemannianMetric;
+
+private:
+  /// Parameters
+
+  /** Maximum dimension of the deflation space */
+  size_t dimension_;
+
+  /** Maximum number of Krylov directions captured in each outer iteration */
+  size_t capture_dimension_;
+
+  /** Riemannian metric and vector transport */
+  RiemannianMetric metric_;
+  LinearOperator transport_;
+
+  /// State
+
+  /** An orthonormal basis for the current deflation space, the corresponding
+   * Hessian-vector products, and the inverses of the (positive) eigenvalues of
+   * the projected Hessian W^T H W (with respect to which W is diagonal) */
+  std::vector<Matrix> W_, HW_;
+  std::vector<Scalar> inverse_Ritz_values_;
+
+  /** Krylov directions V (and their Hessian-vector products HV) captured from
+   * the tCG solve(s) at the current iterate */
+  std::vector<Matrix> V_, HV_;
+
+  /** Total number of Hessian-vector products spent on projecting the Hessian
+   * onto the deflation space */
+  size_t Hessian_vector_products_ = 0;
+
+  /** Recomputes the deflation space at the new iterate Y, using the Hessian
+   * operator HessOp at that point */
+  void update(const Matrix &Y, const LinearOperator &HessOp,
+              Matrix &NablaF_Y);
+
+  /** Applies the coarse-space correction W (W^T H W)^{-1} W^T to V at Y */
+  Matrix coarse_correction(const Matrix &Y, const Matrix &V,
+                           Matrix &NablaF_Y) const;
+
+public:
+  /** Construct a recycler that retains a deflation space of at most
+   * 'dimension' Ritz vectors; these are extracted from the span of the
+   * previous deflation space together with (at most) the first
+   * 'capture_dimension' Krylov directions of each outer iteration (if this is
+   * 0, 2 * dimension directions are captured).  Here 'metric' is the
+   * Riemannian metric, and 'transport' is the vector transport (mapping a
+   * tangent vector at the previous iterate to the tangent space at the passed
+   * iterate), exactly as in RiemannianLBFGS(). */
+  KrylovRecycler(size_t dimension, const RiemannianMetric &metric,
+                 const LinearOperator &transport, size_t capture_dimension = 0);
+
+  /** Returns the local quadratic model QM, augmented to record the Krylov
+   * directions generated by tCG and to update the deflation space at each new
+   * iterate.  The returned function refers to this recycler, which must
+   * therefore outlive it. */
+  QuadraticModel quadratic_model(const QuadraticModel &QM);
+
+  /** Returns the preconditioner 'precon' (or the identity, if this is not
+   * set), augmented with the coarse-space correction determined by the current
+   * deflation space.  The returned function refers to this recycler, which
+   * must therefore outlive it. */
+  LinearOperator preconditioner(const std::optional<LinearOperator> &precon);
+
+  /** Discards the deflation space and any captured Krylov directions */
+  void reset();
+
+  /** Returns the current dimension of the deflation space */
+  size_t deflation_dimension() const { return W_.size(); }
+
+  /** Returns the total number of Hessian-vector products spent on projecting
+   * the Hessian onto the deflation space (these are in addition to those
+   * performed by tCG itself) */
+  size_t Hessian_vector_products() const { return Hessian_vector_products_; }
+};
+
+} // namespace SESync
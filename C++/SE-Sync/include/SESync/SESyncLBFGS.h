@@ -0,0 +1,111 @@
+/** This file provides a Riemannian limited-memory BFGS method, which may be used
+ * in place of the truncated-Newton trust-region method (TNT) to solve the
+ * rank-restricted relaxation at any level of the Riemannian Staircase (cf.
+ * SESyncOpts::local_solver).
+ *
+ * Each iteration requires a single gradient evaluation and (typically) a single
+ * function evaluation, and no Hessian-vector products.  Search directions are
+ * computed using the standard two-loop recursion, with the (optional)
+ * preconditioner serving as the initial inverse Hessian approximation;
+ * curvature pairs from previous iterations are transported to the tangent
+ * space at the current iterate by orthogonal projection.  The stepsize along
+ * each direction is selected by backtracking to satisfy the Armijo condition,
+ * and curvature pairs that fail to satisfy a (cautious) positive-curvature
+ * condition are discarded, so that the inverse Hessian approximation remains
+ * positive-definite.
+ *
+ * Copyright (C) 2016 - 2022 by David M. Rosen (dmrosen@mit.edu)
+ */
+
+#pragma once
+
+#include <limits>
+#include <optional>
+
+#include "Optimization/Riemannian/TNT.h"
+
+#include "SESync/SESync_types.h"
+
+namespace SESync {
+
+/** This struct contains the various parameters that control the Riemannian
+ * L-BFGS method */
+struct LBFGSParams {
+  /** Stopping tolerance for the norm of the Riemannian gradient */
+  Scalar gradient_tolerance = 1e-6;
+
+  /** Stopping tolerance for the norm of the preconditioned Riemannian gradient
+   */
+  Scalar preconditioned_gradient_tolerance = 1e-6;
+
+  /** Stopping criterion based upon the relative decrease in function value
+   * between iterations */
+  Scalar relative_decrease_tolerance = 1e-9;
+
+  /** Stopping criterion based upon the norm of an update step */
+  Scalar stepsize_tolerance = 1e-9;
+
+  /** Maximum permitted number of iterations */
+  size_t max_iterations = 1000;
+
+  /** Maximum elapsed computation time (in seconds) */
+  double max_computation_time = std::numeric_limits<double>::max();
+
+  /** The number of curvature pairs retained in the inverse Hessian
+   * approximation */
+  size_t memory = 10;
+
+  /** Sufficient-decrease parameter for the Armijo condition */
+  Scalar armijo_c1 = 1e-4;
+
+  /** Maximum number of stepsize halvings in the backtracking line search */
+  size_t max_backtracks = 20;
+
+  /** Whether to print output as the algorithm runs */
+  bool verbose = false;
+
+  /** Whether to log and return the entire sequence of iterates */
+  bool log_iterates = false;
+};
+
+/** The L-BFGS method records the same histories as TNT, so that the two local
+ * solvers may be used interchangeably within the Riemannian Staircase.  Since
+ * L-BFGS requires no Hessian-vector products, the 'inner_iterations' history
+ * is identically zero; 'update_step_M_norms' records the norms of the update
+ * steps in the metric determined by the L-BFGS Hessian approximation, and
+ * 'gain_ratios' the ratios of actual to (first-order) predicted decrease. */
+typedef Optimization::Riemannian::TNTResult<Matrix, Scalar> LBFGSResult;
+
+/** Runs the Riemannian L-BFGS method from the initial iterate x0.  Here:
+ *
+ * - f, QM, metric, and retract are the objective, local quadratic model,
+ *   Riemannian metric, and retraction, exactly as required by TNT (only the
+ *   gradient computed by QM is used in the optimization; the Hessian operator
+ *   is passed through to the user function)
+ * - transport is the vector transport: it maps a (tangent) vector at the
+ *   previous iterate to the tangent space at the passed iterate; for an
+ *   embedded submanifold this is simply the orthogonal projection
+ * - precon is an optional positive-definite preconditioner, which is used as
+ *   the initial inverse Hessian approximation in the two-loop recursion
+ * - user_function is an optional user-supplied function, called at the end of
+ *   each iteration (with 'Delta' set to the accepted stepsize, and
+ *   'num_STPCG_iters' to 0); if it returns true, the algorithm terminates.
+ *
+ * The termination status is reported using the TNTStatus flags. */
+LBFGSResult RiemannianLBFGS(
+    const Optimization::Objective<Matrix, Scalar, Matrix> &f,
+    const Optimization::Riemannian::QuadraticModel<Matrix, Matrix, Matrix> &QM,
+    const Optimization::Riemannian::RiemannianMetric<Matrix, Matrix, Scalar,
+                                                     Matrix> &metric,
+    const Optimization::Riemannian::Retraction<Matrix, Matrix, Matrix>
+        &retract,
+    const Optimization::Riemannian::LinearOperator<Matrix, Matrix, Matrix>
+        &transport,
+    const Matrix &x0, Matrix &NablaF_x,
+    const std::optional<
+        Optimization::Riemannian::LinearOperator<Matrix, Matrix, Matrix>>
+        &precon = std::nullopt,
+    const LBFGSParams &params = LBFGSParams(),
+    const std::optional<SESyncTNTUserFunction> &user_function = std::nullopt);
+
+} // namespace SESync
@@ -0,0 +1,106 @@
+/** This file provides a memory governor that keeps the sparse factorizations
+ * performed by SE-Sync within a fixed memory budget.
+ *
+ * Before a problem instance is constructed, the governor estimates the memory
+ * required by each of the factorizations that SE-Sync will perform (the
+ * orthogonal projection, the regularized Cholesky preconditioner, the chordal
+ * initialization, and solution verification), together with that of the data
+ * matrices themselves.  The sizes of the factors are obtained from the same
+ * symbolic analysis of the pose-graph Laplacian used by the autotuner (cf.
+ * compute_problem_features()):  since each of SE-Sync's data matrices has
+ * the block sparsity pattern of this Laplacian (with d x d, (d+1) x (d+1), or
+ * d^2 x d^2 blocks), so does (up to padding within the blocks) each of their
+ * Cholesky factors.  No numerical factorization is performed, so the estimate
+ * costs about as much as reading the measurements.
+ *
+ * The factorizations are then considered in the order in which SE-Sync
+ * performs them; whenever one would not fit into the part of the budget that
+ * remains after those that precede it, it is replaced by a lower-memory
+ * alternative:
+ *
+ * - the orthogonal projection is computed iteratively, using preconditioned
+ *   conjugate gradients (cf. SparseSolverBackend::PCG);
+ * - the regularized Cholesky preconditioner is replaced by the Jacobi
+ *   preconditioner;
+ * - the chordal initialization is replaced by the spanning-tree
+ *   initialization (cf. spanning_tree_initialization());
+ * - the direct factorization of the certificate matrix performed during
+ *   verification is skipped, so that preconditioned LOBPCG can only search
+ *   for directions of negative curvature (cf. fast_verification()); solutions
+ *   can then no longer be certified, and are reported as Uncertified (cf.
+ *   SESyncResult::direct_verification);
+ * - the fill of the incomplete LDL^T factorization used to precondition
+ *   LOBPCG during verification is reduced.
+ *
+ * Each such decision is recorded, so that SE-Sync degrades gracefully (and
+ * reports why) instead of exhausting the available memory.  The governor is
+ * applied to the options actually used for the solve by prepare_problem()
+ * (and hence by SESync(), when called with a set of measurements), which
+ * constructs the problem with the governed factorizations.
+ *
+ * Copyright (C) 2016 - 2022 by David M. Rosen (dmrosen@mit.edu)
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "SESync/RelativePoseMeasurement.h"
+#include "SESync/SESync.h"
+#include "SESync/SESyncAutotuner.h"
+#include "SESync/SESync_types.h"
+
+namespace SESync {
+
+/** Estimated memory (in bytes) required by the data matrices and
+ * factorizations of an SE-Sync problem under a given configuration */
+struct MemoryEstimate {
+  /** The data matrices constructed by SESyncProblem (A, B1, B2, B3, M,
+   * LGrho, and the auxiliary matrices of the Simplified formulation) */
+  size_t data_matrices = 0;
+
+  /** The factorization used to compute the orthogonal projection (only
+   * nonzero for the Simplified formulation) */
+  size_t projection = 0;
+
+  /** The preconditioner used in the Riemannian trust-region method */
+  size_t preconditioner = 0;
+
+  /** Constructing the initial iterate (the QR factorization of B3 for the
+   * chordal initialization) */
+  size_t initialization = 0;
+
+  /** Solution verification:  the certificate matrix, its Cholesky factor, and
+   * the incomplete LDL^T factorization used to precondition LOBPCG */
+  size_t verification = 0;
+
+  /** The peak memory:  the data matrices, projection, and preconditioner
+   * persist throughout the solve, while the initialization and verification
+   * are transient (and never coexist) */
+  size_t peak() const {
+    return data_matrices + projection + preconditioner +
+           std::max(initialization, verification);
+  }
+};
+
+/** Estimates the memory required to solve the problem with the passed
+ * features using the passed options */
+MemoryEstimate estimate_memory_usage(const ProblemFeatures &features,
+                                     const SESyncOpts &options);
+
+/** Returns a copy of 'options' in which every factorization that would not
+ * fit within options.memory_budget_bytes (given the memory required by the
+ * data matrices and the factorizations performed before it) has been replaced
+ * by a lower-memory alternative, for the problem defined by 'measurements'.
+ * A human-readable description of each change is appended to 'decisions', and
+ * the estimated memory required under the returned options is written to
+ * 'estimate'.  If the budget is 0 (unlimited), the options are returned
+ * unchanged (but the estimate is still computed). */
+SESyncOpts govern_memory(const measurements_t &measurements,
+                         const SESyncOpts &options,
+                         std::vector<std::string> &decisions,
+                         MemoryEstimate &estimate);
+
+} // namespace SESync
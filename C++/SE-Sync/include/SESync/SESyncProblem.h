@@ -11,6 +11,10 @@
 
 #pragma once
 
+#include <limits>
+#include <string>
+#include <vector>
+
 /** Use external matrix factorizations/linear solves provided by SuiteSparse
  * (SPQR and Cholmod) */
 
@@ -22,20 +26,25 @@
 #include "SESync/RelativePoseMeasurement.h"
 #include "SESync/SESync_types.h"
 #include "SESync/SESync_utils.h"
+#include "SESync/SparseFactorization.h"
 #include "SESync/StiefelProduct.h"
 
 namespace SESync {
 
-/** The type of the sparse Cholesky factorization to use in the computation of
- * the orthogonal projection operation */
-typedef Eigen::CholmodDecomposition<SparseMatrix> SparseCholeskyFactorization;
-
 /** The type of the QR decomposition to use in the computation of the orthogonal
  * projection operation */
 typedef Eigen::SPQR<SparseMatrix> SparseQRFactorization;
 
+/** Forward declaration of the compile-time specializations of the operators
+ * defined by an SESyncProblem (see SESync/SESyncProblemT.h) */
+template <Formulation F, int Dim> class SESyncProblemT;
+
 class SESyncProblem {
 private:
+  /** The compile-time specializations of this problem's operators require
+   * access to its cached data matrices and factorizations */
+  template <Formulation F, int Dim> friend class SESyncProblemT;
+
   /// PROBLEM DATA
 
   /** The specific formulation of the SE-Sync problem to be solved
@@ -89,10 +98,10 @@ private:
    * efficiency, since it's used frequently.  Only used in Simplified mode. */
   SparseMatrix TT_SqrtOmega_;
 
-  /** An Eigen sparse linear solver that encodes the Cholesky factor L used
-   * in the computation of the orthogonal projection function (cf. eq. 39 of the
+  /** A sparse linear solver that encodes the Cholesky factor L used in the
+   * computation of the orthogonal projection function (cf. eq. 39 of the
    * SE-Sync tech report) */
-  SparseCholeskyFactorization L_;
+  std::unique_ptr<SparseFactorization> L_;
 
   /** An Eigen sparse linear solver that encodes the QR factorization used in
    * the computation of the orthogonal projection function (cf. eq. 98 of the
@@ -114,12 +123,38 @@ private:
   DiagonalMatrix Jacobi_precon_;
 
   /** Tikhonov-regularized Cholesky Preconditioner */
-  SparseCholeskyFactorization reg_Chol_precon_;
+  std::unique_ptr<SparseFactorization> reg_Chol_precon_;
 
   /** Upper-bound on the admissible condition number of the regularized
    * approximate Hessian matrix used for Cholesky preconditioner */
   Scalar reg_Chol_precon_max_cond_;
 
+  /** The Tikhonov regularization constant lambda_reg used to construct the
+   * regularized Cholesky preconditioner */
+  Scalar reg_Chol_precon_lambda_ = 0;
+
+  /** A fingerprint (hash) of the measurements defining this problem */
+  uint64_t fingerprint_ = 0;
+
+  /** If the pose IDs in the measurements defining this problem were not
+   * contiguous, the original ID of each (densely relabeled) pose; otherwise,
+   * empty (cf. compacted_measurements()) */
+  std::vector<size_t> pose_ids_;
+
+  /** The number of threads made available to the sparse factorizations (cf.
+   * SESync/SESync_threading.h); 0 leaves the thread settings of OpenMP, the
+   * BLAS and CHOLMOD unchanged */
+  size_t num_threads_ = 0;
+
+  /** The sparse linear solver backends to use for the projection,
+   * preconditioner and verification */
+  SparseSolverOpts sparse_solvers_;
+
+  /** Upper bound on the fill factor of the incomplete LDL^T factorization used
+   * to precondition LOBPCG during solution verification (e.g., as imposed by
+   * the memory governor; cf. SESync/SESyncMemoryGovernor.h) */
+  Scalar max_verification_fill_factor_ = std::numeric_limits<Scalar>::max();
+
   /** The underlying manifold in which the generalized orientations lie in the
   rank-restricted Riemannian optimization problem (Problem 9 in the SE-Sync tech
   report).*/
@@ -137,6 +172,22 @@ private:
   SparseMatrix compute_Lambda_from_Lambda_blocks(const Matrix &Lambda_blocks,
                                                  size_t offset) const;
 
+  /** Private helper function: computes and caches the factorization (Cholesky
+   * or QR) used to evaluate the orthogonal projection operator Pi from the
+   * (previously-constructed) matrix Ared_SqrtOmega_ */
+  void factorize_projection();
+
+  /** Private helper function: computes and caches the Cholesky factorization
+   * of the regularized data matrix D + lambda_reg * I used by the regularized
+   * Cholesky preconditioner, using the (previously-computed) regularization
+   * constant reg_Chol_precon_lambda_ */
+  void factorize_regularized_Cholesky_preconditioner();
+
+  /** Private helper function: given a matrix B with n - 1 rows, computes and
+   * returns (Ared * Omega * Ared')^-1 * B using the cached factorization of
+   * the orthogonal projection (only valid in Simplified mode) */
+  Matrix reduced_Laplacian_solve(const Matrix &B) const;
+
 public:
   /// CONSTRUCTORS AND MUTATORS
 
@@ -146,7 +197,10 @@ public:
   /** Basic constructor.  Here
    *
    * - measurements is a vector of relative pose measurements defining the
-          pose-graph SLAM problem to be solved.
+          pose-graph SLAM problem to be solved.  If their pose IDs are not
+          contiguous, the poses are relabeled densely (cf. pose_ids()), and
+          every iterate and estimate of this problem refers to the relabeled
+          poses.
    * - formulation is an enum type specifying whether to solve the simplified
    *      form of the SDP relaxation (in which translational states have been
    *      eliminated) or the explicit form (in which the translational states
@@ -157,6 +211,27 @@ public:
    *      formulation of the special Euclidean synchronization problem
    *  - preconditioner is an enum type specifying the preconditioning strategy
    *      to employ
+   *  - num_threads is the number of threads made available to the sparse
+   *      factorizations computed by this problem (during construction, and
+   *      for initialization, rounding and verification); if this is 0, the
+   *      thread settings of OpenMP, the BLAS and CHOLMOD are left unchanged
+   *  - sparse_solvers selects the sparse linear solver backend used for the
+   *      projection, preconditioner and verification
+   *  - max_verification_fill_factor is an upper bound on the fill factor of
+   *      the incomplete LDL^T factorization used to precondition LOBPCG
+   *      during solution verification.
+   *
+   * The problem uses exactly the configuration passed to it; to keep its
+   * factorizations within a memory budget, govern the options with
+   * govern_memory() first (as prepare_problem() does).  In particular, if
+   * sparse_solvers.verification is PCG, verify_solution() can only search for
+   * directions of negative curvature, and never certifies a solution (cf.
+   * fast_verification()).
+   *
+   * If the incomplete Cholesky preconditioner of a PCG backend breaks down,
+   * the corresponding matrix is factored directly (with CHOLMOD) instead;
+   * std::runtime_error is thrown if a direct factorization fails (e.g.
+   * because the pose graph is not connected).
    */
   SESyncProblem(const measurements_t &measurements,
                 const Formulation &formulation = Formulation::Simplified,
@@ -164,11 +239,46 @@ public:
                     ProjectionFactorization::Cholesky,
                 const Preconditioner &preconditioner =
                     Preconditioner::RegularizedCholesky,
-                Scalar reg_chol_precon_max_cond = 1e6);
+                Scalar reg_chol_precon_max_cond = 1e6,
+                size_t num_threads = 0,
+                const SparseSolverOpts &sparse_solvers = SparseSolverOpts(),
+                Scalar max_verification_fill_factor =
+                    std::numeric_limits<Scalar>::max());
 
   /** Set the maximum rank of the rank-restricted semidefinite relaxation */
   void set_relaxation_rank(size_t rank);
 
+  /// PERSISTENCE
+
+  /** Write this (fully-constructed) problem instance to a binary file.  This
+   * stores all of the assembled data matrices, the preconditioner
+   * regularization constant, the thread count and sparse solver settings, a
+   * fingerprint of the measurements from which the problem was constructed,
+   * and the cached Cholesky factorizations used by the orthogonal projection
+   * and the regularized Cholesky preconditioner (in explicit LDL^T form; cf.
+   * LDLTFactor), together with a checksum of the file's contents.  Each
+   * stored array is aligned so that the file can be memory-mapped. Throws
+   * std::runtime_error on failure. */
+  void save(const std::string &filename) const;
+
+  /** Replace this problem instance with the one stored in the given file by
+   * save().  The file is memory-mapped (where supported), and its checksum
+   * and the dimensions and sparsity structure of each stored matrix are
+   * validated.  This avoids all of the matrix assembly, spectral norm
+   * estimation, and Cholesky factorization performed by the constructor; the
+   * stored factors are applied using sparse triangular solves (cf.
+   * StoredLDLTFactorization).  Only the factorizations that have no explicit
+   * form (the QR decomposition and the incomplete Cholesky preconditioner of
+   * the PCG backend) are recomputed from the stored matrices.  Throws
+   * std::runtime_error if the file cannot be read or is not a valid (or is a
+   * corrupt) SE-Sync problem file. */
+  void load(const std::string &filename);
+
+  /** As above, but additionally validates that the stored problem was
+   * constructed from exactly the passed set of measurements, throwing
+   * std::runtime_error if not. */
+  void load(const std::string &filename, const measurements_t &measurements);
+
   /// ACCESSORS
 
   /** Returns the specific formulation of this problem */
@@ -190,6 +300,21 @@ public:
     return reg_Chol_precon_max_cond_;
   }
 
+  /** Returns the number of threads made available to the sparse
+   * factorizations */
+  size_t num_threads() const { return num_threads_; }
+
+  /** Returns the sparse linear solver backends used by this problem */
+  const SparseSolverOpts &sparse_solver_options() const {
+    return sparse_solvers_;
+  }
+
+  /** Returns the upper bound on the fill factor of the incomplete LDL^T
+   * factorization used to precondition LOBPCG during solution verification */
+  Scalar max_verification_fill_factor() const {
+    return max_verification_fill_factor_;
+  }
+
   /** Returns the number of states (poses or rotations) appearing in this
    * problem */
   size_t num_states() const { return n_; }
@@ -197,10 +322,26 @@ public:
   /** Returns the number of measurements in this problem */
   size_t num_measurements() const { return m_; }
 
+  /** Returns the fingerprint of the measurements defining this problem (cf.
+   * measurements_fingerprint()) */
+  uint64_t fingerprint() const { return fingerprint_; }
+
+  /** If the pose IDs in the measurements defining this problem were not
+   * contiguous, returns the original ID of each pose of this problem (which
+   * were relabeled densely); otherwise, returns an empty vector */
+  const std::vector<size_t> &pose_ids() const { return pose_ids_; }
+
   /** Returns the dimensional parameter d for the special Euclidean group SE(d)
    * over which this problem is defined */
   size_t dimension() const { return d_; }
 
+  /** Returns the number of columns of the iterates Y of this problem (d*n for
+   * the Simplified and SOSync formulations, and (d+1)*n for the Explicit
+   * formulation) */
+  size_t iterate_columns() const {
+    return (form_ == Formulation::Explicit ? (d_ + 1) * n_ : d_ * n_);
+  }
+
   /** Returns the current relaxation rank r of this problem */
   size_t relaxation_rank() const { return r_; }
 
@@ -216,7 +357,7 @@ public:
   // to optimize matrix expressions as compile time
   inline Matrix Pi_product(const Matrix &X) const {
     if (projection_factorization_ == ProjectionFactorization::Cholesky)
-      return X - SqrtOmega_AredT_ * L_.solve(Ared_SqrtOmega_ * X);
+      return X - SqrtOmega_AredT_ * L_->solve(Ared_SqrtOmega_ * X);
     else {
       Matrix PiX = X;
       for (size_t c = 0; c < X.cols(); c++) {
@@ -326,7 +467,10 @@ public:
    * boolean value indicating whether S(Y) is positive-semidefinite.  In the
    * event that S is *not* positive-semidefinite, it also computes a direction
    * of negative curvature x of S, and its corresponding Rayleigh quotient
-   * theta := x'*S*x < 0.  Here:
+   * theta := x'*S*x < 0.  If the verification backend is PCG (cf.
+   * SparseSolverOpts::verification), S(Y) is not factored, and this always
+   * returns false; S(Y) is then only known not to be PSD if theta < -eta / 2.
+   * Here:
    *
    * - eta is a numerical tolerance for S(Y)'s positive-semidefiniteness: we
    *   test the positive semidefiniteness of the *regularized* certificate
@@ -342,20 +486,60 @@ public:
    *   sparse triangular factor L is guanteed to have at most max_fill_factor *
    *   (nnz(A) / dim(A)) nonzero elements, and any elements l in L_k (the kth
    *   column of L) satisfying |l| <= drop_tol * |L_k|_1 will be set to 0
+   *   (max_fill_factor is additionally limited to this problem's
+   *   max_verification_fill_factor())
+   * - LOBPCG_precon selects the preconditioner to use with LOBPCG
+   * - deflate is a Boolean value indicating whether to deflate the known
+   *   near-null directions of S(Y) (cf. certificate_nullspace_basis()) from the
+   *   LOBPCG iteration
+   * - eigensolver selects the method used to compute the minimum eigenpair of
+   *   S(Y), and Chebyshev_degree the degree of the polynomial filter used by
+   *   VerificationEigensolver::ChebyshevFilter
+   * - max_computation_time is the maximum elapsed time (in seconds) for the
+   *   eigensolver (cf. fast_verification())
+   * - seed initializes the random number generator used to construct the
+   *   eigensolver's starting block
    */
   bool verify_solution(const Matrix &Y, Scalar eta, size_t nx, Scalar &theta,
                        Vector &x, size_t &num_iters,
                        size_t max_LOBPCG_iters = 1000,
-                       Scalar max_fill_factor = 3,
-                       Scalar drop_tol = 1e-3) const;
+                       Scalar max_fill_factor = 3, Scalar drop_tol = 1e-3,
+                       VerificationPreconditioner LOBPCG_precon =
+                           VerificationPreconditioner::ILDL,
+                       bool deflate = false,
+                       VerificationEigensolver eigensolver =
+                           VerificationEigensolver::LOBPCG,
+                       size_t Chebyshev_degree = 10,
+                       double max_computation_time =
+                           std::numeric_limits<double>::max(),
+                       uint64_t seed = 0) const;
+
+  /** Given a critical point Y of the rank-r relaxation, this function computes
+   * and returns a matrix with orthonormal columns spanning the known
+   * near-nullspace of the certificate matrix S(Y): since S(Y) * X' = 0 at a
+   * critical point, where X is the (full, translation-explicit) lift of Y,
+   * this contains the columns of X', together with (for the
+   * special Euclidean formulations) the global translation direction */
+  Matrix certificate_nullspace_basis(const Matrix &Y) const;
 
   /** Computes and returns the chordal initialization for the
    * rank-restricted semidefinite relaxation */
   Matrix chordal_initialization() const;
 
+  /** Given a set of pose estimates xhat = [t | R] (a d x (d+1)n matrix in the
+   * format returned by round_solution(), e.g. the vertex estimates read by
+   * read_g2o_file()), this function computes and returns the corresponding
+   * point in the domain of the rank-r relaxation.  The rotational blocks are
+   * projected onto the Stiefel manifold, so that estimates that are only
+   * approximately orthonormal are admissible; the translations are used only
+   * by the Explicit formulation, and may be omitted (i.e., xhat may be d x dn)
+   * for the others. */
+  Matrix lift_estimate(const Matrix &xhat) const;
+
   /** Randomly samples a point in the domain for the rank-restricted
-   * semidefinite relaxation */
-  Matrix random_sample() const;
+   * semidefinite relaxation, using the passed seed to initialize the
+   * (counter-based) random number generator */
+  Matrix random_sample(uint64_t seed = 0) const;
 
   ~SESyncProblem() {
     if (QR_)
@@ -0,0 +1,262 @@
+/** This file provides compile-time specializations of the geometric and
+ * objective operators defined by an SESyncProblem.
+ *
+ * An SESyncProblemT<F, Dim> is a lightweight view onto an existing
+ * SESyncProblem whose problem formulation F (and, optionally, dimension Dim of
+ * the rotational blocks) is fixed at compile time.  All of the operators
+ * required by the Riemannian truncated-Newton trust-region method (objective,
+ * gradient, Hessian-vector product, preconditioner, tangent space projection
+ * and retraction) are defined inline here, so that the compiler can see
+ * through the entire Q_product -> Pi_product -> Proj chain without branching on
+ * the problem formulation at each call, and so that the d x d block operations
+ * on the product of Stiefel manifolds can be carried out using fixed-size
+ * matrices when d is known.
+ *
+ * The (runtime) SESyncProblem class remains the user-facing interface; it
+ * dispatches to these specializations via visit_specialized_problem().
+ *
+ * Copyright (C) 2016 - 2022 by David M. Rosen (dmrosen@mit.edu)
+ */
+
+#pragma once
+
+#include <Eigen/Dense>
+#include <Eigen/Eigenvalues>
+
+#include "SESync/SESyncProblem.h"
+#include "SESync/SESync_types.h"
+#include "SESync/SESync_utils.h"
+
+namespace SESync {
+
+template <Formulation F, int Dim = Eigen::Dynamic> class SESyncProblemT {
+private:
+  /** The problem instance whose cached data matrices and factorizations this
+   * specialization operates on */
+  const SESyncProblem &problem_;
+
+  /** Fixed-size types for the d x d blocks appearing in the block-diagonal
+   * operations on the product of Stiefel manifolds */
+  typedef Eigen::Matrix<Scalar, Dim, Dim> BlockMatrix;
+  typedef Eigen::Block<Matrix, Eigen::Dynamic, Dim> ColumnBlock;
+  typedef Eigen::Block<const Matrix, Eigen::Dynamic, Dim> ConstColumnBlock;
+
+  /** Offset of the column at which the rotational blocks begin in an element
+   * of the domain of the relaxation */
+  size_t rotation_offset() const {
+    return (F == Formulation::Explicit ? problem_.n_ : 0);
+  }
+
+  /** Helper function: returns the ith r x d rotational block of X */
+  ConstColumnBlock rotation_block(const Matrix &X, size_t i) const {
+    return ConstColumnBlock(X, 0, rotation_offset() + i * problem_.d_,
+                            X.rows(), problem_.d_);
+  }
+
+  ColumnBlock rotation_block(Matrix &X, size_t i) const {
+    return ColumnBlock(X, 0, rotation_offset() + i * problem_.d_, X.rows(),
+                       problem_.d_);
+  }
+
+  /** Helper function: returns the symmetric part .5 * (B^T C + C^T B) of the
+   * product of two r x d blocks */
+  template <typename BlockB, typename BlockC>
+  static BlockMatrix sym_block(const BlockB &B, const BlockC &C) {
+    BlockMatrix P = B.transpose() * C;
+    return .5 * (P + P.transpose());
+  }
+
+public:
+  explicit SESyncProblemT(const SESyncProblem &problem) : problem_(problem) {}
+
+  /** Returns the problem instance underlying this specialization */
+  const SESyncProblem &problem() const { return problem_; }
+
+  /// OPTIMIZATION AND GEOMETRY
+
+  /** Given a matrix Y, this function computes and returns the matrix product
+   * SY, where S is the data matrix defining the quadratic form of the
+   * objective for formulation F (cf. SESyncProblem::data_matrix_product) */
+  inline Matrix data_matrix_product(const Matrix &Y) const {
+    if constexpr (F == Formulation::Simplified)
+      return problem_.Q_product(Y);
+    else if constexpr (F == Formulation::Explicit)
+      return problem_.M_ * Y;
+    else // F == Formulation::SOSync
+      return problem_.LGrho_ * Y;
+  }
+
+  /** Given a matrix Y, this function computes and returns F(Y), the value of
+   * the objective evaluated at Y */
+  inline Scalar evaluate_objective(const Matrix &Y) const {
+    // F(Y) = tr(Y * S * Y') = <Y', S * Y'>, which we compute as a single
+    // streaming reduction rather than forming the r x r product Y * S * Y'
+    Matrix Yt = Y.transpose();
+    return Frobenius_inner_product(Yt, data_matrix_product(Yt));
+  }
+
+  /** Given a matrix Y, this function computes and returns nabla F(Y), the
+   * *Euclidean* gradient of F at Y. */
+  inline Matrix Euclidean_gradient(const Matrix &Y) const {
+    return 2 * data_matrix_product(Y.transpose()).transpose();
+  }
+
+  /** Given a matrix Y in the domain D of the relaxation and a tangent vector
+   * dotY in T_Y(E), this function computes and returns the orthogonal
+   * projection of dotY onto T_D(Y) */
+  inline Matrix tangent_space_projection(const Matrix &Y,
+                                         const Matrix &dotY) const {
+    // Projection of translational states (if any) is the identity
+    Matrix P = dotY;
+
+    // Projection of the generalized rotational states onto the tangent space
+    // of the product of Stiefel manifolds:  P_i = V_i - Y_i * Sym(Y_i' * V_i)
+#pragma omp parallel for
+    for (size_t i = 0; i < problem_.n_; ++i)
+      rotation_block(P, i).noalias() -=
+          rotation_block(Y, i) *
+          sym_block(rotation_block(Y, i), rotation_block(dotY, i));
+
+    return P;
+  }
+
+  /** Given a matrix Y in the domain D of the relaxation and the *Euclidean*
+   * gradient nabla F(Y) at Y, this function computes and returns the
+   * *Riemannian* gradient grad F(Y) of F at Y */
+  inline Matrix Riemannian_gradient(const Matrix &Y,
+                                    const Matrix &nablaF_Y) const {
+    return tangent_space_projection(Y, nablaF_Y);
+  }
+
+  /** Given a matrix Y in the domain D of the relaxation, this function
+   * computes and returns grad F(Y), the *Riemannian* gradient of F at Y */
+  inline Matrix Riemannian_gradient(const Matrix &Y) const {
+    return tangent_space_projection(Y, Euclidean_gradient(Y));
+  }
+
+  /** Given a matrix Y in the domain D of the relaxation, the *Euclidean*
+   * gradient nablaF_Y of F at Y, and a tangent vector dotY in T_Y(D), this
+   * function computes and returns Hess F(Y)[dotY], the action of the
+   * Riemannian Hessian on dotY (cf. eq. (44) in the SE-Sync tech report) */
+  inline Matrix Riemannian_Hessian_vector_product(const Matrix &Y,
+                                                  const Matrix &nablaF_Y,
+                                                  const Matrix &dotY) const {
+    // Euclidean Hessian-vector product
+    Matrix H_dotY = 2 * data_matrix_product(dotY.transpose()).transpose();
+
+    // For each rotational block, compute the Weingarten correction
+    //
+    // W_i = H_i - dotY_i * Sym(Y_i' * nablaF_Y_i)
+    //
+    // and then project the result onto the tangent space at Y_i, fusing both
+    // operations into a single pass over the blocks
+#pragma omp parallel for
+    for (size_t i = 0; i < problem_.n_; ++i) {
+      ColumnBlock Hi = rotation_block(H_dotY, i);
+      ConstColumnBlock Yi = rotation_block(Y, i);
+      Hi.noalias() -=
+          rotation_block(dotY, i) * sym_block(Yi, rotation_block(nablaF_Y, i));
+      Hi.noalias() -= Yi * sym_block(Yi, Hi);
+    }
+
+    return H_dotY;
+  }
+
+  /** Given a matrix Y in the domain D of the relaxation and a tangent vector
+   * dotY in T_Y(D), this function computes and returns Hess F(Y)[dotY] */
+  inline Matrix Riemannian_Hessian_vector_product(const Matrix &Y,
+                                                  const Matrix &dotY) const {
+    return Riemannian_Hessian_vector_product(Y, Euclidean_gradient(Y), dotY);
+  }
+
+  /** Given a matrix Y in the domain D of the relaxation and a tangent vector
+   * dotY in T_Y(D), this function applies the selected preconditioning
+   * strategy to dotY */
+  inline Matrix precondition(const Matrix &Y, const Matrix &dotY) const {
+    switch (problem_.preconditioner_) {
+    case Preconditioner::None:
+      return dotY;
+    case Preconditioner::Jacobi:
+      return tangent_space_projection(Y, dotY * problem_.Jacobi_precon_);
+    default: // Preconditioner::RegularizedCholesky
+      if constexpr (F != Formulation::Simplified) {
+        return tangent_space_projection(
+            Y, problem_.reg_Chol_precon_->solve(dotY.transpose()).transpose());
+      } else {
+        // The objective matrix Q is the generalized Schur complement of M with
+        // respect to the translational states, so Q^-1 * Ydot' is given by the
+        // second block of the solution Z of the linear system
+        //
+        //  M * Z = [0; Ydot']
+        //
+        // (cf. SESyncProblem::precondition)
+        const size_t dn = problem_.d_ * problem_.n_;
+        Matrix rhs = Matrix::Zero(problem_.M_.rows(), dotY.rows());
+        rhs.bottomRows(dn) = dotY.transpose();
+        Matrix Z = problem_.reg_Chol_precon_->solve(rhs);
+        return tangent_space_projection(Y, Z.bottomRows(dn).transpose());
+      }
+    }
+  }
+
+  /** Given a matrix Y in the domain D of the relaxation and a tangent vector
+   * dotY in T_D(Y), this function returns the point Yplus in D obtained by
+   * retracting along dotY */
+  inline Matrix retract(const Matrix &Y, const Matrix &dotY) const {
+    // Translational states (if any) are simply updated additively
+    Matrix Yplus = Y + dotY;
+
+    // We use the projection-based retraction on the product of Stiefel
+    // manifolds.  Since Y_i'Y_i = I and Y_i'dotY_i is skew-symmetric, the
+    // Gram matrix G_i = A_i'A_i of each block A_i := Y_i + dotY_i satisfies G_i
+    // = I + dotY_i'dotY_i >= I, so that the projection of A_i onto St(d, r) is
+    // given by its polar factor A_i * G_i^(-1/2); this requires only a small
+    // (fixed-size) symmetric eigendecomposition per block
+#pragma omp parallel for
+    for (size_t i = 0; i < problem_.n_; ++i) {
+      ColumnBlock Ai = rotation_block(Yplus, i);
+      BlockMatrix G = Ai.transpose() * Ai;
+      Eigen::SelfAdjointEigenSolver<BlockMatrix> eig(G);
+      Ai = Ai * eig.operatorInverseSqrt();
+    }
+
+    return Yplus;
+  }
+}; // class SESyncProblemT
+
+/** Given a (runtime) SESyncProblem instance, this function constructs the
+ * compile-time specialization SESyncProblemT<F, Dim> matching the problem's
+ * formulation and dimension, and applies the passed visitor to it.  Here
+ * 'visitor' is a callable object accepting a const SESyncProblemT<F, Dim> &
+ * for every formulation F and Dim in {2, 3, Eigen::Dynamic} (e.g. a generic
+ * lambda), and whose return type does not depend upon F or Dim.  Only one
+ * branch is taken per call, so callers that need to invoke the specialized
+ * operators repeatedly (e.g. within an optimization loop) should capture the
+ * specialization inside the visitor, rather than re-visiting at every call. */
+template <int Dim, typename Visitor>
+inline auto visit_specialized_problem(const SESyncProblem &problem,
+                                      Visitor &&visitor) {
+  switch (problem.formulation()) {
+  case Formulation::Simplified:
+    return visitor(SESyncProblemT<Formulation::Simplified, Dim>(problem));
+  case Formulation::Explicit:
+    return visitor(SESyncProblemT<Formulation::Explicit, Dim>(problem));
+  default: // Formulation::SOSync
+    return visitor(SESyncProblemT<Formulation::SOSync, Dim>(problem));
+  }
+}
+
+template <typename Visitor>
+inline auto visit_specialized_problem(const SESyncProblem &problem,
+                                      Visitor &&visitor) {
+  switch (problem.dimension()) {
+  case 2:
+    return visit_specialized_problem<2>(problem, visitor);
+  case 3:
+    return visit_specialized_problem<3>(problem, visitor);
+  default:
+    return visit_specialized_problem<Eigen::Dynamic>(problem, visitor);
+  }
+}
+
+} // namespace SESync
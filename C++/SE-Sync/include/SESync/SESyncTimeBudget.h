@@ -0,0 +1,115 @@
+/** This file provides a simple scheduler for allocating a fixed computational
+ * time budget across the phases of an SE-Sync solve.
+ *
+ * The cost of each phase is modeled as proportional to a (phase-specific)
+ * measure of the work it requires, computed from the size of the problem and
+ * the current level of the Riemannian Staircase.  The constants of
+ * proportionality start from conservative a priori values and are replaced by
+ * measured ones as each phase is executed.  These estimates are used to
+ * reserve enough of the remaining budget to round (and, time permitting,
+ * certify) the current solution, and to set deadlines for the phases that
+ * precede them.
+ *
+ * Copyright (C) 2016 - 2022 by David M. Rosen (dmrosen@mit.edu)
+ */
+
+#pragma once
+
+#include <array>
+#include <chrono>
+
+#include "SESync/SESyncProblem.h"
+#include "SESync/SESync_types.h"
+
+namespace SESync {
+
+/** The phases of an SE-Sync solve, in the order in which they are executed */
+enum class SolvePhase {
+  /** Optimization at a single level of the Riemannian Staircase */
+  Optimization,
+
+  /** Verification of a critical point of the rank-restricted relaxation */
+  Verification,
+
+  /** Escape from a saddle point to the next level of the Staircase */
+  SaddleEscape,
+
+  /** Rounding of the final solution */
+  Rounding,
+
+  /** Construction of the primal solution Lambda and the associated duality gap
+   * and suboptimality bound */
+  PostProcessing,
+};
+
+class TimeBudget {
+private:
+  static constexpr size_t num_phases = 5;
+
+  /** The problem instance being solved */
+  const SESyncProblem &problem_;
+
+  /** The time at which the budget started */
+  std::chrono::time_point<std::chrono::high_resolution_clock> start_time_;
+
+  /** The total time budget (in seconds) */
+  double max_computation_time_;
+
+  /** Multiplicative margin applied to all time estimates */
+  double safety_factor_;
+
+  /** Estimated computation time per unit of work for each phase */
+  std::array<double, num_phases> cost_per_unit_;
+
+  /** Number of measurements of each phase recorded so far */
+  std::array<size_t, num_phases> num_samples_;
+
+  /** Returns the amount of work required by the passed phase at the current
+   * level of the Staircase */
+  double work(SolvePhase phase) const;
+
+public:
+  /** Construct a budget of max_computation_time seconds (starting now) for
+   * solving the passed problem */
+  TimeBudget(const SESyncProblem &problem, double max_computation_time,
+             double safety_factor = 1.5);
+
+  /** Construct a budget of max_computation_time seconds that started at
+   * start_time (e.g. before the problem instance itself was constructed) for
+   * solving the passed problem */
+  TimeBudget(
+      const SESyncProblem &problem, double max_computation_time,
+      const std::chrono::time_point<std::chrono::high_resolution_clock>
+          &start_time,
+      double safety_factor = 1.5);
+
+  /** Elapsed time (in seconds) since the budget started */
+  double elapsed() const;
+
+  /** Remaining time (in seconds) before the deadline */
+  double remaining() const;
+
+  /** Estimated computation time (in seconds) for the passed phase */
+  double estimate(SolvePhase phase) const;
+
+  /** Record the measured computation time for an execution of the passed
+   * phase */
+  void record(SolvePhase phase, double time);
+
+  /** Time (in seconds) that must be reserved for the phases that follow the
+   * passed one (i.e., to obtain a rounded solution, and to certify it, if
+   * the passed phase precedes verification) */
+  double reserved_after(SolvePhase phase) const;
+
+  /** Time (in seconds) that may be spent on the passed phase while still
+   * meeting the reservation for the phases that follow it */
+  double allotment(SolvePhase phase) const;
+
+  /** Returns true if the estimated cost of the passed phase fits within its
+   * allotment */
+  bool affords(SolvePhase phase) const {
+    return estimate(phase) <= allotment(phase);
+  }
+};
+
+} // namespace SESync
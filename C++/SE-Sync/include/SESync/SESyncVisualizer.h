@@ -12,8 +12,17 @@
 #include <pangolin/scene/scenehandler.h>
 
 #include <Eigen/Dense>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <tuple>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "SESync/SESync.h"
@@ -28,17 +37,39 @@ struct VisualizationOpts {
   std::string img_name = "SE-Sync-Iter";   ///< Name for output screenshots.
   std::string img_dir = "SE-Sync-Images";  ///< Output directory name.
   double delay = 0.5;                      ///< Delay between iterates [s].
+  size_t max_stored_iterates = 1000;  ///< Max raw iterates kept in memory.
+  size_t frame_cache_size = 32;       ///< Max rounded frames kept in memory.
+  size_t num_rounding_threads = 2;    ///< Threads used to round iterates.
+  size_t prefetch = 4;  ///< Number of frames rounded ahead of the display.
+  size_t max_rendered_poses = 100000;  ///< Larger graphs are decimated (LOD).
+  bool headless = false;  ///< Render offscreen, without a window (batch mode).
 };
 
 /**
  * @class SESyncVisualizer
  * @brief Class for wrapping OpenGL and Pangoling to visualize in SESync in 3D.
+ *
+ * The SE-Sync solve runs on a background thread, and streams its iterates to
+ * the visualizer as they are generated.  Iterates are only rounded (by a small
+ * pool of worker threads) when they are about to be displayed, and both the
+ * raw iterates and the rounded frames are held in bounded buffers: once more
+ * than max_stored_iterates raw iterates have been received, the stored
+ * sequence is decimated by a factor of 2 (and only every other subsequent
+ * iterate is retained), and rounded frames are evicted in least-recently-used
+ * order.
+ *
+ * The displayed frame is held in OpenGL vertex buffers, which are only updated
+ * when the frame changes.  Graphs with more than max_rendered_poses poses (or
+ * loop closures) are rendered at a reduced level of detail, using a regular
+ * subsample of the trajectory and of the loop closures.
  */
 class SESyncVisualizer {
  public:
   /**
-   * @brief Default constructor.
-   * @param num_poses     Total number of poses in the problem.
+   * @brief Default constructor; starts the SE-Sync solve in the background.
+   * @param num_poses     Total number of poses in the problem (superseded by
+   *                      the number of distinct pose IDs, if these are not
+   *                      contiguous).
    * @param measurements  Vector with relative pose measurements.
    * @param options       Structure with SE-Sync initialization options.
    */
@@ -48,7 +79,7 @@ class SESyncVisualizer {
       const VisualizationOpts &vopts = VisualizationOpts());
 
   /**
-   * @brief Default destructor.
+   * @brief Default destructor; stops the solve and the rounding threads.
    */
   ~SESyncVisualizer();
 
@@ -57,24 +88,110 @@ class SESyncVisualizer {
    */
   void RenderSynchronization();
 
+  /**
+   * @brief Batch mode: renders every (stored) iterate to an offscreen
+   * framebuffer, and writes the resulting image sequence to img_dir.  If
+   * headless is set, no window is created (this works e.g. with Mesa's software
+   * OpenGL implementation, and so requires no display).  Throws
+   * std::runtime_error if img_dir cannot be created.
+   */
+  void RenderToImages();
+
+  /**
+   * @brief Blocks until the SE-Sync solve has finished, and returns its result.
+   */
+  const SESyncResult &WaitForResult();
+
  private:
+  /// A single (raw) iterate of the Riemannian Staircase.
+  struct StreamedIterate {
+    size_t iter;  ///< Index of this iterate in the complete sequence.
+    size_t rank;  ///< Level of the Riemannian Staircase.
+    std::shared_ptr<const Matrix> Y;  ///< The iterate itself (shared).
+  };
+
+  /// A rounded iterate, reduced to the vertex data needed for rendering.
+  struct Frame {
+    std::vector<Eigen::Vector3f> solution;  ///< Rendered positions, raw.
+    std::vector<Eigen::Vector3f> pinned;    ///< Rendered positions, pinned.
+    std::vector<Eigen::Vector3f> lcs;       ///< Loop closures, natural.
+    std::vector<Eigen::Vector3f> lcspind;   ///< Loop closures, rot.
+  };
+
+  /**
+   * @brief Appends a newly-generated iterate to the stored sequence.
+   * @param[in] Y  Iterate generated by the SE-Sync solver.
+   */
+  void PushIterate(const Matrix &Y);
+
+  /**
+   * @brief Finds the first stored iterate with index at least iter.
+   * @param[in]  iter     Index of the requested iterate.
+   * @param[out] iterate  The stored iterate, if any.
+   * @return True if such an iterate exists.
+   */
+  bool FindIterate(const size_t iter, StreamedIterate &iterate) const;
+
+  /**
+   * @brief Returns the rounded frame for an iterate, if it is available, and
+   * otherwise schedules it to be rounded in the background.
+   * @param[in] iterate  The iterate to display.
+   * @return The rounded frame, or nullptr if it is not yet available.
+   */
+  std::shared_ptr<const Frame> RequestFrame(const StreamedIterate &iterate);
+
+  /**
+   * @brief Schedules the iterates following iter for rounding.
+   * @param[in] iter  Index of the currently-displayed iterate.
+   */
+  void Prefetch(const size_t iter);
+
+  /**
+   * @brief Main loop for the rounding worker threads.
+   */
+  void RoundingWorker();
+
+  /**
+   * @brief Blocks until the rounded frame for an iterate is available.
+   * @param[in] iterate  The iterate to display.
+   * @return The rounded frame.
+   */
+  std::shared_ptr<const Frame> WaitForFrame(const StreamedIterate &iterate);
+
+  /**
+   * @brief Rounds an iterate and parses it into a renderable frame.
+   * @param[in] iterate  Raw iterate to round.
+   * @return Parsed frame.
+   */
+  std::shared_ptr<const Frame> BuildFrame(const StreamedIterate &iterate) const;
+
+  /**
+   * @brief Uploads a frame into the vertex buffers used for rendering.
+   * @param[in]  frame       Frame to upload.
+   * @param[in]  pin         Whether to upload the pinned or natural solution.
+   * @param[out] trajectory  Vertex buffer for the rendered positions.
+   * @param[out] lcs         Vertex buffer for the loop-closing lines.
+   */
+  void UploadFrame(const Frame &frame, const bool pin,
+                   pangolin::GlBuffer &trajectory,
+                   pangolin::GlBuffer &lcs) const;
+
   /**
    * @brief Renders the solution as points and lines.
-   * @param[in] trajectory  Eigen-aligned vector of 3D poses.
-   * @param[in] lcs         Vector of 3D position pairs for loop-closing lines.
+   * @param[in] trajectory  Vertex buffer with the rendered positions.
+   * @param[in] lcs         Vertex buffer with loop-closing line endpoints.
    * @param[in] marker      Whether to draw point markers or not.
    * @param[in] loops       Whether to draw loop closing lines or not.
    */
-  void DrawIterate(const Trajectory3 &trajectory,
-                   const std::vector<Eigen::Vector3d> &lcs, const bool marker,
-                   const bool loops) const;
+  void DrawIterate(pangolin::GlBuffer &trajectory, pangolin::GlBuffer &lcs,
+                   const bool marker, const bool loops) const;
 
   /**
-   * @brief Parse an Xhat solution matrix into individual poses.
+   * @brief Extract the (rendered subset of) positions from a solution.
    * @param[in] xhat  Solution matrix with [translations|Rotations].
-   * @return Vector with parsed poses.
+   * @return Vector with the positions of the rendered poses.
    */
-  Trajectory3 ParseXhatToVector(const Matrix &xhat) const;
+  std::vector<Eigen::Vector3f> ExtractPositions(const Matrix &xhat) const;
 
   /**
    * @brief Rotates a solution such that the first pose had identity R.
@@ -86,9 +203,11 @@ class SESyncVisualizer {
   /**
    * @brief Draws text to screen with iterate number and staircase level.
    * @param[in] iter   Number of the current iterate.
+   * @param[in] level  Staircase level of the current iterate.
    * @param[in] bkgnd  If true, black background enabled, otherwise white.
    */
-  void DrawInfoText(const size_t iter, const bool bkgnd) const;
+  void DrawInfoText(const size_t iter, const size_t level,
+                    const bool bkgnd) const;
 
   /**
    * @brief Creates a padded string with specified number of digits.
@@ -97,12 +216,27 @@ class SESyncVisualizer {
   std::string GetScreenshotName(const size_t iter,
                                 const size_t digits = 3) const;
 
-  std::vector<Matrix> iterates_;        ///< Rounded iterates for visualization.
-  std::vector<Trajectory3> solutions_;  ///< Parsed solutions, raw.
-  std::vector<Trajectory3> solnspind_;  ///< Parsed solutions, pinned and rot'd.
-  std::vector<std::vector<Eigen::Vector3d>> lcs_;  ///< Loop closures, natural.
-  std::vector<std::vector<Eigen::Vector3d>> lcspind_;  ///< Loop closures, rot.
-  std::unordered_map<size_t, size_t> staircase_;  ///< iter -> staircase lvl.
+  /// Iterate stream (guarded by iterates_mutex_).
+  mutable std::mutex iterates_mutex_;
+  std::deque<StreamedIterate> iterates_;  ///< Stored raw iterates.
+  size_t num_received_ = 0;               ///< Total iterates received.
+  size_t stride_ = 1;                     ///< Current decimation factor.
+
+  /// Rounded frames (guarded by frames_mutex_).
+  std::mutex frames_mutex_;
+  std::condition_variable frames_cv_;
+  std::unordered_map<size_t, std::pair<std::shared_ptr<const Frame>,
+                                       std::list<size_t>::iterator>>
+      frames_;                                ///< iter -> (frame, LRU pos).
+  std::list<size_t> frames_lru_;              ///< Most recently used first.
+  std::deque<StreamedIterate> round_queue_;   ///< Iterates awaiting rounding.
+  std::unordered_set<size_t> rounding_;       ///< Iterates being rounded.
+  std::condition_variable frame_ready_cv_;    ///< Signals rounded frames.
+  std::vector<std::thread> rounding_threads_;  ///< Rounding worker pool.
+
+  std::vector<size_t> rendered_poses_;  ///< Poses drawn (level of detail).
+
+  std::vector<std::pair<size_t, size_t>> loop_closures_;  ///< (i, j) pairs.
 
   float w_ = 1200.0f;  ///< Width of the screen [px].
   float h_ = 800.0f;   ///< Heigh of the screen [px].
@@ -110,13 +244,16 @@ class SESyncVisualizer {
 
   measurements_t measurements_;  ///< Relative pose measurements data.
   size_t num_poses_;             ///< Total number of poses.
-  size_t num_iters_;             ///< Total number of iterates.
   size_t dim_;                   ///< Dimension of the problem.
   VisualizationOpts vopts_;      ///< Visualization related parameters.
   SESyncOpts options_;           ///< Initial description of problem.
   SESyncResult result_;          ///< Bundle of magic is all here.
   std::shared_ptr<SESyncProblem> problem_;  ///< Problem instance.
 
+  std::thread solver_thread_;       ///< Thread running the SE-Sync solve.
+  std::atomic<bool> solver_done_{false};  ///< Whether the solve has finished.
+  std::atomic<bool> shutdown_{false};     ///< Whether to stop all threads.
+
  public:
   EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 };
@@ -0,0 +1,62 @@
+/** This file provides the (counter-based) random number generation used
+ * throughout SE-Sync, e.g. to sample random initial iterates and starting
+ * blocks for the eigensolvers used in solution verification.
+ *
+ * Samples are generated using the Philox4x32-10 generator of Salmon et al.
+ * ("Parallel Random Numbers: As Easy as 1, 2, 3").  This is a keyed bijection
+ * of a 128-bit counter, so that the kth sample in a given stream is a pure
+ * function of (seed, stream, k): arrays of samples can therefore be filled in
+ * parallel (in any order, and by any number of threads), with bitwise-identical
+ * results.
+ *
+ * Copyright (C) 2016 - 2022 by David M. Rosen (dmrosen@mit.edu)
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "SESync/SESync_types.h"
+
+namespace SESync {
+
+/** Independent streams of random samples used by SE-Sync */
+enum class RandomStream : uint64_t {
+  /** Random points on the Stiefel product manifold */
+  StiefelSample,
+
+  /** Random translations (for the Explicit formulation) */
+  TranslationSample,
+
+  /** Starting vectors for the Lanczos process */
+  Lanczos,
+
+  /** Starting blocks for Chebyshev-filtered subspace iteration */
+  ChebyshevFilter,
+
+  /** Starting blocks for (unpreconditioned) LOBPCG */
+  LOBPCG,
+
+  /** Starting blocks for preconditioned LOBPCG */
+  PreconditionedLOBPCG
+};
+
+/** Applies the Philox4x32-10 bijection with the passed key to the passed
+ * counter, and returns the resulting 128 random bits */
+std::array<uint32_t, 4> Philox4x32(const std::array<uint32_t, 4> &counter,
+                                   const std::array<uint32_t, 2> &key);
+
+/** Fills the array 'data' of length 'size' with samples from the standard
+ * normal distribution, drawn from the passed stream of the generator
+ * initialized with the passed seed.  Large arrays are filled in parallel (using
+ * OpenMP); the result is independent of the number of threads. */
+void fill_standard_normal(Scalar *data, size_t size, uint64_t seed,
+                          uint64_t stream = 0);
+
+/** Returns a (rows x cols) matrix whose elements are sampled independently from
+ * the standard normal distribution (cf. fill_standard_normal()) */
+Matrix random_normal_matrix(size_t rows, size_t cols, uint64_t seed,
+                            RandomStream stream);
+
+} // namespace SESync
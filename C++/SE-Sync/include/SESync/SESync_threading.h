@@ -0,0 +1,110 @@
+/** This file provides a single point of control for the threads used by
+ * SE-Sync and the numerical libraries it links against.
+ *
+ * Besides the OpenMP-parallelized block kernels in SE-Sync itself, the BLAS
+ * implementation (OpenBLAS, MKL, BLIS, ...) and SuiteSparse (CHOLMOD and SPQR)
+ * may each maintain their own thread pools.  Left unmanaged, these compete for
+ * the same cores: BLAS threads spawned within OpenMP-parallel regions
+ * oversubscribe the machine, while the OpenMP threads sit idle during
+ * (BLAS-bound) supernodal factorizations.  The functions here detect the BLAS
+ * implementation present at runtime, and apply a per-phase thread budget to
+ * OpenMP, the BLAS, and the CHOLMOD/SPQR Common structs consistently.
+ *
+ * A thread count of 0 means that no thread count was specified:  in that
+ * case the thread settings of OpenMP, the BLAS and CHOLMOD are left exactly as
+ * they are (i.e., at the defaults of the respective libraries, or at whatever
+ * the calling application has configured).
+ *
+ * Note that the OpenMP and BLAS thread counts are process-wide settings.
+ * ScopedThreadingPhase saves and restores them, so phases nest correctly
+ * within a single thread of control, but concurrent solves in the same
+ * process (e.g. the worker threads of a solver daemon) race on these
+ * settings:  each worker's phase may be overridden, or restored to another
+ * worker's value, by the others.  Such applications should either use a
+ * thread count of 0 (leaving the settings alone), or give every worker the
+ * same thread count.  Auxiliary threads that run SE-Sync computations
+ * alongside a solve (e.g. to round its iterates for visualization) should
+ * instead hold a ScopedThreadingBypass, so that they leave these settings to
+ * the solver.
+ *
+ * Copyright (C) 2016 - 2022 by David M. Rosen (dmrosen@mit.edu)
+ */
+
+#pragma once
+
+#include <string>
+
+#include <Eigen/CholmodSupport>
+
+namespace SESync {
+
+/** The BLAS implementations whose thread pools SE-Sync knows how to control */
+enum class BLASVendor { Unknown, OpenBLAS, MKL, BLIS };
+
+/** The computational phases of SE-Sync, which favor different allocations of
+ * threads:
+ *
+ * - Factorization: sparse (supernodal) Cholesky and QR factorizations, whose
+ *   work is dominated by dense BLAS-3 kernels, and which should therefore be
+ *   given the entire thread budget on the BLAS side.
+ *
+ * - BlockKernels: the Riemannian optimization and verification, whose work
+ *   is dominated by OpenMP-parallelized sparse matrix products and small
+ *   per-block operations, and during which the BLAS should run serially.
+ */
+enum class ThreadingPhase { Factorization, BlockKernels };
+
+/** Returns the BLAS implementation that SE-Sync is running against (detected
+ * once, at the first call) */
+BLASVendor BLAS_vendor();
+
+/** Returns a human-readable name for the passed BLAS vendor */
+std::string BLAS_vendor_name(BLASVendor vendor);
+
+/** Returns the number of threads currently used by the BLAS, or 0 if this
+ * cannot be determined */
+size_t BLAS_num_threads();
+
+/** Sets the number of threads used by the BLAS.  Returns false if the BLAS
+ * implementation is not one whose thread pool SE-Sync can control.  Note that
+ * this setting is process-wide. */
+bool set_BLAS_num_threads(size_t num_threads);
+
+/** Configures the CHOLMOD Common struct 'common' (which also carries the
+ * parameters for SPQR) to use at most 'num_threads' threads (if num_threads
+ * is 0, 'common' is left unchanged) */
+void configure_cholmod_threads(cholmod_common &common, size_t num_threads);
+
+/** This class applies the thread budget for a given computational phase
+ * upon construction, and restores the previous OpenMP and BLAS settings upon
+ * destruction (if num_threads is 0, it does nothing) */
+class ScopedThreadingPhase {
+private:
+  bool active_ = false;
+  int prev_omp_threads_ = 0;
+  size_t prev_BLAS_threads_ = 0;
+
+public:
+  ScopedThreadingPhase(ThreadingPhase phase, size_t num_threads);
+
+  ScopedThreadingPhase(const ScopedThreadingPhase &) = delete;
+  ScopedThreadingPhase &operator=(const ScopedThreadingPhase &) = delete;
+
+  ~ScopedThreadingPhase();
+};
+
+/** While an instance of this class exists, every ScopedThreadingPhase
+ * constructed on the same thread does nothing, so that thread never changes
+ * (or restores) the process-wide OpenMP and BLAS settings.  Instances may be
+ * nested. */
+class ScopedThreadingBypass {
+public:
+  ScopedThreadingBypass();
+
+  ScopedThreadingBypass(const ScopedThreadingBypass &) = delete;
+  ScopedThreadingBypass &operator=(const ScopedThreadingBypass &) = delete;
+
+  ~ScopedThreadingBypass();
+};
+
+} // namespace SESync
@@ -54,8 +54,77 @@ enum class ProjectionFactorization { Cholesky, QR };
  * Trust Region when solving this problem */
 enum class Preconditioner { None, Jacobi, RegularizedCholesky };
 
+/** The set of available backends for solving the sparse symmetric
+ * positive-definite linear systems arising in SE-Sync (cf.
+ * SESync/SparseFactorization.h) */
+enum class SparseSolverBackend {
+  /** Supernodal / simplicial Cholesky factorization using CHOLMOD */
+  Cholmod,
+
+  /** Eigen's built-in simplicial LDL^T factorization */
+  SimplicialLDLT,
+
+  /** Conjugate gradient iteration, preconditioned by an incomplete Cholesky
+   * factorization */
+  PCG
+};
+
+/** The preconditioner to use with LOBPCG when computing a minimum eigenpair
+ * of the certificate matrix during solution verification */
+enum class VerificationPreconditioner {
+  /** Construct a fresh incomplete symmetric indefinite factorization of the
+   * (regularized) certificate matrix at each verification */
+  ILDL,
+
+  /** Reuse the problem's cached regularized Cholesky factorization of the
+   * data matrix (requiring no further factorization); falls back to ILDL if
+   * the problem was not constructed with the regularized Cholesky
+   * preconditioner */
+  RegularizedCholesky
+};
+
+/** The method to use when computing a minimum eigenpair of the certificate
+ * matrix during solution verification */
+enum class VerificationEigensolver {
+  /** (Optionally preconditioned) LOBPCG */
+  LOBPCG,
+
+  /** Chebyshev-filtered subspace iteration: replaces LOBPCG's per-iteration
+   * Rayleigh-Ritz procedure with repeated (parallel) sparse matrix products,
+   * requiring only occasional dense orthogonalization */
+  ChebyshevFilter
+};
+
+/** The local optimization method to use at each level of the Riemannian
+ * Staircase */
+enum class LocalSolver {
+  /** Riemannian truncated-Newton trust-region method */
+  TNT,
+
+  /** Riemannian limited-memory BFGS method (cf. SESync/SESyncLBFGS.h) */
+  LBFGS
+};
+
 /** The strategy to use for constructing an initial iterate */
-enum class Initialization { Chordal, Random };
+enum class Initialization {
+  /** The chordal initialization (cf. SESyncProblem::chordal_initialization())
+   */
+  Chordal,
+
+  /** A randomly-sampled point in the domain of the relaxation */
+  Random,
+
+  /** The lift of a set of pose estimates read from the input file (cf.
+   * SESyncOpts::initial_estimate) */
+  FromFile,
+
+  /** The composition of the relative pose measurements along a spanning tree
+   * of the pose graph (cf. spanning_tree_initialization()); this requires no
+   * factorization, and is therefore available for problems too large for the
+   * chordal initialization.  It is only available when SESync() is called
+   * with a set of measurements. */
+  SpanningTree
+};
 
 /** A typedef for a user-definable function that can be used to
  * instrument/monitor the performance of the internal Riemannian
@@ -7,15 +7,74 @@ matrices used in the SE-Sync algorithm.
 
 #pragma once
 
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <optional>
+#include <stdexcept>
 #include <string>
+#include <type_traits>
+#include <vector>
 
 #include <Eigen/Sparse>
 
+#include "Optimization/LinearAlgebra/LOBPCG.h"
+
 #include "SESync/RelativePoseMeasurement.h"
 #include "SESync/SESync_types.h"
 
 namespace SESync {
 
+/** A dense relabeling of the (possibly sparse or non-contiguous) pose IDs
+ * appearing in a set of measurements, e.g. the IDs 1000000 + k used by
+ * multi-robot or multi-session pose-graphs.  The poses are numbered
+ * 0, ..., n - 1 in increasing order of their original IDs. */
+struct PoseIDMap {
+  /** The original ID of each pose, in increasing order:  pose k of the
+   * relabeled problem is the pose with ID ids[k] in the original one */
+  std::vector<size_t> ids;
+
+  /** Returns the number of poses */
+  size_t size() const { return ids.size(); }
+
+  /** Returns true if the original IDs were already 0, ..., n - 1 */
+  bool is_identity() const { return ids.empty() || ids.back() + 1 == size(); }
+
+  /** Returns the dense index of the pose with the passed original ID, or
+   * size() if there is no such pose */
+  size_t find(size_t id) const;
+
+  /** Returns the dense index of the pose with the passed original ID (throws
+   * std::out_of_range if there is no such pose) */
+  size_t index(size_t id) const;
+};
+
+/** Given a set of relative pose measurements, computes the dense relabeling
+ * of the pose IDs they contain */
+PoseIDMap pose_id_map(const measurements_t &measurements);
+
+/** Relabels the poses in the passed measurements (in place) according to
+ * the passed map */
+void remap_pose_ids(measurements_t &measurements, const PoseIDMap &map);
+
+/** Relabels the poses in the passed measurements (in place) so that their IDs
+ * are 0, ..., n - 1, and returns the map from the new IDs to the original
+ * ones.  This should be applied before constructing a problem whose
+ * measurements contain sparse pose IDs, since the data matrices are otherwise
+ * sized by the largest ID. */
+PoseIDMap compact_pose_ids(measurements_t &measurements);
+
+/** Returns the passed measurements with their poses relabeled densely (cf.
+ * compact_pose_ids()), and writes the map from the new IDs to the original
+ * ones to 'pose_ids'.  If the IDs are already contiguous, 'measurements'
+ * itself is returned (without copying); otherwise, the relabeled copy is
+ * stored in 'storage'.  Every path that constructs an SESyncProblem uses this
+ * to avoid sizing the data matrices by the largest ID. */
+const measurements_t &compacted_measurements(const measurements_t &measurements,
+                                             measurements_t &storage,
+                                             PoseIDMap &pose_ids);
+
 /** Given the name of a file containing a description of a special Euclidean
  * synchronization problem expressed in the .g2o format (i.e. using "EDGE_SE2 or
  * EDGE_SE3:QUAT" measurements), this function constructs and returns the
@@ -23,6 +82,119 @@ namespace SESync {
  * number of poses in the pose-graph */
 measurements_t read_g2o_file(const std::string &filename, size_t &num_poses);
 
+/** This overload additionally parses the initial pose estimates recorded in
+ * the file's "VERTEX_SE2" or "VERTEX_SE3:QUAT" lines (e.g. from odometry, or
+ * from a previous run).  If every pose in the pose-graph has a vertex estimate,
+ * these are returned in 'vertex_estimates' as a d x (d+1)n matrix of the form
+ * xhat = [t | R] (cf. SESyncResult::xhat); otherwise, 'vertex_estimates' is
+ * empty. */
+measurements_t read_g2o_file(const std::string &filename, size_t &num_poses,
+                             std::optional<Matrix> &vertex_estimates);
+
+/** This overload additionally relabels the poses densely (cf.
+ * compact_pose_ids()):  the returned measurements, num_poses, and
+ * vertex_estimates all refer to the relabeled poses, and pose_ids records the
+ * original ID of each. */
+measurements_t read_g2o_file(const std::string &filename, size_t &num_poses,
+                             std::optional<Matrix> &vertex_estimates,
+                             PoseIDMap &pose_ids);
+
+/** Given a vector of relative pose measurements, this function computes and
+ * returns a 64-bit fingerprint (FNV-1a hash) of their complete contents
+ * (topology, raw measurements, and precisions).  This is used to validate that
+ * cached or persisted data derived from a measurement set is being applied to
+ * the same set of measurements. */
+uint64_t measurements_fingerprint(const measurements_t &measurements);
+
+/// BINARY SERIALIZATION
+
+/** The following helpers are used to read and write the binary files in which
+ * problem instances and solver state are persisted.  Values are stored in
+ * native byte order, and every array is written starting at an offset (from
+ * the beginning of the stream) that is a multiple of binary_alignment bytes,
+ * so that these files can be memory-mapped and their arrays accessed in place.
+ * The read functions throw std::runtime_error if the stream ends prematurely.
+ */
+constexpr size_t binary_alignment = 64;
+
+/** Write a single plain-old-data value to out */
+template <typename T> void write_binary(std::ostream &out, const T &value) {
+  out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+/** Read a single plain-old-data value from in */
+template <typename T> void read_binary(std::istream &in, T &value) {
+  if (!in.read(reinterpret_cast<char *>(&value), sizeof(T)))
+    throw std::runtime_error("Unexpected end of binary stream");
+}
+
+/** Returns the number of bytes remaining in the (seekable) stream in; the
+ * read functions use this to reject stored sizes that exceed the data
+ * actually present before allocating anything */
+uint64_t remaining_binary_bytes(std::istream &in);
+
+/** Write a dense matrix to out (as its dimensions, followed by its aligned
+ * column-major coefficient array) */
+void write_binary(std::ostream &out, const Matrix &X);
+
+/** Read a dense matrix written by write_binary from in.  Throws
+ * std::runtime_error if the stored dimensions exceed the remaining data. */
+void read_binary(std::istream &in, Matrix &X);
+
+/** Write a sparse matrix to out (in compressed row-major format, as its
+ * dimensions and number of nonzeros, followed by its aligned outer index,
+ * inner index, and value arrays) */
+void write_binary(std::ostream &out, const SparseMatrix &S);
+
+/** Read a sparse matrix written by write_binary from in.  Throws
+ * std::runtime_error if the stored compressed structure is invalid (i.e., its
+ * outer index array is not nondecreasing and consistent with the number of
+ * nonzeros, or an inner index is out of range). */
+void read_binary(std::istream &in, SparseMatrix &S);
+
+/** Write a string to out (as its length, followed by its characters) */
+void write_binary(std::ostream &out, const std::string &value);
+
+/** Read a string written by write_binary from in */
+void read_binary(std::istream &in, std::string &value);
+
+/** Write a vector of size_t values to out; these are stored as 64-bit
+ * integers, independently of the width of size_t */
+void write_binary(std::ostream &out, const std::vector<size_t> &values);
+
+/** Read a vector of size_t values written by write_binary from in */
+void read_binary(std::istream &in, std::vector<size_t> &values);
+
+/** Read the length of a vector written by write_binary from in.  Throws
+ * std::runtime_error if fewer than min_element_size bytes per element remain
+ * in the stream, so that a corrupted length is rejected before anything is
+ * allocated. */
+uint64_t read_binary_length(std::istream &in, size_t min_element_size);
+
+/** Write a vector of values (plain-old-data values, matrices, strings, or
+ * vectors of these) to out, as its length followed by its elements */
+template <typename T>
+void write_binary(std::ostream &out, const std::vector<T> &values) {
+  write_binary<uint64_t>(out, values.size());
+  for (const T &value : values)
+    write_binary(out, value);
+}
+
+/** Read a vector of values written by write_binary from in */
+template <typename T>
+void read_binary(std::istream &in, std::vector<T> &values) {
+  // Each element that is not plain-old-data is stored as (at least) a 64-bit
+  // length
+  values.resize(read_binary_length(
+      in, std::is_trivially_copyable<T>::value ? sizeof(T) : sizeof(uint64_t)));
+  for (T &value : values)
+    read_binary(in, value);
+}
+
+/** Returns a 64-bit checksum (FNV-1a hash) of the passed block of bytes; this
+ * is used to detect corruption of persisted files */
+uint64_t binary_checksum(const char *data, size_t size);
+
 /** Given a vector of relative pose measurements, this function constructs and
  * returns the Laplacian of the rotational weight graph L(W^rho) */
 SparseMatrix
@@ -71,14 +243,29 @@ SparseMatrix construct_M_matrix(const measurements_t &measurements);
 
 /** Given the measurement matrix B3 defined in equation (69c) of the tech report
  * and the problem dimension d, this function computes and returns the
- * corresponding chordal initialization for the rotational states */
-Matrix chordal_initialization(size_t d, const SparseMatrix &B3);
+ * corresponding chordal initialization for the rotational states.  The QR
+ * factorization this requires is computed in the Factorization phase (cf.
+ * SESync/SESync_threading.h) using num_threads threads (0 leaves the thread
+ * settings unchanged). */
+Matrix chordal_initialization(size_t d, const SparseMatrix &B3,
+                              size_t num_threads = 0);
+
+/** Given a vector of relative pose measurements, this function computes and
+ * returns pose estimates xhat = [t | R] (a d x (d+1)n matrix) by composing the
+ * measurements along a maximum-weight (with respect to the rotational
+ * precisions kappa) spanning tree of the pose graph, rooted at the first pose
+ * (which is fixed to the origin).  Each connected component of the pose graph
+ * is rooted at its lowest-indexed pose.  This requires only O(m log m) work
+ * and O(n + m) memory. */
+Matrix spanning_tree_initialization(const measurements_t &measurements);
 
 /** Given the measurement matrices B1 and B2 and a matrix R of rotational state
  * estimates, this function computes and returns the corresponding optimal
- * translation estimates */
+ * translation estimates.  As in chordal_initialization(), the QR factorization
+ * this requires uses num_threads threads (0 leaves the thread settings
+ * unchanged). */
 Matrix recover_translations(const SparseMatrix &B1, const SparseMatrix &B2,
-                            const Matrix &R);
+                            const Matrix &R, size_t num_threads = 0);
 
 /** Given a square d x d matrix, this function returns a closest element of
  * SO(d) */
@@ -98,6 +285,34 @@ Scalar dS(const Matrix &X, const Matrix &Y, Matrix *G_S = nullptr);
  */
 Scalar dO(const Matrix &X, const Matrix &Y, Matrix *G_O = nullptr);
 
+/** Given two matrices A and B of the same dimensions, this function computes
+ * and returns their Frobenius inner product <A, B> := tr(A' * B).  This is
+ * computed as a single (vectorized, and for large matrices parallel) streaming
+ * pass over the elements of A and B, without forming any intermediate matrix
+ * products.  The partial sums are combined in a fixed order, so the result
+ * does not depend upon the number of threads. */
+Scalar Frobenius_inner_product(const Matrix &A, const Matrix &B);
+
+/** Given a matrix A, this function computes and returns its Frobenius norm
+ * |A|_F, using the same single-pass reduction as Frobenius_inner_product */
+Scalar Frobenius_norm(const Matrix &A);
+
+/** Given a d x dn matrix comprised of d x d blocks [B_1, ... B_n], this
+ * function computes and returns the sum of the traces of its blocks */
+Scalar block_diagonal_trace(const Matrix &blocks, size_t d);
+
+/** Given an r x n matrix Y, this function computes its numerical rank k (the
+ * number of singular values of Y greater than rank_tol times the largest, but
+ * at least min_rank) from the r x r Gram matrix Y * Y', and returns the k x n
+ * matrix V' * Y, where V is the r x k matrix of leading eigenvectors of Y * Y'.
+ * The rows of the returned matrix are therefore a rotation of (the significant
+ * part of) Y, so that its Gram matrix Y' * Y agrees with that of Y up to the
+ * (numerically negligible) discarded singular values.  In particular, if Y is
+ * an element of the Stiefel product manifold St(d, r)^n, then the returned
+ * matrix is a (nearly feasible) element of St(d, k)^n that attains the same
+ * objective value in the rank-restricted semidefinite relaxation. */
+Matrix reduce_rank(const Matrix &Y, size_t min_rank, Scalar rank_tol = 1e-6);
+
 /** This function implements the fast solution verification method (Algorithm 3)
  * described in the paper "Accelerating Certifiable Estimation with
  * Preconditioned Eigensolvers".
@@ -119,10 +334,71 @@ Scalar dO(const Matrix &X, const Matrix &Y, Matrix *G_O = nullptr);
  *   factor L is guanteed to have at most max_fill_factor * (nnz(A) / dim(A))
  *   nonzero elements, and any elements l in L_k (the kth column of L)
  *   satisfying |l| <= drop_tol * |L_k|_1 will be set to 0.
+ * - backend is the (direct) sparse solver backend used to test the
+ *   positive-definiteness of M.  If this is SparseSolverBackend::PCG, M is
+ *   not factored at all (e.g. because its factor would not fit in memory);
+ *   the eigensolver is then always run to search for a direction of negative
+ *   curvature, and this function always returns false, since failing to find
+ *   such a direction does not prove that M is PSD.  The caller must then
+ *   distinguish these cases using theta (cf. SESyncStatus::Uncertified).
+ * - precon is an optional (symmetric positive-definite) preconditioner for M
+ *   to use with LOBPCG; if none is supplied, the incomplete symmetric
+ *   indefinite factorization described above is constructed and used
+ * - Z is an (optional) matrix with orthonormal columns spanning a subspace of
+ *   known near-null directions of S (e.g. Y' at a critical point Y), which
+ *   are deflated from the LOBPCG iteration
+ * - eigensolver selects the method used to compute the minimum eigenpair of M
+ *   (if it is not PSD); when using Chebyshev-filtered subspace iteration,
+ *   max_iters bounds the number of filter applications, each of which
+ *   requires Chebyshev_degree products with M
+ * - max_computation_time is the maximum elapsed time (in seconds) for the
+ *   entire verification; the eigensolver is terminated (with its current
+ *   estimate) once this is exceeded.  Note that the direct factorization of M
+ *   cannot itself be interrupted.
+ * - seed initializes the random number generator used to construct the
+ *   eigensolvers' starting blocks (cf. SESync/SESync_random.h)
+ * - num_threads is the number of threads made available to the direct and
+ *   incomplete factorizations of M, which are computed in the Factorization
+ *   phase (cf. SESync/SESync_threading.h); 0 leaves the thread settings
+ *   unchanged
  */
-bool fast_verification(const SparseMatrix &S, Scalar eta, size_t nx,
-                       Scalar &theta, Vector &x, size_t &num_iters,
-                       size_t max_iters = 1000, Scalar max_fill_factor = 3,
-                       Scalar drop_tol = 1e-3);
+bool fast_verification(
+    const SparseMatrix &S, Scalar eta, size_t nx, Scalar &theta, Vector &x,
+    size_t &num_iters, size_t max_iters = 1000, Scalar max_fill_factor = 3,
+    Scalar drop_tol = 1e-3,
+    SparseSolverBackend backend = SparseSolverBackend::Cholmod,
+    const std::optional<
+        Optimization::LinearAlgebra::SymmetricLinearOperator<Matrix>> &precon =
+        std::nullopt,
+    const Matrix &Z = Matrix(),
+    VerificationEigensolver eigensolver = VerificationEigensolver::LOBPCG,
+    size_t Chebyshev_degree = 10,
+    double max_computation_time = std::numeric_limits<double>::max(),
+    uint64_t seed = 0, size_t num_threads = 0);
+
+/** Given a symmetric linear operator A on R^n, this function estimates
+ * the extremal eigenvalues of A using num_steps steps of the Lanczos process,
+ * and returns a pair (lower, upper) consisting of an estimate of lambda_min(A)
+ * and an upper bound for lambda_max(A) */
+std::pair<Scalar, Scalar> Lanczos_spectrum_bounds(
+    const Optimization::LinearAlgebra::SymmetricLinearOperator<Matrix> &A,
+    size_t n, size_t num_steps, uint64_t seed = 0);
+
+/** Given a symmetric linear operator A on R^n, this function estimates the nx
+ * algebraically-smallest eigenpairs of A using Chebyshev-filtered subspace
+ * iteration.  Each iteration applies a Chebyshev polynomial filter of the given
+ * degree (i.e. 'degree' block products with A) to the current block of
+ * eigenvector estimates, followed by a single orthonormalization and
+ * Rayleigh-Ritz projection.  The iteration terminates after max_iters
+ * iterations, or as soon as the (optional) function stopfun, called with the
+ * current Ritz values and vectors, returns true.  Returns the Ritz values (in
+ * increasing order) and vectors, and sets num_iters to the number of
+ * iterations performed */
+std::pair<Vector, Matrix> Chebyshev_subspace_iteration(
+    const Optimization::LinearAlgebra::SymmetricLinearOperator<Matrix> &A,
+    size_t n, size_t nx, size_t degree, size_t max_iters, size_t &num_iters,
+    const std::function<bool(const Vector &, const Matrix &)> &stopfun =
+        nullptr,
+    uint64_t seed = 0);
 
 } // namespace SESync
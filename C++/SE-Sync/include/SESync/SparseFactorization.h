@@ -0,0 +1,234 @@
+/** This file defines an abstract interface for the sparse symmetric
+ * positive-definite linear solvers used by SE-Sync (to compute orthogonal
+ * projections, apply the regularized Cholesky preconditioner, and test the
+ * positive-semidefiniteness of the certificate matrix), together with the
+ * backends implementing it:
+ *
+ * - CholmodFactorization:  sparse Cholesky factorization via CHOLMOD
+ * - SimplicialLDLTFactorization:  Eigen's built-in simplicial LDL^T
+ * - PCGSolver:  conjugate gradients, preconditioned by an incomplete Cholesky
+ *   factorization
+ * - StoredLDLTFactorization:  a previously-computed factorization, restored
+ *   from an explicit LDL^T factor (e.g. one persisted to disk)
+ *
+ * The backend used at each site is selected via a SparseSolverOpts struct, so
+ * that the fastest backend for a given problem size can be chosen at runtime.
+ *
+ * Copyright (C) 2016 - 2022 by David M. Rosen (dmrosen@mit.edu)
+ */
+
+#pragma once
+
+#include <memory>
+
+#include <Eigen/CholmodSupport>
+#include <Eigen/IterativeLinearSolvers>
+#include <Eigen/SparseCholesky>
+
+#include "SESync/SESync_types.h"
+
+namespace SESync {
+
+/** This struct selects the sparse linear solver backend used at each of the
+ * sites in SE-Sync that require one */
+struct SparseSolverOpts {
+  /** Backend used to compute the orthogonal projection operator Pi (only
+   * operative when solving the Simplified formulation using
+   * ProjectionFactorization::Cholesky) */
+  SparseSolverBackend projection = SparseSolverBackend::Cholmod;
+
+  /** Backend used to apply the regularized Cholesky preconditioner */
+  SparseSolverBackend preconditioner = SparseSolverBackend::Cholmod;
+
+  /** Backend used to test the positive-semidefiniteness of the certificate
+   * matrix during solution verification.  PCG skips the factorization, so
+   * that LOBPCG can only search for directions of negative curvature (cf.
+   * fast_verification()), and no solution can be certified (cf.
+   * SESyncStatus::Uncertified); the memory governor selects this when the
+   * direct factorization would exceed the memory budget. */
+  SparseSolverBackend verification = SparseSolverBackend::Cholmod;
+
+  /** Relative residual tolerance for the PCG backend */
+  Scalar PCG_tolerance = 1e-10;
+
+  /** Maximum number of iterations for the PCG backend */
+  size_t PCG_max_iterations = 1000;
+};
+
+/** An explicit sparse factorization A = P^T * L * D * L^T * P of a symmetric
+ * positive-definite matrix A, in which L is unit lower-triangular, D is
+ * diagonal, and P is a permutation.  This is the form in which the direct
+ * backends export their factorizations (cf. SparseFactorization::
+ * export_factor()), so that these can be persisted and later restored without
+ * refactoring A. */
+struct LDLTFactor {
+  /** The unit lower-triangular factor L; only its strictly lower-triangular
+   * part is referenced */
+  Eigen::SparseMatrix<Scalar, Eigen::ColMajor> L;
+
+  /** The diagonal of D */
+  Vector D;
+
+  /** The permutation P:  row k of P * A is row permutation(k) of A */
+  Eigen::VectorXi permutation;
+};
+
+/** Abstract interface for a solver for sparse symmetric positive-definite
+ * linear systems A * X = B */
+class SparseFactorization {
+public:
+  virtual ~SparseFactorization() = default;
+
+  /** Performs any symbolic analysis (e.g. fill-reducing ordering) that depends
+   * only upon the sparsity pattern of A */
+  virtual void analyze(const SparseMatrix &A) = 0;
+
+  /** Computes the numerical factorization of A, whose sparsity pattern must
+   * match that passed to the most recent call to analyze() */
+  virtual void factorize(const SparseMatrix &A) = 0;
+
+  /** Convenience function:  analyze and factorize A */
+  void compute(const SparseMatrix &A) {
+    analyze(A);
+    factorize(A);
+  }
+
+  /** Updates the factorization after the numerical values (but not the
+   * sparsity pattern) of A have changed, reusing the symbolic analysis */
+  virtual void update(const SparseMatrix &A) { factorize(A); }
+
+  /** Returns the solution X of A * X = B, for a (possibly multi-column)
+   * right-hand side B */
+  virtual Matrix solve(const Matrix &B) const = 0;
+
+  /** Returns true if the most recent factorization succeeded.  For the direct
+   * backends, this is the case if and only if A is (numerically)
+   * positive-definite. */
+  virtual bool success() const = 0;
+
+  /** Returns the (approximate) number of bytes of memory used to store the
+   * factorization */
+  virtual size_t memory_usage() const = 0;
+
+  /** Sets the maximum number of threads the backend may use internally */
+  virtual void set_num_threads(size_t num_threads) {}
+
+  /** If set, factorize() is used only to test A for positive-definiteness:
+   * it returns as early as possible (and without reporting any error) if A
+   * is found not to be positive-definite */
+  virtual void set_definiteness_test(bool test) {}
+
+  /** Returns the backend implementing this solver */
+  virtual SparseSolverBackend backend() const = 0;
+
+  /** Writes the current factorization to 'factor' in explicit LDL^T form,
+   * returning false if this backend does not compute an explicit
+   * factorization (e.g. PCG), or if there is no successful factorization to
+   * export */
+  virtual bool export_factor(LDLTFactor &factor) const { return false; }
+};
+
+/** Sparse Cholesky factorization using CHOLMOD */
+class CholmodFactorization : public SparseFactorization {
+private:
+  /** Eigen's CHOLMOD wrapper, extended with access to the underlying CHOLMOD
+   * factor (so that it can be exported) */
+  class Decomposition : public Eigen::CholmodDecomposition<SparseMatrix> {
+  public:
+    const cholmod_factor *factor() const { return m_cholmodFactor; }
+  };
+
+  Decomposition chol_;
+
+public:
+  void analyze(const SparseMatrix &A) override { chol_.analyzePattern(A); }
+  void factorize(const SparseMatrix &A) override { chol_.factorize(A); }
+  Matrix solve(const Matrix &B) const override { return chol_.solve(B); }
+  bool success() const override { return chol_.info() == Eigen::Success; }
+  size_t memory_usage() const override;
+  void set_num_threads(size_t num_threads) override;
+  void set_definiteness_test(bool test) override;
+  SparseSolverBackend backend() const override {
+    return SparseSolverBackend::Cholmod;
+  }
+  bool export_factor(LDLTFactor &factor) const override;
+};
+
+/** Eigen's built-in simplicial LDL^T factorization */
+class SimplicialLDLTFactorization : public SparseFactorization {
+private:
+  typedef Eigen::SparseMatrix<Scalar, Eigen::ColMajor> ColMajorSparseMatrix;
+
+  Eigen::SimplicialLDLT<ColMajorSparseMatrix> LDLT_;
+
+  /** Whether the most recently-factored matrix was positive-definite */
+  bool positive_definite_ = false;
+
+public:
+  void analyze(const SparseMatrix &A) override;
+  void factorize(const SparseMatrix &A) override;
+  Matrix solve(const Matrix &B) const override { return LDLT_.solve(B); }
+  bool success() const override { return positive_definite_; }
+  size_t memory_usage() const override;
+  SparseSolverBackend backend() const override {
+    return SparseSolverBackend::SimplicialLDLT;
+  }
+  bool export_factor(LDLTFactor &factor) const override;
+};
+
+/** Conjugate gradients preconditioned by an incomplete Cholesky factorization.
+ * Since SparseMatrix is row-major, the sparse matrix-vector products in each
+ * iteration are parallelized using OpenMP. */
+class PCGSolver : public SparseFactorization {
+private:
+  /** The coefficient matrix (the iteration needs access to A itself, not only
+   * to its factorization) */
+  SparseMatrix A_;
+
+  Eigen::ConjugateGradient<SparseMatrix, Eigen::Lower | Eigen::Upper,
+                           Eigen::IncompleteCholesky<Scalar>>
+      CG_;
+
+public:
+  PCGSolver(Scalar tolerance, size_t max_iterations);
+
+  void analyze(const SparseMatrix &A) override {}
+  void factorize(const SparseMatrix &A) override;
+  Matrix solve(const Matrix &B) const override { return CG_.solve(B); }
+  bool success() const override { return CG_.info() == Eigen::Success; }
+  size_t memory_usage() const override;
+  SparseSolverBackend backend() const override {
+    return SparseSolverBackend::PCG;
+  }
+};
+
+/** A factorization restored from an explicit LDL^T factor, which is applied
+ * using sparse triangular solves.  This reports the backend that originally
+ * computed the factor; if A is subsequently refactored, the new factorization
+ * is computed using Eigen's simplicial LDL^T. */
+class StoredLDLTFactorization : public SparseFactorization {
+private:
+  LDLTFactor factor_;
+
+  /** The backend that computed factor_ */
+  SparseSolverBackend backend_;
+
+public:
+  StoredLDLTFactorization(LDLTFactor factor, SparseSolverBackend backend);
+
+  void analyze(const SparseMatrix &A) override {}
+  void factorize(const SparseMatrix &A) override;
+  Matrix solve(const Matrix &B) const override;
+  bool success() const override;
+  size_t memory_usage() const override;
+  SparseSolverBackend backend() const override { return backend_; }
+  bool export_factor(LDLTFactor &factor) const override;
+};
+
+/** Constructs and returns a sparse linear solver of the requested type, using
+ * the settings contained in 'opts' */
+std::unique_ptr<SparseFactorization>
+make_sparse_factorization(SparseSolverBackend backend,
+                          const SparseSolverOpts &opts = SparseSolverOpts());
+
+} // namespace SESync
@@ -8,7 +8,7 @@
 
 #pragma once
 
-#include <random> // For sampling random points on the manifold
+#include <cstdint>
 
 #include <Eigen/Dense>
 
@@ -78,9 +78,10 @@ public:
   Matrix retract(const Matrix &Y, const Matrix &V) const;
 
   /** Sample a random point on M, using the (optional) passed seed to initialize
-   * the random number generator.  */
-  Matrix random_sample(const std::default_random_engine::result_type &seed =
-                           std::default_random_engine::default_seed) const;
+   * the (counter-based) random number generator; the result depends only upon
+   * the seed, and not on the number of threads used (cf.
+   * SESync/SESync_random.h) */
+  Matrix random_sample(uint64_t seed = 0) const;
 };
 
 } // namespace SESync
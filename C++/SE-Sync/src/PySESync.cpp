@@ -1,9 +1,13 @@
 #include "SESync/RelativePoseMeasurement.h"
 #include "SESync/SESync.h"
+#include "SESync/SESyncAutotuner.h"
+#include "SESync/SESyncCheckpoint.h"
+#include "SESync/SESyncMemoryGovernor.h"
 #include "SESync/SESyncProblem.h"
 #include "SESync/SESync_types.h"
 #include "SESync/SESync_utils.h"
 
+#include <limits>
 #include <tuple>
 
 #include <pybind11/eigen.h>
@@ -47,13 +51,51 @@ PYBIND11_MODULE(PySESync, m) {
       .value("RegularizedCholesky",
              SESync::Preconditioner::RegularizedCholesky);
 
+  // Sparse linear solver backend
+  py::enum_<SESync::SparseSolverBackend>(
+      m, "SparseSolverBackend",
+      "The backend to use for solving sparse symmetric positive-definite "
+      "linear systems")
+      .value("Cholmod", SESync::SparseSolverBackend::Cholmod)
+      .value("SimplicialLDLT", SESync::SparseSolverBackend::SimplicialLDLT)
+      .value("PCG", SESync::SparseSolverBackend::PCG);
+
+  // LOBPCG preconditioner used in solution verification
+  py::enum_<SESync::VerificationPreconditioner>(
+      m, "VerificationPreconditioner",
+      "The preconditioner to use with LOBPCG during solution verification")
+      .value("ILDL", SESync::VerificationPreconditioner::ILDL)
+      .value("RegularizedCholesky",
+             SESync::VerificationPreconditioner::RegularizedCholesky);
+
+  // Minimum-eigenpair solver used in solution verification
+  py::enum_<SESync::VerificationEigensolver>(
+      m, "VerificationEigensolver",
+      "The method to use when computing a minimum eigenpair of the "
+      "certificate matrix during solution verification")
+      .value("LOBPCG", SESync::VerificationEigensolver::LOBPCG)
+      .value("ChebyshevFilter",
+             SESync::VerificationEigensolver::ChebyshevFilter);
+
+  // Local optimization method
+  py::enum_<SESync::LocalSolver>(
+      m, "LocalSolver",
+      "The local optimization method to use at each level of the Riemannian "
+      "Staircase")
+      .value("TNT", SESync::LocalSolver::TNT,
+             "Riemannian truncated-Newton trust-region method")
+      .value("LBFGS", SESync::LocalSolver::LBFGS,
+             "Riemannian limited-memory BFGS method");
+
   // Initialization method
   py::enum_<SESync::Initialization>(
       m, "Initialization",
       "The initialization method to use constructing an initial estimate, if "
       "none is provided")
       .value("Chordal", SESync::Initialization::Chordal)
-      .value("Random", SESync::Initialization::Random);
+      .value("Random", SESync::Initialization::Random)
+      .value("FromFile", SESync::Initialization::FromFile)
+      .value("SpanningTree", SESync::Initialization::SpanningTree);
 
   // SE-Sync algorithm termination status
   py::enum_<SESync::SESyncStatus>(
@@ -72,7 +114,12 @@ PYBIND11_MODULE(PySESync, m) {
              "Staircase iterations before finding an optimal solution")
       .value("ElapsedTime", SESync::SESyncStatus::ElapsedTime,
              "The algorithm exhausted the alloted computation time before "
-             "finding an optimal solution");
+             "finding an optimal solution")
+      .value("Uncertified", SESync::SESyncStatus::Uncertified,
+             "The algorithm converged to a first-order critical point at "
+             "which no direction of sufficiently negative curvature was "
+             "found, but whose global optimality could not be certified, "
+             "since the certificate matrix was not factored directly");
 
   /// Bindings for the RelativePoseMeasurement struct
 
@@ -125,8 +172,36 @@ PYBIND11_MODULE(PySESync, m) {
                      "Maximum number of inner (truncated conjugate-gradient) "
                      "iterations to perform per outer iteration")
 
+      .def_readwrite("local_solver", &SESync::SESyncOpts::local_solver,
+                     "Local optimization method to use at each level of the "
+                     "Riemannian Staircase")
+      .def_readwrite("local_solver_schedule",
+                     &SESync::SESyncOpts::local_solver_schedule,
+                     "If nonempty, the local solver to use at each level of "
+                     "the Riemannian Staircase, starting from r0 (the last "
+                     "element applies to all subsequent levels)")
+      .def_readwrite("LBFGS_memory", &SESync::SESyncOpts::LBFGS_memory,
+                     "Number of curvature pairs retained by the L-BFGS local "
+                     "solver")
+      .def_readwrite("initial_trust_region_radius",
+                     &SESync::SESyncOpts::initial_trust_region_radius,
+                     "If positive, the initial trust-region radius for the "
+                     "first level of the Riemannian Staircase")
+      .def_readwrite("carry_trust_region_radius",
+                     &SESync::SESyncOpts::carry_trust_region_radius,
+                     "Whether to carry the trust-region radius across levels "
+                     "of the Riemannian Staircase")
+
       .def_readwrite("STPCG_kappa", &SESync::SESyncOpts::STPCG_kappa)
       .def_readwrite("STPCG_theta", &SESync::SESyncOpts::STPCG_theta)
+      .def_readwrite("recycle_Krylov_subspace",
+                     &SESync::SESyncOpts::recycle_Krylov_subspace,
+                     "Whether to recycle Krylov information across the "
+                     "truncated conjugate gradient solves of the trust-region "
+                     "method")
+      .def_readwrite("Krylov_recycling_dimension",
+                     &SESync::SESyncOpts::Krylov_recycling_dimension,
+                     "Maximum dimension of the recycled deflation space")
 
       .def_readwrite(
           "formulation", &SESync::SESyncOpts::formulation,
@@ -135,6 +210,13 @@ PYBIND11_MODULE(PySESync, m) {
                      "Initial level of the Riemannian Staircase")
       .def_readwrite("rmax", &SESync::SESyncOpts::rmax,
                      "Maximum level of the Riemannian Staircase to explore")
+      .def_readwrite("reduce_rank", &SESync::SESyncOpts::reduce_rank,
+                     "Whether to truncate the iterate to its numerical rank "
+                     "before ascending the Riemannian Staircase, and upon "
+                     "termination")
+      .def_readwrite("rank_tol", &SESync::SESyncOpts::rank_tol,
+                     "Relative tolerance for determining the numerical rank "
+                     "of the iterate")
       .def_readwrite("min_eig_num_tol", &SESync::SESyncOpts::min_eig_num_tol,
                      "Numerical tolerance for accepting the minimum eigenvalue "
                      "of the certificate matrix as nonnegative; this should be "
@@ -150,6 +232,21 @@ PYBIND11_MODULE(PySESync, m) {
                      &SESync::SESyncOpts::LOBPCG_max_iterations,
                      "Maximum number of LOBPCG iterations to permit for the "
                      "minimum-eigenpair computation")
+      .def_readwrite("LOBPCG_preconditioner",
+                     &SESync::SESyncOpts::LOBPCG_preconditioner,
+                     "Preconditioner to use with LOBPCG during solution "
+                     "verification")
+      .def_readwrite("LOBPCG_deflation", &SESync::SESyncOpts::LOBPCG_deflation,
+                     "Whether to deflate the known near-nullspace of the "
+                     "certificate matrix from LOBPCG")
+      .def_readwrite("certificate_eigensolver",
+                     &SESync::SESyncOpts::certificate_eigensolver,
+                     "Method to use when computing a minimum eigenpair of the "
+                     "certificate matrix")
+      .def_readwrite("Chebyshev_filter_degree",
+                     &SESync::SESyncOpts::Chebyshev_filter_degree,
+                     "Degree of the polynomial filter used by "
+                     "Chebyshev-filtered subspace iteration")
 
       .def_readwrite("projection_factorization",
                      &SESync::SESyncOpts::projection_factorization,
@@ -161,10 +258,19 @@ PYBIND11_MODULE(PySESync, m) {
       .def_readwrite(
           "reg_Chol_precon_max_cond",
           &SESync::SESyncOpts::reg_Cholesky_precon_max_condition_number)
+      .def_readwrite("sparse_solvers", &SESync::SESyncOpts::sparse_solvers,
+                     "Sparse linear solver backends to use")
 
       .def_readwrite("initialization", &SESync::SESyncOpts::initialization,
                      "Initialization method to use for calculating an initial "
                      "iterate Y0, if none was provided ")
+      .def_readwrite("initial_estimate",
+                     &SESync::SESyncOpts::initial_estimate,
+                     "Pose estimates [t | R] from which to construct the "
+                     "initial iterate when initialization is FromFile")
+      .def_readwrite("random_seed", &SESync::SESyncOpts::random_seed,
+                     "Seed for the random number generator used for random "
+                     "initialization and eigensolver starting blocks")
 
       .def_readwrite("verbose", &SESync::SESyncOpts::verbose,
                      "Boolean value indicating whether to print output as the "
@@ -174,7 +280,54 @@ PYBIND11_MODULE(PySESync, m) {
           "If this value is true, SE-Sync will log and return the entire "
           "sequence of iterates generated by the Riemannian Staircase")
       .def_readwrite("num_threads", &SESync::SESyncOpts::num_threads,
-                     "Number of threads to use for parallel parallelization");
+                     "Number of threads to use for parallelization (0 leaves "
+                     "the OpenMP and BLAS thread settings unchanged)")
+      .def_readwrite("enforce_deadline",
+                     &SESync::SESyncOpts::enforce_deadline,
+                     "If true, max_computation_time is treated as a hard "
+                     "deadline for the entire SE-Sync solve")
+      .def_readwrite("checkpoint_file", &SESync::SESyncOpts::checkpoint_file,
+                     "If nonempty, the file to which the state of the "
+                     "Riemannian Staircase is periodically checkpointed")
+      .def_readwrite("checkpoint_interval",
+                     &SESync::SESyncOpts::checkpoint_interval,
+                     "Minimum interval (in seconds) between successive "
+                     "checkpoints")
+      .def_readwrite("autotune", &SESync::SESyncOpts::autotune,
+                     "If true, the formulation, preconditioner, projection "
+                     "factorization, r0, and LOBPCG parameters are selected "
+                     "by the autotuner")
+      .def_readwrite("autotuning_table",
+                     &SESync::SESyncOpts::autotuning_table,
+                     "If nonempty, the autotuning table file used by the "
+                     "autotuner")
+      .def_readwrite("memory_budget_bytes",
+                     &SESync::SESyncOpts::memory_budget_bytes,
+                     "If nonzero, a budget (in bytes) for the data matrices "
+                     "and sparse factorizations; factorizations exceeding it "
+                     "are replaced by lower-memory alternatives");
+
+  /// Bindings for the SparseSolverOpts struct
+
+  py::class_<SESync::SparseSolverOpts>(
+      m, "SparseSolverOpts",
+      "Selection of the sparse linear solver backend used at each site in "
+      "SE-Sync that requires one")
+      .def(py::init<>())
+      .def_readwrite("projection", &SESync::SparseSolverOpts::projection,
+                     "Backend used to compute orthogonal projections")
+      .def_readwrite("preconditioner",
+                     &SESync::SparseSolverOpts::preconditioner,
+                     "Backend used to apply the regularized Cholesky "
+                     "preconditioner")
+      .def_readwrite("verification", &SESync::SparseSolverOpts::verification,
+                     "Backend used to test the positive-semidefiniteness of "
+                     "the certificate matrix; with PCG, the matrix is not "
+                     "factored, and solutions can only be reported as "
+                     "Uncertified (never GlobalOpt)")
+      .def_readwrite("PCG_tolerance", &SESync::SparseSolverOpts::PCG_tolerance)
+      .def_readwrite("PCG_max_iterations",
+                     &SESync::SparseSolverOpts::PCG_max_iterations);
 
   /// Bindings for the SESyncResult struct
 
@@ -230,6 +383,13 @@ PYBIND11_MODULE(PySESync, m) {
           "A vector containing the sequence of "
           "(# Hessian-vector products required) at each level of the "
           "Riemannian Staircase")
+      .def_readwrite(
+          "recycling_Hessian_vector_products",
+          &SESync::SESyncResult::recycling_Hessian_vector_products,
+          "A vector containing the sequence of (# additional Hessian-vector "
+          "products spent on Krylov subspace recycling) at each level of the "
+          "Riemannian Staircase; these correspond one-to-one with the "
+          "elements of Hessian_vector_products")
       .def_readwrite("update_step_norms",
                      &SESync::SESyncResult::update_step_norms,
                      "A vector containing the sequence of norms of the update "
@@ -256,6 +416,15 @@ PYBIND11_MODULE(PySESync, m) {
           "A vector containing the sequence of minimum eigenvalues of the "
           "certificate matrix constructed at the critical point recovered from "
           "optimization at each level of the Riemannian Staircase")
+      .def_readwrite("local_solvers", &SESync::SESyncResult::local_solvers,
+                     "The local solver used at each level of the Riemannian "
+                     "Staircase")
+      .def_readwrite("rejected_steps", &SESync::SESyncResult::rejected_steps,
+                     "The number of rejected update steps at each level of the "
+                     "Riemannian Staircase")
+      .def_readwrite("trust_region_radius",
+                     &SESync::SESyncResult::trust_region_radius,
+                     "The most recent trust-region radius")
       .def_readwrite("LOBPCG_iters", &SESync::SESyncResult::LOBPCG_iters)
       .def_readwrite(
           "verification_times", &SESync::SESyncResult::verification_times,
@@ -265,6 +434,22 @@ PYBIND11_MODULE(PySESync, m) {
                      "If log_iterates = true, this will contain the sequence "
                      "of iterates generated by the TNT method at each level of "
                      "the Riemannian Staircase")
+      .def_readwrite("pose_ids", &SESync::SESyncResult::pose_ids,
+                     "If the pose IDs were relabeled densely, the original ID "
+                     "of each pose in xhat; otherwise empty")
+      .def_readwrite("estimated_memory_bytes",
+                     &SESync::SESyncResult::estimated_memory_bytes,
+                     "If a memory budget was set, the estimated peak memory "
+                     "required by the configuration actually used")
+      .def_readwrite("memory_governor_decisions",
+                     &SESync::SESyncResult::memory_governor_decisions,
+                     "A description of each change made by the memory "
+                     "governor to respect the memory budget")
+      .def_readwrite("direct_verification",
+                     &SESync::SESyncResult::direct_verification,
+                     "Whether the certificate matrix was tested for "
+                     "positive-semidefiniteness by direct factorization; if "
+                     "not, the status is at best Uncertified")
       .def_readwrite("status", &SESync::SESyncResult::status,
                      "Termination status of the SE-Sync algorithm");
 
@@ -297,6 +482,34 @@ PYBIND11_MODULE(PySESync, m) {
       "RelativePoseMeasurements and (2) the total number of poses in the "
       "pose-graph");
 
+  m.def(
+      "compact_pose_ids",
+      [](SESync::measurements_t measurements)
+          -> std::pair<SESync::measurements_t, std::vector<size_t>> {
+        SESync::PoseIDMap map = SESync::compact_pose_ids(measurements);
+        return {measurements, map.ids};
+      },
+      "Relabels the poses in the passed measurements so that their IDs are "
+      "0, ..., n - 1, and returns a pair consisting of (1) the relabeled "
+      "measurements and (2) the original ID of each pose");
+
+  m.def(
+      "read_g2o_file_with_vertices",
+
+      [](const std::string &filename)
+          -> std::tuple<SESync::measurements_t, size_t,
+                        std::optional<SESync::Matrix>> {
+        size_t num_poses;
+        std::optional<SESync::Matrix> vertex_estimates;
+        SESync::measurements_t measurements =
+            SESync::read_g2o_file(filename, num_poses, vertex_estimates);
+
+        return {measurements, num_poses, vertex_estimates};
+      },
+      "As read_g2o_file, but additionally returns the initial pose estimates "
+      "[t | R] recorded in the file's 'VERTEX_SE2' or 'VERTEX_SE3:QUAT' "
+      "lines (or None, if some pose has no such estimate)");
+
   m.def(
       "construct_rotational_weight_graph_Laplacian",
       &SESync::construct_rotational_weight_graph_Laplacian,
@@ -359,11 +572,22 @@ PYBIND11_MODULE(PySESync, m) {
       "Given the measurement matrix B3 defined in equation (69c) of the tech "
       "report and the problem dimension d, this function computes and returns "
       "the corresponding chordal initialization for the rotational states");
+  m.def("spanning_tree_initialization",
+        &SESync::spanning_tree_initialization,
+        "Given a list of relative pose measurements, this function computes "
+        "and returns pose estimates xhat = [t | R] by composing the "
+        "measurements along a maximum-weight spanning tree of the pose graph");
   m.def("recover_translations", &SESync::recover_translations,
         "Given the measurement matrices B1 and B2 and a matrix R of rotational "
         "state estimates, this function computes and returns the "
         "corresponding optimal translation estimates");
 
+  m.def("reduce_rank", &SESync::reduce_rank, py::arg("Y"),
+        py::arg("min_rank"), py::arg("rank_tol") = 1e-6,
+        "Given an r x n matrix Y, this function returns a k x n matrix with "
+        "(numerically) the same Gram matrix Y^T Y, where k >= min_rank is the "
+        "numerical rank of Y");
+
   m.def(
       "dS",
       [](const SESync::Matrix &X,
@@ -428,6 +652,7 @@ PYBIND11_MODULE(PySESync, m) {
                          "(uninitialized) problem instance")
       .def(py::init<SESync::measurements_t, SESync::Formulation,
                     SESync::ProjectionFactorization, SESync::Preconditioner,
+                    SESync::Scalar, size_t, SESync::SparseSolverOpts,
                     SESync::Scalar>(),
            py::arg("measurements"),
            py::arg("formulation") = SESync::Formulation::Simplified,
@@ -435,7 +660,14 @@ PYBIND11_MODULE(PySESync, m) {
                SESync::ProjectionFactorization::Cholesky,
            py::arg("preconditioner") =
                SESync::Preconditioner::RegularizedCholesky,
-           py::arg("reg_chol_precon_max_cond") = 1e6, "Basic constructor.")
+           py::arg("reg_chol_precon_max_cond") = 1e6,
+           py::arg("num_threads") = 0,
+           py::arg("sparse_solvers") = SESync::SparseSolverOpts(),
+           py::arg("max_verification_fill_factor") =
+               std::numeric_limits<SESync::Scalar>::max(),
+           "Basic constructor.  The problem uses exactly the passed "
+           "configuration; to respect a memory budget, construct it from the "
+           "options (and LOBPCG_max_fill_factor) returned by govern_memory().")
       .def("set_relaxation_rank", &SESync::SESyncProblem::set_relaxation_rank,
            "Set maximum rank of the rank-restricted semidefinite relaxation.")
       .def("formulation", &SESync::SESyncProblem::formulation,
@@ -448,6 +680,10 @@ PYBIND11_MODULE(PySESync, m) {
           "instance of the special Euclidean synchronization problem")
       .def("preconditioner", &SESync::SESyncProblem::preconditioner,
            "Get the preconditioning strategy")
+      .def("max_verification_fill_factor",
+           &SESync::SESyncProblem::max_verification_fill_factor,
+           "Get the upper bound on the fill factor of the incomplete LDL^T "
+           "factorization used to precondition LOBPCG during verification")
       .def("num_states", &SESync::SESyncProblem::num_states,
            "Get the number of states (poses or rotations) appearing in this "
            "problem")
@@ -456,6 +692,11 @@ PYBIND11_MODULE(PySESync, m) {
       .def("dimension", &SESync::SESyncProblem::dimension,
            "Get the dimension d of the group SE(d) or SO(d) over which this "
            "problem is defined")
+      .def("iterate_columns", &SESync::SESyncProblem::iterate_columns,
+           "Get the number of columns of the iterates Y of this problem")
+      .def("pose_ids", &SESync::SESyncProblem::pose_ids,
+           "Get the original ID of each (densely relabeled) pose of this "
+           "problem; empty if the original IDs were already contiguous")
       .def("relaxation_rank", &SESync::SESyncProblem::relaxation_rank,
            "Get the current relaxation rank r of this problem")
       .def("oriented_incidence_matrix",
@@ -513,9 +754,156 @@ PYBIND11_MODULE(PySESync, m) {
            &SESync::SESyncProblem::chordal_initialization,
            "This function computes and returns a chordal initialization for "
            "the rank-restricted semidefinite relaxation")
+      .def("lift_estimate", &SESync::SESyncProblem::lift_estimate,
+           "Given a set of pose estimates xhat = [t | R], this function "
+           "computes and returns the corresponding point in the domain of the "
+           "rank-restricted semidefinite relaxation")
       .def("random_sample", &SESync::SESyncProblem::random_sample,
            "Randomly sample a point in the domain of the rank-restricted "
-           "semidefinite relaxation");
+           "semidefinite relaxation",
+           py::arg("seed") = 0);
+
+  /// Bindings for the autotuner
+
+  py::class_<SESync::ProblemFeatures>(
+      m, "ProblemFeatures",
+      "Cheap structural and statistical features of a pose-graph SLAM problem")
+      .def(py::init<>())
+      .def_readwrite("n", &SESync::ProblemFeatures::n, "Number of poses")
+      .def_readwrite("m", &SESync::ProblemFeatures::m,
+                     "Number of measurements")
+      .def_readwrite("d", &SESync::ProblemFeatures::d,
+                     "Dimension of the estimation problem")
+      .def_readwrite("mean_degree", &SESync::ProblemFeatures::mean_degree)
+      .def_readwrite("max_degree", &SESync::ProblemFeatures::max_degree)
+      .def_readwrite("degree_variation",
+                     &SESync::ProblemFeatures::degree_variation,
+                     "Coefficient of variation of the pose degrees")
+      .def_readwrite("loop_closure_ratio",
+                     &SESync::ProblemFeatures::loop_closure_ratio,
+                     "Fraction of measurements that are loop closures")
+      .def_readwrite("kappa_spread", &SESync::ProblemFeatures::kappa_spread,
+                     "log10(max / min) of the rotational precisions")
+      .def_readwrite("tau_spread", &SESync::ProblemFeatures::tau_spread,
+                     "log10(max / min) of the translational precisions")
+      .def_readwrite("factor_nonzeros",
+                     &SESync::ProblemFeatures::factor_nonzeros,
+                     "Estimated number of nonzeros in the Cholesky factor of "
+                     "the pose-graph Laplacian")
+      .def_readwrite("factor_fill", &SESync::ProblemFeatures::factor_fill,
+                     "Estimated fill ratio of the Cholesky factor of the "
+                     "pose-graph Laplacian");
+
+  py::class_<SESync::AutotuneConfig>(
+      m, "AutotuneConfig", "The subset of SE-Sync's options selected by the "
+                           "autotuner")
+      .def(py::init<>())
+      .def_readwrite("formulation", &SESync::AutotuneConfig::formulation)
+      .def_readwrite("preconditioner", &SESync::AutotuneConfig::preconditioner)
+      .def_readwrite("projection_factorization",
+                     &SESync::AutotuneConfig::projection_factorization)
+      .def_readwrite("r0_offset", &SESync::AutotuneConfig::r0_offset,
+                     "Initial level of the Riemannian Staircase, relative to "
+                     "the dimension d of the problem")
+      .def_readwrite("LOBPCG_block_size",
+                     &SESync::AutotuneConfig::LOBPCG_block_size)
+      .def_readwrite("LOBPCG_max_fill_factor",
+                     &SESync::AutotuneConfig::LOBPCG_max_fill_factor)
+      .def_readwrite("LOBPCG_drop_tol",
+                     &SESync::AutotuneConfig::LOBPCG_drop_tol)
+      .def_static("from_options", &SESync::AutotuneConfig::from_options,
+                  py::arg("options"), py::arg("d"),
+                  "Extracts the autotuned subset of the passed options, for a "
+                  "problem of dimension d")
+      .def(
+          "apply",
+          [](const SESync::AutotuneConfig &config,
+             const SESync::SESyncOpts &options,
+             size_t d) -> SESync::SESyncOpts {
+            SESync::SESyncOpts tuned = options;
+            config.apply(tuned, d);
+            return tuned;
+          },
+          py::arg("options"), py::arg("d"),
+          "Returns a copy of the passed options, with the autotuned subset "
+          "replaced by this configuration");
+
+  py::class_<SESync::AutotuningTable>(
+      m, "AutotuningTable",
+      "A table of benchmark problems and the fastest configuration found for "
+      "each, used to predict configurations for new problems")
+      .def(py::init<>())
+      .def(py::init<const std::string &>(), py::arg("filename"),
+           "Load a table from the passed file")
+      .def("add_benchmark_result",
+           &SESync::AutotuningTable::add_benchmark_result, py::arg("name"),
+           py::arg("features"), py::arg("config"), py::arg("time"),
+           "Records that the passed configuration solved the named benchmark "
+           "problem in the passed time, retaining the fastest configuration "
+           "for each problem")
+      .def("predict", &SESync::AutotuningTable::predict,
+           "Predicts the fastest configuration for a problem with the passed "
+           "features")
+      .def("save", &SESync::AutotuningTable::save,
+           "Writes this table to the passed file")
+      .def("__len__", &SESync::AutotuningTable::size);
+
+  m.def("compute_problem_features", &SESync::compute_problem_features,
+        "Computes the features of the problem defined by the passed list of "
+        "measurements");
+  m.def("default_autotune_config", &SESync::default_autotune_config,
+        "Predicts a configuration for a problem with the passed features "
+        "using the autotuner's built-in rules");
+  m.def(
+      "autotune",
+      [](const SESync::measurements_t &measurements,
+         const SESync::SESyncOpts &options,
+         const SESync::AutotuningTable *table) {
+        return SESync::autotune(measurements, options, table);
+      },
+      py::arg("measurements"), py::arg("options") = SESync::SESyncOpts(),
+      py::arg("table") = nullptr,
+      "Returns a copy of the passed options, with the formulation, "
+      "preconditioner, projection factorization, r0, and LOBPCG parameters "
+      "replaced by those predicted for the passed problem");
+
+  /// Bindings for the memory governor
+
+  py::class_<SESync::MemoryEstimate>(
+      m, "MemoryEstimate",
+      "Estimated memory (in bytes) required by the data matrices and "
+      "factorizations of an SE-Sync problem")
+      .def(py::init<>())
+      .def_readwrite("data_matrices", &SESync::MemoryEstimate::data_matrices)
+      .def_readwrite("projection", &SESync::MemoryEstimate::projection)
+      .def_readwrite("preconditioner",
+                     &SESync::MemoryEstimate::preconditioner)
+      .def_readwrite("initialization",
+                     &SESync::MemoryEstimate::initialization)
+      .def_readwrite("verification", &SESync::MemoryEstimate::verification)
+      .def("peak", &SESync::MemoryEstimate::peak,
+           "The estimated peak memory required");
+
+  m.def("estimate_memory_usage", &SESync::estimate_memory_usage,
+        py::arg("features"), py::arg("options") = SESync::SESyncOpts(),
+        "Estimates the memory required to solve the problem with the passed "
+        "features using the passed options");
+  m.def(
+      "govern_memory",
+      [](const SESync::measurements_t &measurements,
+         const SESync::SESyncOpts &options) {
+        std::vector<std::string> decisions;
+        SESync::MemoryEstimate estimate;
+        SESync::SESyncOpts governed =
+            SESync::govern_memory(measurements, options, decisions, estimate);
+        return std::make_tuple(governed, decisions, estimate);
+      },
+      py::arg("measurements"), py::arg("options") = SESync::SESyncOpts(),
+      "Returns a tuple (options, decisions, estimate) consisting of a copy of "
+      "the passed options in which any factorization exceeding "
+      "options.memory_budget_bytes has been replaced by a lower-memory "
+      "alternative, a description of each such change, and the estimated "
+      "memory required under the returned options");
 
   /// Bindings for the main SESync driver
   m.def(
@@ -550,4 +938,18 @@ PYBIND11_MODULE(PySESync, m) {
       "Main SE-Sync function:  Given an SESyncProblem instance, this "
       "function computes and returns an estimated solution using the SE-Sync "
       "algorithm ");
+
+  m.def(
+      "resume",
+      [](SESync::SESyncProblem &problem, const std::string &checkpoint,
+         const SESync::SESyncOpts &options) -> SESync::SESyncResult {
+        // Redirect emitted output from (C++) stdout to (Python) sys.stdout
+        py::scoped_ostream_redirect stream(
+            std::cout, py::module::import("sys").attr("stdout"));
+        return SESync::resume(problem, checkpoint, options);
+      },
+      py::arg("problem"), py::arg("checkpoint"),
+      py::arg("options") = SESync::SESyncOpts(),
+      "Resumes SE-Sync on the passed problem instance from the state recorded "
+      "in a checkpoint file");
 }
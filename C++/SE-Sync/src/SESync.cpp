@@ -1,18 +1,39 @@
 ﻿#include <functional>
 
 #include "SESync/SESync.h"
+#include "SESync/SESyncAutotuner.h"
+#include "SESync/SESyncCheckpoint.h"
+#include "SESync/SESyncKrylovRecycling.h"
+#include "SESync/SESyncLBFGS.h"
+#include "SESync/SESyncMemoryGovernor.h"
 #include "SESync/SESyncProblem.h"
+#include "SESync/SESyncProblemT.h"
+#include "SESync/SESyncTimeBudget.h"
+#include "SESync/SESync_threading.h"
 #include "SESync/SESync_types.h"
 #include "SESync/SESync_utils.h"
 
 #include "Optimization/Riemannian/TNT.h"
 
 #include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <optional>
 
 namespace SESync {
 
-SESyncResult SESync(SESyncProblem &problem, const SESyncOpts &options,
-                    const Matrix &Y0) {
+/** Helper function:  runs SE-Sync on the passed problem instance, starting
+ * either from the initial iterate Y0 (if checkpoint is null) or from the state
+ * recorded in the passed checkpoint.  If budget_start_time is non-null, the
+ * hard deadline (if enforced) is measured from this time rather than from the
+ * start of this function, so that it also covers the work performed before
+ * the problem instance was constructed. */
+static SESyncResult run_SESync(
+    SESyncProblem &problem, const SESyncOpts &options, const Matrix &Y0,
+    const SESyncCheckpoint *checkpoint,
+    const std::chrono::time_point<std::chrono::high_resolution_clock>
+        *budget_start_time = nullptr) {
 
   /// INPUT SANITATION
 
@@ -24,6 +45,40 @@ SESyncResult SESync(SESyncProblem &problem, const SESyncOpts &options,
     throw std::invalid_argument("Maximum relaxation rank must be greater than "
                                 "or equal to initial relaxation rank.");
 
+  if (!checkpoint && Y0.size() != 0 &&
+      static_cast<size_t>(Y0.rows()) != options.r0)
+    throw std::invalid_argument("The number of rows of the initial iterate Y0 "
+                                "must equal the initial relaxation rank r0.");
+
+  if (!checkpoint && Y0.size() == 0 &&
+      options.initialization == Initialization::FromFile &&
+      options.initial_estimate.size() == 0)
+    throw std::invalid_argument("Initialization from file requires a set of "
+                                "initial pose estimates");
+
+  if (!checkpoint && Y0.size() == 0 &&
+      options.initialization == Initialization::SpanningTree &&
+      options.initial_estimate.size() == 0)
+    throw std::invalid_argument("Spanning-tree initialization requires "
+                                "SESync() to be called with a set of "
+                                "measurements");
+
+  if (options.reduce_rank && !(options.rank_tol >= 0 && options.rank_tol < 1))
+    throw std::invalid_argument(
+        "Relative tolerance for numerical rank must be in the range [0, 1)");
+
+  if (checkpoint && checkpoint->level > options.rmax)
+    throw std::invalid_argument("Checkpointed level of the Riemannian "
+                                "Staircase exceeds the maximum relaxation "
+                                "rank.");
+
+  if (checkpoint && (checkpoint->r < problem.dimension() ||
+                     checkpoint->r > checkpoint->level))
+    throw std::invalid_argument("Checkpointed relaxation rank must lie "
+                                "between the dimension of the problem and "
+                                "the checkpointed level of the Riemannian "
+                                "Staircase.");
+
   if (options.max_computation_time <= 0)
     throw std::invalid_argument(
         "Maximum computation time must be a positive value");
@@ -32,6 +87,10 @@ SESyncResult SESync(SESyncProblem &problem, const SESyncOpts &options,
     throw std::invalid_argument("Numerical tolerance for minimum eigenvalue "
                                 "nonnegativity must be a positive value");
 
+  if (options.Chebyshev_filter_degree < 1)
+    throw std::invalid_argument(
+        "Chebyshev filter degree must be a positive integer");
+
   if (options.LOBPCG_block_size < 1)
     throw std::invalid_argument("LOBPCG block size must be a positive integer");
 
@@ -47,6 +106,13 @@ SESyncResult SESync(SESyncProblem &problem, const SESyncOpts &options,
     throw std::invalid_argument(
         "Maximum number of LOBPCG iterations must be a positive value");
 
+  if (options.recycle_Krylov_subspace && options.Krylov_recycling_dimension < 1)
+    throw std::invalid_argument(
+        "Dimension of the Krylov recycling space must be a positive integer");
+
+  if (options.LBFGS_memory < 1)
+    throw std::invalid_argument("L-BFGS memory must be a positive integer");
+
   /// ALGORITHM DATA
 
   // The current iterate in the Riemannian Staircase
@@ -57,7 +123,23 @@ SESyncResult SESync(SESyncProblem &problem, const SESyncOpts &options,
 
   // The output results struct that we will return
   SESyncResult sesync_result;
+  if (checkpoint && checkpoint->result)
+    sesync_result = *checkpoint->result;
   sesync_result.status = MaxRank;
+  sesync_result.pose_ids = problem.pose_ids();
+
+  // Without a direct factorization of the certificate matrix, verification
+  // can find directions of negative curvature, but cannot certify optimality
+  const bool direct_verification =
+      problem.sparse_solver_options().verification != SparseSolverBackend::PCG;
+  sesync_result.direct_verification = direct_verification;
+
+  // Asynchronous writer for checkpoints of the Riemannian Staircase (if
+  // requested)
+  std::unique_ptr<CheckpointWriter> checkpoint_writer;
+  if (!options.checkpoint_file.empty())
+    checkpoint_writer =
+        std::make_unique<CheckpointWriter>(options.checkpoint_file);
 
   /// OPTION PARSING AND OUTPUT TO USER
 
@@ -78,11 +160,33 @@ SESyncResult SESync(SESyncProblem &problem, const SESyncOpts &options,
               << std::endl;
     std::cout << " Maximum level of Riemannian staircase: " << options.rmax
               << std::endl;
+    if (options.reduce_rank)
+      std::cout << " Reducing iterates to numerical rank with relative "
+                   "tolerance: "
+                << options.rank_tol << std::endl;
     std::cout << " Tolerance for accepting an eigenvalue as numerically "
                  "nonnegative in optimality verification: "
               << options.min_eig_num_tol << std::endl;
+    std::cout << " Minimum-eigenpair solver for verification: "
+              << (options.certificate_eigensolver ==
+                          VerificationEigensolver::LOBPCG
+                      ? "LOBPCG"
+                      : "Chebyshev-filtered subspace iteration (degree " +
+                            std::to_string(options.Chebyshev_filter_degree) +
+                            ")")
+              << std::endl;
     std::cout << " LOBPCG block size: " << options.LOBPCG_block_size
               << std::endl;
+    std::cout << " LOBPCG preconditioner: "
+              << (options.LOBPCG_preconditioner ==
+                          VerificationPreconditioner::ILDL
+                      ? "incomplete LDL^T"
+                      : "cached regularized Cholesky")
+              << std::endl;
+    if (options.LOBPCG_deflation)
+      std::cout << " Deflating the known near-nullspace of the certificate "
+                   "matrix in LOBPCG"
+                << std::endl;
     std::cout << " LOBPCG preconditioner maximum fill factor: "
               << options.LOBPCG_max_fill_factor << std::endl;
     std::cout << " LOBPCG preconditioner drop tolerance: "
@@ -102,19 +206,50 @@ SESyncResult SESync(SESyncProblem &problem, const SESyncOpts &options,
                 << std::endl;
     }
     std::cout << " Initialization method: "
-              << (options.initialization == Initialization::Chordal ? "chordal"
-                                                                    : "random")
+              << (options.initialization == Initialization::Chordal
+                      ? "chordal"
+                      : (options.initialization == Initialization::Random
+                             ? "random"
+                             : (options.initialization ==
+                                        Initialization::SpanningTree
+                                    ? "spanning tree"
+                                    : "from file")))
               << std::endl;
+    if (options.memory_budget_bytes > 0)
+      std::cout << " Memory budget: " << options.memory_budget_bytes
+                << " bytes" << std::endl;
+    std::cout << " Random seed: " << options.random_seed << std::endl;
     if (options.log_iterates)
       std::cout << " Logging entire sequence of Riemannian Staircase iterates"
                 << std::endl;
 #if defined(_OPENMP)
-    std::cout << " Running SE-Sync with " << options.num_threads << " threads"
-              << std::endl;
+    if (options.num_threads > 0)
+      std::cout << " Running SE-Sync with " << options.num_threads
+                << " threads" << std::endl;
+    else
+      std::cout << " Running SE-Sync with the default thread settings"
+                << std::endl;
 #endif
+    std::cout << " BLAS implementation: " << BLAS_vendor_name(BLAS_vendor())
+              << std::endl;
     std::cout << std::endl;
 
-    std::cout << "Riemannian trust-region settings:" << std::endl;
+    std::cout << "Local solver settings:" << std::endl;
+    std::cout << " Local solver: ";
+    if (options.local_solver_schedule.empty())
+      std::cout << (options.local_solver == LocalSolver::TNT
+                        ? "truncated-Newton trust-region"
+                        : "L-BFGS");
+    else
+      for (size_t k = 0; k < options.local_solver_schedule.size(); ++k)
+        std::cout << (k > 0 ? ", " : "") << "r = " << options.r0 + k
+                  << (k + 1 == options.local_solver_schedule.size() ? "+" : "")
+                  << ": "
+                  << (options.local_solver_schedule[k] == LocalSolver::TNT
+                          ? "TNT"
+                          : "L-BFGS");
+    std::cout << std::endl;
+    std::cout << " L-BFGS memory: " << options.LBFGS_memory << std::endl;
     std::cout << " Stopping tolerance for norm of Riemannian gradient: "
               << options.grad_norm_tol << std::endl;
     std::cout << " Stopping tolerance for norm of preconditioned Riemannian "
@@ -133,6 +268,10 @@ SESyncResult SESync(SESyncProblem &problem, const SESyncOpts &options,
               << options.STPCG_kappa << std::endl;
     std::cout << " STPCG target q-superlinear convergence rate (1 + theta): "
               << (1 + options.STPCG_theta) << std::endl;
+    if (options.recycle_Krylov_subspace)
+      std::cout << " Recycling Krylov subspaces of dimension "
+                << options.Krylov_recycling_dimension
+                << " across truncated conjugate gradient solves" << std::endl;
     std::cout
         << " Preconditioning the truncated conjugate gradient method using ";
     if (problem.preconditioner() == Preconditioner::None)
@@ -143,87 +282,132 @@ SESyncResult SESync(SESyncProblem &problem, const SESyncOpts &options,
       std::cout << "regularized Cholesky preconditioner with maximum condition "
                    "number "
                 << problem.regularized_Cholesky_preconditioner_max_condition();
+    std::cout << std::endl;
+
+    if (options.enforce_deadline)
+      std::cout << " Enforcing a hard deadline of "
+                << options.max_computation_time
+                << " seconds for the entire solve" << std::endl;
 
-    std::cout << std::endl << std::endl;
+    if (!options.checkpoint_file.empty())
+      std::cout << " Checkpointing to file " << options.checkpoint_file
+                << " every " << options.checkpoint_interval << " seconds"
+                << std::endl;
+
+    std::cout << std::endl;
   } // if (options.verbose)
 
   /// ALGORITHM START
   auto SESync_start_time = Stopwatch::tick();
 
-// Set number of threads
-#if defined(_OPENMP)
-  omp_set_num_threads(options.num_threads);
-#endif
+  // Scheduler for the total time budget (if enforcing a hard deadline)
+  std::optional<TimeBudget> budget;
+  if (options.enforce_deadline)
+    budget.emplace(problem, options.max_computation_time,
+                   budget_start_time ? *budget_start_time : SESync_start_time);
+
+  // Set number of threads: during the optimization and verification phases,
+  // the threads are assigned to SE-Sync's own (OpenMP) kernels, and the BLAS
+  // runs serially.  The sparse factorizations performed along the way (the
+  // chordal initialization, the rounding, and the Cholesky factorization of
+  // the certificate matrix during verification) each enter a Factorization
+  // phase of their own, which hands the threads back to the BLAS.
+  ScopedThreadingPhase threading(ThreadingPhase::BlockKernels,
+                                 options.num_threads);
 
   /// SET UP OPTIMIZATION
 
   /// Function handles required by the TNT optimization algorithm
 
-  // Objective
-  Optimization::Objective<Matrix, Scalar, Matrix> F =
-      [&problem](const Matrix &Y, const Matrix &NablaF_Y) {
-        return problem.evaluate_objective(Y);
-      };
+  Optimization::Objective<Matrix, Scalar, Matrix> F;
+  Optimization::Riemannian::QuadraticModel<Matrix, Matrix, Matrix> QM;
+  Optimization::Riemannian::Retraction<Matrix, Matrix, Matrix> retraction;
+  Optimization::Riemannian::LinearOperator<Matrix, Matrix, Matrix> transport;
+  std::optional<
+      Optimization::Riemannian::LinearOperator<Matrix, Matrix, Matrix>>
+      precon;
 
-  // Local quadratic model constructor
-  Optimization::Riemannian::QuadraticModel<Matrix, Matrix, Matrix> QM =
-      [&problem](const Matrix &Y, Matrix &grad,
-                 Optimization::Riemannian::LinearOperator<Matrix, Matrix,
-                                                          Matrix> &HessOp,
-                 Matrix &NablaF_Y) {
-        // Compute and cache Euclidean gradient at the current iterate
-        NablaF_Y = problem.Euclidean_gradient(Y);
-
-        // Compute Riemannian gradient from Euclidean gradient
-        grad = problem.Riemannian_gradient(Y, NablaF_Y);
-
-        // Define linear operator for computing Riemannian Hessian-vector
-        // products (cf. eq. (44) in the SE-Sync tech report)
-        HessOp = [&problem](const Matrix &Y, const Matrix &Ydot,
-                            const Matrix &NablaF_Y) {
-          return problem.Riemannian_Hessian_vector_product(Y, NablaF_Y, Ydot);
-        };
+  // We construct the objective, quadratic model, retraction, and
+  // preconditioning operators from the compile-time specialization of the
+  // problem matching its formulation and dimension, so that the (many)
+  // operator evaluations performed within the local solver do not need to
+  // re-dispatch on these at every call
+  visit_specialized_problem(problem, [&](const auto &P) {
+    // Objective
+    F = [P](const Matrix &Y, const Matrix &NablaF_Y) {
+      return P.evaluate_objective(Y);
+    };
+
+    // Local quadratic model constructor
+    QM = [P](const Matrix &Y, Matrix &grad,
+             Optimization::Riemannian::LinearOperator<Matrix, Matrix, Matrix>
+                 &HessOp,
+             Matrix &NablaF_Y) {
+      // Compute and cache Euclidean gradient at the current iterate
+      NablaF_Y = P.Euclidean_gradient(Y);
+
+      // Compute Riemannian gradient from Euclidean gradient
+      grad = P.Riemannian_gradient(Y, NablaF_Y);
+
+      // Define linear operator for computing Riemannian Hessian-vector
+      // products (cf. eq. (44) in the SE-Sync tech report)
+      HessOp = [P](const Matrix &Y, const Matrix &Ydot,
+                   const Matrix &NablaF_Y) {
+        return P.Riemannian_Hessian_vector_product(Y, NablaF_Y, Ydot);
       };
+    };
+
+    // Retraction operator
+    retraction = [P](const Matrix &Y, const Matrix &Ydot,
+                     const Matrix &NablaF_Y) { return P.retract(Y, Ydot); };
+
+    // Vector transport (used by L-BFGS): since the product of Stiefel manifolds
+    // is an embedded submanifold, we may simply use the orthogonal projection
+    // onto the tangent space at the new iterate
+    transport = [P](const Matrix &Y, const Matrix &V, const Matrix &NablaF_Y) {
+      return P.tangent_space_projection(Y, V);
+    };
+
+    // Preconditioning operator (optional)
+    if (options.preconditioner == Preconditioner::None)
+      precon = std::nullopt;
+    else
+      precon = [P](const Matrix &Y, const Matrix &Ydot,
+                   const Matrix &NablaF_Y) { return P.precondition(Y, Ydot); };
+  });
 
   // Riemannian metric
 
   // We consider a realization of the product of Stiefel manifolds as an
   // embedded submanifold of R^{r x dn}; consequently, the induced Riemannian
-  // metric is simply the usual Euclidean inner product
+  // metric is simply the usual Euclidean (Frobenius) inner product
   Optimization::Riemannian::RiemannianMetric<Matrix, Matrix, Scalar, Matrix>
-      metric = [&problem](const Matrix &Y, const Matrix &V1, const Matrix &V2,
-                          const Matrix &NablaF_Y) {
-        return (V1 * V2.transpose()).trace();
+      metric = [](const Matrix &Y, const Matrix &V1, const Matrix &V2,
+                  const Matrix &NablaF_Y) {
+        return Frobenius_inner_product(V1, V2);
       };
 
-  // Retraction operator
-  Optimization::Riemannian::Retraction<Matrix, Matrix, Matrix> retraction =
-      [&problem](const Matrix &Y, const Matrix &Ydot, const Matrix &NablaF_Y) {
-        return problem.retract(Y, Ydot);
-      };
-
-  // Preconditioning operator (optional)
-  std::optional<
-      Optimization::Riemannian::LinearOperator<Matrix, Matrix, Matrix>>
-      precon;
-  if (options.preconditioner == Preconditioner::None)
-    precon = std::nullopt;
-  else {
-    Optimization::Riemannian::LinearOperator<Matrix, Matrix, Matrix> precon_op =
-        [&problem](const Matrix &Y, const Matrix &Ydot,
-                   const Matrix &NablaF_Y) {
-          return problem.precondition(Y, Ydot);
-        };
-    precon = precon_op;
-  }
-
   /// INITIALIZATION
   if (options.verbose)
     std::cout << "INITIALIZATION:" << std::endl;
 
-  problem.set_relaxation_rank(options.r0);
+  // The level of the Riemannian Staircase at which to begin, and the
+  // relaxation rank at that level (which is smaller than the level if a saddle
+  // point was previously truncated to its numerical rank)
+  const size_t r0 = (checkpoint ? checkpoint->level : options.r0);
+  problem.set_relaxation_rank(checkpoint ? checkpoint->r : options.r0);
 
-  if (Y0.size() != 0) {
+  if (checkpoint) {
+    if (options.verbose)
+      std::cout << " Resuming from checkpoint at level " << r0
+                << " (relaxation rank r = " << checkpoint->r << ", "
+                << checkpoint->TNT_iterations
+                << " TNT iterations completed, "
+                << checkpoint->elapsed_time << " seconds elapsed)"
+                << std::endl;
+
+    Y = checkpoint->Y;
+  } else if (Y0.size() != 0) {
     if (options.verbose)
       std::cout << " Using user-supplied initial iterate Y0" << std::endl;
 
@@ -234,21 +418,37 @@ SESyncResult SESync(SESyncProblem &problem, const SESyncOpts &options,
         std::cout << " Computing chordal initialization ... ";
 
       auto chordal_init_start_time = Stopwatch::tick();
-      Y = problem.chordal_initialization();
+      {
+        // The chordal initialization is a sparse QR factorization, so the
+        // threads are handed back to the BLAS for its duration
+        ScopedThreadingPhase factorization_threading(
+            ThreadingPhase::Factorization, options.num_threads);
+        Y = problem.chordal_initialization();
+      }
       double chordal_init_elapsed_time =
           Stopwatch::tock(chordal_init_start_time);
       if (options.verbose)
         std::cout << "elapsed computation time: " << chordal_init_elapsed_time
                   << " seconds" << std::endl;
 
+    } else if (options.initialization == Initialization::FromFile) {
+      if (options.verbose)
+        std::cout << " Lifting the initial pose estimates read from file"
+                  << std::endl;
+      Y = problem.lift_estimate(options.initial_estimate);
+    } else if (options.initialization == Initialization::SpanningTree) {
+      if (options.verbose)
+        std::cout << " Lifting the spanning-tree initialization" << std::endl;
+      Y = problem.lift_estimate(options.initial_estimate);
     } else {
       if (options.verbose)
         std::cout << " Sampling a random initialization ... " << std::endl;
-      Y = problem.random_sample();
+      Y = problem.random_sample(options.random_seed);
     }
   }
 
-  sesync_result.initialization_time = Stopwatch::tock(SESync_start_time);
+  if (!checkpoint)
+    sesync_result.initialization_time = Stopwatch::tock(SESync_start_time);
   if (options.verbose)
     std::cout << " SE-Sync initialization finished; elapsed time: "
               << sesync_result.initialization_time << " seconds" << std::endl
@@ -276,13 +476,84 @@ SESyncResult SESync(SESyncProblem &problem, const SESyncOpts &options,
   params.log_iterates = options.log_iterates;
   params.verbose = options.verbose;
 
+  const Scalar default_initial_radius = params.initial_radius;
+
+  // The trust-region radius with which to begin the optimization at the next
+  // level of the Staircase
+  Scalar initial_radius = (options.initial_trust_region_radius > 0
+                               ? options.initial_trust_region_radius
+                               : default_initial_radius);
+
+  LBFGSParams lbfgs_params;
+  lbfgs_params.gradient_tolerance = options.grad_norm_tol;
+  lbfgs_params.preconditioned_gradient_tolerance =
+      options.preconditioned_grad_norm_tol;
+  lbfgs_params.relative_decrease_tolerance = options.rel_func_decrease_tol;
+  lbfgs_params.stepsize_tolerance = options.stepsize_tol;
+  lbfgs_params.memory = options.LBFGS_memory;
+  lbfgs_params.log_iterates = options.log_iterates;
+  lbfgs_params.verbose = options.verbose;
+
+  // Helper function: the local solver to use at the passed level of the
+  // Staircase (where the first level is numbered r0)
+  auto local_solver = [&](size_t level) {
+    if (options.local_solver_schedule.empty())
+      return options.local_solver;
+    return options.local_solver_schedule[std::min(
+        level > options.r0 ? level - options.r0 : 0,
+        options.local_solver_schedule.size() - 1)];
+  };
+
   auto riemannian_staircase_start_time = Stopwatch::tick();
 
-  for (size_t r = options.r0; r <= options.rmax; r++) {
+  // Computation time consumed by the Riemannian Staircase before this run
+  // (if resuming from a checkpoint)
+  const double prior_elapsed_time = (checkpoint ? checkpoint->elapsed_time : 0);
+
+  // Helper function: the total computation time consumed by the Riemannian
+  // Staircase
+  auto staircase_elapsed_time = [&]() {
+    return prior_elapsed_time +
+           Stopwatch::tock(riemannian_staircase_start_time);
+  };
+
+  // The results of the completed levels of the Staircase, as recorded in
+  // checkpoints.  This snapshot is shared by every checkpoint written during
+  // a level (so that periodic checkpoints do not copy the results on the
+  // solver thread), and is only refreshed when a level is completed.
+  std::shared_ptr<const SESyncResult> completed_levels;
+  if (checkpoint_writer)
+    completed_levels = checkpoint_result(sesync_result);
+
+  // Helper function: record a checkpoint of the current state
+  auto last_checkpoint_time = Stopwatch::tick();
+  auto submit_checkpoint = [&](size_t level, size_t r, const Matrix &Y,
+                               Scalar Delta, size_t TNT_iterations) {
+    SESyncCheckpoint state;
+    state.fingerprint = problem.fingerprint();
+    state.formulation = problem.formulation();
+    state.level = level;
+    state.r = r;
+    state.Y = Y;
+    state.trust_region_radius = Delta;
+    state.TNT_iterations = TNT_iterations;
+    state.elapsed_time = staircase_elapsed_time();
+    state.result = completed_levels;
+    checkpoint_writer->submit(std::move(state));
+    last_checkpoint_time = Stopwatch::tick();
+  };
+
+  // The current relaxation rank.  This increases by one at each level of the
+  // Staircase, but may also decrease when a saddle point is truncated to its
+  // numerical rank (cf. options.reduce_rank); the levels themselves are
+  // therefore counted separately, so that they progress monotonically and
+  // the Staircase visits at most rmax - r0 + 1 of them
+  size_t r = (checkpoint ? checkpoint->r : r0);
+
+  for (size_t level = r0; level <= options.rmax; level++) {
     // The elapsed time from the start of the Riemannian Staircase algorithm
     // until the start of this iteration of RTR
-    double RTR_iteration_start_time =
-        Stopwatch::tock(riemannian_staircase_start_time);
+    double RTR_iteration_start_time = staircase_elapsed_time();
 
     /// Test temporal stopping condition
 
@@ -296,6 +567,22 @@ SESyncResult SESync(SESyncProblem &problem, const SESyncOpts &options,
     params.max_computation_time =
         options.max_computation_time - RTR_iteration_start_time;
 
+    if (budget) {
+      // Reserve enough time to verify and round the solution of this level
+      if (budget->allotment(SolvePhase::Optimization) <= 0) {
+        // If we have not yet completed any level of the Staircase, the best
+        // available estimate is the initial iterate
+        if (sesync_result.Yopt.size() == 0) {
+          sesync_result.Yopt = Y;
+          sesync_result.SDPval = problem.evaluate_objective(Y);
+        }
+        sesync_result.status = ElapsedTime;
+        break;
+      }
+      params.max_computation_time =
+          budget->allotment(SolvePhase::Optimization);
+    }
+
     if (options.verbose)
       std::cout << std::endl
                 << std::endl
@@ -303,50 +590,158 @@ SESyncResult SESync(SESyncProblem &problem, const SESyncOpts &options,
                 << ") ======" << std::endl
                 << std::endl;
 
+    const LocalSolver solver = local_solver(level);
+
+    // If we are resuming partway through this level, restore the state of
+    // the truncated-Newton trust-region method
+    const bool resuming_level = checkpoint && (level == r0);
+    size_t TNT_iterations = (resuming_level ? checkpoint->TNT_iterations : 0);
+    params.initial_radius =
+        (resuming_level ? checkpoint->trust_region_radius : initial_radius);
+    params.max_iterations = (TNT_iterations < options.max_iterations
+                                 ? options.max_iterations - TNT_iterations
+                                 : 1);
+
+    if (options.verbose && solver == LocalSolver::TNT)
+      std::cout << "Initial trust-region radius: " << params.initial_radius
+                << std::endl
+                << std::endl;
+
+    // The most recent trust-region radius, and the number of rejected update
+    // steps, at this level
+    Scalar final_radius = params.initial_radius;
+    size_t rejected_steps = 0;
+
+    // If Krylov subspace recycling is enabled, the recycler used by TNT at
+    // this level, together with the number of Hessian-vector products it has
+    // performed in each outer iteration.  The deflation space is rebuilt from
+    // scratch at each level of the Staircase, since the dimension of the
+    // tangent spaces changes.
+    std::optional<KrylovRecycler> recycler;
+    if (solver == LocalSolver::TNT && options.recycle_Krylov_subspace)
+      recycler.emplace(options.Krylov_recycling_dimension, metric, transport);
+    std::vector<size_t> recycling_Hessian_vector_products;
+    size_t recorded_recycling_Hessian_vector_products = 0;
+
+    // Helper function: the number of Hessian-vector products performed by the
+    // recycler since the previous call
+    auto new_recycling_Hessian_vector_products = [&]() -> size_t {
+      if (!recycler)
+        return 0;
+      const size_t total = recycler->Hessian_vector_products();
+      const size_t count = total - recorded_recycling_Hessian_vector_products;
+      recorded_recycling_Hessian_vector_products = total;
+      return count;
+    };
+
+    // We augment the user function to track the state of the trust-region
+    // method, and (if checkpointing is enabled) to periodically record the
+    // state of the optimization
+    std::optional<SESyncTNTUserFunction> user_function =
+        [&, r](double t, const Matrix &x, Scalar f, const Matrix &g,
+               const Optimization::Riemannian::LinearOperator<Matrix, Matrix,
+                                                              Matrix> &HessOp,
+               Scalar Delta, size_t num_STPCG_iters, const Matrix &h, Scalar df,
+               Scalar rho, bool accepted, Matrix &NablaF_Y) {
+          ++TNT_iterations;
+          if (solver == LocalSolver::TNT)
+            final_radius = Delta;
+          if (!accepted)
+            ++rejected_steps;
+          recycling_Hessian_vector_products.push_back(
+              new_recycling_Hessian_vector_products());
+
+          bool stop = options.user_function &&
+                      (*options.user_function)(t, x, f, g, HessOp, Delta,
+                                               num_STPCG_iters, h, df, rho,
+                                               accepted, NablaF_Y);
+
+          // At L-BFGS levels Delta is the line-search stepsize, which must not
+          // be recorded as a trust-region radius; final_radius is only
+          // updated at TNT levels
+          if (checkpoint_writer && Stopwatch::tock(last_checkpoint_time) >=
+                                       options.checkpoint_interval)
+            submit_checkpoint(level, r, x, final_radius,
+                              TNT_iterations);
+
+          return stop;
+        };
+
     /// Run optimization!
-    Optimization::Riemannian::TNTResult<Matrix, Scalar> tnt_result =
-        Optimization::Riemannian::TNT<Matrix, Matrix, Scalar, Matrix>(
-            F, QM, metric, retraction, Y, NablaF_Y, precon, params,
-            options.user_function);
+    Optimization::Riemannian::TNTResult<Matrix, Scalar> opt_result;
+    if (solver == LocalSolver::LBFGS) {
+      lbfgs_params.max_computation_time = params.max_computation_time;
+      lbfgs_params.max_iterations = params.max_iterations;
+      opt_result =
+          RiemannianLBFGS(F, QM, metric, retraction, transport, Y, NablaF_Y,
+                          precon, lbfgs_params, user_function);
+    } else if (recycler)
+      opt_result =
+          Optimization::Riemannian::TNT<Matrix, Matrix, Scalar, Matrix>(
+              F, recycler->quadratic_model(QM), metric, retraction, Y,
+              NablaF_Y, recycler->preconditioner(precon), params,
+              user_function);
+    else
+      opt_result =
+          Optimization::Riemannian::TNT<Matrix, Matrix, Scalar, Matrix>(
+              F, QM, metric, retraction, Y, NablaF_Y, precon, params,
+              user_function);
+    sesync_result.local_solvers.push_back(solver);
+    sesync_result.rejected_steps.push_back(rejected_steps);
+
+    // Charge any Hessian-vector products the recycler performed after the
+    // final outer iteration to that iteration
+    const size_t remaining_recycling_Hessian_vector_products =
+        new_recycling_Hessian_vector_products();
+    if (!recycling_Hessian_vector_products.empty())
+      recycling_Hessian_vector_products.back() +=
+          remaining_recycling_Hessian_vector_products;
+    sesync_result.recycling_Hessian_vector_products.push_back(
+        recycling_Hessian_vector_products);
+    if (solver == LocalSolver::TNT)
+      sesync_result.trust_region_radius = final_radius;
 
     // Extract the results
-    sesync_result.Yopt = tnt_result.x;
-    sesync_result.SDPval = tnt_result.f;
+    sesync_result.Yopt = opt_result.x;
+    sesync_result.SDPval = opt_result.f;
     sesync_result.gradnorm =
-        problem.Riemannian_gradient(sesync_result.Yopt).norm();
+        Frobenius_norm(problem.Riemannian_gradient(sesync_result.Yopt));
 
     // Record sequence of function values
-    sesync_result.function_values.push_back(tnt_result.objective_values);
+    sesync_result.function_values.push_back(opt_result.objective_values);
 
     // Record sequence of gradient norms
-    sesync_result.gradient_norms.push_back(tnt_result.gradient_norms);
+    sesync_result.gradient_norms.push_back(opt_result.gradient_norms);
 
     // Record sequence of preconditioned gradient norms
     sesync_result.preconditioned_gradient_norms.push_back(
-        tnt_result.preconditioned_gradient_norms);
+        opt_result.preconditioned_gradient_norms);
 
     // Record sequence of (# Hessian-vector products)
     sesync_result.Hessian_vector_products.push_back(
-        tnt_result.inner_iterations);
+        opt_result.inner_iterations);
 
     // Record sequence of update step norms
-    sesync_result.update_step_norms.push_back(tnt_result.update_step_norms);
+    sesync_result.update_step_norms.push_back(opt_result.update_step_norms);
 
     // Record sequence of update step M-norms
-    sesync_result.update_step_M_norms.push_back(tnt_result.update_step_M_norms);
+    sesync_result.update_step_M_norms.push_back(opt_result.update_step_M_norms);
 
     // Record sequence of gain ratios for the update steps
-    sesync_result.gain_ratios.push_back(tnt_result.gain_ratios);
+    sesync_result.gain_ratios.push_back(opt_result.gain_ratios);
 
     // Record sequence of elapsed optimization times
-    sesync_result.elapsed_optimization_times.push_back(tnt_result.time);
+    sesync_result.elapsed_optimization_times.push_back(opt_result.time);
 
     // Record sequence of pose estimates, if requested
     if (options.log_iterates)
-      sesync_result.iterates.push_back(tnt_result.iterates);
+      sesync_result.iterates.push_back(opt_result.iterates);
 
-    /// Check TNT termination status
-    if (tnt_result.status == Optimization::Riemannian::TNTStatus::ElapsedTime) {
+    if (budget)
+      budget->record(SolvePhase::Optimization, opt_result.elapsed_time);
+
+    /// Check local solver termination status
+    if (opt_result.status == Optimization::Riemannian::TNTStatus::ElapsedTime) {
       sesync_result.status = SESyncStatus::ElapsedTime;
       break;
     }
@@ -356,26 +751,85 @@ SESyncResult SESync(SESyncProblem &problem, const SESyncOpts &options,
       std::cout << std::endl
                 << "Found first-order critical point with value F(Y) = "
                 << sesync_result.SDPval
-                << "!  Elapsed computation time: " << tnt_result.elapsed_time
+                << "!  Elapsed computation time: " << opt_result.elapsed_time
                 << " seconds" << std::endl
                 << std::endl;
+      if (recycler) {
+        size_t tCG_products = 0, recycling_products = 0;
+        for (size_t count : opt_result.inner_iterations)
+          tCG_products += count;
+        for (size_t count : recycling_Hessian_vector_products)
+          recycling_products += count;
+        std::cout << "Hessian-vector products: " << tCG_products
+                  << " in tCG + " << recycling_products
+                  << " for Krylov subspace recycling = "
+                  << tCG_products + recycling_products << std::endl
+                  << std::endl;
+      }
       std::cout << "Checking second order optimality ... " << std::endl;
     }
 
     /// Check second-order optimality
 
+    // If the deadline does not leave enough time to verify this critical
+    // point, return it as the current estimate
+    if (budget && !budget->affords(SolvePhase::Verification)) {
+      if (options.verbose)
+        std::cout << "Insufficient time remaining to verify this critical "
+                     "point!"
+                  << std::endl;
+      sesync_result.status = ElapsedTime;
+      break;
+    }
+
     size_t num_lobpcg_iters;
     auto verification_start_time = Stopwatch::tick();
 
+    // Maximum permitted computation time for the verification
+    double verification_max_time =
+        (budget ? budget->allotment(SolvePhase::Verification)
+                : std::numeric_limits<double>::max());
+
     Vector v;     // Escape direction
     Scalar theta; // Curvature of certificate matrix along escape direction
 
     bool global_opt = problem.verify_solution(
         sesync_result.Yopt, options.min_eig_num_tol, options.LOBPCG_block_size,
         theta, v, num_lobpcg_iters, options.LOBPCG_max_iterations,
-        options.LOBPCG_max_fill_factor, options.LOBPCG_drop_tol);
+        options.LOBPCG_max_fill_factor, options.LOBPCG_drop_tol,
+        options.LOBPCG_preconditioner, options.LOBPCG_deflation,
+        options.certificate_eigensolver, options.Chebyshev_filter_degree,
+        verification_max_time, options.random_seed);
     double verification_elapsed_time = Stopwatch::tock(verification_start_time);
 
+    if (budget) {
+      budget->record(SolvePhase::Verification, verification_elapsed_time);
+
+      // If the eigensolver was cut off by the deadline before finding a
+      // direction of sufficiently negative curvature, we have run out of time
+      if (!global_opt && theta >= -options.min_eig_num_tol / 2 &&
+          verification_elapsed_time >= verification_max_time) {
+        sesync_result.status = ElapsedTime;
+        break;
+      }
+    }
+
+    // If the certificate matrix could not be factored directly, a critical
+    // point at which the eigensolver found no direction of sufficiently
+    // negative curvature is (probably) optimal, but cannot be certified
+    if (!direct_verification && theta >= -options.min_eig_num_tol / 2) {
+      if (options.verbose)
+        std::cout << "No direction of negative curvature found, but the "
+                     "certificate matrix was not factored; the solution "
+                     "cannot be certified!"
+                  << std::endl;
+      sesync_result.escape_direction_curvatures.push_back(theta);
+      sesync_result.LOBPCG_iters.push_back(num_lobpcg_iters);
+      sesync_result.verification_times.push_back(verification_elapsed_time);
+      sesync_result.status = Uncertified;
+      break;
+    }
+
     // Check eigenvalue convergence
     if (!global_opt && theta >= -options.min_eig_num_tol / 2) {
       if (options.verbose)
@@ -411,6 +865,28 @@ SESyncResult SESync(SESyncProblem &problem, const SESyncOpts &options,
                   << num_lobpcg_iters << " LOBPCG iterations)." << std::endl;
       }
 
+      // Don't bother escaping if there is no time left to use the result
+      if (budget && !budget->affords(SolvePhase::SaddleEscape)) {
+        sesync_result.status = ElapsedTime;
+        break;
+      }
+      auto escape_start_time = Stopwatch::tick();
+
+      // Since both the certificate matrix S and the objective depend upon
+      // Yopt only through Yopt^T Yopt, we may first truncate Yopt to its
+      // numerical rank, and ascend from there instead
+      if (options.reduce_rank) {
+        Matrix Yred = reduce_rank(sesync_result.Yopt, problem.dimension(),
+                                  options.rank_tol);
+        if (static_cast<size_t>(Yred.rows()) < r) {
+          if (options.verbose)
+            std::cout << "Reducing rank of saddle point from " << r << " to "
+                      << Yred.rows() << std::endl;
+          sesync_result.Yopt = std::move(Yred);
+          r = sesync_result.Yopt.rows();
+        }
+      }
+
       // Augment the rank of the rank-restricted semidefinite relaxation in
       // preparation for ascending to the next level of the Riemannian
       // Staircase
@@ -421,9 +897,33 @@ SESyncResult SESync(SESyncProblem &problem, const SESyncOpts &options,
           problem, sesync_result.Yopt, theta, v, options.grad_norm_tol,
           options.preconditioned_grad_norm_tol, Yplus);
 
+      if (budget)
+        budget->record(SolvePhase::SaddleEscape,
+                       Stopwatch::tock(escape_start_time));
+
       if (escape_success) {
+        // Carry the trust-region radius over to the next level of the
+        // Staircase, enlarging it if necessary so that the trust region at
+        // Yplus contains the escape step that led to it
+        if (options.carry_trust_region_radius) {
+          Matrix Ylift = Matrix::Zero(Yplus.rows(), Yplus.cols());
+          Ylift.topRows(sesync_result.Yopt.rows()) = sesync_result.Yopt;
+          initial_radius = std::max(sesync_result.trust_region_radius,
+                                    Frobenius_norm(Yplus - Ylift));
+          if (!(initial_radius > 0 && std::isfinite(initial_radius)))
+            initial_radius = default_initial_radius;
+        } else
+          initial_radius = default_initial_radius;
+
         // Update initialization point for next level in the Staircase
         Y = Yplus;
+        ++r;
+
+        // (There is nothing to resume if this was the last permitted level)
+        if (checkpoint_writer && level < options.rmax) {
+          completed_levels = checkpoint_result(sesync_result);
+          submit_checkpoint(level + 1, r, Y, initial_radius, 0);
+        }
       } else {
         if (options.verbose)
           std::cout
@@ -439,6 +939,12 @@ SESyncResult SESync(SESyncProblem &problem, const SESyncOpts &options,
 
   /// POST-PROCESSING
 
+  if (options.reduce_rank && sesync_result.Yopt.size() != 0) {
+    sesync_result.Yopt = reduce_rank(sesync_result.Yopt, problem.dimension(),
+                                     options.rank_tol);
+    problem.set_relaxation_rank(sesync_result.Yopt.rows());
+  }
+
   if (options.verbose) {
     std::cout << std::endl
               << std::endl
@@ -469,6 +975,12 @@ SESyncResult SESync(SESyncProblem &problem, const SESyncOpts &options,
                    "time before finding global optimum!"
                 << std::endl;
       break;
+    case Uncertified:
+      std::cout << "WARNING: Found a critical point with no direction of "
+                   "negative curvature, but its global optimality could not "
+                   "be certified without a direct factorization!"
+                << std::endl;
+      break;
     }
   } // if (options.verbose)
 
@@ -478,9 +990,17 @@ SESyncResult SESync(SESyncProblem &problem, const SESyncOpts &options,
   // Round solution
   auto rounding_start_time = Stopwatch::tick();
   // Recover the complete pose matrix X = [t | R]
-  sesync_result.xhat = problem.round_solution(sesync_result.Yopt);
+  {
+    // Recovering the translations requires a sparse QR factorization
+    ScopedThreadingPhase factorization_threading(ThreadingPhase::Factorization,
+                                                 options.num_threads);
+    sesync_result.xhat = problem.round_solution(sesync_result.Yopt);
+  }
   double rounding_elapsed_time = Stopwatch::tock(rounding_start_time);
 
+  if (budget)
+    budget->record(SolvePhase::Rounding, rounding_elapsed_time);
+
   if (options.verbose)
     std::cout << "elapsed computation time: " << rounding_elapsed_time
               << " seconds" << std::endl
@@ -501,29 +1021,45 @@ SESyncResult SESync(SESyncProblem &problem, const SESyncOpts &options,
                  problem.dimension() * problem.num_states()))
            : problem.evaluate_objective(sesync_result.xhat));
 
-  // Compute the primal optimal SDP solution Lambda and its objective value
-  Matrix Lambda_blocks = problem.compute_Lambda_blocks(sesync_result.Yopt);
+  if (budget && !budget->affords(SolvePhase::PostProcessing)) {
+    // There is insufficient time remaining to construct the primal solution
+    // Lambda, so we return the rounded solution without the associated
+    // duality gap and suboptimality bound
+    if (options.verbose)
+      std::cout << "WARNING: Insufficient time remaining to compute "
+                   "suboptimality bound!"
+                << std::endl;
+
+    sesync_result.trLambda = std::numeric_limits<Scalar>::quiet_NaN();
+    sesync_result.duality_gap = std::numeric_limits<Scalar>::quiet_NaN();
+    sesync_result.suboptimality_bound =
+        std::numeric_limits<Scalar>::quiet_NaN();
+  } else {
+    auto post_processing_start_time = Stopwatch::tick();
 
-  sesync_result.trLambda = 0;
-  for (size_t i = 0; i < problem.num_states(); i++)
-    sesync_result.trLambda +=
-        Lambda_blocks
-            .block(0, i * problem.dimension(), problem.dimension(),
-                   problem.dimension())
-            .trace();
+    // Compute the primal optimal SDP solution Lambda and its objective value
+    Matrix Lambda_blocks = problem.compute_Lambda_blocks(sesync_result.Yopt);
 
-  sesync_result.Lambda =
-      problem.compute_Lambda_from_Lambda_blocks(Lambda_blocks);
+    sesync_result.trLambda =
+        block_diagonal_trace(Lambda_blocks, problem.dimension());
 
-  // Get the duality gap for the primal-dual pair (Y'*Y, Lambda) of SDP
-  // estimates
+    sesync_result.Lambda =
+        problem.compute_Lambda_from_Lambda_blocks(Lambda_blocks);
 
-  sesync_result.duality_gap = sesync_result.SDPval - sesync_result.trLambda;
+    // Get the duality gap for the primal-dual pair (Y'*Y, Lambda) of SDP
+    // estimates
 
-  // Get an upper bound on the (global) suboptimality of the recovered (rounded)
-  // pose estimates
-  sesync_result.suboptimality_bound =
-      sesync_result.Fxhat - sesync_result.trLambda;
+    sesync_result.duality_gap = sesync_result.SDPval - sesync_result.trLambda;
+
+    // Get an upper bound on the (global) suboptimality of the recovered
+    // (rounded) pose estimates
+    sesync_result.suboptimality_bound =
+        sesync_result.Fxhat - sesync_result.trLambda;
+
+    if (budget)
+      budget->record(SolvePhase::PostProcessing,
+                     Stopwatch::tock(post_processing_start_time));
+  }
 
   /// FINAL OUTPUT
 
@@ -553,15 +1089,129 @@ SESyncResult SESync(SESyncProblem &problem, const SESyncOpts &options,
   return sesync_result;
 }
 
+SESyncResult SESync(SESyncProblem &problem, const SESyncOpts &options,
+                    const Matrix &Y0) {
+  return run_SESync(problem, options, Y0, nullptr);
+}
+
+SESyncResult resume(SESyncProblem &problem, const std::string &checkpoint,
+                    const SESyncOpts &options) {
+  SESyncCheckpoint state = load_checkpoint(checkpoint);
+
+  if (state.fingerprint != problem.fingerprint() ||
+      state.formulation != problem.formulation())
+    throw std::invalid_argument("Checkpoint " + checkpoint +
+                                " does not match the passed problem instance");
+
+  if (static_cast<size_t>(state.Y.rows()) != state.r ||
+      static_cast<size_t>(state.Y.cols()) != problem.iterate_columns())
+    throw std::invalid_argument(
+        "The iterate in checkpoint " + checkpoint + " must be an r x " +
+        std::to_string(problem.iterate_columns()) + " matrix");
+
+  return run_SESync(problem, options, Matrix(), &state);
+}
+
 SESyncResult SESync(const measurements_t &measurements,
                     const SESyncOpts &options, const Matrix &Y0) {
+  // The hard deadline (if enforced) covers the entire solve, including the
+  // preprocessing, autotuning, and problem construction performed by
+  // prepare_problem()
+  auto SESync_start_time = Stopwatch::tick();
+
+  PreparedProblem prepared = prepare_problem(measurements, options, Y0);
+
+  SESyncResult result = run_SESync(*prepared.problem, prepared.options, Y0,
+                                   nullptr, &SESync_start_time);
+  prepared.annotate(result);
+  return result;
+}
+
+void PreparedProblem::annotate(SESyncResult &result) const {
+  result.estimated_memory_bytes = estimated_memory_bytes;
+  result.memory_governor_decisions = memory_governor_decisions;
+}
+
+PreparedProblem prepare_problem(const measurements_t &original_measurements,
+                                const SESyncOpts &requested_options,
+                                const Matrix &Y0) {
+  PreparedProblem prepared;
+  SESyncOpts options = requested_options;
+
+  // If the pose IDs are not contiguous, the problem relabels the poses densely
+  // (cf. SESyncProblem::pose_ids()); the preprocessing performed here must use
+  // the same relabeling, so that it is not sized by the largest ID either
+  PoseIDMap pose_ids;
+  measurements_t compacted;
+  const measurements_t &measurements =
+      compacted_measurements(original_measurements, compacted, pose_ids);
+  if (!pose_ids.is_identity() && options.verbose)
+    std::cout << "Relabeling " << pose_ids.size()
+              << " poses with non-contiguous IDs (largest ID "
+              << pose_ids.ids.back() << ")" << std::endl
+              << std::endl;
+
+  if (options.autotune) {
+    if (options.verbose)
+      std::cout << "Autotuning SE-Sync configuration ... ";
+
+    auto autotuning_start_time = Stopwatch::tick();
+    options = autotune(measurements, requested_options);
+
+    // A user-supplied initial iterate determines the formulation and the
+    // initial relaxation rank
+    if (Y0.size() != 0) {
+      options.formulation = requested_options.formulation;
+      options.r0 = requested_options.r0;
+      options.rmax = requested_options.rmax;
+    }
+
+    double autotuning_elapsed_time = Stopwatch::tock(autotuning_start_time);
+    if (options.verbose)
+      std::cout << "elapsed computation time: " << autotuning_elapsed_time
+                << " seconds" << std::endl
+                << std::endl;
+  }
+  prepared.options = options;
+
+  // Replace any factorizations that would exceed the memory budget with
+  // lower-memory alternatives before constructing the problem
+  Scalar max_verification_fill_factor = std::numeric_limits<Scalar>::max();
+  if (options.memory_budget_bytes > 0) {
+    MemoryEstimate estimate;
+    prepared.options = govern_memory(measurements, options,
+                                     prepared.memory_governor_decisions,
+                                     estimate);
+    prepared.estimated_memory_bytes = estimate.peak();
+    max_verification_fill_factor = prepared.options.LOBPCG_max_fill_factor;
+
+    if (options.verbose) {
+      std::cout << "Estimated peak memory usage: "
+                << prepared.estimated_memory_bytes
+                << " bytes (budget: " << options.memory_budget_bytes
+                << " bytes)" << std::endl;
+      for (const std::string &decision : prepared.memory_governor_decisions)
+        std::cout << " " << decision << std::endl;
+      std::cout << std::endl;
+    }
+  }
+  const SESyncOpts &governed = prepared.options;
+
+  // The spanning-tree initialization is computed directly from the
+  // measurements
+  if (Y0.size() == 0 && governed.initialization == Initialization::SpanningTree)
+    prepared.options.initial_estimate =
+        spanning_tree_initialization(measurements);
+
   if (options.verbose)
     std::cout << "Constructing SE-Sync problem instance ... ";
 
   auto problem_construction_start_time = Stopwatch::tick();
-  SESyncProblem problem(
-      measurements, options.formulation, options.projection_factorization,
-      options.preconditioner, options.reg_Cholesky_precon_max_condition_number);
+  prepared.problem = std::make_shared<SESyncProblem>(
+      original_measurements, governed.formulation,
+      governed.projection_factorization, governed.preconditioner,
+      governed.reg_Cholesky_precon_max_condition_number, governed.num_threads,
+      governed.sparse_solvers, max_verification_fill_factor);
   double problem_construction_elapsed_time =
       Stopwatch::tock(problem_construction_start_time);
   if (options.verbose)
@@ -569,7 +1219,7 @@ SESyncResult SESync(const measurements_t &measurements,
               << problem_construction_elapsed_time << " seconds" << std::endl
               << std::endl;
 
-  return SESync(problem, options, Y0);
+  return prepared;
 }
 
 bool escape_saddle(const SESyncProblem &problem, const Matrix &Y, Scalar theta,
@@ -627,9 +1277,9 @@ bool escape_saddle(const SESyncProblem &problem, const Matrix &Y, Scalar theta,
     // gradient tolerance stopping criterion at the next iteration
     Scalar FYtest = problem.evaluate_objective(Ytest);
     Matrix grad_FYtest = problem.Riemannian_gradient(Ytest);
-    Scalar grad_FYtest_norm = grad_FYtest.norm();
+    Scalar grad_FYtest_norm = Frobenius_norm(grad_FYtest);
     Scalar preconditioned_grad_FYtest_norm =
-        problem.precondition(Ytest, grad_FYtest).norm();
+        Frobenius_norm(problem.precondition(Ytest, grad_FYtest));
 
     // Record trial stepsize and function value
     alphas.push_back(alpha);
@@ -0,0 +1,504 @@
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+#include <Eigen/OrderingMethods>
+
+#include "SESync/SESyncAutotuner.h"
+
+namespace SESync {
+
+/// Thresholds used by the built-in rules (cf. default_autotune_config())
+
+/** Maximum estimated number of nonzeros in the (dn x dn) Cholesky factor of the
+ * data matrix for which we use the regularized Cholesky preconditioner (about
+ * 400 MB in double precision) */
+static constexpr Scalar max_preconditioner_factor_nonzeros = 5e7;
+
+/** Maximum estimated number of nonzeros in the (n x n) Cholesky factor of the
+ * pose-graph Laplacian for which we solve the Simplified formulation (which
+ * requires factoring it to compute the orthogonal projection) */
+static constexpr Scalar max_projection_factor_nonzeros = 2e7;
+
+/** Spread of the translational measurement precisions above which we compute
+ * the orthogonal projection using the (more stable) QR factorization */
+static constexpr Scalar max_Cholesky_tau_spread = 8;
+
+/** Number of poses above which we use larger LOBPCG blocks */
+static constexpr size_t large_problem_size = 20000;
+
+/** Mean degree above which the pose graph is considered densely connected */
+static constexpr Scalar dense_mean_degree = 6;
+
+/** Helper function:  computes log10(max / min) over a set of (positive)
+ * values */
+static Scalar spread(Scalar min, Scalar max) {
+  return (min > 0 && max >= min ? std::log10(max / min) : 0);
+}
+
+/** Helper function:  given the adjacency lists of an undirected graph on n
+ * vertices, computes and returns the number of nonzeros in the
+ * lower-triangular Cholesky factor of a matrix with the corresponding sparsity
+ * pattern, under the approximate minimum degree ordering.  This requires only
+ * a symbolic analysis:  the nonzero pattern of each row k of the factor is the
+ * subtree of the elimination tree reached by following parent pointers
+ * upwards from the (permuted) neighbors of k that precede it (cf. Sec. 4.1 of
+ * Davis's "Direct Methods for Sparse Linear Systems"). */
+static size_t
+symbolic_Cholesky_nonzeros(const std::vector<std::vector<size_t>> &adjacency) {
+  typedef Eigen::SparseMatrix<Scalar, Eigen::ColMajor, int> ColMajorPattern;
+
+  const size_t n = adjacency.size();
+  if (n == 0)
+    return 0;
+
+  /// Compute fill-reducing ordering
+
+  std::vector<Eigen::Triplet<Scalar, int>> triplets;
+  for (size_t i = 0; i < n; ++i) {
+    triplets.emplace_back(i, i, 1);
+    for (size_t j : adjacency[i])
+      triplets.emplace_back(i, j, 1);
+  }
+  ColMajorPattern pattern(n, n);
+  pattern.setFromTriplets(triplets.begin(), triplets.end());
+
+  // AMD returns the permutation mapping each new index to an original one
+  Eigen::PermutationMatrix<Eigen::Dynamic, Eigen::Dynamic, int> perm;
+  Eigen::AMDOrdering<int> amd;
+  amd(pattern, perm);
+
+  std::vector<size_t> new_index(n);
+  for (size_t k = 0; k < n; ++k)
+    new_index[perm.indices()(k)] = k;
+
+  /// Compute elimination tree (using path compression)
+
+  const size_t none = std::numeric_limits<size_t>::max();
+  std::vector<size_t> parent(n, none), ancestor(n, none);
+  for (size_t k = 0; k < n; ++k) {
+    for (size_t j : adjacency[perm.indices()(k)]) {
+      for (size_t i = new_index[j]; i < k;) {
+        size_t next = ancestor[i];
+        ancestor[i] = k;
+        if (next == none) {
+          parent[i] = k;
+          break;
+        }
+        i = next;
+      }
+    }
+  }
+
+  /// Count the nonzeros in each row of the factor
+
+  size_t nnz = n; // Diagonal
+  std::vector<size_t> mark(n, none);
+  for (size_t k = 0; k < n; ++k) {
+    mark[k] = k;
+    for (size_t j : adjacency[perm.indices()(k)])
+      for (size_t i = new_index[j]; i < k && mark[i] != k; i = parent[i]) {
+        mark[i] = k;
+        ++nnz;
+      }
+  }
+
+  return nnz;
+}
+
+ProblemFeatures compute_problem_features(const measurements_t &measurements) {
+  ProblemFeatures features;
+  if (measurements.empty())
+    return features;
+
+  features.m = measurements.size();
+  features.d = measurements[0].R.rows();
+
+  for (const RelativePoseMeasurement &measurement : measurements)
+    features.n = std::max(features.n, std::max(measurement.i, measurement.j));
+  features.n++; // Account for 0-based indexing
+
+  /// Degree distribution, loop closures, and measurement precisions
+
+  std::vector<size_t> degree(features.n, 0);
+  std::vector<std::vector<size_t>> adjacency(features.n);
+  size_t num_loop_closures = 0;
+  Scalar kappa_min = std::numeric_limits<Scalar>::max(), kappa_max = 0;
+  Scalar tau_min = std::numeric_limits<Scalar>::max(), tau_max = 0;
+
+  for (const RelativePoseMeasurement &measurement : measurements) {
+    ++degree[measurement.i];
+    ++degree[measurement.j];
+
+    if (measurement.j != measurement.i + 1 &&
+        measurement.i != measurement.j + 1)
+      ++num_loop_closures;
+
+    if (measurement.i != measurement.j) {
+      adjacency[measurement.i].push_back(measurement.j);
+      adjacency[measurement.j].push_back(measurement.i);
+    }
+
+    kappa_min = std::min(kappa_min, measurement.kappa);
+    kappa_max = std::max(kappa_max, measurement.kappa);
+    tau_min = std::min(tau_min, measurement.tau);
+    tau_max = std::max(tau_max, measurement.tau);
+  }
+
+  features.mean_degree = 2.0 * features.m / features.n;
+  features.max_degree = *std::max_element(degree.begin(), degree.end());
+
+  Scalar degree_variance = 0;
+  for (size_t deg : degree)
+    degree_variance += std::pow(deg - features.mean_degree, 2);
+  degree_variance /= features.n;
+  features.degree_variation =
+      std::sqrt(degree_variance) / features.mean_degree;
+
+  features.loop_closure_ratio =
+      static_cast<Scalar>(num_loop_closures) / features.m;
+  features.kappa_spread = spread(kappa_min, kappa_max);
+  features.tau_spread = spread(tau_min, tau_max);
+
+  /// Estimated Cholesky fill
+
+  // Remove duplicate edges (e.g. multiple measurements between the same pair
+  // of poses)
+  size_t num_edges = 0;
+  for (std::vector<size_t> &neighbors : adjacency) {
+    std::sort(neighbors.begin(), neighbors.end());
+    neighbors.erase(std::unique(neighbors.begin(), neighbors.end()),
+                    neighbors.end());
+    num_edges += neighbors.size();
+  }
+  num_edges /= 2;
+
+  features.factor_nonzeros = symbolic_Cholesky_nonzeros(adjacency);
+  features.factor_fill =
+      static_cast<Scalar>(features.factor_nonzeros) / (features.n + num_edges);
+
+  return features;
+}
+
+AutotuneConfig AutotuneConfig::from_options(const SESyncOpts &options,
+                                            size_t d) {
+  AutotuneConfig config;
+  config.formulation = options.formulation;
+  config.preconditioner = options.preconditioner;
+  config.projection_factorization = options.projection_factorization;
+  config.r0_offset = (options.r0 > d ? options.r0 - d : 0);
+  config.LOBPCG_block_size = options.LOBPCG_block_size;
+  config.LOBPCG_max_fill_factor = options.LOBPCG_max_fill_factor;
+  config.LOBPCG_drop_tol = options.LOBPCG_drop_tol;
+  return config;
+}
+
+void AutotuneConfig::apply(SESyncOpts &options, size_t d) const {
+  // The Simplified and Explicit formulations are interchangeable, but the
+  // SO-Sync problem is a different problem
+  if (options.formulation != Formulation::SOSync &&
+      formulation != Formulation::SOSync)
+    options.formulation = formulation;
+
+  options.preconditioner = preconditioner;
+  options.projection_factorization = projection_factorization;
+  options.r0 = d + r0_offset;
+  options.rmax = std::max(options.rmax, options.r0);
+  options.LOBPCG_block_size = LOBPCG_block_size;
+  options.LOBPCG_max_fill_factor = LOBPCG_max_fill_factor;
+  options.LOBPCG_drop_tol = LOBPCG_drop_tol;
+}
+
+AutotuneConfig default_autotune_config(const ProblemFeatures &features) {
+  AutotuneConfig config;
+
+  // Solve the Simplified formulation (which is typically better-conditioned)
+  // unless the factorization required to compute the orthogonal projection is
+  // prohibitively expensive
+  config.formulation =
+      (features.factor_nonzeros <= max_projection_factor_nonzeros
+           ? Formulation::Simplified
+           : Formulation::Explicit);
+
+  // Use the regularized Cholesky preconditioner whenever its (d x d block)
+  // factor fits within the memory budget
+  Scalar d2 = features.d * features.d;
+  config.preconditioner =
+      (d2 * features.factor_nonzeros <= max_preconditioner_factor_nonzeros
+           ? Preconditioner::RegularizedCholesky
+           : Preconditioner::Jacobi);
+
+  // Widely-varying translational precisions make the reduced Laplacian
+  // ill-conditioned
+  config.projection_factorization =
+      (features.tau_spread <= max_Cholesky_tau_spread
+           ? ProjectionFactorization::Cholesky
+           : ProjectionFactorization::QR);
+
+  // Problems with many loop closures or heterogeneous measurement precisions
+  // are more likely to require ascending the Staircase
+  config.r0_offset =
+      (features.loop_closure_ratio > .3 || features.kappa_spread > 2 ? 1 : 0);
+
+  config.LOBPCG_block_size = (features.n > large_problem_size ? 8 : 4);
+
+  // The ILDL fill factor is relative to the number of nonzeros per row, so
+  // densely-connected graphs require less of it
+  config.LOBPCG_max_fill_factor =
+      (features.mean_degree > dense_mean_degree ? 2 : 3);
+  config.LOBPCG_drop_tol = 1e-3;
+
+  return config;
+}
+
+/// AutotuningTable
+
+static const std::string autotuning_table_header = "SESYNC_AUTOTUNING_TABLE";
+static const int autotuning_table_version = 1;
+
+/** Helper functions:  (de)serialize the autotuned enumerations */
+static std::string to_string(Formulation formulation) {
+  switch (formulation) {
+  case Formulation::Simplified:
+    return "Simplified";
+  case Formulation::Explicit:
+    return "Explicit";
+  default:
+    return "SOSync";
+  }
+}
+
+static std::string to_string(Preconditioner preconditioner) {
+  switch (preconditioner) {
+  case Preconditioner::None:
+    return "None";
+  case Preconditioner::Jacobi:
+    return "Jacobi";
+  default:
+    return "RegularizedCholesky";
+  }
+}
+
+static std::string to_string(ProjectionFactorization factorization) {
+  return (factorization == ProjectionFactorization::Cholesky ? "Cholesky"
+                                                             : "QR");
+}
+
+static void parse(const std::string &token, Formulation &formulation) {
+  if (token == "Simplified")
+    formulation = Formulation::Simplified;
+  else if (token == "Explicit")
+    formulation = Formulation::Explicit;
+  else if (token == "SOSync")
+    formulation = Formulation::SOSync;
+  else
+    throw std::runtime_error("Unrecognized formulation: " + token);
+}
+
+static void parse(const std::string &token, Preconditioner &preconditioner) {
+  if (token == "None")
+    preconditioner = Preconditioner::None;
+  else if (token == "Jacobi")
+    preconditioner = Preconditioner::Jacobi;
+  else if (token == "RegularizedCholesky")
+    preconditioner = Preconditioner::RegularizedCholesky;
+  else
+    throw std::runtime_error("Unrecognized preconditioner: " + token);
+}
+
+static void parse(const std::string &token,
+                  ProjectionFactorization &factorization) {
+  if (token == "Cholesky")
+    factorization = ProjectionFactorization::Cholesky;
+  else if (token == "QR")
+    factorization = ProjectionFactorization::QR;
+  else
+    throw std::runtime_error("Unrecognized projection factorization: " +
+                             token);
+}
+
+/** Helper function:  the features used to measure the distance between
+ * problems (scale-dependent quantities are compared logarithmically) */
+static std::vector<Scalar> feature_vector(const ProblemFeatures &features) {
+  return {std::log10(std::max<Scalar>(features.n, 1)),
+          features.mean_degree,
+          features.degree_variation,
+          features.loop_closure_ratio,
+          features.kappa_spread,
+          features.tau_spread,
+          std::log10(std::max<Scalar>(features.factor_fill, 1))};
+}
+
+AutotuningTable::AutotuningTable(const std::string &filename) {
+  std::ifstream infile(filename);
+  if (!infile)
+    throw std::runtime_error("Could not open file " + filename +
+                             " for reading");
+
+  std::string line, token;
+  int version = 0;
+  std::getline(infile, line);
+  std::istringstream header(line);
+  if (!(header >> token >> version) || token != autotuning_table_header ||
+      version != autotuning_table_version)
+    throw std::runtime_error(filename +
+                             " is not a valid SE-Sync autotuning table");
+
+  while (std::getline(infile, line)) {
+    std::istringstream strstrm(line);
+    if (!(strstrm >> token) || token != "ENTRY")
+      continue; // Blank line or comment
+
+    Entry entry;
+    ProblemFeatures &f = entry.features;
+    AutotuneConfig &c = entry.config;
+    std::string formulation, preconditioner, projection_factorization;
+
+    strstrm >> entry.name >> f.n >> f.m >> f.d >> f.mean_degree >>
+        f.max_degree >> f.degree_variation >> f.loop_closure_ratio >>
+        f.kappa_spread >> f.tau_spread >> f.factor_nonzeros >> f.factor_fill >>
+        formulation >> preconditioner >> projection_factorization >>
+        c.r0_offset >> c.LOBPCG_block_size >> c.LOBPCG_max_fill_factor >>
+        c.LOBPCG_drop_tol >> entry.time;
+
+    if (!strstrm)
+      throw std::runtime_error("Malformed entry in autotuning table " +
+                               filename + ": " + line);
+
+    parse(formulation, c.formulation);
+    parse(preconditioner, c.preconditioner);
+    parse(projection_factorization, c.projection_factorization);
+
+    entries_.push_back(std::move(entry));
+  }
+}
+
+void AutotuningTable::add_benchmark_result(const std::string &name,
+                                           const ProblemFeatures &features,
+                                           const AutotuneConfig &config,
+                                           double time) {
+  if (name.empty() ||
+      std::any_of(name.begin(), name.end(), [](char c) { return isspace(c); }))
+    throw std::invalid_argument(
+        "Benchmark names must be nonempty and contain no whitespace");
+
+  for (Entry &entry : entries_)
+    if (entry.name == name) {
+      if (time < entry.time) {
+        entry.features = features;
+        entry.config = config;
+        entry.time = time;
+      }
+      return;
+    }
+
+  entries_.push_back({name, features, config, time});
+}
+
+AutotuneConfig
+AutotuningTable::predict(const ProblemFeatures &features) const {
+  std::vector<const Entry *> candidates;
+  for (const Entry &entry : entries_)
+    if (entry.features.d == features.d)
+      candidates.push_back(&entry);
+
+  if (candidates.empty())
+    return default_autotune_config(features);
+
+  // Normalize each feature by its standard deviation across the candidates,
+  // so that no single feature dominates the distance
+  std::vector<std::vector<Scalar>> phi;
+  for (const Entry *entry : candidates)
+    phi.push_back(feature_vector(entry->features));
+  std::vector<Scalar> x = feature_vector(features);
+
+  const size_t num_features = x.size();
+  std::vector<Scalar> scale(num_features, 1);
+  for (size_t k = 0; k < num_features; ++k) {
+    Scalar mean = 0, var = 0;
+    for (const std::vector<Scalar> &p : phi)
+      mean += p[k];
+    mean /= phi.size();
+    for (const std::vector<Scalar> &p : phi)
+      var += (p[k] - mean) * (p[k] - mean);
+    var /= phi.size();
+    if (var > 0)
+      scale[k] = std::sqrt(var);
+  }
+
+  size_t nearest = 0;
+  Scalar nearest_distance = std::numeric_limits<Scalar>::max();
+  for (size_t c = 0; c < phi.size(); ++c) {
+    Scalar distance = 0;
+    for (size_t k = 0; k < num_features; ++k)
+      distance += std::pow((phi[c][k] - x[k]) / scale[k], 2);
+    if (distance < nearest_distance) {
+      nearest = c;
+      nearest_distance = distance;
+    }
+  }
+
+  return candidates[nearest]->config;
+}
+
+void AutotuningTable::save(const std::string &filename) const {
+  std::ofstream outfile(filename, std::ios::trunc);
+  if (!outfile)
+    throw std::runtime_error("Could not open file " + filename +
+                             " for writing");
+
+  outfile << autotuning_table_header << " " << autotuning_table_version
+          << std::endl;
+  outfile << "# ENTRY name n m d mean_degree max_degree degree_variation "
+             "loop_closure_ratio kappa_spread tau_spread factor_nonzeros "
+             "factor_fill formulation preconditioner projection_factorization "
+             "r0_offset LOBPCG_block_size LOBPCG_max_fill_factor "
+             "LOBPCG_drop_tol time"
+          << std::endl;
+
+  outfile << std::setprecision(std::numeric_limits<Scalar>::max_digits10);
+  for (const Entry &entry : entries_) {
+    const ProblemFeatures &f = entry.features;
+    const AutotuneConfig &c = entry.config;
+    outfile << "ENTRY " << entry.name << " " << f.n << " " << f.m << " "
+            << f.d << " " << f.mean_degree << " " << f.max_degree << " "
+            << f.degree_variation << " " << f.loop_closure_ratio << " "
+            << f.kappa_spread << " " << f.tau_spread << " "
+            << f.factor_nonzeros << " " << f.factor_fill << " "
+            << to_string(c.formulation) << " " << to_string(c.preconditioner)
+            << " " << to_string(c.projection_factorization) << " "
+            << c.r0_offset << " " << c.LOBPCG_block_size << " "
+            << c.LOBPCG_max_fill_factor << " " << c.LOBPCG_drop_tol << " "
+            << entry.time << std::endl;
+  }
+
+  if (!outfile)
+    throw std::runtime_error("Error writing autotuning table to file " +
+                             filename);
+}
+
+SESyncOpts autotune(const measurements_t &measurements,
+                    const SESyncOpts &options, const AutotuningTable *table) {
+  SESyncOpts tuned = options;
+  tuned.autotune = false;
+  if (measurements.empty())
+    return tuned;
+
+  AutotuningTable loaded_table;
+  if (!table && !options.autotuning_table.empty()) {
+    loaded_table = AutotuningTable(options.autotuning_table);
+    table = &loaded_table;
+  }
+
+  ProblemFeatures features = compute_problem_features(measurements);
+  AutotuneConfig config = (table ? table->predict(features)
+                                 : default_autotune_config(features));
+  config.apply(tuned, features.d);
+  return tuned;
+}
+
+} // namespace SESync
@@ -0,0 +1,520 @@
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "SESync/SESyncBatch.h"
+#include "SESync/SESync_utils.h"
+
+namespace SESync {
+
+/** A row-major dense matrix, used to view the lanes of a LaneArray */
+typedef Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+    RowMajorMatrix;
+
+/** Stride between successive elements of a single lane of a LaneArray */
+typedef Eigen::Stride<Eigen::Dynamic, Eigen::Dynamic> LaneStride;
+
+/** Decay factor for the weighted average of previous objective values used as
+ * the reference value in the nonmonotone line search */
+static constexpr Scalar nonmonotone_decay = .85;
+
+SESyncBatch::SESyncBatch(const std::vector<measurements_t> &problems,
+                         const SESyncBatchOpts &options)
+    : L_(problems.size()), options_(options) {
+
+  if (problems.empty() || problems[0].empty())
+    throw std::invalid_argument("Batch must contain at least one nonempty "
+                                "problem");
+
+  /// Determine (and validate) the common problem shape
+
+  const measurements_t &reference = problems[0];
+  d_ = reference[0].R.rows();
+  n_ = 0;
+  for (const RelativePoseMeasurement &m : reference)
+    n_ = std::max<size_t>(n_, std::max(m.i, m.j) + 1);
+  N_ = n_ * d_;
+
+  for (const measurements_t &measurements : problems) {
+    if (measurements.size() != reference.size())
+      throw std::invalid_argument("All problems in a batch must contain the "
+                                  "same number of measurements");
+
+    for (size_t k = 0; k < measurements.size(); ++k)
+      if (measurements[k].i != reference[k].i ||
+          measurements[k].j != reference[k].j ||
+          static_cast<size_t>(measurements[k].R.rows()) != d_)
+        throw std::invalid_argument("All problems in a batch must have the "
+                                    "same dimension and graph topology");
+  }
+
+  if (options_.r0 < d_)
+    throw std::invalid_argument("Initial relaxation rank r0 must be greater "
+                                "than or equal to the dimension of the "
+                                "estimation problem.");
+
+  if (options_.rmax < options_.r0)
+    throw std::invalid_argument("Maximum relaxation rank must be greater than "
+                                "or equal to initial relaxation rank.");
+
+  if (options_.min_eig_num_tol <= 0)
+    throw std::invalid_argument("Numerical tolerance for minimum eigenvalue "
+                                "nonnegativity must be a positive value");
+
+  /// Construct the data matrices for each problem
+
+  Q_.resize(N_ * (N_ + 1) / 2, L_);
+  T_.resize(L_);
+  Q_norm_.resize(L_);
+
+  // Matrix used to compute the pseudoinverse of the (connected) translational
+  // weight graph Laplacian L(W^tau) = M11:  M11^+ = (M11 + J)^-1 - J, where
+  // J = 11' / n
+  const Matrix J = Matrix::Constant(n_, n_, 1.0 / n_);
+
+  for (size_t l = 0; l < L_; ++l) {
+    const Matrix M(construct_M_matrix(problems[l]));
+
+    const Matrix M11 = M.topLeftCorner(n_, n_);
+    const Matrix M12 = M.topRightCorner(n_, N_);
+
+    Matrix M11_pinv = (M11 + J).llt().solve(Matrix::Identity(n_, n_)) - J;
+    Matrix M11_pinv_M12 = M11_pinv * M12;
+
+    // Eliminate the translational states via the Schur complement of M11
+    const Matrix Q =
+        M.bottomRightCorner(N_, N_) - M12.transpose() * M11_pinv_M12;
+
+    // Store the upper triangle of Q, row by row
+    for (size_t b = 0, k = 0; b < N_; ++b)
+      for (size_t j = b; j < N_; ++j, ++k)
+        Q_(k, l) = Q(b, j);
+    T_[l] = -M11_pinv_M12.transpose();
+
+    // Gershgorin bound on lambda_max(Q)
+    Q_norm_(l) = Q.cwiseAbs().rowwise().sum().maxCoeff();
+  }
+}
+
+Matrix SESyncBatch::lane(const LaneArray &A, size_t l, size_t rows,
+                         size_t cols) const {
+  return Eigen::Map<const RowMajorMatrix, 0, LaneStride>(
+      A.data() + l, rows, cols, LaneStride(cols * L_, L_));
+}
+
+void SESyncBatch::set_lane(LaneArray &A, size_t l, const Matrix &X) const {
+  Eigen::Map<RowMajorMatrix, 0, LaneStride>(A.data() + l, X.rows(), X.cols(),
+                                            LaneStride(X.cols() * L_, L_)) = X;
+}
+
+Matrix SESyncBatch::data_matrix(size_t l) const {
+  Matrix Q(N_, N_);
+  for (size_t b = 0, k = 0; b < N_; ++b)
+    for (size_t j = b; j < N_; ++j, ++k)
+      Q(b, j) = Q(j, b) = Q_(k, l);
+  return Q;
+}
+
+void SESyncBatch::Euclidean_gradient(const LaneArray &Y, size_t r,
+                                     LaneArray &G) const {
+  G.setZero(r * N_, L_);
+
+  // G(a, j) = 2 * sum_b Y(a, b) * Q(b, j).  Each stored element Q(b, j) of
+  // the upper triangle is loaded exactly once, and applied to every row of
+  // Y (and, if b != j, also as Q(j, b)), so that Q is streamed through the
+  // cache only once per evaluation
+  for (size_t b = 0, k = 0; b < N_; ++b) {
+    const auto Qbb = Q_.row(k++);
+    for (size_t a = 0; a < r; ++a)
+      G.row(a * N_ + b) += Y.row(a * N_ + b) * Qbb;
+
+    for (size_t j = b + 1; j < N_; ++j) {
+      const auto Qbj = Q_.row(k++);
+      for (size_t a = 0; a < r; ++a) {
+        G.row(a * N_ + j) += Y.row(a * N_ + b) * Qbj;
+        G.row(a * N_ + b) += Y.row(a * N_ + j) * Qbj;
+      }
+    }
+  }
+
+  G *= 2;
+}
+
+void SESyncBatch::symmetric_block_products(const LaneArray &Y,
+                                           const LaneArray &G, size_t r,
+                                           LaneArray &P) const {
+  const size_t d2 = d_ * d_;
+  P.setZero(n_ * d2, L_);
+
+  for (size_t i = 0; i < n_; ++i) {
+    // P_i = Y_i' * G_i
+    for (size_t p = 0; p < d_; ++p)
+      for (size_t q = 0; q < d_; ++q)
+        for (size_t a = 0; a < r; ++a)
+          P.row(i * d2 + p * d_ + q) +=
+              Y.row(a * N_ + i * d_ + p) * G.row(a * N_ + i * d_ + q);
+
+    // P_i <- sym(P_i)
+    for (size_t p = 0; p < d_; ++p)
+      for (size_t q = p + 1; q < d_; ++q) {
+        LaneScalars s =
+            .5 * (P.row(i * d2 + p * d_ + q) + P.row(i * d2 + q * d_ + p));
+        P.row(i * d2 + p * d_ + q) = s;
+        P.row(i * d2 + q * d_ + p) = s;
+      }
+  }
+}
+
+void SESyncBatch::Riemannian_gradient(const LaneArray &Y, const LaneArray &G,
+                                      size_t r, LaneArray &grad) const {
+  const size_t d2 = d_ * d_;
+  LaneArray P;
+  symmetric_block_products(Y, G, r, P);
+
+  // grad_i = G_i - Y_i * sym(Y_i' * G_i)
+  grad = G;
+  for (size_t i = 0; i < n_; ++i)
+    for (size_t a = 0; a < r; ++a)
+      for (size_t q = 0; q < d_; ++q)
+        for (size_t p = 0; p < d_; ++p)
+          grad.row(a * N_ + i * d_ + q) -=
+              Y.row(a * N_ + i * d_ + p) * P.row(i * d2 + p * d_ + q);
+}
+
+void SESyncBatch::retract(LaneArray &X, size_t r) const {
+  LaneScalars s(L_);
+
+  // Gram-Schmidt orthonormalization of the columns of each block X_i (i.e.,
+  // the Q-factor retraction on each Stiefel manifold St(d, r))
+  for (size_t i = 0; i < n_; ++i)
+    for (size_t q = 0; q < d_; ++q) {
+      const size_t c = i * d_ + q;
+
+      for (size_t p = 0; p < q; ++p) {
+        const size_t cp = i * d_ + p;
+        s.setZero();
+        for (size_t a = 0; a < r; ++a)
+          s += X.row(a * N_ + cp) * X.row(a * N_ + c);
+        for (size_t a = 0; a < r; ++a)
+          X.row(a * N_ + c) -= s * X.row(a * N_ + cp);
+      }
+
+      s.setZero();
+      for (size_t a = 0; a < r; ++a)
+        s += X.row(a * N_ + c).square();
+      s = s.sqrt();
+      for (size_t a = 0; a < r; ++a)
+        X.row(a * N_ + c) /= s;
+    }
+}
+
+void SESyncBatch::orthonormalize_blocks(Matrix &Y) const {
+  for (size_t i = 0; i < n_; ++i)
+    for (size_t q = 0; q < d_; ++q) {
+      for (size_t p = 0; p < q; ++p)
+        Y.col(i * d_ + q) -=
+            Y.col(i * d_ + p).dot(Y.col(i * d_ + q)) * Y.col(i * d_ + p);
+      Y.col(i * d_ + q).normalize();
+    }
+}
+
+Matrix SESyncBatch::spectral_initialization(const Matrix &Q,
+                                            Scalar Q_norm) const {
+  // The eigenvectors corresponding to the d smallest eigenvalues of Q are
+  // computed by subspace inverse iteration, which requires only a single
+  // Cholesky factorization of (a slightly regularized copy of) Q:  since Q
+  // is positive-semidefinite and its d smallest eigenvalues are well
+  // separated from the rest, this converges in a handful of iterations
+  Eigen::LLT<Matrix> LLT(Q + 1e-10 * Q_norm * Matrix::Identity(N_, N_));
+  if (LLT.info() != Eigen::Success) {
+    Eigen::SelfAdjointEigenSolver<Matrix> eig(Q);
+    return round_rotations(eig.eigenvectors().leftCols(d_).transpose());
+  }
+
+  Matrix X = Matrix::Zero(N_, d_);
+  for (size_t i = 0; i < n_; ++i)
+    X.block(i * d_, 0, d_, d_).setIdentity();
+
+  for (size_t k = 0; k < 4; ++k)
+    X = LLT.solve(X).householderQr().householderQ() *
+        Matrix::Identity(N_, d_);
+
+  return round_rotations(X.transpose());
+}
+
+Matrix SESyncBatch::round_rotations(const Matrix &Y) const {
+  // Rank-d truncated singular value decomposition of Y
+  Eigen::JacobiSVD<Matrix> svd(Y, Eigen::ComputeThinV);
+  Matrix R = svd.singularValues().head(d_).asDiagonal() *
+             svd.matrixV().leftCols(d_).transpose();
+
+  // If fewer than half of the blocks of R have positive determinant, reverse
+  // their orientations
+  size_t ng0 = 0;
+  for (size_t i = 0; i < n_; ++i)
+    if (R.block(0, i * d_, d_, d_).determinant() > 0)
+      ++ng0;
+
+  if (ng0 < n_ / 2) {
+    Matrix reflector = Matrix::Identity(d_, d_);
+    reflector(d_ - 1, d_ - 1) = -1;
+    R = reflector * R;
+  }
+
+  // Project each block to SO(d)
+  for (size_t i = 0; i < n_; ++i)
+    R.block(0, i * d_, d_, d_) = project_to_SOd(R.block(0, i * d_, d_, d_));
+
+  return R;
+}
+
+std::vector<SESyncBatchResult> SESyncBatch::solve() const {
+  std::vector<SESyncBatchResult> results(L_);
+
+  const Scalar grad_norm_tol2 = options_.grad_norm_tol * options_.grad_norm_tol;
+
+  /// INITIALIZATION
+
+  // Spectral initialization:  round the eigenvectors corresponding to the d
+  // smallest eigenvalues of each data matrix Q
+  size_t r = options_.r0;
+  LaneArray Y = LaneArray::Zero(r * N_, L_);
+  for (size_t l = 0; l < L_; ++l) {
+    Matrix Y0 = Matrix::Zero(r, N_);
+    Y0.topRows(d_) = spectral_initialization(data_matrix(l), Q_norm_(l));
+    set_lane(Y, l, Y0);
+  }
+
+  // Whether each lane has terminated, and the number of iterations it used
+  std::vector<bool> finished(L_, false);
+  std::vector<size_t> iterations(L_, 0);
+
+  // Working space
+  LaneArray G, grad, X, GX, gradX, P;
+  LaneScalars F, FX, gnorm2, alpha, step, active(L_), accepted(L_);
+
+  // Reference values (and their weights) for the nonmonotone line search
+  LaneScalars C, C_weight;
+
+  /// RIEMANNIAN STAIRCASE
+  while (true) {
+
+    /// Run the Riemannian gradient method on all remaining lanes in lockstep
+
+    for (size_t l = 0; l < L_; ++l)
+      active(l) = finished[l] ? 0 : 1;
+
+    Euclidean_gradient(Y, r, G);
+    F = .5 * (Y * G).colwise().sum();
+    Riemannian_gradient(Y, G, r, grad);
+    gnorm2 = grad.square().colwise().sum();
+
+    // Initial stepsizes:  the inverse of (an upper bound for) the Lipschitz
+    // constant of the Euclidean gradient
+    alpha = 1 / (2 * Q_norm_.max(1e-12));
+
+    C = F;
+    C_weight.setOnes(L_);
+
+    // The number of iterations performed by each lane at this level, and the
+    // number of consecutive steps it has rejected
+    std::vector<size_t> level_iterations(L_, 0), rejections(L_, 0);
+
+    while (true) {
+      for (size_t l = 0; l < L_; ++l)
+        if (gnorm2(l) <= grad_norm_tol2 ||
+            level_iterations[l] >= options_.max_iterations)
+          active(l) = 0;
+
+      if (active.maxCoeff() == 0)
+        break;
+
+      // Trial step (lanes that are not active take a null step).  Lanes are
+      // not backtracked in lockstep, since that would require every lane to
+      // re-evaluate its gradient whenever any one of them rejects its step;
+      // instead, a lane that rejects its step remains at its current iterate,
+      // and retries with half the stepsize at the next iteration.  Since
+      // Barzilai-Borwein steps frequently increase the objective transiently,
+      // a step is accepted if it sufficiently decreases a weighted average C
+      // of the previous objective values (the nonmonotone condition of Zhang
+      // and Hager), rather than the current value itself.
+      step = alpha * active;
+      X = Y - grad.rowwise() * step;
+      retract(X, r);
+      Euclidean_gradient(X, r, GX);
+      FX = .5 * (X * GX).colwise().sum();
+
+      for (size_t l = 0; l < L_; ++l) {
+        accepted(l) =
+            active(l) && FX(l) <= C(l) - 1e-4 * step(l) * gnorm2(l) ? 1 : 0;
+
+        if (accepted(l))
+          rejections[l] = 0;
+        else if (active(l)) {
+          alpha(l) *= .5;
+
+          // Lanes that have rejected too many consecutive steps have stalled
+          if (++rejections[l] > options_.max_backtracks)
+            active(l) = 0;
+        }
+
+        // Lanes that did not accept a step remain at their current iterates
+        if (!accepted(l)) {
+          X.col(l) = Y.col(l);
+          GX.col(l) = G.col(l);
+          FX(l) = F(l);
+        }
+      }
+
+      Riemannian_gradient(X, GX, r, gradX);
+
+      // Barzilai-Borwein stepsizes for the next iteration
+      const LaneScalars ss = (X - Y).square().colwise().sum();
+      const LaneScalars sy = ((X - Y) * (gradX - grad)).colwise().sum();
+      for (size_t l = 0; l < L_; ++l) {
+        if (!accepted(l))
+          continue;
+
+        ++iterations[l];
+        ++level_iterations[l];
+        alpha(l) = (sy(l) > 0 ? ss(l) / sy(l) : 2 * alpha(l));
+        alpha(l) = std::min(std::max(alpha(l), 1e-12), 1e12);
+
+        // Update the reference value for the nonmonotone line search
+        const Scalar weight = nonmonotone_decay * C_weight(l) + 1;
+        C(l) = (nonmonotone_decay * C_weight(l) * C(l) + FX(l)) / weight;
+        C_weight(l) = weight;
+
+        // Test relative decrease stopping criterion (since the objective need
+        // not decrease monotonically, this tests the magnitude of the change)
+        if (fabs(F(l) - FX(l)) <=
+            options_.rel_func_decrease_tol * std::max<Scalar>(1, fabs(F(l))))
+          active(l) = 0;
+      }
+
+      Y.swap(X);
+      G.swap(GX);
+      grad.swap(gradX);
+      F = FX;
+      gnorm2 = grad.square().colwise().sum();
+    }
+
+    /// Certify each remaining lane, and construct escape directions from
+    /// saddle points
+
+    // The (symmetric) diagonal blocks of Y'YQ; the Lagrange multipliers are
+    // Lambda_i = P_i / 2, since G = 2 Y Q
+    symmetric_block_products(Y, G, r, P);
+
+    std::vector<Matrix> Yplus(L_);
+    for (size_t l = 0; l < L_; ++l) {
+      if (finished[l])
+        continue;
+
+      const Matrix Yl = lane(Y, l, r, N_);
+      const Matrix Q = data_matrix(l);
+      const Matrix Pl = lane(P, l, N_, d_);
+
+      // Certificate matrix S = Q - Lambda
+      Matrix S = Q;
+      for (size_t i = 0; i < n_; ++i)
+        S.block(i * d_, i * d_, d_, d_) -= .5 * Pl.block(i * d_, 0, d_, d_);
+
+      results[l].Yopt = Yl;
+      results[l].SDPval = F(l);
+      results[l].iterations = iterations[l];
+
+      // As in SESyncProblem::verify_solution(), we first test whether
+      // S + min_eig_num_tol * I is positive-definite using a Cholesky
+      // factorization, which is far cheaper than an eigendecomposition; the
+      // latter is required only to construct an escape direction
+      Eigen::LLT<Matrix> LLT(S + options_.min_eig_num_tol *
+                                     Matrix::Identity(N_, N_));
+      if (LLT.info() == Eigen::Success) {
+        // S annihilates the rows of Yopt, so lambda_min(S) lies in
+        // [-min_eig_num_tol, 0]
+        results[l].lambda_min = 0;
+        results[l].status = GlobalOpt;
+        finished[l] = true;
+        continue;
+      }
+
+      Eigen::SelfAdjointEigenSolver<Matrix> eig(S);
+      const Scalar lambda_min = eig.eigenvalues()(0);
+      results[l].lambda_min = lambda_min;
+
+      if (lambda_min >= -options_.min_eig_num_tol) {
+        results[l].status = GlobalOpt;
+        finished[l] = true;
+        continue;
+      }
+
+      if (r == options_.rmax) {
+        results[l].status = MaxRank;
+        finished[l] = true;
+        continue;
+      }
+
+      // Escape from the saddle point along the direction of negative
+      // curvature Ydot = e_{r+1} * v' (cf. escape_saddle())
+      Matrix Y_augmented = Matrix::Zero(r + 1, N_);
+      Y_augmented.topRows(r) = Yl;
+      Matrix Ydot = Matrix::Zero(r + 1, N_);
+      Ydot.bottomRows<1>() = eig.eigenvectors().col(0).transpose();
+
+      const Scalar alpha_min = 1e-6;
+      for (Scalar a = std::max(16 * alpha_min,
+                               10 * options_.grad_norm_tol / fabs(lambda_min));
+           a >= alpha_min; a /= 2) {
+        Matrix Ytest = Y_augmented + a * Ydot;
+        orthonormalize_blocks(Ytest);
+        if ((Ytest * Q).cwiseProduct(Ytest).sum() < F(l)) {
+          Yplus[l] = Ytest;
+          break;
+        }
+      }
+
+      if (Yplus[l].size() == 0) {
+        results[l].status = SaddlePoint;
+        finished[l] = true;
+      }
+    }
+
+    if (std::all_of(finished.begin(), finished.end(),
+                    [](bool f) { return f; }))
+      break;
+
+    /// Ascend to the next level of the Staircase:  the rank-r iterates are
+    /// embedded by appending a row of zeros, except in lanes that escaped a
+    /// saddle point
+    LaneArray Ynext = LaneArray::Zero((r + 1) * N_, L_);
+    Ynext.topRows(r * N_) = Y;
+    for (size_t l = 0; l < L_; ++l)
+      if (Yplus[l].size() != 0)
+        set_lane(Ynext, l, Yplus[l]);
+    Y.swap(Ynext);
+    ++r;
+  }
+
+  /// ROUNDING
+
+  for (size_t l = 0; l < L_; ++l) {
+    SESyncBatchResult &result = results[l];
+    const Matrix Q = data_matrix(l);
+
+    const Matrix R = round_rotations(result.Yopt);
+    result.xhat.resize(d_, n_ * (d_ + 1));
+    result.xhat.leftCols(n_) = R * T_[l];
+    result.xhat.rightCols(N_) = R;
+
+    result.Fxhat = (R * Q).cwiseProduct(R).sum();
+
+    // Since tr(Lambda) = F(Yopt), the suboptimality bound F(xhat) - tr(Lambda)
+    // is simply the gap between the rounded and relaxed objective values
+    result.suboptimality_bound = result.Fxhat - result.SDPval;
+  }
+
+  return results;
+}
+
+} // namespace SESync
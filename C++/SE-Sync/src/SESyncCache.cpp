@@ -0,0 +1,426 @@
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#include "SESync/SESyncAutotuner.h"
+#include "SESync/SESyncCache.h"
+#include "SESync/SESync_utils.h"
+
+namespace SESync {
+
+/** Magic number and format version identifying persisted cache entries */
+static const uint64_t cache_file_magic =
+    0x4552434e59534553ULL; // "SESYNCRE" on little-endian hosts
+static const uint32_t cache_file_version = 3;
+
+/** Quantized measurement values must be strictly less than this in magnitude
+ * (2^62) in order to be safely rounded to an int64_t */
+static const Scalar max_quantized_value = 4611686018427387904.0;
+
+/** Helper class: incremental 64-bit FNV-1a hash */
+class FNV1aHash {
+private:
+  uint64_t h_ = 0xcbf29ce484222325ULL;
+
+public:
+  template <typename T> void add(const T &value) {
+    const unsigned char *bytes = reinterpret_cast<const unsigned char *>(&value);
+    for (size_t k = 0; k < sizeof(T); ++k) {
+      h_ ^= bytes[k];
+      h_ *= 0x100000001b3ULL;
+    }
+  }
+
+  uint64_t value() const { return h_; }
+};
+
+/** Helper functions:  write / read every field of an SESyncResult */
+static void write_result(std::ostream &out, const SESyncResult &result) {
+  write_binary<uint32_t>(out, static_cast<uint32_t>(result.status));
+  write_binary(out, result.Yopt);
+  write_binary(out, result.SDPval);
+  write_binary(out, result.gradnorm);
+  write_binary(out, result.Lambda);
+  write_binary(out, result.trLambda);
+  write_binary(out, result.duality_gap);
+  write_binary(out, result.Fxhat);
+  write_binary(out, result.xhat);
+  write_binary(out, result.pose_ids);
+  write_binary<uint64_t>(out, result.estimated_memory_bytes);
+  write_binary(out, result.memory_governor_decisions);
+  write_binary<uint8_t>(out, result.direct_verification);
+  write_binary(out, result.suboptimality_bound);
+  write_binary(out, result.total_computation_time);
+  write_binary(out, result.initialization_time);
+  write_binary(out, result.function_values);
+  write_binary(out, result.gradient_norms);
+  write_binary(out, result.preconditioned_gradient_norms);
+  write_binary(out, result.Hessian_vector_products);
+  write_binary(out, result.recycling_Hessian_vector_products);
+  write_binary(out, result.update_step_norms);
+  write_binary(out, result.update_step_M_norms);
+  write_binary(out, result.gain_ratios);
+  write_binary(out, result.elapsed_optimization_times);
+  std::vector<uint32_t> local_solvers;
+  for (LocalSolver solver : result.local_solvers)
+    local_solvers.push_back(static_cast<uint32_t>(solver));
+  write_binary(out, local_solvers);
+  write_binary(out, result.rejected_steps);
+  write_binary(out, result.trust_region_radius);
+  write_binary(out, result.escape_direction_curvatures);
+  write_binary(out, result.LOBPCG_iters);
+  write_binary(out, result.verification_times);
+  write_binary(out, result.iterates);
+}
+
+static void read_result(std::istream &in, SESyncResult &result) {
+  uint32_t status;
+  read_binary(in, status);
+  result.status = static_cast<SESyncStatus>(status);
+  read_binary(in, result.Yopt);
+  read_binary(in, result.SDPval);
+  read_binary(in, result.gradnorm);
+  read_binary(in, result.Lambda);
+  read_binary(in, result.trLambda);
+  read_binary(in, result.duality_gap);
+  read_binary(in, result.Fxhat);
+  read_binary(in, result.xhat);
+  read_binary(in, result.pose_ids);
+  uint64_t estimated_memory_bytes;
+  read_binary(in, estimated_memory_bytes);
+  result.estimated_memory_bytes = estimated_memory_bytes;
+  read_binary(in, result.memory_governor_decisions);
+  uint8_t direct_verification;
+  read_binary(in, direct_verification);
+  result.direct_verification = direct_verification;
+  read_binary(in, result.suboptimality_bound);
+  read_binary(in, result.total_computation_time);
+  read_binary(in, result.initialization_time);
+  read_binary(in, result.function_values);
+  read_binary(in, result.gradient_norms);
+  read_binary(in, result.preconditioned_gradient_norms);
+  read_binary(in, result.Hessian_vector_products);
+  read_binary(in, result.recycling_Hessian_vector_products);
+  read_binary(in, result.update_step_norms);
+  read_binary(in, result.update_step_M_norms);
+  read_binary(in, result.gain_ratios);
+  read_binary(in, result.elapsed_optimization_times);
+  std::vector<uint32_t> local_solvers;
+  read_binary(in, local_solvers);
+  result.local_solvers.clear();
+  for (uint32_t solver : local_solvers)
+    result.local_solvers.push_back(static_cast<LocalSolver>(solver));
+  read_binary(in, result.rejected_steps);
+  read_binary(in, result.trust_region_radius);
+  read_binary(in, result.escape_direction_curvatures);
+  read_binary(in, result.LOBPCG_iters);
+  read_binary(in, result.verification_times);
+  read_binary(in, result.iterates);
+}
+
+SESyncCache::SESyncCache(const SESyncCacheOpts &opts) : opts_(opts) {
+  if (opts_.quantization <= 0)
+    throw std::invalid_argument("Cache quantization must be a positive value");
+
+  if (!opts_.directory.empty())
+    std::filesystem::create_directories(opts_.directory);
+}
+
+uint64_t
+SESyncCache::edge_key(const RelativePoseMeasurement &measurement) const {
+  FNV1aHash h;
+  auto add_quantized = [&h, this](Scalar v) {
+    // Values whose quantized representation does not fit in an int64_t
+    // (including infinities and NaNs) are hashed exactly, via their raw bits;
+    // a tag distinguishes these from quantized values
+    const Scalar q = v / opts_.quantization;
+    if (std::fabs(q) < max_quantized_value) {
+      h.add<uint8_t>(0);
+      h.add<int64_t>(std::llround(q));
+    } else {
+      h.add<uint8_t>(1);
+      h.add<Scalar>(v);
+    }
+  };
+
+  h.add<uint64_t>(measurement.i);
+  h.add<uint64_t>(measurement.j);
+  for (Eigen::Index k = 0; k < measurement.R.size(); ++k)
+    add_quantized(measurement.R.data()[k]);
+  for (Eigen::Index k = 0; k < measurement.t.size(); ++k)
+    add_quantized(measurement.t(k));
+  add_quantized(measurement.kappa);
+  add_quantized(measurement.tau);
+
+  return h.value();
+}
+
+uint64_t SESyncCache::options_key(const SESyncOpts &options) {
+  FNV1aHash h;
+
+  // Stopping criteria
+  h.add(options.grad_norm_tol);
+  h.add(options.preconditioned_grad_norm_tol);
+  h.add(options.rel_func_decrease_tol);
+  h.add(options.stepsize_tol);
+  h.add<uint64_t>(options.max_iterations);
+  h.add<uint64_t>(options.max_tCG_iterations);
+  h.add(options.STPCG_kappa);
+  h.add(options.STPCG_theta);
+
+  // Local solver(s)
+  h.add<uint32_t>(static_cast<uint32_t>(options.local_solver));
+  h.add<uint64_t>(options.local_solver_schedule.size());
+  for (LocalSolver solver : options.local_solver_schedule)
+    h.add<uint32_t>(static_cast<uint32_t>(solver));
+
+  // Riemannian Staircase and verification
+  h.add<uint64_t>(options.r0);
+  h.add<uint64_t>(options.rmax);
+  h.add<uint8_t>(options.reduce_rank);
+  h.add(options.rank_tol);
+  h.add(options.min_eig_num_tol);
+
+  // Initialization
+  h.add<uint32_t>(static_cast<uint32_t>(options.initialization));
+  h.add<uint64_t>(options.random_seed);
+  h.add<uint64_t>(options.initial_estimate.rows());
+  h.add<uint64_t>(options.initial_estimate.cols());
+  for (Eigen::Index k = 0; k < options.initial_estimate.size(); ++k)
+    h.add(options.initial_estimate.data()[k]);
+
+  return h.value();
+}
+
+size_t SESyncCache::edit_distance(const std::vector<uint64_t> &a,
+                                  const std::vector<uint64_t> &b) {
+  // Since a and b are sorted, we can compute the size of their (multiset)
+  // intersection with a single merge pass
+  size_t common = 0;
+  auto ia = a.begin();
+  auto ib = b.begin();
+  while (ia != a.end() && ib != b.end()) {
+    if (*ia < *ib)
+      ++ia;
+    else if (*ib < *ia)
+      ++ib;
+    else {
+      ++common;
+      ++ia;
+      ++ib;
+    }
+  }
+  return (a.size() - common) + (b.size() - common);
+}
+
+void SESyncCache::insert(Entry &&entry) {
+  auto it = index_.find(entry.key);
+  if (it != index_.end()) {
+    entries_.erase(it->second);
+    index_.erase(it);
+  }
+
+  entries_.push_front(std::move(entry));
+  index_[entries_.front().key] = entries_.begin();
+
+  while (entries_.size() > opts_.max_memory_entries) {
+    index_.erase(entries_.back().key);
+    entries_.pop_back();
+  }
+}
+
+std::string SESyncCache::entry_path(uint64_t key) const {
+  std::stringstream name;
+  name << std::hex << std::setw(16) << std::setfill('0') << key << ".sesync";
+  return (std::filesystem::path(opts_.directory) / name.str()).string();
+}
+
+void SESyncCache::write_entry(const Entry &entry) const {
+  std::ofstream out(entry_path(entry.key), std::ios::binary | std::ios::trunc);
+  if (!out)
+    return; // Persistence is best-effort
+
+  write_binary(out, cache_file_magic);
+  write_binary(out, cache_file_version);
+  write_binary(out, entry.key);
+  write_binary<uint64_t>(out, entry.n);
+  write_binary<uint64_t>(out, entry.d);
+  write_binary<uint32_t>(out, static_cast<uint32_t>(entry.formulation));
+
+  write_binary(out, entry.edge_keys);
+
+  write_result(out, entry.result);
+}
+
+bool SESyncCache::read_entry(uint64_t key, Entry &entry) const {
+  std::string path = entry_path(key);
+  std::ifstream in(path, std::ios::binary);
+  if (!in)
+    return false;
+
+  try {
+    uint64_t magic, n, d;
+    uint32_t version, formulation;
+    read_binary(in, magic);
+    read_binary(in, version);
+    if (magic != cache_file_magic || version != cache_file_version)
+      return false;
+
+    read_binary(in, entry.key);
+    if (entry.key != key)
+      return false;
+
+    read_binary(in, n);
+    read_binary(in, d);
+    read_binary(in, formulation);
+    entry.n = n;
+    entry.d = d;
+    entry.formulation = static_cast<Formulation>(formulation);
+
+    read_binary(in, entry.edge_keys);
+
+    read_result(in, entry.result);
+  } catch (const std::runtime_error &) {
+    return false; // Truncated or corrupted entry
+  }
+
+  // Mark this entry as recently used
+  std::error_code ec;
+  std::filesystem::last_write_time(
+      path, std::filesystem::file_time_type::clock::now(), ec);
+
+  return true;
+}
+
+void SESyncCache::prune_directory() const {
+  std::vector<std::pair<std::filesystem::file_time_type, std::string>> files;
+  std::error_code ec;
+  for (const auto &file :
+       std::filesystem::directory_iterator(opts_.directory, ec))
+    if (file.path().extension() == ".sesync")
+      files.emplace_back(file.last_write_time(ec), file.path().string());
+
+  if (files.size() <= opts_.max_disk_entries)
+    return;
+
+  // Remove the least-recently used files
+  std::sort(files.begin(), files.end());
+  for (size_t k = 0; k < files.size() - opts_.max_disk_entries; ++k)
+    std::filesystem::remove(files[k].second, ec);
+}
+
+SESyncResult SESyncCache::solve(const measurements_t &measurements,
+                                const SESyncOpts &requested_options,
+                                SESyncCacheOutcome *outcome) {
+  // Autotune before computing the fingerprint, so that cached solutions are
+  // keyed by the formulation that was actually solved
+  const SESyncOpts options = (requested_options.autotune
+                                  ? autotune(measurements, requested_options)
+                                  : requested_options);
+
+  /// Compute the fingerprint of this problem
+
+  Entry entry;
+  entry.n = 0;
+  entry.d = (!measurements.empty() ? measurements[0].R.rows() : 0);
+  entry.formulation = options.formulation;
+  entry.edge_keys.resize(measurements.size());
+
+#pragma omp parallel for
+  for (size_t e = 0; e < measurements.size(); ++e)
+    entry.edge_keys[e] = edge_key(measurements[e]);
+
+  for (const RelativePoseMeasurement &measurement : measurements)
+    entry.n = std::max<size_t>(entry.n, std::max(measurement.i, measurement.j));
+  entry.n++; // Account for 0-based indexing
+
+  // Sort the edge keys, so that the fingerprint is independent of the order
+  // in which the measurements are listed
+  std::sort(entry.edge_keys.begin(), entry.edge_keys.end());
+
+  FNV1aHash h;
+  h.add<uint64_t>(entry.n);
+  h.add<uint64_t>(entry.d);
+  h.add<uint32_t>(static_cast<uint32_t>(entry.formulation));
+  h.add(options_key(options));
+  for (uint64_t k : entry.edge_keys)
+    h.add(k);
+  entry.key = h.value();
+
+  /// Exact hit (in memory)
+  auto it = index_.find(entry.key);
+  if (it != index_.end()) {
+    entries_.splice(entries_.begin(), entries_, it->second);
+    ++hits_;
+    if (outcome)
+      *outcome = SESyncCacheOutcome::Hit;
+    return entries_.front().result;
+  }
+
+  /// Exact hit (on disk)
+  Entry persisted;
+  if (!opts_.directory.empty() && read_entry(entry.key, persisted)) {
+    insert(std::move(persisted));
+    ++hits_;
+    if (outcome)
+      *outcome = SESyncCacheOutcome::Hit;
+    return entries_.front().result;
+  }
+
+  /// Near hit:  find the closest cached problem defined over the same set of
+  /// poses, if one lies within the maximum admissible edit distance
+  const Entry *nearest = nullptr;
+  size_t nearest_distance = opts_.max_edit_distance + 1;
+  for (const Entry &cached : entries_) {
+    if (cached.n != entry.n || cached.d != entry.d ||
+        cached.formulation != entry.formulation)
+      continue;
+
+    size_t distance = edit_distance(cached.edge_keys, entry.edge_keys);
+    if (distance < nearest_distance) {
+      nearest = &cached;
+      nearest_distance = distance;
+    }
+  }
+
+  SESyncOpts solve_options = options;
+  Matrix Y0;
+  if (nearest) {
+    // Warm-start from the cached solution, at the level of the Riemannian
+    // Staircase at which it was found
+    Y0 = nearest->result.Yopt;
+    solve_options.r0 = std::max<size_t>(Y0.rows(), entry.d);
+    solve_options.rmax = std::max(solve_options.rmax, solve_options.r0);
+    if (solve_options.carry_trust_region_radius)
+      solve_options.initial_trust_region_radius =
+          nearest->result.trust_region_radius;
+    ++near_hits_;
+    if (outcome)
+      *outcome = SESyncCacheOutcome::NearHit;
+  } else {
+    ++misses_;
+    if (outcome)
+      *outcome = SESyncCacheOutcome::Miss;
+  }
+
+  entry.result = SESync(measurements, solve_options, Y0);
+
+  /// Cache the new solution
+  if (!opts_.directory.empty()) {
+    write_entry(entry);
+    prune_directory();
+  }
+  insert(std::move(entry));
+
+  return entries_.front().result;
+}
+
+void SESyncCache::clear() {
+  entries_.clear();
+  index_.clear();
+}
+
+} // namespace SESync
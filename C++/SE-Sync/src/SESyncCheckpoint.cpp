@@ -0,0 +1,204 @@
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+#include "SESync/SESyncCheckpoint.h"
+#include "SESync/SESync_utils.h"
+
+namespace SESync {
+
+/** Magic number and format version identifying SE-Sync checkpoint files */
+static const uint64_t checkpoint_file_magic =
+    0x4b43434e59534553ULL; // "SESYNCCK" on little-endian hosts
+static const uint32_t checkpoint_file_version = 6;
+
+std::shared_ptr<const SESyncResult>
+checkpoint_result(const SESyncResult &result) {
+  auto recorded = std::make_shared<SESyncResult>();
+  recorded->initialization_time = result.initialization_time;
+  recorded->function_values = result.function_values;
+  recorded->gradient_norms = result.gradient_norms;
+  recorded->preconditioned_gradient_norms =
+      result.preconditioned_gradient_norms;
+  recorded->Hessian_vector_products = result.Hessian_vector_products;
+  recorded->recycling_Hessian_vector_products =
+      result.recycling_Hessian_vector_products;
+  recorded->update_step_norms = result.update_step_norms;
+  recorded->update_step_M_norms = result.update_step_M_norms;
+  recorded->gain_ratios = result.gain_ratios;
+  recorded->elapsed_optimization_times = result.elapsed_optimization_times;
+  recorded->local_solvers = result.local_solvers;
+  recorded->rejected_steps = result.rejected_steps;
+  recorded->trust_region_radius = result.trust_region_radius;
+  recorded->escape_direction_curvatures = result.escape_direction_curvatures;
+  recorded->LOBPCG_iters = result.LOBPCG_iters;
+  recorded->verification_times = result.verification_times;
+  return recorded;
+}
+
+void save_checkpoint(const std::string &filename,
+                     const SESyncCheckpoint &checkpoint) {
+  const std::string tmp_filename = filename + ".tmp";
+
+  {
+    std::ofstream out(tmp_filename, std::ios::binary | std::ios::trunc);
+    if (!out)
+      throw std::runtime_error("Could not open file " + tmp_filename +
+                               " for writing");
+
+    /// Header
+    write_binary(out, checkpoint_file_magic);
+    write_binary(out, checkpoint_file_version);
+    write_binary(out, checkpoint.fingerprint);
+    write_binary<uint32_t>(out, static_cast<uint32_t>(checkpoint.formulation));
+
+    /// Staircase state
+    write_binary<uint64_t>(out, checkpoint.level);
+    write_binary<uint64_t>(out, checkpoint.r);
+    write_binary<uint64_t>(out, checkpoint.TNT_iterations);
+    write_binary(out, checkpoint.trust_region_radius);
+    write_binary(out, checkpoint.elapsed_time);
+    write_binary(out, checkpoint.Y);
+
+    /// Accumulated results
+    const SESyncResult &result =
+        (checkpoint.result ? *checkpoint.result : SESyncResult());
+    write_binary(out, result.initialization_time);
+    write_binary(out, result.function_values);
+    write_binary(out, result.gradient_norms);
+    write_binary(out, result.preconditioned_gradient_norms);
+    write_binary(out, result.Hessian_vector_products);
+    write_binary(out, result.update_step_norms);
+    write_binary(out, result.update_step_M_norms);
+    write_binary(out, result.gain_ratios);
+    write_binary(out, result.elapsed_optimization_times);
+    write_binary(out, result.escape_direction_curvatures);
+    write_binary(out, result.LOBPCG_iters);
+    write_binary(out, result.verification_times);
+    std::vector<uint32_t> local_solvers;
+    for (LocalSolver solver : result.local_solvers)
+      local_solvers.push_back(static_cast<uint32_t>(solver));
+    write_binary(out, local_solvers);
+    write_binary(out, result.rejected_steps);
+    write_binary(out, result.recycling_Hessian_vector_products);
+    write_binary(out, result.trust_region_radius);
+
+    if (!out)
+      throw std::runtime_error("Error writing checkpoint to file " +
+                               tmp_filename);
+  }
+
+  if (std::rename(tmp_filename.c_str(), filename.c_str()) != 0)
+    throw std::runtime_error("Could not rename checkpoint file " +
+                             tmp_filename + " to " + filename);
+}
+
+SESyncCheckpoint load_checkpoint(const std::string &filename) {
+  std::ifstream in(filename, std::ios::binary);
+  if (!in)
+    throw std::runtime_error("Could not open file " + filename +
+                             " for reading");
+
+  SESyncCheckpoint checkpoint;
+
+  /// Header
+  uint64_t magic;
+  uint32_t version, formulation;
+  read_binary(in, magic);
+  read_binary(in, version);
+  if (magic != checkpoint_file_magic || version != checkpoint_file_version)
+    throw std::runtime_error(filename + " is not a valid SE-Sync checkpoint");
+
+  read_binary(in, checkpoint.fingerprint);
+  read_binary(in, formulation);
+  checkpoint.formulation = static_cast<Formulation>(formulation);
+
+  /// Staircase state
+  uint64_t level, r, TNT_iterations;
+  read_binary(in, level);
+  read_binary(in, r);
+  read_binary(in, TNT_iterations);
+  checkpoint.level = level;
+  checkpoint.r = r;
+  checkpoint.TNT_iterations = TNT_iterations;
+  read_binary(in, checkpoint.trust_region_radius);
+  read_binary(in, checkpoint.elapsed_time);
+  read_binary(in, checkpoint.Y);
+  if (static_cast<uint64_t>(checkpoint.Y.rows()) != r)
+    throw std::runtime_error("The iterate in checkpoint " + filename +
+                             " does not have r rows");
+
+  /// Accumulated results
+  auto accumulated = std::make_shared<SESyncResult>();
+  SESyncResult &result = *accumulated;
+  read_binary(in, result.initialization_time);
+  read_binary(in, result.function_values);
+  read_binary(in, result.gradient_norms);
+  read_binary(in, result.preconditioned_gradient_norms);
+  read_binary(in, result.Hessian_vector_products);
+  read_binary(in, result.update_step_norms);
+  read_binary(in, result.update_step_M_norms);
+  read_binary(in, result.gain_ratios);
+  read_binary(in, result.elapsed_optimization_times);
+  read_binary(in, result.escape_direction_curvatures);
+  read_binary(in, result.LOBPCG_iters);
+  read_binary(in, result.verification_times);
+  std::vector<uint32_t> local_solvers;
+  read_binary(in, local_solvers);
+  result.local_solvers.clear();
+  for (uint32_t solver : local_solvers)
+    result.local_solvers.push_back(static_cast<LocalSolver>(solver));
+  read_binary(in, result.rejected_steps);
+  read_binary(in, result.recycling_Hessian_vector_products);
+  read_binary(in, result.trust_region_radius);
+  checkpoint.result = std::move(accumulated);
+
+  return checkpoint;
+}
+
+CheckpointWriter::CheckpointWriter(const std::string &filename)
+    : filename_(filename), worker_(&CheckpointWriter::run, this) {}
+
+void CheckpointWriter::submit(SESyncCheckpoint &&checkpoint) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_ = std::move(checkpoint);
+  }
+  cv_.notify_one();
+}
+
+void CheckpointWriter::run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    cv_.wait(lock, [this] { return done_ || pending_.has_value(); });
+
+    if (pending_) {
+      SESyncCheckpoint checkpoint = std::move(*pending_);
+      pending_.reset();
+
+      // Release the lock while writing, so that the solver can continue to
+      // submit checkpoints
+      lock.unlock();
+      try {
+        save_checkpoint(filename_, checkpoint);
+      } catch (const std::exception &e) {
+        // A failed checkpoint should never abort the solve itself
+        std::cerr << "WARNING: " << e.what() << std::endl;
+      }
+      lock.lock();
+    } else if (done_)
+      return;
+  }
+}
+
+CheckpointWriter::~CheckpointWriter() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    done_ = true;
+  }
+  cv_.notify_one();
+  worker_.join();
+}
+
+} // namespace SESync
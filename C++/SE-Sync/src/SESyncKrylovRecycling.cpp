@@ -0,0 +1,197 @@
+#include <cmath>
+#include <stdexcept>
+
+#include <Eigen/Eigenvalues>
+
+#include "SESync/SESyncKrylovRecycling.h"
+
+namespace SESync {
+
+/** Relative tolerance below which a direction is treated as numerically
+ * linearly dependent upon those preceding it */
+static constexpr Scalar dependence_tol = 1e-8;
+
+/** Relative tolerance below which an eigenvalue of the projected Hessian is
+ * treated as nonpositive */
+static constexpr Scalar curvature_tol = 1e-10;
+
+KrylovRecycler::KrylovRecycler(size_t dimension,
+                               const RiemannianMetric &metric,
+                               const LinearOperator &transport,
+                               size_t capture_dimension)
+    : dimension_(dimension),
+      capture_dimension_(capture_dimension > 0 ? capture_dimension
+                                               : 2 * dimension),
+      metric_(metric), transport_(transport) {
+  if (dimension_ < 1)
+    throw std::invalid_argument(
+        "Dimension of the Krylov recycling space must be a positive integer");
+}
+
+void KrylovRecycler::reset() {
+  W_.clear();
+  HW_.clear();
+  inverse_Ritz_values_.clear();
+  V_.clear();
+  HV_.clear();
+}
+
+void KrylovRecycler::update(const Matrix &Y, const LinearOperator &HessOp,
+                            Matrix &NablaF_Y) {
+  // The recycling space S at the previous iterate is spanned by the previous
+  // deflation space together with the captured Krylov directions
+  std::vector<Matrix> S = std::move(W_), HS = std::move(HW_);
+  for (size_t k = 0; k < V_.size(); ++k) {
+    S.push_back(std::move(V_[k]));
+    HS.push_back(std::move(HV_[k]));
+  }
+  reset();
+
+  const size_t m = S.size();
+  if (m == 0)
+    return;
+
+  /// Rayleigh-Ritz procedure on S
+
+  // Gram matrix G = S^T S and projected Hessian A = S^T H S (the embedded
+  // metric is independent of the base point, so these inner products may be
+  // evaluated at the current iterate)
+  Matrix G(m, m), A(m, m);
+  for (size_t i = 0; i < m; ++i)
+    for (size_t j = 0; j <= i; ++j) {
+      G(i, j) = G(j, i) = metric_(Y, S[i], S[j], NablaF_Y);
+      A(i, j) = A(j, i) = (metric_(Y, S[i], HS[j], NablaF_Y) +
+                           metric_(Y, S[j], HS[i], NablaF_Y)) /
+                          2;
+    }
+
+  // Orthonormalize S (discarding numerically dependent directions) by
+  // computing an eigendecomposition of its Gram matrix
+  Eigen::SelfAdjointEigenSolver<Matrix> G_eig(G);
+  const Scalar G_max = G_eig.eigenvalues().maxCoeff();
+  std::vector<size_t> independent;
+  for (size_t k = 0; k < m; ++k)
+    if (G_eig.eigenvalues()(k) > dependence_tol * dependence_tol * G_max)
+      independent.push_back(k);
+  if (independent.empty())
+    return;
+
+  Matrix Q(m, independent.size());
+  for (size_t k = 0; k < independent.size(); ++k)
+    Q.col(k) = G_eig.eigenvectors().col(independent[k]) /
+               std::sqrt(G_eig.eigenvalues()(independent[k]));
+
+  // Ritz values are returned in increasing order
+  Eigen::SelfAdjointEigenSolver<Matrix> A_eig(Q.transpose() * A * Q);
+  const Matrix C = Q * A_eig.eigenvectors();
+
+  /// Transport the Ritz vectors with the smallest positive Ritz values to the
+  /// tangent space at Y, and orthonormalize them there
+
+  std::vector<Matrix> W;
+  for (size_t k = 0; k < static_cast<size_t>(C.cols()) && W.size() < dimension_;
+       ++k) {
+    if (A_eig.eigenvalues()(k) <= 0)
+      continue;
+
+    Matrix y = C(0, k) * S[0];
+    for (size_t j = 1; j < m; ++j)
+      y += C(j, k) * S[j];
+    Matrix w = transport_(Y, y, NablaF_Y);
+
+    // Modified Gram-Schmidt
+    const Scalar w_norm = std::sqrt(metric_(Y, w, w, NablaF_Y));
+    for (const Matrix &u : W)
+      w -= metric_(Y, u, w, NablaF_Y) * u;
+    const Scalar w_perp_norm = std::sqrt(metric_(Y, w, w, NablaF_Y));
+    if (w_perp_norm <= dependence_tol * w_norm)
+      continue;
+    W.push_back(w / w_perp_norm);
+  }
+  if (W.empty())
+    return;
+
+  /// Project the Hessian at Y onto the transported deflation space
+
+  const size_t k = W.size();
+  std::vector<Matrix> HW;
+  HW.reserve(k);
+  for (const Matrix &w : W)
+    HW.push_back(HessOp(Y, w, NablaF_Y));
+  Hessian_vector_products_ += k;
+
+  Matrix B(k, k);
+  for (size_t i = 0; i < k; ++i)
+    for (size_t j = 0; j <= i; ++j)
+      B(i, j) = B(j, i) = (metric_(Y, W[i], HW[j], NablaF_Y) +
+                           metric_(Y, W[j], HW[i], NablaF_Y)) /
+                          2;
+
+  // Diagonalize W^T H W, and retain only its directions of (sufficiently)
+  // positive curvature, so that the coarse-space correction is positive
+  // semidefinite
+  Eigen::SelfAdjointEigenSolver<Matrix> B_eig(B);
+  const Scalar B_max = B_eig.eigenvalues().maxCoeff();
+  if (B_max <= 0)
+    return;
+
+  for (size_t i = 0; i < k; ++i) {
+    const Scalar lambda = B_eig.eigenvalues()(i);
+    if (lambda <= curvature_tol * B_max)
+      continue;
+
+    Matrix z = B_eig.eigenvectors()(0, i) * W[0];
+    Matrix Hz = B_eig.eigenvectors()(0, i) * HW[0];
+    for (size_t j = 1; j < k; ++j) {
+      z += B_eig.eigenvectors()(j, i) * W[j];
+      Hz += B_eig.eigenvectors()(j, i) * HW[j];
+    }
+    W_.push_back(std::move(z));
+    HW_.push_back(std::move(Hz));
+    inverse_Ritz_values_.push_back(1 / lambda);
+  }
+}
+
+Matrix KrylovRecycler::coarse_correction(const Matrix &Y, const Matrix &V,
+                                         Matrix &NablaF_Y) const {
+  Matrix P = Matrix::Zero(V.rows(), V.cols());
+  for (size_t i = 0; i < W_.size(); ++i)
+    P += (inverse_Ritz_values_[i] * metric_(Y, W_[i], V, NablaF_Y)) * W_[i];
+  return P;
+}
+
+KrylovRecycler::QuadraticModel
+KrylovRecycler::quadratic_model(const QuadraticModel &QM) {
+  return [this, QM](const Matrix &Y, Matrix &grad, LinearOperator &HessOp,
+                    Matrix &NablaF_Y) {
+    QM(Y, grad, HessOp, NablaF_Y);
+
+    // This is a new iterate: recycle the Krylov information gathered at the
+    // previous one
+    update(Y, HessOp, NablaF_Y);
+
+    // Record the first few Krylov directions on which tCG applies the Hessian
+    // at this iterate
+    HessOp = [this, H = HessOp](const Matrix &Y, const Matrix &V,
+                                Matrix &NablaF_Y) {
+      Matrix HV = H(Y, V, NablaF_Y);
+      if (V_.size() < capture_dimension_) {
+        V_.push_back(V);
+        HV_.push_back(HV);
+      }
+      return HV;
+    };
+  };
+}
+
+KrylovRecycler::LinearOperator
+KrylovRecycler::preconditioner(const std::optional<LinearOperator> &precon) {
+  return [this, precon](const Matrix &Y, const Matrix &V, Matrix &NablaF_Y) {
+    Matrix PV = (precon ? (*precon)(Y, V, NablaF_Y) : V);
+    if (!W_.empty())
+      PV += coarse_correction(Y, V, NablaF_Y);
+    return PV;
+  };
+}
+
+} // namespace SESync
@@ -0,0 +1,294 @@
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#include "Optimization/Util/Stopwatch.h"
+
+#include "SESync/SESyncLBFGS.h"
+
+namespace SESync {
+
+using Optimization::Riemannian::LinearOperator;
+using Optimization::Riemannian::TNTStatus;
+
+LBFGSResult RiemannianLBFGS(
+    const Optimization::Objective<Matrix, Scalar, Matrix> &f,
+    const Optimization::Riemannian::QuadraticModel<Matrix, Matrix, Matrix> &QM,
+    const Optimization::Riemannian::RiemannianMetric<Matrix, Matrix, Scalar,
+                                                     Matrix> &metric,
+    const Optimization::Riemannian::Retraction<Matrix, Matrix, Matrix>
+        &retract,
+    const LinearOperator<Matrix, Matrix, Matrix> &transport, const Matrix &x0,
+    Matrix &NablaF_x,
+    const std::optional<LinearOperator<Matrix, Matrix, Matrix>> &precon,
+    const LBFGSParams &params,
+    const std::optional<SESyncTNTUserFunction> &user_function) {
+
+  /// Argument checking
+
+  if (params.memory < 1)
+    throw std::invalid_argument("L-BFGS memory must be a positive integer");
+
+  if (params.armijo_c1 <= 0 || params.armijo_c1 >= 1)
+    throw std::invalid_argument(
+        "Armijo sufficient-decrease parameter must be in the range (0, 1)");
+
+  auto start_time = Stopwatch::tick();
+
+  LBFGSResult result;
+  result.status = TNTStatus::IterationLimit;
+
+  /// Algorithm data
+
+  // Current iterate, its gradient, and the Hessian operator at that point
+  Matrix x = x0;
+  Matrix grad;
+  LinearOperator<Matrix, Matrix, Matrix> HessOp;
+
+  // Proposed iterate and the corresponding quantities
+  Matrix x_proposed, grad_proposed, NablaF_x_proposed;
+  LinearOperator<Matrix, Matrix, Matrix> HessOp_proposed;
+
+  // Curvature pairs (s_k, y_k) and the corresponding scalars
+  // rho_k = 1 / <s_k, y_k>, ordered from oldest to newest
+  std::deque<Matrix> S, Y;
+  std::deque<Scalar> rho;
+
+  // Helper function: the norm of a tangent vector at x
+  auto norm = [&](const Matrix &V) { return sqrt(metric(x, V, V, NablaF_x)); };
+
+  // Helper function: apply the initial inverse Hessian approximation H0 to a
+  // tangent vector at x
+  auto apply_H0 = [&](const Matrix &V) -> Matrix {
+    if (precon)
+      return (*precon)(x, V, NablaF_x);
+
+    // In the absence of a preconditioner, we use the usual scaling
+    // gamma = <s, y> / <y, y> determined by the most recent curvature pair
+    if (S.empty())
+      return V;
+    return (metric(x, S.back(), Y.back(), NablaF_x) /
+            metric(x, Y.back(), Y.back(), NablaF_x)) *
+           V;
+  };
+
+  /// Initialization
+
+  Scalar fx = f(x, NablaF_x);
+  QM(x, grad, HessOp, NablaF_x);
+  Scalar grad_norm = norm(grad);
+
+  Matrix precon_grad = (precon ? (*precon)(x, grad, NablaF_x) : grad);
+  Scalar precon_grad_norm = norm(precon_grad);
+
+  result.objective_values.push_back(fx);
+  result.time.push_back(Stopwatch::tock(start_time));
+  result.gradient_norms.push_back(grad_norm);
+  result.preconditioned_gradient_norms.push_back(precon_grad_norm);
+  if (params.log_iterates)
+    result.iterates.push_back(x);
+
+  if (params.verbose)
+    std::cout << "Riemannian L-BFGS optimization (memory " << params.memory
+              << "):" << std::endl;
+
+  size_t iteration = 0;
+  for (iteration = 0; iteration < params.max_iterations; ++iteration) {
+    /// Test stopping criteria
+
+    if (Stopwatch::tock(start_time) > params.max_computation_time) {
+      result.status = TNTStatus::ElapsedTime;
+      break;
+    }
+
+    if (grad_norm < params.gradient_tolerance) {
+      result.status = TNTStatus::Gradient;
+      break;
+    }
+
+    if (precon_grad_norm < params.preconditioned_gradient_tolerance) {
+      result.status = TNTStatus::PreconditionedGradient;
+      break;
+    }
+
+    /// Compute search direction via the two-loop recursion
+
+    Matrix p;
+    if (S.empty()) {
+      // H0 * grad has already been computed
+      p = (precon ? precon_grad : grad);
+    } else {
+      std::vector<Scalar> alpha(S.size());
+      Matrix q = grad;
+      for (size_t k = S.size(); k-- > 0;) {
+        alpha[k] = rho[k] * metric(x, S[k], q, NablaF_x);
+        q -= alpha[k] * Y[k];
+      }
+      p = apply_H0(q);
+      for (size_t k = 0; k < S.size(); ++k) {
+        Scalar beta = rho[k] * metric(x, Y[k], p, NablaF_x);
+        p += (alpha[k] - beta) * S[k];
+      }
+    }
+    p *= -1;
+
+    // Directional derivative of f along p
+    Scalar df_p = metric(x, grad, p, NablaF_x);
+
+    // Guard against a loss of positive-definiteness in the inverse Hessian
+    // approximation (due e.g. to roundoff): if p is not a descent direction,
+    // discard the curvature information and restart
+    if (!(df_p < 0) && !S.empty()) {
+      S.clear();
+      Y.clear();
+      rho.clear();
+      p = -(precon ? precon_grad : grad);
+      df_p = metric(x, grad, p, NablaF_x);
+    }
+
+    /// Backtracking line search
+
+    // In the absence of any curvature information, limit the length of the
+    // initial trial step
+    Scalar stepsize =
+        (S.empty() && !precon ? std::min<Scalar>(1, 1 / grad_norm) : 1);
+
+    Scalar f_proposed = fx;
+    bool sufficient_decrease = false;
+    for (size_t k = 0; k <= params.max_backtracks; ++k) {
+      x_proposed = retract(x, stepsize * p, NablaF_x);
+      f_proposed = f(x_proposed, NablaF_x_proposed);
+      if (f_proposed <= fx + params.armijo_c1 * stepsize * df_p) {
+        sufficient_decrease = true;
+        break;
+      }
+      stepsize /= 2;
+    }
+
+    if (!sufficient_decrease) {
+      if (!S.empty()) {
+        // Retry from a steepest-descent (preconditioned) direction
+        S.clear();
+        Y.clear();
+        rho.clear();
+        continue;
+      }
+
+      // We are unable to make further progress
+      result.status = TNTStatus::Stepsize;
+      break;
+    }
+
+    /// Accept the update step
+
+    Matrix h = stepsize * p;
+    Scalar h_norm = norm(h);
+    Scalar h_M_norm = stepsize * sqrt(-df_p);
+    Scalar df = fx - f_proposed;
+    Scalar gain_ratio = df / (-stepsize * df_p);
+
+    QM(x_proposed, grad_proposed, HessOp_proposed, NablaF_x_proposed);
+
+    // Transport the update step, the old gradient, and the stored curvature
+    // pairs to the tangent space at the new iterate
+    Matrix s = transport(x_proposed, h, NablaF_x_proposed);
+    Matrix y =
+        grad_proposed - transport(x_proposed, grad, NablaF_x_proposed);
+    for (size_t k = 0; k < S.size(); ++k) {
+      S[k] = transport(x_proposed, S[k], NablaF_x_proposed);
+      Y[k] = transport(x_proposed, Y[k], NablaF_x_proposed);
+    }
+
+    Scalar fx_prev = fx;
+    x = std::move(x_proposed);
+    fx = f_proposed;
+    grad = std::move(grad_proposed);
+    NablaF_x = std::move(NablaF_x_proposed);
+    HessOp = std::move(HessOp_proposed);
+    grad_norm = norm(grad);
+    precon_grad = (precon ? (*precon)(x, grad, NablaF_x) : grad);
+    precon_grad_norm = norm(precon_grad);
+
+    // Cautious update: only retain curvature pairs that are sufficiently
+    // positive relative to the current gradient norm
+    Scalar sy = metric(x, s, y, NablaF_x);
+    Scalar ss = metric(x, s, s, NablaF_x);
+    if (sy > 1e-6 * grad_norm * ss) {
+      S.push_back(std::move(s));
+      Y.push_back(std::move(y));
+      rho.push_back(1 / sy);
+      if (S.size() > params.memory) {
+        S.pop_front();
+        Y.pop_front();
+        rho.pop_front();
+      }
+    }
+
+    /// Record output
+    result.objective_values.push_back(fx);
+    result.time.push_back(Stopwatch::tock(start_time));
+    result.gradient_norms.push_back(grad_norm);
+    result.preconditioned_gradient_norms.push_back(precon_grad_norm);
+    result.inner_iterations.push_back(0);
+    result.update_step_norms.push_back(h_norm);
+    result.update_step_M_norms.push_back(h_M_norm);
+    result.gain_ratios.push_back(gain_ratio);
+    if (params.log_iterates)
+      result.iterates.push_back(x);
+
+    if (params.verbose)
+      std::cout << "Iter: " << std::setw(5) << iteration
+                << ". Time: " << std::setw(9) << result.time.back()
+                << ". f: " << std::setw(12) << fx
+                << ". |g|: " << std::setw(12) << grad_norm
+                << ". |h|: " << std::setw(12) << h_norm
+                << ". alpha: " << std::setw(9) << stepsize
+                << ". df: " << std::setw(12) << df << std::endl;
+
+    /// Call user function, if one was provided
+    if (user_function &&
+        (*user_function)(result.time.back(), x, fx, grad, HessOp, stepsize, 0,
+                         h, df, gain_ratio, true, NablaF_x)) {
+      result.status = TNTStatus::UserFunction;
+      ++iteration;
+      break;
+    }
+
+    /// Test remaining stopping criteria
+
+    if (h_norm < params.stepsize_tolerance) {
+      result.status = TNTStatus::Stepsize;
+      ++iteration;
+      break;
+    }
+
+    if (df / std::max<Scalar>(fabs(fx_prev), 1e-16) <
+        params.relative_decrease_tolerance) {
+      result.status = TNTStatus::RelativeDecrease;
+      ++iteration;
+      break;
+    }
+  }
+
+  result.x = std::move(x);
+  result.f = fx;
+  result.grad_f_x_norm = grad_norm;
+  result.preconditioned_grad_f_x_norm = precon_grad_norm;
+  result.elapsed_time = Stopwatch::tock(start_time);
+
+  if (params.verbose)
+    std::cout << std::endl
+              << "Riemannian L-BFGS terminated after " << iteration
+              << " iterations; f(x) = " << result.f
+              << ", |g(x)| = " << result.grad_f_x_norm
+              << ", elapsed time: " << result.elapsed_time << " seconds"
+              << std::endl;
+
+  return result;
+}
+
+} // namespace SESync
@@ -0,0 +1,339 @@
+#include <iomanip>
+#include <sstream>
+
+#include "SESync/SESyncMemoryGovernor.h"
+
+namespace SESync {
+
+/** Memory required to store a single nonzero element of a sparse matrix or
+ * factor (its value and its row index) */
+static constexpr size_t bytes_per_nonzero =
+    sizeof(Scalar) + sizeof(SparseMatrix::StorageIndex);
+
+/** Smallest fill factor to which the governor will reduce the incomplete
+ * LDL^T factorization used to precondition LOBPCG */
+static constexpr Scalar min_LOBPCG_fill_factor = 1;
+
+/** Helper function:  the number of nonzeros in a (symmetric, fully-stored)
+ * matrix with the block sparsity pattern of the pose-graph Laplacian, with
+ * k x k blocks */
+static Scalar block_matrix_nonzeros(const ProblemFeatures &features,
+                                    size_t k) {
+  return static_cast<Scalar>(features.n + 2 * features.m) * k * k;
+}
+
+/** Helper function:  the number of nonzeros in the lower triangle of a matrix
+ * with the block sparsity pattern of the pose-graph Laplacian, with k x k
+ * blocks */
+static Scalar block_lower_triangle_nonzeros(const ProblemFeatures &features,
+                                            size_t k) {
+  return static_cast<Scalar>(features.n + features.m) * k * k;
+}
+
+/** Helper function:  the number of nonzeros in the lower-triangular Cholesky
+ * factor of a matrix with the block sparsity pattern of the pose-graph
+ * Laplacian, with k x k blocks.  Each off-diagonal nonzero of the (scalar)
+ * Laplacian's factor becomes a dense k x k block, and each diagonal element a
+ * dense lower-triangular one. */
+static Scalar block_factor_nonzeros(const ProblemFeatures &features,
+                                    size_t k) {
+  return static_cast<Scalar>(features.factor_nonzeros - features.n) * k * k +
+         static_cast<Scalar>(features.n) * k * (k + 1) / 2;
+}
+
+/** Helper functions:  the memory required to store the passed number of
+ * nonzeros of a sparse matrix, or elements of a dense one */
+static size_t sparse_bytes(Scalar nonzeros) {
+  return static_cast<size_t>(nonzeros) * bytes_per_nonzero;
+}
+
+static size_t dense_bytes(Scalar elements) {
+  return static_cast<size_t>(elements) * sizeof(Scalar);
+}
+
+/** Helper function:  formats a number of bytes for display */
+static std::string format_bytes(size_t bytes) {
+  static const char *units[] = {"B", "KiB", "MiB", "GiB", "TiB"};
+  Scalar value = bytes;
+  size_t u = 0;
+  while (value >= 1024 && u + 1 < sizeof(units) / sizeof(units[0])) {
+    value /= 1024;
+    ++u;
+  }
+
+  std::ostringstream str;
+  str << std::fixed << std::setprecision(u > 0 ? 1 : 0) << value << " "
+      << units[u];
+  return str.str();
+}
+
+MemoryEstimate estimate_memory_usage(const ProblemFeatures &features,
+                                     const SESyncOpts &options) {
+  MemoryEstimate estimate;
+  if (features.n == 0)
+    return estimate;
+
+  const Scalar n = features.n, m = features.m;
+  const size_t d = features.d;
+  const Formulation form = options.formulation;
+
+  /// Data matrices
+
+  // Oriented incidence matrix A and rotational measurement matrix B3
+  Scalar data_nonzeros = 2 * m + (d * d * d + d * d) * m;
+
+  if (form != Formulation::SOSync)
+    // B1, B2, and M
+    data_nonzeros +=
+        2 * d * m + d * d * m + block_matrix_nonzeros(features, d + 1);
+
+  if (form != Formulation::Explicit)
+    // Rotational connection Laplacian LGrho
+    data_nonzeros += block_matrix_nonzeros(features, d);
+
+  if (form == Formulation::Simplified)
+    // Ared * SqrtOmega, SqrtOmega * T, and their transposes
+    data_nonzeros += 2 * (2 * m + d * m);
+
+  estimate.data_matrices = sparse_bytes(data_nonzeros);
+
+  /// Orthogonal projection
+
+  if (form == Formulation::Simplified) {
+    // The reduced Laplacian Ared * Omega * Ared^T
+    const Scalar Laplacian_nonzeros = n + 2 * m;
+
+    if (options.projection_factorization == ProjectionFactorization::QR)
+      // The R factor of Omega^(1/2) * Ared^T has the same pattern as the
+      // Cholesky factor of the reduced Laplacian; the Householder vectors
+      // require at least as much storage again
+      estimate.projection = sparse_bytes(2 * features.factor_nonzeros);
+    else if (options.sparse_solvers.projection == SparseSolverBackend::PCG)
+      // The incomplete Cholesky factor retains the pattern of the lower
+      // triangle of the Laplacian
+      estimate.projection = sparse_bytes(Laplacian_nonzeros + (n + m));
+    else
+      estimate.projection =
+          sparse_bytes(Laplacian_nonzeros + features.factor_nonzeros);
+  }
+
+  /// Preconditioner
+
+  // The preconditioner is built from M for SE-synchronization, and from LGrho
+  // for SO-synchronization
+  const size_t k = (form == Formulation::SOSync ? d : d + 1);
+
+  if (options.preconditioner == Preconditioner::Jacobi)
+    estimate.preconditioner =
+        dense_bytes((form == Formulation::Explicit ? d + 1 : d) * n);
+  else if (options.preconditioner == Preconditioner::RegularizedCholesky) {
+    // The regularized data matrix P = D + lambda * I, and its factor
+    Scalar P_nonzeros = block_matrix_nonzeros(features, k);
+    Scalar factor_nonzeros =
+        (options.sparse_solvers.preconditioner == SparseSolverBackend::PCG
+             ? block_lower_triangle_nonzeros(features, k)
+             : block_factor_nonzeros(features, k));
+    estimate.preconditioner = sparse_bytes(P_nonzeros + factor_nonzeros);
+  }
+
+  /// Initialization
+
+  // Every initialization produces a dense set of pose estimates
+  estimate.initialization = dense_bytes(d * (d + 1) * n);
+
+  if (options.initialization == Initialization::Chordal) {
+    // QR factorization of the reduced measurement matrix B3red (whose R factor
+    // has the block pattern of the Laplacian with d^2 x d^2 blocks), together
+    // with a copy of B3red
+    estimate.initialization +=
+        sparse_bytes(2 * block_factor_nonzeros(features, d * d) +
+                     (d * d * d + d * d) * m);
+
+    if (form == Formulation::Explicit)
+      // QR factorization of the reduced matrix B1red used to recover the
+      // translations
+      estimate.initialization +=
+          sparse_bytes(2 * block_factor_nonzeros(features, d) + 2 * d * m);
+  } else if (options.initialization == Initialization::SpanningTree)
+    // Incidence lists and the priority queue of frontier measurements
+    estimate.initialization +=
+        2 * static_cast<size_t>(m) * sizeof(size_t) +
+        static_cast<size_t>(m) * (sizeof(Scalar) + sizeof(size_t));
+
+  /// Verification
+
+  // The certificate matrix S, the regularized matrix S + eta * I, and (unless
+  // its definiteness is tested iteratively) its Cholesky factor
+  Scalar verification_nonzeros = 2 * block_matrix_nonzeros(features, k);
+  if (options.sparse_solvers.verification != SparseSolverBackend::PCG)
+    verification_nonzeros += block_factor_nonzeros(features, k);
+
+  // The incomplete LDL^T factorization used to precondition LOBPCG is bounded
+  // by the fill factor (relative to the lower triangle of S); this is only
+  // constructed if the cached regularized Cholesky factorization cannot be
+  // reused
+  if (options.LOBPCG_preconditioner == VerificationPreconditioner::ILDL ||
+      options.preconditioner != Preconditioner::RegularizedCholesky)
+    verification_nonzeros += options.LOBPCG_max_fill_factor *
+                             block_lower_triangle_nonzeros(features, k);
+
+  estimate.verification = sparse_bytes(verification_nonzeros);
+
+  return estimate;
+}
+
+SESyncOpts govern_memory(const measurements_t &measurements,
+                         const SESyncOpts &options,
+                         std::vector<std::string> &decisions,
+                         MemoryEstimate &estimate) {
+  SESyncOpts governed = options;
+  const ProblemFeatures features = compute_problem_features(measurements);
+  estimate = estimate_memory_usage(features, governed);
+
+  const size_t budget = options.memory_budget_bytes;
+  if (budget == 0 || features.n == 0)
+    return governed;
+
+  /// Data matrices (these have no lower-memory alternative)
+
+  size_t committed = estimate.data_matrices;
+  if (committed > budget)
+    decisions.push_back("The data matrices alone require an estimated " +
+                        format_bytes(committed) +
+                        ", which exceeds the memory budget of " +
+                        format_bytes(budget));
+
+  /// Orthogonal projection
+
+  if (governed.formulation == Formulation::Simplified &&
+      committed + estimate.projection > budget &&
+      (governed.projection_factorization == ProjectionFactorization::QR ||
+       governed.sparse_solvers.projection != SparseSolverBackend::PCG)) {
+    const size_t direct = estimate.projection;
+
+    governed.projection_factorization = ProjectionFactorization::Cholesky;
+    governed.sparse_solvers.projection = SparseSolverBackend::PCG;
+    estimate = estimate_memory_usage(features, governed);
+
+    decisions.push_back(
+        "Orthogonal projection: the " +
+        std::string(options.projection_factorization ==
+                            ProjectionFactorization::QR
+                        ? "QR"
+                        : "Cholesky") +
+        " factorization requires an estimated " + format_bytes(direct) +
+        "; computing projections iteratively using preconditioned conjugate "
+        "gradients instead (" +
+        format_bytes(estimate.projection) + ")");
+  }
+  committed += estimate.projection;
+
+  /// Preconditioner
+
+  if (governed.preconditioner == Preconditioner::RegularizedCholesky &&
+      committed + estimate.preconditioner > budget) {
+    const size_t factored = estimate.preconditioner;
+
+    governed.preconditioner = Preconditioner::Jacobi;
+    estimate = estimate_memory_usage(features, governed);
+
+    decisions.push_back(
+        "Preconditioner: the regularized Cholesky factorization requires an "
+        "estimated " +
+        format_bytes(factored) + "; using the Jacobi preconditioner instead (" +
+        format_bytes(estimate.preconditioner) + ")");
+  }
+  committed += estimate.preconditioner;
+
+  /// Initialization
+
+  if (governed.initialization == Initialization::Chordal &&
+      committed + estimate.initialization > budget) {
+    const size_t chordal = estimate.initialization;
+
+    governed.initialization = Initialization::SpanningTree;
+    estimate = estimate_memory_usage(features, governed);
+
+    decisions.push_back(
+        "Initialization: the chordal initialization requires an estimated " +
+        format_bytes(chordal) +
+        "; using the spanning-tree initialization instead (" +
+        format_bytes(estimate.initialization) + ")");
+  }
+
+  /// Verification
+
+  // If the direct factorization of the certificate matrix does not fit even
+  // with the smallest admissible LOBPCG preconditioner, its definiteness is
+  // tested using preconditioned LOBPCG alone
+  if (governed.sparse_solvers.verification != SparseSolverBackend::PCG) {
+    SESyncOpts minimal = governed;
+    minimal.LOBPCG_max_fill_factor =
+        std::min<Scalar>(governed.LOBPCG_max_fill_factor,
+                         min_LOBPCG_fill_factor);
+
+    if (committed + estimate_memory_usage(features, minimal).verification >
+        budget) {
+      const size_t direct = estimate.verification;
+
+      governed.sparse_solvers.verification = SparseSolverBackend::PCG;
+      estimate = estimate_memory_usage(features, governed);
+
+      decisions.push_back(
+          "Verification: the direct factorization of the certificate matrix "
+          "requires an estimated " +
+          format_bytes(direct) +
+          "; searching for directions of negative curvature using "
+          "preconditioned LOBPCG alone instead (" +
+          format_bytes(estimate.verification) +
+          "), so solutions cannot be certified globally optimal (their "
+          "status is at best Uncertified)");
+    }
+  }
+
+  if (committed + estimate.verification > budget) {
+    // Reduce the fill of the incomplete LDL^T factorization (if one will be
+    // constructed) as far as necessary to fit within the budget
+    SESyncOpts unfilled = governed;
+    unfilled.LOBPCG_max_fill_factor = 0;
+    const MemoryEstimate without_ILDL_fill =
+        estimate_memory_usage(features, unfilled);
+
+    if (without_ILDL_fill.verification < estimate.verification) {
+      const Scalar ILDL_bytes_per_unit_fill =
+          (estimate.verification - without_ILDL_fill.verification) /
+          governed.LOBPCG_max_fill_factor;
+
+      Scalar fill = min_LOBPCG_fill_factor;
+      if (committed + without_ILDL_fill.verification < budget)
+        fill = std::max<Scalar>(
+            min_LOBPCG_fill_factor,
+            static_cast<Scalar>(budget - committed -
+                                without_ILDL_fill.verification) /
+                ILDL_bytes_per_unit_fill);
+
+      if (fill < governed.LOBPCG_max_fill_factor) {
+        governed.LOBPCG_max_fill_factor = fill;
+        estimate = estimate_memory_usage(features, governed);
+
+        std::ostringstream str;
+        str << "Verification: reduced the maximum fill factor of the LOBPCG "
+               "preconditioner from "
+            << options.LOBPCG_max_fill_factor << " to " << fill;
+        decisions.push_back(str.str());
+      }
+    }
+
+    if (committed + estimate.verification > budget)
+      decisions.push_back(
+          "Verification: the certificate matrix and the LOBPCG preconditioner "
+          "require an estimated " +
+          format_bytes(estimate.verification) +
+          ", which exceeds the remaining memory budget; these have no "
+          "lower-memory alternative, and are retained");
+  }
+
+  return governed;
+}
+
+} // namespace SESync
@@ -0,0 +1,735 @@
+/** This file provides a MEX gateway to the SE-Sync C++ library, for use from
+ * MATLAB or GNU Octave.  It exposes a single function, sesync_mex(command,
+ * ...), supporting the following commands:
+ *
+ * [Yopt, xhat, Lambda, info] = sesync_mex('solve', measurements, opts, Y0)
+ * [Yopt, xhat, Lambda, info] = sesync_mex('solve', handle, opts, Y0)
+ *   Runs SE-Sync on the problem defined by the passed measurements struct (in
+ *   the format returned by load_g2o_data()), or on a previously-constructed
+ *   problem instance.  opts (optional) is a struct whose fields have the same
+ *   names as those of SESyncOpts (enumerated values are passed as strings),
+ *   and Y0 (optional) is an initial iterate.  xhat is a struct with fields t
+ *   (d x n) and R (d x dn), as returned by SE_Sync().
+ *
+ * handle = sesync_mex('create', measurements, opts)
+ *   Constructs an SESyncProblem instance (using the formulation,
+ *   preconditioner, and factorization options in opts), whose operators may
+ *   then be applied using the commands below.  The relaxation rank is set to
+ *   opts.r0.
+ *
+ * sesync_mex('destroy', handle)
+ *   Releases a problem instance.
+ *
+ * sesync_mex('set_relaxation_rank', handle, r)
+ * n = sesync_mex('num_states', handle)
+ * d = sesync_mex('dimension', handle)
+ * r = sesync_mex('relaxation_rank', handle)
+ *
+ * SY = sesync_mex('data_matrix_product', handle, Y)
+ * F = sesync_mex('evaluate_objective', handle, Y)
+ * G = sesync_mex('Euclidean_gradient', handle, Y)
+ * G = sesync_mex('Riemannian_gradient', handle, Y)
+ * H = sesync_mex('Riemannian_Hessian_vector_product', handle, Y, Ydot)
+ * V = sesync_mex('tangent_space_projection', handle, Y, Ydot)
+ * V = sesync_mex('precondition', handle, Y, Ydot)
+ * Y = sesync_mex('retract', handle, Y, Ydot)
+ * Lambda = sesync_mex('compute_Lambda', handle, Y)
+ * xhat = sesync_mex('round_solution', handle, Y)
+ * Y = sesync_mex('chordal_initialization', handle)
+ * Y = sesync_mex('lift_estimate', handle, xhat)
+ * Y = sesync_mex('random_sample', handle, seed)
+ * [PSD, theta, x, iters] = sesync_mex('verify_solution', handle, Y, eta, nx)
+ *
+ * Since Eigen's default (column-major) storage order matches MATLAB's,
+ * measurement and matrix arguments are read in place from MATLAB's buffers,
+ * and each result is written exactly once, directly into a newly-allocated
+ * MATLAB array (Lambda's compressed index arrays are transferred as-is), with
+ * no intermediate conversions or reorderings.  Output written to std::cout
+ * (e.g. when opts.verbose is set) is forwarded to the MATLAB/Octave console.
+ *
+ * Copyright (C) 2016 - 2022 by David M. Rosen (dmrosen@mit.edu)
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+
+#include "mex.h"
+
+#include "SESync/RelativePoseMeasurement.h"
+#include "SESync/SESync.h"
+#include "SESync/SESyncProblem.h"
+#include "SESync/SESync_types.h"
+
+using namespace SESync;
+
+namespace {
+
+typedef Eigen::Map<const Matrix> ConstMatrixMap;
+typedef Eigen::Map<Matrix> MatrixMap;
+
+/// STREAM REDIRECTION
+
+/** A stream buffer that forwards its contents to mexPrintf */
+class MexStreamBuffer : public std::streambuf {
+protected:
+  int overflow(int c) override {
+    if (c != EOF)
+      mexPrintf("%c", c);
+    return c;
+  }
+
+  std::streamsize xsputn(const char *s, std::streamsize n) override {
+    mexPrintf("%.*s", static_cast<int>(n), s);
+    return n;
+  }
+};
+
+/** Redirects std::cout to the MATLAB/Octave console for the lifetime of this
+ * object */
+class ScopedCoutRedirect {
+private:
+  MexStreamBuffer buffer_;
+  std::streambuf *original_;
+
+public:
+  ScopedCoutRedirect() : original_(std::cout.rdbuf(&buffer_)) {}
+  ~ScopedCoutRedirect() { std::cout.rdbuf(original_); }
+};
+
+/// PROBLEM INSTANCES
+
+/** Problem instances constructed by 'create', indexed by their handles */
+std::map<uint64_t, std::shared_ptr<SESyncProblem>> problems;
+uint64_t next_handle = 1;
+
+void release_problems() { problems.clear(); }
+
+SESyncProblem &get_problem(const mxArray *handle) {
+  if (!mxIsUint64(handle) || mxGetNumberOfElements(handle) != 1)
+    throw std::invalid_argument("Invalid SE-Sync problem handle");
+
+  auto it = problems.find(*static_cast<const uint64_t *>(mxGetData(handle)));
+  if (it == problems.end())
+    throw std::invalid_argument("Invalid SE-Sync problem handle");
+
+  return *it->second;
+}
+
+/// INPUT CONVERSION
+
+std::string get_string(const mxArray *array) {
+  if (!mxIsChar(array))
+    throw std::invalid_argument("Expected a string argument");
+
+  char *chars = mxArrayToString(array);
+  std::string str(chars);
+  mxFree(chars);
+  return str;
+}
+
+/** Returns a read-only view of a real, dense, double-precision MATLAB matrix */
+ConstMatrixMap get_matrix(const mxArray *array, const char *name) {
+  if (!mxIsDouble(array) || mxIsComplex(array) || mxIsSparse(array) ||
+      mxGetNumberOfDimensions(array) > 2)
+    throw std::invalid_argument(std::string(name) +
+                                " must be a real, dense double matrix");
+
+  return ConstMatrixMap(mxGetPr(array), mxGetM(array), mxGetN(array));
+}
+
+Scalar get_scalar(const mxArray *array, const char *name) {
+  if (!mxIsNumeric(array) && !mxIsLogical(array))
+    throw std::invalid_argument(std::string(name) + " must be numeric");
+  if (mxGetNumberOfElements(array) != 1)
+    throw std::invalid_argument(std::string(name) + " must be a scalar");
+  return mxGetScalar(array);
+}
+
+/** Returns the kth element of a measurement field, which may be either a cell
+ * array (as returned by load_g2o_data()) or a numeric array whose last
+ * dimension indexes the measurements */
+ConstMatrixMap get_measurement_element(const mxArray *field, size_t k,
+                                       size_t rows, size_t cols,
+                                       const char *name) {
+  if (mxIsCell(field)) {
+    const mxArray *element = mxGetCell(field, k);
+    if (!element)
+      throw std::invalid_argument(std::string("Missing element of ") + name);
+    ConstMatrixMap M = get_matrix(element, name);
+    if (static_cast<size_t>(M.size()) != rows * cols)
+      throw std::invalid_argument(std::string("Element of ") + name +
+                                  " has incorrect dimensions");
+    return ConstMatrixMap(M.data(), rows, cols);
+  }
+
+  if (!mxIsDouble(field) || mxIsComplex(field) || mxIsSparse(field))
+    throw std::invalid_argument(std::string(name) +
+                                " must be a cell array or a double array");
+  if (mxGetNumberOfElements(field) < (k + 1) * rows * cols)
+    throw std::invalid_argument(std::string(name) +
+                                " has incorrect dimensions");
+  return ConstMatrixMap(mxGetPr(field) + k * rows * cols, rows, cols);
+}
+
+const mxArray *get_required_field(const mxArray *s, const char *name) {
+  const mxArray *field = mxGetField(s, 0, name);
+  if (!field)
+    throw std::invalid_argument(std::string("measurements struct must have a "
+                                            "field named '") +
+                                name + "'");
+  return field;
+}
+
+/** The largest integer n such that every integer in [0, n] is exactly
+ * representable as a double (2^53) */
+static constexpr double max_exact_integer = 9007199254740992.0;
+
+/** Converts a measurements struct (with fields edges, R, t, kappa, and tau,
+ * and 1-based pose indices) into a vector of RelativePoseMeasurements */
+measurements_t get_measurements(const mxArray *s) {
+  if (!mxIsStruct(s))
+    throw std::invalid_argument("measurements must be a struct");
+
+  const mxArray *edges = get_required_field(s, "edges");
+  const mxArray *R = get_required_field(s, "R");
+  const mxArray *t = get_required_field(s, "t");
+  const mxArray *kappa = get_required_field(s, "kappa");
+  const mxArray *tau = get_required_field(s, "tau");
+
+  ConstMatrixMap E = get_matrix(edges, "edges");
+  if (E.cols() != 2)
+    throw std::invalid_argument("edges must be an m x 2 matrix");
+  const size_t m = E.rows();
+  if (m == 0)
+    return measurements_t();
+
+  // Determine the dimension of the problem from the first rotation
+  size_t d = (mxIsCell(R) ? mxGetM(mxGetCell(R, 0)) : mxGetM(R));
+  if (d != 2 && d != 3)
+    throw std::invalid_argument("Rotations must be 2 x 2 or 3 x 3 matrices");
+
+  measurements_t measurements(m);
+  for (size_t k = 0; k < m; ++k) {
+    // Reject (rather than truncate) indices that are not integers, or that
+    // are too large to be represented exactly
+    for (size_t c = 0; c < 2; ++c)
+      if (!(E(k, c) >= 1 && E(k, c) <= max_exact_integer) ||
+          E(k, c) != std::floor(E(k, c)))
+        throw std::invalid_argument("Pose indices must be positive integers");
+
+    RelativePoseMeasurement &measurement = measurements[k];
+    // NB: MATLAB uses 1-based indexing
+    measurement.i = static_cast<size_t>(E(k, 0)) - 1;
+    measurement.j = static_cast<size_t>(E(k, 1)) - 1;
+    measurement.R = get_measurement_element(R, k, d, d, "R");
+    measurement.t = get_measurement_element(t, k, d, 1, "t");
+    measurement.kappa = get_measurement_element(kappa, k, 1, 1, "kappa")(0);
+    measurement.tau = get_measurement_element(tau, k, 1, 1, "tau")(0);
+  }
+
+  return measurements;
+}
+
+/** Case-insensitive string comparison */
+bool matches(const std::string &str, const char *value) {
+  return str.size() == strlen(value) &&
+         std::equal(str.begin(), str.end(), value, [](char a, char b) {
+           return std::tolower(a) == std::tolower(b);
+         });
+}
+
+/** Helper macros for reading the fields of an options struct */
+#define READ_OPTION(name)                                                      \
+  if (const mxArray *field = mxGetField(s, 0, #name))                          \
+    opts.name = static_cast<decltype(opts.name)>(get_scalar(field, #name));
+
+#define READ_ENUM_OPTION(name, parse)                                          \
+  if (const mxArray *field = mxGetField(s, 0, #name))                          \
+    opts.name = parse(get_string(field));
+
+Formulation parse_formulation(const std::string &str) {
+  if (matches(str, "Simplified"))
+    return Formulation::Simplified;
+  if (matches(str, "Explicit"))
+    return Formulation::Explicit;
+  if (matches(str, "SOSync"))
+    return Formulation::SOSync;
+  throw std::invalid_argument("Unrecognized formulation: " + str);
+}
+
+Preconditioner parse_preconditioner(const std::string &str) {
+  if (matches(str, "None"))
+    return Preconditioner::None;
+  if (matches(str, "Jacobi"))
+    return Preconditioner::Jacobi;
+  if (matches(str, "RegularizedCholesky"))
+    return Preconditioner::RegularizedCholesky;
+  throw std::invalid_argument("Unrecognized preconditioner: " + str);
+}
+
+ProjectionFactorization parse_projection_factorization(const std::string &str) {
+  if (matches(str, "Cholesky"))
+    return ProjectionFactorization::Cholesky;
+  if (matches(str, "QR"))
+    return ProjectionFactorization::QR;
+  throw std::invalid_argument("Unrecognized projection factorization: " + str);
+}
+
+Initialization parse_initialization(const std::string &str) {
+  if (matches(str, "Chordal"))
+    return Initialization::Chordal;
+  if (matches(str, "Random"))
+    return Initialization::Random;
+  if (matches(str, "FromFile"))
+    return Initialization::FromFile;
+  if (matches(str, "SpanningTree"))
+    return Initialization::SpanningTree;
+  throw std::invalid_argument("Unrecognized initialization: " + str);
+}
+
+LocalSolver parse_local_solver(const std::string &str) {
+  if (matches(str, "TNT"))
+    return LocalSolver::TNT;
+  if (matches(str, "LBFGS"))
+    return LocalSolver::LBFGS;
+  throw std::invalid_argument("Unrecognized local solver: " + str);
+}
+
+VerificationEigensolver parse_eigensolver(const std::string &str) {
+  if (matches(str, "LOBPCG"))
+    return VerificationEigensolver::LOBPCG;
+  if (matches(str, "ChebyshevFilter"))
+    return VerificationEigensolver::ChebyshevFilter;
+  throw std::invalid_argument("Unrecognized eigensolver: " + str);
+}
+
+/** Converts an (optional) options struct into an SESyncOpts instance */
+SESyncOpts get_options(const mxArray *s) {
+  SESyncOpts opts;
+  if (!s || mxIsEmpty(s))
+    return opts;
+  if (!mxIsStruct(s))
+    throw std::invalid_argument("opts must be a struct");
+
+  READ_OPTION(grad_norm_tol);
+  READ_OPTION(preconditioned_grad_norm_tol);
+  READ_OPTION(rel_func_decrease_tol);
+  READ_OPTION(stepsize_tol);
+  READ_OPTION(max_iterations);
+  READ_OPTION(max_tCG_iterations);
+  READ_OPTION(max_computation_time);
+  READ_ENUM_OPTION(local_solver, parse_local_solver);
+  READ_OPTION(LBFGS_memory);
+  READ_OPTION(initial_trust_region_radius);
+  READ_OPTION(carry_trust_region_radius);
+  READ_OPTION(enforce_deadline);
+  READ_OPTION(STPCG_kappa);
+  READ_OPTION(STPCG_theta);
+  READ_OPTION(recycle_Krylov_subspace);
+  READ_OPTION(Krylov_recycling_dimension);
+  READ_ENUM_OPTION(formulation, parse_formulation);
+  READ_OPTION(r0);
+  READ_OPTION(rmax);
+  READ_OPTION(reduce_rank);
+  READ_OPTION(rank_tol);
+  READ_OPTION(min_eig_num_tol);
+  READ_OPTION(LOBPCG_block_size);
+  READ_OPTION(LOBPCG_max_fill_factor);
+  READ_OPTION(LOBPCG_drop_tol);
+  READ_OPTION(LOBPCG_max_iterations);
+  READ_OPTION(LOBPCG_deflation);
+  READ_ENUM_OPTION(certificate_eigensolver, parse_eigensolver);
+  READ_OPTION(Chebyshev_filter_degree);
+  READ_ENUM_OPTION(projection_factorization, parse_projection_factorization);
+  READ_ENUM_OPTION(preconditioner, parse_preconditioner);
+  READ_OPTION(reg_Cholesky_precon_max_condition_number);
+  READ_OPTION(autotune);
+  READ_ENUM_OPTION(autotuning_table, std::string);
+  READ_OPTION(memory_budget_bytes);
+  READ_ENUM_OPTION(initialization, parse_initialization);
+  if (const mxArray *field = mxGetField(s, 0, "initial_estimate"))
+    opts.initial_estimate = get_matrix(field, "initial_estimate");
+  READ_OPTION(random_seed);
+  READ_OPTION(verbose);
+  READ_OPTION(log_iterates);
+  READ_OPTION(num_threads);
+  READ_ENUM_OPTION(checkpoint_file, std::string);
+  READ_OPTION(checkpoint_interval);
+
+  return opts;
+}
+
+#undef READ_OPTION
+#undef READ_ENUM_OPTION
+
+/// OUTPUT CONVERSION
+
+/** Allocates a rows x cols MATLAB matrix, and returns it together with a
+ * writable view of its storage */
+mxArray *create_matrix(size_t rows, size_t cols, double **data) {
+  mxArray *array = mxCreateDoubleMatrix(rows, cols, mxREAL);
+  *data = mxGetPr(array);
+  return array;
+}
+
+template <typename Derived>
+mxArray *to_mxArray(const Eigen::MatrixBase<Derived> &M) {
+  double *data;
+  mxArray *array = create_matrix(M.rows(), M.cols(), &data);
+  MatrixMap(data, M.rows(), M.cols()) = M;
+  return array;
+}
+
+mxArray *to_mxArray(Scalar x) { return mxCreateDoubleScalar(x); }
+
+/** Since Lambda is symmetric, its (row-major) compressed storage is
+ * identical to the (column-major) compressed storage of Lambda^T = Lambda
+ * used by MATLAB, so its index arrays can be transferred directly */
+mxArray *to_mxArray(const SparseMatrix &A) {
+  if (!A.isCompressed()) {
+    SparseMatrix compressed = A;
+    compressed.makeCompressed();
+    return to_mxArray(compressed);
+  }
+
+  mxArray *array = mxCreateSparse(A.rows(), A.cols(), A.nonZeros(), mxREAL);
+  mwIndex *jc = mxGetJc(array);
+  mwIndex *ir = mxGetIr(array);
+  double *pr = mxGetPr(array);
+
+  std::copy(A.outerIndexPtr(), A.outerIndexPtr() + A.outerSize() + 1, jc);
+  std::copy(A.innerIndexPtr(), A.innerIndexPtr() + A.nonZeros(), ir);
+  std::copy(A.valuePtr(), A.valuePtr() + A.nonZeros(), pr);
+  return array;
+}
+
+template <typename T> mxArray *to_mxArray(const std::vector<T> &v) {
+  double *data;
+  mxArray *array = create_matrix(v.size(), 1, &data);
+  std::copy(v.begin(), v.end(), data);
+  return array;
+}
+
+template <typename T>
+mxArray *to_mxArray(const std::vector<std::vector<T>> &v) {
+  mxArray *array = mxCreateCellMatrix(v.size(), 1);
+  for (size_t k = 0; k < v.size(); ++k)
+    mxSetCell(array, k, to_mxArray(v[k]));
+  return array;
+}
+
+mxArray *to_mxArray(const std::vector<std::string> &v) {
+  mxArray *array = mxCreateCellMatrix(v.size(), 1);
+  for (size_t k = 0; k < v.size(); ++k)
+    mxSetCell(array, k, mxCreateString(v[k].c_str()));
+  return array;
+}
+
+/** Splits a rounded solution xhat = [t | R] of a problem with n poses into a
+ * struct with fields t and R, in the format returned by SE_Sync() (t is empty
+ * for the SO-Sync formulation, whose solutions contain only rotations) */
+mxArray *xhat_to_mxArray(const Matrix &xhat, size_t n) {
+  const size_t num_translations = xhat.cols() - xhat.rows() * n;
+
+  const char *fields[] = {"t", "R"};
+  mxArray *s = mxCreateStructMatrix(1, 1, 2, fields);
+  mxSetField(s, 0, "t", to_mxArray(xhat.leftCols(num_translations)));
+  mxSetField(s, 0, "R",
+             to_mxArray(xhat.rightCols(xhat.cols() - num_translations)));
+  return s;
+}
+
+const char *status_name(SESyncStatus status) {
+  switch (status) {
+  case GlobalOpt:
+    return "GlobalOpt";
+  case SaddlePoint:
+    return "SaddlePoint";
+  case EigImprecision:
+    return "EigImprecision";
+  case MaxRank:
+    return "MaxRank";
+  case ElapsedTime:
+    return "ElapsedTime";
+  case Uncertified:
+    return "Uncertified";
+  default:
+    return "Unknown";
+  }
+}
+
+mxArray *info_to_mxArray(const SESyncResult &result) {
+  const char *fields[] = {"SDPval",
+                          "gradnorm",
+                          "trLambda",
+                          "duality_gap",
+                          "Fxhat",
+                          "suboptimality_bound",
+                          "status",
+                          "total_computation_time",
+                          "initialization_time",
+                          "function_values",
+                          "gradient_norms",
+                          "elapsed_optimization_times",
+                          "escape_direction_curvatures",
+                          "LOBPCG_iters",
+                          "verification_times",
+                          "trust_region_radius",
+                          "Hessian_vector_products",
+                          "recycling_Hessian_vector_products",
+                          "pose_ids",
+                          "estimated_memory_bytes",
+                          "memory_governor_decisions",
+                          "direct_verification"};
+  const int num_fields = sizeof(fields) / sizeof(fields[0]);
+  mxArray *s = mxCreateStructMatrix(1, 1, num_fields, fields);
+
+  mxSetField(s, 0, "SDPval", to_mxArray(result.SDPval));
+  mxSetField(s, 0, "gradnorm", to_mxArray(result.gradnorm));
+  mxSetField(s, 0, "trLambda", to_mxArray(result.trLambda));
+  mxSetField(s, 0, "duality_gap", to_mxArray(result.duality_gap));
+  mxSetField(s, 0, "Fxhat", to_mxArray(result.Fxhat));
+  mxSetField(s, 0, "suboptimality_bound",
+             to_mxArray(result.suboptimality_bound));
+  mxSetField(s, 0, "status", mxCreateString(status_name(result.status)));
+  mxSetField(s, 0, "total_computation_time",
+             to_mxArray(result.total_computation_time));
+  mxSetField(s, 0, "initialization_time",
+             to_mxArray(result.initialization_time));
+  mxSetField(s, 0, "function_values", to_mxArray(result.function_values));
+  mxSetField(s, 0, "gradient_norms", to_mxArray(result.gradient_norms));
+  mxSetField(s, 0, "elapsed_optimization_times",
+             to_mxArray(result.elapsed_optimization_times));
+  mxSetField(s, 0, "escape_direction_curvatures",
+             to_mxArray(result.escape_direction_curvatures));
+  mxSetField(s, 0, "LOBPCG_iters", to_mxArray(result.LOBPCG_iters));
+  mxSetField(s, 0, "verification_times", to_mxArray(result.verification_times));
+  mxSetField(s, 0, "trust_region_radius",
+             to_mxArray(result.trust_region_radius));
+  mxSetField(s, 0, "Hessian_vector_products",
+             to_mxArray(result.Hessian_vector_products));
+  mxSetField(s, 0, "recycling_Hessian_vector_products",
+             to_mxArray(result.recycling_Hessian_vector_products));
+
+  // Original (1-based) pose IDs, if the poses were relabeled
+  std::vector<size_t> pose_ids(result.pose_ids);
+  for (size_t &id : pose_ids)
+    ++id;
+  mxSetField(s, 0, "pose_ids", to_mxArray(pose_ids));
+
+  mxSetField(s, 0, "estimated_memory_bytes",
+             to_mxArray(static_cast<Scalar>(result.estimated_memory_bytes)));
+  mxSetField(s, 0, "memory_governor_decisions",
+             to_mxArray(result.memory_governor_decisions));
+  mxSetField(s, 0, "direct_verification",
+             mxCreateLogicalScalar(result.direct_verification));
+  return s;
+}
+
+/// COMMANDS
+
+void check_arguments(int nrhs, int min_args, int max_args,
+                     const std::string &command) {
+  if (nrhs < min_args || nrhs > max_args)
+    throw std::invalid_argument("Wrong number of arguments for command '" +
+                                command + "'");
+}
+
+/** Helper function: returns the pth right-hand side argument, or null if it
+ * was not supplied */
+const mxArray *optional_argument(int nrhs, const mxArray *prhs[], int p) {
+  return (p < nrhs ? prhs[p] : nullptr);
+}
+
+void solve(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]) {
+  check_arguments(nrhs, 2, 4, "solve");
+
+  SESyncOpts opts = get_options(optional_argument(nrhs, prhs, 2));
+
+  const mxArray *Y0_array = optional_argument(nrhs, prhs, 3);
+  Matrix Y0;
+  if (Y0_array && !mxIsEmpty(Y0_array)) {
+    Y0 = get_matrix(Y0_array, "Y0");
+    opts.r0 = Y0.rows();
+    opts.rmax = std::max(opts.rmax, opts.r0);
+  }
+
+  SESyncResult result;
+  size_t n;
+  if (mxIsStruct(prhs[1])) {
+    measurements_t measurements = get_measurements(prhs[1]);
+    if (measurements.empty())
+      throw std::invalid_argument("measurements must be nonempty");
+    result = SESync::SESync(measurements, opts, Y0);
+    n = 0;
+    for (const RelativePoseMeasurement &measurement : measurements)
+      n = std::max(n, std::max(measurement.i, measurement.j) + 1);
+    if (!result.pose_ids.empty())
+      n = result.pose_ids.size();
+  } else {
+    SESyncProblem &problem = get_problem(prhs[1]);
+    result = SESync::SESync(problem, opts, Y0);
+    n = problem.num_states();
+  }
+
+  plhs[0] = to_mxArray(result.Yopt);
+  if (nlhs > 1)
+    plhs[1] = xhat_to_mxArray(result.xhat, n);
+  if (nlhs > 2)
+    plhs[2] = to_mxArray(result.Lambda);
+  if (nlhs > 3)
+    plhs[3] = info_to_mxArray(result);
+}
+
+void create(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]) {
+  check_arguments(nrhs, 2, 3, "create");
+
+  measurements_t measurements = get_measurements(prhs[1]);
+  if (measurements.empty())
+    throw std::invalid_argument("measurements must be nonempty");
+  SESyncOpts opts = get_options(optional_argument(nrhs, prhs, 2));
+
+  // Construct the problem within the memory budget (if any)
+  PreparedProblem prepared = prepare_problem(measurements, opts);
+  std::shared_ptr<SESyncProblem> problem = prepared.problem;
+  problem->set_relaxation_rank(prepared.options.r0);
+
+  uint64_t handle = next_handle++;
+  problems[handle] = std::move(problem);
+
+  plhs[0] = mxCreateNumericMatrix(1, 1, mxUINT64_CLASS, mxREAL);
+  *static_cast<uint64_t *>(mxGetData(plhs[0])) = handle;
+}
+
+void destroy(int nrhs, const mxArray *prhs[]) {
+  check_arguments(nrhs, 2, 2, "destroy");
+  get_problem(prhs[1]);
+  problems.erase(*static_cast<const uint64_t *>(mxGetData(prhs[1])));
+}
+
+/** Dispatches the commands that apply an operator of an existing problem */
+void apply_operator(const std::string &command, int nlhs, mxArray *plhs[],
+                    int nrhs, const mxArray *prhs[]) {
+  SESyncProblem &problem = get_problem(prhs[1]);
+
+  if (command == "set_relaxation_rank") {
+    check_arguments(nrhs, 3, 3, command);
+    problem.set_relaxation_rank(get_scalar(prhs[2], "r"));
+  } else if (command == "num_states") {
+    plhs[0] = to_mxArray(static_cast<Scalar>(problem.num_states()));
+  } else if (command == "dimension") {
+    plhs[0] = to_mxArray(static_cast<Scalar>(problem.dimension()));
+  } else if (command == "relaxation_rank") {
+    plhs[0] = to_mxArray(static_cast<Scalar>(problem.relaxation_rank()));
+  } else if (command == "chordal_initialization") {
+    plhs[0] = to_mxArray(problem.chordal_initialization());
+  } else if (command == "lift_estimate") {
+    check_arguments(nrhs, 3, 3, command);
+    plhs[0] = to_mxArray(problem.lift_estimate(get_matrix(prhs[2], "xhat")));
+  } else if (command == "random_sample") {
+    check_arguments(nrhs, 2, 3, command);
+    uint64_t seed = (nrhs > 2 ? get_scalar(prhs[2], "seed") : 0);
+    plhs[0] = to_mxArray(problem.random_sample(seed));
+  } else {
+    check_arguments(nrhs, 3, 5, command);
+    ConstMatrixMap Y = get_matrix(prhs[2], "Y");
+    if (static_cast<size_t>(Y.rows()) != problem.relaxation_rank())
+      throw std::invalid_argument(
+          "Y must have relaxation_rank rows (cf. 'set_relaxation_rank')");
+
+    if (command == "data_matrix_product")
+      plhs[0] = to_mxArray(problem.data_matrix_product(Y));
+    else if (command == "evaluate_objective")
+      plhs[0] = to_mxArray(problem.evaluate_objective(Y));
+    else if (command == "Euclidean_gradient")
+      plhs[0] = to_mxArray(problem.Euclidean_gradient(Y));
+    else if (command == "Riemannian_gradient")
+      plhs[0] = to_mxArray(problem.Riemannian_gradient(Y));
+    else if (command == "compute_Lambda")
+      plhs[0] = to_mxArray(problem.compute_Lambda(Y));
+    else if (command == "round_solution")
+      plhs[0] =
+          xhat_to_mxArray(problem.round_solution(Y), problem.num_states());
+    else if (command == "verify_solution") {
+      check_arguments(nrhs, 5, 5, command);
+      Scalar theta;
+      Vector x;
+      size_t num_iters;
+      bool PSD = problem.verify_solution(Y, get_scalar(prhs[3], "eta"),
+                                         get_scalar(prhs[4], "nx"), theta, x,
+                                         num_iters);
+      plhs[0] = mxCreateLogicalScalar(PSD);
+      if (nlhs > 1)
+        plhs[1] = to_mxArray(theta);
+      if (nlhs > 2)
+        plhs[2] = to_mxArray(x);
+      if (nlhs > 3)
+        plhs[3] = to_mxArray(static_cast<Scalar>(num_iters));
+    } else {
+      // The remaining operators act upon a tangent vector Ydot at Y
+      check_arguments(nrhs, 4, 4, command);
+      ConstMatrixMap Ydot = get_matrix(prhs[3], "Ydot");
+      if (Ydot.rows() != Y.rows() || Ydot.cols() != Y.cols())
+        throw std::invalid_argument("Y and Ydot must have the same dimensions");
+
+      if (command == "Riemannian_Hessian_vector_product")
+        plhs[0] = to_mxArray(problem.Riemannian_Hessian_vector_product(
+            Y, problem.Euclidean_gradient(Y), Ydot));
+      else if (command == "tangent_space_projection")
+        plhs[0] = to_mxArray(problem.tangent_space_projection(Y, Ydot));
+      else if (command == "precondition")
+        plhs[0] = to_mxArray(problem.precondition(Y, Ydot));
+      else if (command == "retract")
+        plhs[0] = to_mxArray(problem.retract(Y, Ydot));
+      else
+        throw std::invalid_argument("Unrecognized command: " + command);
+    }
+  }
+}
+
+/** Error messages must outlive the C++ scope in which they are raised, since
+ * mexErrMsgIdAndTxt does not return */
+std::string error_message;
+
+} // namespace
+
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]) {
+  mexAtExit(release_problems);
+
+  bool failed = false;
+  try {
+    ScopedCoutRedirect redirect;
+
+    if (nrhs < 1)
+      throw std::invalid_argument("Usage: sesync_mex(command, ...)");
+    const std::string command = get_string(prhs[0]);
+
+    if (command == "solve")
+      solve(nlhs, plhs, nrhs, prhs);
+    else if (command == "create")
+      create(nlhs, plhs, nrhs, prhs);
+    else if (command == "destroy")
+      destroy(nrhs, prhs);
+    else {
+      if (nrhs < 2)
+        throw std::invalid_argument("Command '" + command +
+                                    "' requires a problem handle");
+      apply_operator(command, nlhs, plhs, nrhs, prhs);
+    }
+    std::cout.flush();
+  } catch (const std::exception &e) {
+    error_message = e.what();
+    failed = true;
+  }
+
+  if (failed)
+    mexErrMsgIdAndTxt("SESync:error", "%s", error_message.c_str());
+}
@@ -1,19 +1,51 @@
 #include "SESync/SESyncProblem.h"
+#include "SESync/SESyncProblemT.h"
+#include "SESync/SESync_random.h"
+#include "SESync/SESync_threading.h"
 #include "SESync/SESync_utils.h"
 
 #include "Optimization/LinearAlgebra/LOBPCG.h"
 
-#include <random>
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 namespace SESync {
 
 SESyncProblem::SESyncProblem(
-    const measurements_t &measurements, const Formulation &formulation,
+    const measurements_t &original_measurements,
+    const Formulation &formulation,
     const ProjectionFactorization &projection_factorization,
-    const Preconditioner &precon, Scalar reg_chol_precon_max_cond)
+    const Preconditioner &precon, Scalar reg_chol_precon_max_cond,
+    size_t num_threads, const SparseSolverOpts &sparse_solvers,
+    Scalar max_verification_fill_factor)
     : form_(formulation), projection_factorization_(projection_factorization),
       preconditioner_(precon),
-      reg_Chol_precon_max_cond_(reg_chol_precon_max_cond) {
+      reg_Chol_precon_max_cond_(reg_chol_precon_max_cond),
+      num_threads_(num_threads), sparse_solvers_(sparse_solvers),
+      max_verification_fill_factor_(max_verification_fill_factor) {
+
+  // Record a fingerprint of the measurements defining this problem, so that
+  // persisted copies of it can be validated when they are reloaded
+  fingerprint_ = measurements_fingerprint(original_measurements);
+
+  // If the pose IDs are not contiguous, relabel the poses densely, so that the
+  // data matrices are not sized by the largest ID
+  PoseIDMap pose_id_map;
+  measurements_t compacted;
+  const measurements_t &measurements =
+      compacted_measurements(original_measurements, compacted, pose_id_map);
+  if (!pose_id_map.is_identity())
+    pose_ids_ = std::move(pose_id_map.ids);
 
   /// Construct oriented incidence matrix for the underlying pose graph
   A_ = construct_oriented_incidence_matrix(measurements);
@@ -90,18 +122,7 @@ SESyncProblem::SESyncProblem(
       /// Construct matrices necessary to compute orthogonal projection onto the
       /// kernel of the weighted reduced oriented incidence matrix
       /// Ared_SqrtOmega
-      if (projection_factorization_ == ProjectionFactorization::Cholesky) {
-        // Compute and cache the Cholesky factor L of Ared * Omega * Ared^T
-        L_.compute(Ared_SqrtOmega_ * SqrtOmega_AredT_);
-      } else {
-        // Compute the QR decomposition of Omega^(1/2) * Ared^T (cf. eq. (98) of
-        // the tech report).Note that Eigen's sparse QR factorization can only
-        // be called on matrices stored in compressed format
-        SqrtOmega_AredT_.makeCompressed();
-
-        QR_ = new SparseQRFactorization();
-        QR_->compute(SqrtOmega_AredT_);
-      }
+      factorize_projection();
     } // if (form_ == Formulation::Simplified)
   }   // Auxiliary data matrix construction
 
@@ -158,17 +179,84 @@ SESyncProblem::SESyncProblem(
     Scalar Dnorm = -theta(0);
 
     // Compute the required value of the regularization parameter lambda_reg
-    Scalar lambda_reg = Dnorm / (reg_Chol_precon_max_cond_ - 1);
+    reg_Chol_precon_lambda_ = Dnorm / (reg_Chol_precon_max_cond_ - 1);
 
     /// Construct and factor the regularized data matrix P := D + lambda_reg * I
+    factorize_regularized_Cholesky_preconditioner();
+  } // Preconditioner construction
+}
 
-    // Construct regularized data matrix Mbar
-    SparseMatrix P =
-        D + SparseMatrix(Vector::Constant(D.rows(), lambda_reg).asDiagonal());
+/** Helper function:  factors the symmetric positive-definite matrix A using
+ * the passed backend, and returns the result.  If the incomplete Cholesky
+ * factorization used to precondition the PCG backend breaks down, A is
+ * instead factored directly (using CHOLMOD), and 'backend' is updated
+ * accordingly.  Throws std::runtime_error if a direct factorization fails (so
+ * that A is not numerically positive-definite).  Here 'description' names A
+ * in error messages. */
+static std::unique_ptr<SparseFactorization>
+factor_matrix(const SparseMatrix &A, SparseSolverBackend &backend,
+              const SparseSolverOpts &opts, size_t num_threads,
+              const std::string &description) {
+  std::unique_ptr<SparseFactorization> F =
+      make_sparse_factorization(backend, opts);
+  F->set_num_threads(num_threads);
+  F->compute(A);
+
+  if (!F->success() && backend == SparseSolverBackend::PCG) {
+    backend = SparseSolverBackend::Cholmod;
+    F = make_sparse_factorization(backend, opts);
+    F->set_num_threads(num_threads);
+    F->compute(A);
+  }
 
-    // Compute and cache Cholesky factorization of Mbar
-    reg_Chol_precon_.compute(P);
-  } // Preconditioner construction
+  if (!F->success())
+    throw std::runtime_error("Factorization of the " + description +
+                             " failed: the matrix is not numerically "
+                             "positive-definite");
+  return F;
+}
+
+void SESyncProblem::factorize_projection() {
+  ScopedThreadingPhase threading(ThreadingPhase::Factorization, num_threads_);
+
+  if (projection_factorization_ == ProjectionFactorization::Cholesky) {
+    // Compute and cache the Cholesky factor L of Ared * Omega * Ared^T
+    L_ = factor_matrix(Ared_SqrtOmega_ * SqrtOmega_AredT_,
+                       sparse_solvers_.projection, sparse_solvers_,
+                       num_threads_, "reduced translational Laplacian");
+  } else {
+    // Compute the QR decomposition of Omega^(1/2) * Ared^T (cf. eq. (98) of
+    // the tech report).Note that Eigen's sparse QR factorization can only
+    // be called on matrices stored in compressed format
+    SqrtOmega_AredT_.makeCompressed();
+
+    if (QR_)
+      delete QR_;
+    QR_ = new SparseQRFactorization();
+    configure_cholmod_threads(*QR_->cholmodCommon(), num_threads_);
+    QR_->compute(SqrtOmega_AredT_);
+    if (QR_->info() != Eigen::Success)
+      throw std::runtime_error("QR factorization of the weighted reduced "
+                               "incidence matrix failed");
+  }
+}
+
+void SESyncProblem::factorize_regularized_Cholesky_preconditioner() {
+  ScopedThreadingPhase threading(ThreadingPhase::Factorization, num_threads_);
+
+  // We build the preconditioner from LGrho for SO-synchronization, and from
+  // M for SE-synchronization
+  const SparseMatrix &D = (form_ == Formulation::SOSync ? LGrho_ : M_);
+
+  // Construct regularized data matrix P := D + lambda_reg * I
+  SparseMatrix P =
+      D + SparseMatrix(Vector::Constant(D.rows(), reg_Chol_precon_lambda_)
+                           .asDiagonal());
+
+  // Compute and cache Cholesky factorization of P
+  reg_Chol_precon_ =
+      factor_matrix(P, sparse_solvers_.preconditioner, sparse_solvers_,
+                    num_threads_, "regularized data matrix");
 }
 
 void SESyncProblem::set_relaxation_rank(size_t rank) {
@@ -176,21 +264,449 @@ void SESyncProblem::set_relaxation_rank(size_t rank) {
   SP_.set_p(r_);
 }
 
+/** Magic number and format version identifying SE-Sync problem files */
+static const uint64_t problem_file_magic =
+    0x4250434e59534553ULL; // "SESYNCPB" on little-endian hosts
+static const uint32_t problem_file_version = 3;
+
+/** Size of the header of a problem file (its magic number, version, payload
+ * size and payload checksum), padded so that the payload that follows it
+ * begins at an aligned offset */
+static constexpr size_t problem_file_header_size = binary_alignment;
+
+/** Helper class:  a read-only stream buffer over a block of memory, so that a
+ * (memory-mapped) file can be parsed using the binary stream helpers without
+ * first being copied */
+class MemoryStreamBuffer : public std::streambuf {
+public:
+  MemoryStreamBuffer(const char *data, size_t size) {
+    char *begin = const_cast<char *>(data);
+    setg(begin, begin, begin + size);
+  }
+
+protected:
+  pos_type seekoff(off_type off, std::ios_base::seekdir dir,
+                   std::ios_base::openmode which) override {
+    char *base = (dir == std::ios_base::beg
+                      ? eback()
+                      : (dir == std::ios_base::cur ? gptr() : egptr()));
+    if (off < eback() - base || off > egptr() - base)
+      return pos_type(off_type(-1));
+
+    setg(eback(), base + off, egptr());
+    return pos_type(gptr() - eback());
+  }
+
+  pos_type seekpos(pos_type pos, std::ios_base::openmode which) override {
+    return seekoff(off_type(pos), std::ios_base::beg, which);
+  }
+};
+
+/** Helper class:  the contents of a file, which are memory-mapped where
+ * supported (and otherwise read into memory) */
+class FileContents {
+private:
+  const char *data_ = nullptr;
+  size_t size_ = 0;
+
+  /** The memory mapping of the file (if any) */
+  void *mapping_ = nullptr;
+
+  /** The contents of the file, if it could not be memory-mapped */
+  std::string buffer_;
+
+public:
+  explicit FileContents(const std::string &filename) {
+#if defined(__unix__) || defined(__APPLE__)
+    const int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+      throw std::runtime_error("Could not open file " + filename +
+                               " for reading");
+
+    struct stat status;
+    if (fstat(fd, &status) == 0 && status.st_size > 0) {
+      void *mapping = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE,
+                           fd, 0);
+      if (mapping != MAP_FAILED) {
+        mapping_ = mapping;
+        data_ = static_cast<const char *>(mapping);
+        size_ = status.st_size;
+      }
+    }
+    close(fd);
+
+    if (mapping_)
+      return;
+#endif
+
+    // Fall back to reading the entire file into memory
+    std::ifstream in(filename, std::ios::binary);
+    if (!in)
+      throw std::runtime_error("Could not open file " + filename +
+                               " for reading");
+    buffer_.assign(std::istreambuf_iterator<char>(in),
+                   std::istreambuf_iterator<char>());
+    data_ = buffer_.data();
+    size_ = buffer_.size();
+  }
+
+  ~FileContents() {
+#if defined(__unix__) || defined(__APPLE__)
+    if (mapping_)
+      munmap(mapping_, size_);
+#endif
+  }
+
+  FileContents(const FileContents &) = delete;
+  FileContents &operator=(const FileContents &) = delete;
+
+  const char *data() const { return data_; }
+  size_t size() const { return size_; }
+};
+
+/** Helper function:  write the factorization held by 'factorization' (if it
+ * can be exported in explicit LDL^T form) to out */
+static void write_factor(std::ostream &out,
+                         const SparseFactorization *factorization) {
+  LDLTFactor factor;
+  const bool stored = factorization && factorization->export_factor(factor);
+  write_binary<uint32_t>(out, stored);
+  if (!stored)
+    return;
+
+  write_binary(out, SparseMatrix(factor.L));
+  write_binary(out, Matrix(factor.D));
+  write_binary<uint64_t>(out, factor.permutation.size());
+  for (Eigen::Index k = 0; k < factor.permutation.size(); ++k)
+    write_binary<int32_t>(out, factor.permutation(k));
+}
+
+/** Helper function:  read a factorization written by write_factor() from in,
+ * validating that it factors a matrix of the passed dimension.  Returns null
+ * if no factorization was stored. */
+static std::unique_ptr<SparseFactorization>
+read_factor(std::istream &in, SparseSolverBackend backend, size_t dimension) {
+  uint32_t stored;
+  read_binary(in, stored);
+  if (!stored)
+    return nullptr;
+
+  SparseMatrix L;
+  Matrix D;
+  uint64_t permutation_size;
+  read_binary(in, L);
+  read_binary(in, D);
+  read_binary(in, permutation_size);
+
+  if (static_cast<size_t>(L.rows()) != dimension ||
+      static_cast<size_t>(L.cols()) != dimension ||
+      static_cast<size_t>(D.rows()) != dimension || D.cols() != 1 ||
+      permutation_size != dimension)
+    throw std::runtime_error("Stored factorization has invalid dimensions");
+
+  LDLTFactor factor;
+  factor.L = L;
+  factor.D = D.col(0);
+  factor.permutation.resize(dimension);
+  for (size_t k = 0; k < dimension; ++k) {
+    int32_t index;
+    read_binary(in, index);
+    factor.permutation(k) = index;
+  }
+
+  std::unique_ptr<SparseFactorization> F;
+  try {
+    F = std::make_unique<StoredLDLTFactorization>(std::move(factor), backend);
+  } catch (const std::invalid_argument &e) {
+    throw std::runtime_error(std::string("Invalid stored factorization: ") +
+                             e.what());
+  }
+
+  if (!F->success())
+    throw std::runtime_error(
+        "Invalid stored factorization: D is not positive");
+  return F;
+}
+
+/** Helper function:  throw std::runtime_error unless the matrix S read from a
+ * problem file has the expected dimensions (or is empty, if it is not used by
+ * the stored problem) */
+static void check_dimensions(const SparseMatrix &S, bool used, size_t rows,
+                             size_t cols, const std::string &name) {
+  const bool valid =
+      (used ? (static_cast<size_t>(S.rows()) == rows &&
+               static_cast<size_t>(S.cols()) == cols)
+            : S.size() == 0);
+  if (!valid)
+    throw std::runtime_error("Stored matrix " + name +
+                             " has invalid dimensions");
+}
+
+void SESyncProblem::save(const std::string &filename) const {
+  // The payload is assembled in memory first, so that its checksum can be
+  // recorded in the header
+  std::ostringstream payload(std::ios::binary);
+
+  /// Problem description
+  write_binary(payload, fingerprint_);
+  write_binary<uint32_t>(payload, static_cast<uint32_t>(form_));
+  write_binary<uint32_t>(payload,
+                         static_cast<uint32_t>(projection_factorization_));
+  write_binary<uint32_t>(payload, static_cast<uint32_t>(preconditioner_));
+  write_binary<uint64_t>(payload, n_);
+  write_binary<uint64_t>(payload, m_);
+  write_binary<uint64_t>(payload, d_);
+  write_binary<uint64_t>(payload, r_);
+  write_binary(payload, reg_Chol_precon_max_cond_);
+  write_binary(payload, reg_Chol_precon_lambda_);
+  write_binary(payload, pose_ids_);
+
+  /// Solver settings
+  write_binary<uint64_t>(payload, num_threads_);
+  write_binary<uint32_t>(payload,
+                         static_cast<uint32_t>(sparse_solvers_.projection));
+  write_binary<uint32_t>(payload,
+                         static_cast<uint32_t>(sparse_solvers_.preconditioner));
+  write_binary<uint32_t>(payload,
+                         static_cast<uint32_t>(sparse_solvers_.verification));
+  write_binary(payload, sparse_solvers_.PCG_tolerance);
+  write_binary<uint64_t>(payload, sparse_solvers_.PCG_max_iterations);
+
+  /// Data matrices
+  write_binary(payload, A_);
+  write_binary(payload, B1_);
+  write_binary(payload, B2_);
+  write_binary(payload, B3_);
+  write_binary(payload, M_);
+  write_binary(payload, LGrho_);
+  write_binary(payload, Ared_SqrtOmega_);
+  write_binary(payload, SqrtOmega_AredT_);
+  write_binary(payload, SqrtOmega_T_);
+  write_binary(payload, TT_SqrtOmega_);
+  write_binary(payload, Matrix(Jacobi_precon_.diagonal()));
+
+  /// Cached factorizations
+  write_factor(payload, L_.get());
+  write_factor(payload, reg_Chol_precon_.get());
+
+  if (!payload)
+    throw std::runtime_error("Error serializing problem");
+  const std::string bytes = payload.str();
+
+  std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+  if (!out)
+    throw std::runtime_error("Could not open file " + filename +
+                             " for writing");
+
+  /// Header
+  write_binary(out, problem_file_magic);
+  write_binary(out, problem_file_version);
+  write_binary<uint32_t>(out, 0); // Reserved
+  write_binary<uint64_t>(out, bytes.size());
+  write_binary(out, binary_checksum(bytes.data(), bytes.size()));
+  static const char zeros[problem_file_header_size] = {};
+  out.write(zeros, problem_file_header_size - static_cast<size_t>(out.tellp()));
+
+  out.write(bytes.data(), bytes.size());
+
+  if (!out)
+    throw std::runtime_error("Error writing problem to file " + filename);
+}
+
+void SESyncProblem::load(const std::string &filename) {
+  const FileContents file(filename);
+
+  /// Header
+  if (file.size() < problem_file_header_size)
+    throw std::runtime_error(filename +
+                             " is not a valid SE-Sync problem file");
+
+  MemoryStreamBuffer header_buffer(file.data(), problem_file_header_size);
+  std::istream header(&header_buffer);
+
+  uint64_t magic, payload_size, checksum;
+  uint32_t version, reserved;
+  read_binary(header, magic);
+  read_binary(header, version);
+  read_binary(header, reserved);
+  read_binary(header, payload_size);
+  read_binary(header, checksum);
+
+  if (magic != problem_file_magic || version != problem_file_version)
+    throw std::runtime_error(filename +
+                             " is not a valid SE-Sync problem file");
+
+  const char *payload_data = file.data() + problem_file_header_size;
+  if (payload_size != file.size() - problem_file_header_size ||
+      checksum != binary_checksum(payload_data, payload_size))
+    throw std::runtime_error("SE-Sync problem file " + filename +
+                             " is truncated or corrupt");
+
+  MemoryStreamBuffer payload_buffer(payload_data, payload_size);
+  std::istream in(&payload_buffer);
+
+  /// Problem description
+  uint32_t form, projection_factorization, preconditioner;
+  uint64_t n, m, d, r;
+
+  read_binary(in, fingerprint_);
+  read_binary(in, form);
+  read_binary(in, projection_factorization);
+  read_binary(in, preconditioner);
+  read_binary(in, n);
+  read_binary(in, m);
+  read_binary(in, d);
+  read_binary(in, r);
+  read_binary(in, reg_Chol_precon_max_cond_);
+  read_binary(in, reg_Chol_precon_lambda_);
+  read_binary(in, pose_ids_);
+
+  if (form > static_cast<uint32_t>(Formulation::SOSync) ||
+      projection_factorization >
+          static_cast<uint32_t>(ProjectionFactorization::QR) ||
+      preconditioner >
+          static_cast<uint32_t>(Preconditioner::RegularizedCholesky) ||
+      (m > 0 && (n == 0 || d == 0)) || r < d ||
+      (!pose_ids_.empty() &&
+       (pose_ids_.size() != n ||
+        !std::is_sorted(pose_ids_.begin(), pose_ids_.end()) ||
+        std::adjacent_find(pose_ids_.begin(), pose_ids_.end()) !=
+            pose_ids_.end())))
+    throw std::runtime_error("SE-Sync problem file " + filename +
+                             " contains an invalid problem description");
+
+  form_ = static_cast<Formulation>(form);
+  projection_factorization_ =
+      static_cast<ProjectionFactorization>(projection_factorization);
+  preconditioner_ = static_cast<Preconditioner>(preconditioner);
+  n_ = n;
+  m_ = m;
+  d_ = d;
+
+  /// Solver settings
+  uint64_t num_threads, PCG_max_iterations;
+  uint32_t backends[3];
+  read_binary(in, num_threads);
+  for (uint32_t &backend : backends) {
+    read_binary(in, backend);
+    if (backend > static_cast<uint32_t>(SparseSolverBackend::PCG))
+      throw std::runtime_error("SE-Sync problem file " + filename +
+                               " contains an invalid sparse solver backend");
+  }
+  read_binary(in, sparse_solvers_.PCG_tolerance);
+  read_binary(in, PCG_max_iterations);
+
+  num_threads_ = num_threads;
+  sparse_solvers_.projection = static_cast<SparseSolverBackend>(backends[0]);
+  sparse_solvers_.preconditioner =
+      static_cast<SparseSolverBackend>(backends[1]);
+  sparse_solvers_.verification = static_cast<SparseSolverBackend>(backends[2]);
+  sparse_solvers_.PCG_max_iterations = PCG_max_iterations;
+
+  // The stored backends already reflect any decisions made by the memory
+  // governor before the problem was constructed; the fill cap is not stored
+  max_verification_fill_factor_ = std::numeric_limits<Scalar>::max();
+
+  /// Data matrices
+  read_binary(in, A_);
+  read_binary(in, B1_);
+  read_binary(in, B2_);
+  read_binary(in, B3_);
+  read_binary(in, M_);
+  read_binary(in, LGrho_);
+  read_binary(in, Ared_SqrtOmega_);
+  read_binary(in, SqrtOmega_AredT_);
+  read_binary(in, SqrtOmega_T_);
+  read_binary(in, TT_SqrtOmega_);
+
+  Matrix Jacobi_diagonal;
+  read_binary(in, Jacobi_diagonal);
+
+  // Validate the dimensions of each of the stored matrices against the
+  // problem description
+  const bool SE = (form_ != Formulation::SOSync);
+  const bool Simplified = (form_ == Formulation::Simplified);
+  const size_t nr = (n_ > 0 ? n_ - 1 : 0);
+  check_dimensions(A_, true, n_, m_, "A");
+  check_dimensions(B1_, SE, d_ * m_, d_ * n_, "B1");
+  check_dimensions(B2_, SE, d_ * m_, d_ * d_ * n_, "B2");
+  check_dimensions(B3_, true, d_ * d_ * m_, d_ * d_ * n_, "B3");
+  check_dimensions(M_, SE, (d_ + 1) * n_, (d_ + 1) * n_, "M");
+  check_dimensions(LGrho_, form_ != Formulation::Explicit, d_ * n_, d_ * n_,
+                   "LGrho");
+  check_dimensions(Ared_SqrtOmega_, Simplified, nr, m_, "Ared_SqrtOmega");
+  check_dimensions(SqrtOmega_AredT_, Simplified, m_, nr, "SqrtOmega_AredT");
+  check_dimensions(SqrtOmega_T_, Simplified, m_, d_ * n_, "SqrtOmega_T");
+  check_dimensions(TT_SqrtOmega_, Simplified, d_ * n_, m_, "TT_SqrtOmega");
+
+  const size_t Jacobi_dimension =
+      (preconditioner_ != Preconditioner::Jacobi
+           ? 0
+           : (form_ == Formulation::Explicit ? d_ + 1 : d_) * n_);
+  if (static_cast<size_t>(Jacobi_diagonal.size()) != Jacobi_dimension)
+    throw std::runtime_error(
+        "Stored Jacobi preconditioner has invalid dimensions");
+  Jacobi_precon_ = Jacobi_diagonal.col(0).asDiagonal();
+
+  /// Cached factorizations
+  std::unique_ptr<SparseFactorization> projection_factor =
+      read_factor(in, sparse_solvers_.projection, nr);
+  std::unique_ptr<SparseFactorization> preconditioner_factor =
+      read_factor(in, sparse_solvers_.preconditioner,
+                  (SE ? d_ + 1 : d_) * n_);
+
+  /// Restore the manifold and cached factorizations
+  SP_.set_k(d_);
+  SP_.set_n(n_);
+  set_relaxation_rank(r);
+
+  // Factorizations that could not be stored in explicit form (those computed
+  // by PCG or QR) are recomputed from the stored matrices
+  L_.reset();
+  if (form_ == Formulation::Simplified) {
+    if (projection_factor &&
+        projection_factorization_ == ProjectionFactorization::Cholesky)
+      L_ = std::move(projection_factor);
+    else
+      factorize_projection();
+  }
+
+  reg_Chol_precon_.reset();
+  if (preconditioner_ == Preconditioner::RegularizedCholesky) {
+    if (preconditioner_factor)
+      reg_Chol_precon_ = std::move(preconditioner_factor);
+    else
+      factorize_regularized_Cholesky_preconditioner();
+  }
+}
+
+void SESyncProblem::load(const std::string &filename,
+                         const measurements_t &measurements) {
+  load(filename);
+
+  if (fingerprint_ != measurements_fingerprint(measurements))
+    throw std::runtime_error(
+        "Problem stored in " + filename +
+        " was not constructed from the passed set of measurements");
+}
+
+/// The following operators are evaluated by dispatching to the compile-time
+/// specialization of this problem matching its formulation and dimension (cf.
+/// SESync/SESyncProblemT.h)
+
 Matrix SESyncProblem::data_matrix_product(const Matrix &Y) const {
-  if (form_ == Formulation::Simplified)
-    return Q_product(Y);
-  else if (form_ == Formulation::Explicit)
-    return M_ * Y;
-  else // form_ == Formulation::SOSync
-    return LGrho_ * Y;
+  return visit_specialized_problem(
+      *this, [&Y](const auto &P) { return P.data_matrix_product(Y); });
 }
 
 Scalar SESyncProblem::evaluate_objective(const Matrix &Y) const {
-  return (Y * data_matrix_product(Y.transpose())).trace();
+  return visit_specialized_problem(
+      *this, [&Y](const auto &P) { return P.evaluate_objective(Y); });
 }
 
 Matrix SESyncProblem::Euclidean_gradient(const Matrix &Y) const {
-  return 2 * data_matrix_product(Y.transpose()).transpose();
+  return visit_specialized_problem(
+      *this, [&Y](const auto &P) { return P.Euclidean_gradient(Y); });
 }
 
 Matrix SESyncProblem::Riemannian_gradient(const Matrix &Y,
@@ -199,26 +715,15 @@ Matrix SESyncProblem::Riemannian_gradient(const Matrix &Y,
 }
 
 Matrix SESyncProblem::Riemannian_gradient(const Matrix &Y) const {
-  return tangent_space_projection(Y, Euclidean_gradient(Y));
+  return visit_specialized_problem(
+      *this, [&Y](const auto &P) { return P.Riemannian_gradient(Y); });
 }
 
 Matrix SESyncProblem::Riemannian_Hessian_vector_product(
     const Matrix &Y, const Matrix &nablaF_Y, const Matrix &dotY) const {
-  if (form_ == Formulation::Simplified || form_ == Formulation::SOSync)
-    return SP_.Proj(Y, 2 * data_matrix_product(dotY.transpose()).transpose() -
-                           SP_.SymBlockDiagProduct(dotY, Y, nablaF_Y));
-  else {
-    // Euclidean Hessian-vector product
-    Matrix H_dotY = 2 * dotY * M_;
-
-    H_dotY.block(0, n_, r_, d_ * n_) = SP_.Proj(
-        Y.block(0, n_, r_, d_ * n_),
-        H_dotY.block(0, n_, r_, d_ * n_) -
-            SP_.SymBlockDiagProduct(dotY.block(0, n_, r_, d_ * n_),
-                                    Y.block(0, n_, r_, d_ * n_),
-                                    nablaF_Y.block(0, n_, r_, d_ * n_)));
-    return H_dotY;
-  }
+  return visit_specialized_problem(*this, [&](const auto &P) {
+    return P.Riemannian_Hessian_vector_product(Y, nablaF_Y, dotY);
+  });
 }
 
 Matrix
@@ -228,79 +733,20 @@ SESyncProblem::Riemannian_Hessian_vector_product(const Matrix &Y,
 }
 
 Matrix SESyncProblem::precondition(const Matrix &Y, const Matrix &dotY) const {
-  if (preconditioner_ == Preconditioner::None)
-    return dotY;
-  else if (preconditioner_ == Preconditioner::Jacobi)
-    return tangent_space_projection(Y, dotY * Jacobi_precon_);
-  else {
-    // preconditioner == RegularizedCholesky
-    if (form_ != Formulation::Simplified) {
-      return tangent_space_projection(
-          Y, reg_Chol_precon_.solve(dotY.transpose()).transpose());
-    } else {
-      // When preconditioning the Simplified form of the problem (whose
-      // objective matrix S is the generalized Schur complement of the data
-      // matrix M with respect to the translational states), we make use of the
-      // fact that for a block matrix of the form:
-      //
-      // M = [A  B]
-      //     [B' C]
-      //
-      // and Schur complement S := C - B' * A^-1 * B, the product PYdot := S^-1
-      // * Ydot is given by the second block of the solution Z := (X,PYdot) to
-      // the following linear system:
-      //
-      //  M  [X]   =   [0]
-      //   [PYdot] = [Ydot]
-
-      // Allocate right-hand side
-      Matrix rhs = Matrix::Zero(M_.rows(), r_);
-
-      // Set second block to Ydot
-      rhs.bottomRows(d_ * n_) = dotY.transpose();
-
-      // Solve linear system
-      Matrix Z = reg_Chol_precon_.solve(rhs);
-
-      // Extract PYdot from Z and return
-      return tangent_space_projection(Y, Z.bottomRows(d_ * n_).transpose());
-    } // formulation == Simplified
-  }   // preconditioner == RegularizedCholesky
+  return visit_specialized_problem(
+      *this, [&](const auto &P) { return P.precondition(Y, dotY); });
 }
 
 Matrix SESyncProblem::tangent_space_projection(const Matrix &Y,
                                                const Matrix &dotY) const {
-  if (form_ == Formulation::Simplified || form_ == Formulation::SOSync)
-    return SP_.Proj(Y, dotY);
-  else {
-    // form == Explicit
-    Matrix P(dotY.rows(), dotY.cols());
-
-    // Projection of translational states is the identity
-    P.block(0, 0, r_, n_) = dotY.block(0, 0, r_, n_);
-
-    // Projection of generalized rotational states comes from the product of
-    // Stiefel manifolds
-    P.block(0, n_, r_, d_ * n_) =
-        SP_.Proj(Y.block(0, n_, r_, d_ * n_), dotY.block(0, n_, r_, d_ * n_));
-
-    return P;
-  }
+  return visit_specialized_problem(*this, [&](const auto &P) {
+    return P.tangent_space_projection(Y, dotY);
+  });
 }
 
 Matrix SESyncProblem::retract(const Matrix &Y, const Matrix &dotY) const {
-  if (form_ == Formulation::Simplified || form_ == Formulation::SOSync)
-    return SP_.retract(Y, dotY);
-  else // form == Explicit
-  {
-    Matrix Yplus = Y;
-    Yplus.block(0, 0, r_, n_) += dotY.block(0, 0, r_, n_);
-
-    Yplus.block(0, n_, r_, d_ * n_) = SP_.retract(
-        Y.block(0, n_, r_, d_ * n_), dotY.block(0, n_, r_, d_ * n_));
-
-    return Yplus;
-  }
+  return visit_specialized_problem(
+      *this, [&](const auto &P) { return P.retract(Y, dotY); });
 }
 
 Matrix SESyncProblem::round_solution(const Matrix Y) const {
@@ -366,7 +812,7 @@ Matrix SESyncProblem::round_solution(const Matrix Y) const {
     X.block(0, n_, d_, d_ * n_) = R;
 
     // Recover translational states
-    X.block(0, 0, d_, n_) = recover_translations(B1_, B2_, R);
+    X.block(0, 0, d_, n_) = recover_translations(B1_, B2_, R, num_threads_);
 
     return X;
   }
@@ -427,11 +873,81 @@ SparseMatrix SESyncProblem::compute_Lambda(const Matrix &Y) const {
   return compute_Lambda_from_Lambda_blocks(Lambda_blocks);
 }
 
+Matrix SESyncProblem::reduced_Laplacian_solve(const Matrix &B) const {
+  if (projection_factorization_ == ProjectionFactorization::Cholesky)
+    return L_->solve(B);
+
+  // The cached QR decomposition Omega^(1/2) * Ared' * P = Q * R (where P is a
+  // column permutation) provides Ared * Omega * Ared' = P * R' * R * P'
+  const size_t k = n_ - 1;
+  const SparseMatrix R = QR_->matrixR().topLeftCorner(k, k);
+  const auto &E = QR_->colsPermutation().indices();
+
+  Matrix W(k, B.cols());
+  for (size_t i = 0; i < k; ++i)
+    W.row(i) = B.row(E(i));
+
+  R.triangularView<Eigen::Upper>().transpose().solveInPlace(W);
+  R.triangularView<Eigen::Upper>().solveInPlace(W);
+
+  Matrix X(k, B.cols());
+  for (size_t i = 0; i < k; ++i)
+    X.row(E(i)) = W.row(i);
+  return X;
+}
+
+Matrix SESyncProblem::certificate_nullspace_basis(const Matrix &Y) const {
+  /// Construct the (transpose of the) lift X of Y to the domain of the full
+  /// certificate matrix S
+
+  Matrix Xt;
+
+  if (form_ == Formulation::SOSync || form_ == Formulation::Explicit)
+    Xt = Y.transpose();
+  else {
+    // In the Simplified formulation, Y contains only the rotational states; we
+    // recover the optimal translational states t (with the last fixed to the
+    // origin) given Y by solving the translational block of the normal
+    // equations M * X' = 0:
+    //
+    // L(W^tau) * t' = -V * Y'
+    //
+    // where L(W^tau) and V are the top-left and top-right blocks of M.  Fixing
+    // the last translation reduces L(W^tau) to Ared * Omega * Ared', whose
+    // factorization is already cached for the orthogonal projection
+    Xt = Matrix::Zero(n_ + d_ * n_, Y.rows());
+    Xt.bottomRows(d_ * n_) = Y.transpose();
+
+    if (n_ > 1)
+      Xt.topRows(n_ - 1) = reduced_Laplacian_solve(
+          -(M_.block(0, n_, n_ - 1, d_ * n_) * Y.transpose()));
+  }
+
+  /// Append the global translation direction (which lies in the nullspace of
+  /// both M and Lambda)
+  if (form_ != Formulation::SOSync) {
+    Xt.conservativeResize(Eigen::NoChange, Xt.cols() + 1);
+    Xt.col(Xt.cols() - 1).setZero();
+    Xt.col(Xt.cols() - 1).head(n_).setOnes();
+  }
+
+  /// Orthonormalize
+  Eigen::ColPivHouseholderQR<Matrix> QR(Xt);
+  Matrix Q = QR.householderQ() * Matrix::Identity(Xt.rows(), QR.rank());
+
+  return Q;
+}
+
 bool SESyncProblem::verify_solution(const Matrix &Y, Scalar eta, size_t nx,
                                     Scalar &theta, Vector &x, size_t &num_iters,
                                     size_t max_LOBPCG_iters,
-                                    Scalar max_fill_factor,
-                                    Scalar drop_tol) const {
+                                    Scalar max_fill_factor, Scalar drop_tol,
+                                    VerificationPreconditioner LOBPCG_precon,
+                                    bool deflate,
+                                    VerificationEigensolver eigensolver,
+                                    size_t Chebyshev_degree,
+                                    double max_computation_time,
+                                    uint64_t seed) const {
 
   /// Construct certificate matrix S
 
@@ -447,10 +963,34 @@ bool SESyncProblem::verify_solution(const Matrix &Y, Scalar eta, size_t nx,
     S = M_ - compute_Lambda_from_Lambda_blocks(Lambda_blocks, n_);
   }
 
+  /// Set up the LOBPCG preconditioner (if we are reusing a cached
+  /// factorization)
+  std::optional<Optimization::LinearAlgebra::SymmetricLinearOperator<Matrix>>
+      T;
+
+  if (LOBPCG_precon == VerificationPreconditioner::RegularizedCholesky &&
+      preconditioner_ == Preconditioner::RegularizedCholesky) {
+    // The certificate matrix S = D - Lambda differs from the regularized data
+    // matrix P = D + lambda_reg * I (whose factorization we have already
+    // cached) only by the block-diagonal matrix Lambda and a diagonal shift, so
+    // P^-1 is an effective preconditioner for the regularized certificate
+    // matrix S + eta * I
+    const SparseFactorization &P = *reg_Chol_precon_;
+    T = [&P](const Matrix &X) -> Matrix { return P.solve(X); };
+  }
+
   /// Test positive-semidefiniteness of certificate matrix S using fast
   /// verification method
   bool PSD = fast_verification(S, eta, nx, theta, x, num_iters,
-                               max_LOBPCG_iters, max_fill_factor, drop_tol);
+                               max_LOBPCG_iters,
+                               std::min(max_fill_factor,
+                                        max_verification_fill_factor_),
+                               drop_tol,
+                               sparse_solvers_.verification, T,
+                               deflate ? certificate_nullspace_basis(Y)
+                                       : Matrix(),
+                               eigensolver, Chebyshev_degree,
+                               max_computation_time, seed, num_threads_);
 
   if (!PSD && (form_ == Formulation::Simplified)) {
     // Extract the (trailing) portion of the tangent vector corresponding to the
@@ -471,42 +1011,64 @@ Matrix SESyncProblem::chordal_initialization() const {
   Matrix Y;
   if ((form_ == Formulation::Simplified) || (form_ == Formulation::SOSync)) {
     Y = Matrix::Zero(r_, n_ * d_);
-    Y.topRows(d_) = SESync::chordal_initialization(d_, B3_);
+    Y.topRows(d_) = SESync::chordal_initialization(d_, B3_, num_threads_);
   } else // form == explicit
   {
     Y = Matrix::Zero(r_, n_ * (d_ + 1));
 
     // Compute rotations using chordal initialization
-    Y.block(0, n_, d_, n_ * d_) = SESync::chordal_initialization(d_, B3_);
+    Y.block(0, n_, d_, n_ * d_) =
+        SESync::chordal_initialization(d_, B3_, num_threads_);
 
     // Recover corresponding translations
-    Y.block(0, 0, d_, n_) =
-        recover_translations(B1_, B2_, Y.block(0, n_, d_, n_ * d_));
+    Y.block(0, 0, d_, n_) = recover_translations(
+        B1_, B2_, Y.block(0, n_, d_, n_ * d_), num_threads_);
   }
 
   return Y;
 }
 
-Matrix SESyncProblem::random_sample() const {
+Matrix SESyncProblem::lift_estimate(const Matrix &xhat) const {
+  const size_t num_translations =
+      (form_ == Formulation::Explicit ? n_ : 0);
+
+  if (static_cast<size_t>(xhat.rows()) != d_ ||
+      (static_cast<size_t>(xhat.cols()) != (d_ + 1) * n_ &&
+       static_cast<size_t>(xhat.cols()) != num_translations + d_ * n_))
+    throw std::invalid_argument("Pose estimates must be a d x (d+1)n matrix of "
+                                "the form [t | R]");
+
+  // Embed the rotational blocks in the top d rows of an r x dn matrix, and
+  // project the result onto the Stiefel product manifold
+  Matrix R = Matrix::Zero(r_, n_ * d_);
+  R.topRows(d_) = xhat.rightCols(n_ * d_);
+  R = SP_.project(R);
+
+  if (form_ != Formulation::Explicit)
+    return R;
+
+  Matrix Y = Matrix::Zero(r_, n_ * (d_ + 1));
+  Y.block(0, 0, d_, n_) = xhat.leftCols(n_);
+  Y.rightCols(n_ * d_) = R;
+  return Y;
+}
+
+Matrix SESyncProblem::random_sample(uint64_t seed) const {
   Matrix Y;
   if ((form_ == Formulation::Simplified) || (form_ == Formulation::SOSync))
     // Randomly sample a point on the Stiefel manifold
-    Y = SP_.random_sample();
+    Y = SP_.random_sample(seed);
   else // form == Explicit
   {
     Y = Matrix::Zero(r_, n_ * (d_ + 1));
 
     // Randomly sample a set of elements on the Stiefel product manifold
-    Y.block(0, n_, r_, n_ * d_) = SP_.random_sample();
+    Y.block(0, n_, r_, n_ * d_) = SP_.random_sample(seed);
 
     // Randomly sample a set of coordinates for the initial positions from the
     // standard normal distribution
-    std::default_random_engine generator;
-    std::normal_distribution<Scalar> g;
-
-    for (size_t i = 0; i < r_; ++i)
-      for (size_t j = 0; j < n_; ++j)
-        Y(i, j) = g(generator);
+    Y.block(0, 0, r_, n_) =
+        random_normal_matrix(r_, n_, seed, RandomStream::TranslationSample);
   }
 
   return Y;
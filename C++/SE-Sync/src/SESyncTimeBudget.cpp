@@ -0,0 +1,112 @@
+#include <algorithm>
+#include <cmath>
+
+#include "Optimization/Util/Stopwatch.h"
+
+#include "SESync/SESyncTimeBudget.h"
+
+namespace SESync {
+
+TimeBudget::TimeBudget(const SESyncProblem &problem,
+                       double max_computation_time, double safety_factor)
+    : TimeBudget(problem, max_computation_time, Stopwatch::tick(),
+                 safety_factor) {}
+
+TimeBudget::TimeBudget(
+    const SESyncProblem &problem, double max_computation_time,
+    const std::chrono::time_point<std::chrono::high_resolution_clock>
+        &start_time,
+    double safety_factor)
+    : problem_(problem), start_time_(start_time),
+      max_computation_time_(max_computation_time),
+      safety_factor_(safety_factor) {
+
+  // A priori (pessimistic) estimates of the computation time per unit of work
+  // for each phase; these are replaced by measured values once available
+  cost_per_unit_[static_cast<size_t>(SolvePhase::Optimization)] = 1e-7;
+  cost_per_unit_[static_cast<size_t>(SolvePhase::Verification)] = 1e-7;
+  cost_per_unit_[static_cast<size_t>(SolvePhase::SaddleEscape)] = 1e-8;
+  cost_per_unit_[static_cast<size_t>(SolvePhase::Rounding)] = 1e-8;
+  cost_per_unit_[static_cast<size_t>(SolvePhase::PostProcessing)] = 1e-8;
+
+  num_samples_.fill(0);
+}
+
+double TimeBudget::work(SolvePhase phase) const {
+  const double n = problem_.num_states();
+  const double m = problem_.num_measurements();
+  const double d = problem_.dimension();
+  const double r = problem_.relaxation_rank();
+
+  // Number of nonzero elements in the data matrix
+  const double nnz = (n + 2 * m) * d * d;
+
+  switch (phase) {
+  case SolvePhase::Optimization:
+    // Cost of a single trust-region iteration, times a nominal number of
+    // iterations per level
+    return 10 * nnz * r;
+  case SolvePhase::Verification:
+    // Sparse factorization of the certificate matrix, whose fill grows
+    // superlinearly with its size
+    return nnz * d * std::max(1.0, std::log2(n));
+  case SolvePhase::SaddleEscape:
+    // A handful of objective and gradient evaluations
+    return nnz * r;
+  case SolvePhase::Rounding:
+    // Thin SVD of Y, and (possibly) recovery of the translational states
+    return n * d * r * r + nnz;
+  case SolvePhase::PostProcessing:
+    // Computation of Lambda, and evaluation of the objective
+    return nnz * r;
+  default:
+    return 0;
+  }
+}
+
+double TimeBudget::elapsed() const { return Stopwatch::tock(start_time_); }
+
+double TimeBudget::remaining() const {
+  return std::max(max_computation_time_ - elapsed(), 0.0);
+}
+
+double TimeBudget::estimate(SolvePhase phase) const {
+  return safety_factor_ * cost_per_unit_[static_cast<size_t>(phase)] *
+         work(phase);
+}
+
+void TimeBudget::record(SolvePhase phase, double time) {
+  const size_t p = static_cast<size_t>(phase);
+  const double cost = time / std::max(work(phase), 1.0);
+
+  // The first measurement replaces the a priori estimate; thereafter we
+  // conservatively retain the largest observed cost per unit of work
+  cost_per_unit_[p] =
+      (num_samples_[p] == 0 ? cost : std::max(cost_per_unit_[p], cost));
+  ++num_samples_[p];
+}
+
+double TimeBudget::reserved_after(SolvePhase phase) const {
+  double reserve = 0;
+
+  // Always reserve time to round the solution and compute its suboptimality
+  // bound
+  if (phase < SolvePhase::Rounding)
+    reserve +=
+        estimate(SolvePhase::Rounding) + estimate(SolvePhase::PostProcessing);
+  else if (phase == SolvePhase::Rounding)
+    reserve += estimate(SolvePhase::PostProcessing);
+
+  // Optimization is always followed by verification of the critical point it
+  // returns
+  if (phase == SolvePhase::Optimization)
+    reserve += estimate(SolvePhase::Verification);
+
+  return reserve;
+}
+
+double TimeBudget::allotment(SolvePhase phase) const {
+  return std::max(remaining() - reserved_after(phase), 0.0);
+}
+
+} // namespace SESync
@@ -6,9 +6,15 @@
  */
 
 #include "SESync/SESyncVisualizer.h"
+#include "SESync/SESync_threading.h"
 
 #include <Eigen/StdVector>
+#include <algorithm>
+#include <chrono>
 #include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
 
 namespace SESync {
 
@@ -21,66 +27,272 @@ SESyncVisualizer::SESyncVisualizer(const size_t num_poses,
       measurements_(measurements),
       options_(options),
       vopts_(vopts) {
-  // Build an SE-Sync problem.
-  options_.log_iterates = true;  // Ensure this is ON at all times.
-  problem_ = std::make_shared<SESyncProblem>(
-      measurements_, options_.formulation, options_.projection_factorization,
-      options_.preconditioner,
-      options_.reg_Cholesky_precon_max_condition_number);
+  // Build an SE-Sync problem (within the memory budget, if any).
+  PreparedProblem prepared = prepare_problem(measurements_, options_);
+  problem_ = prepared.problem;
+  options_ = prepared.options;
+
+  // The problem relabels non-contiguous pose IDs densely, and so do we, so
+  // that the measurements index the poses of the rounded solutions.
+  compact_pose_ids(measurements_);
+  num_poses_ = problem_->num_states();
+  dim_ = problem_->dimension();
+
+  // Level of detail: render at most max_rendered_poses poses.
+  const size_t max_rendered = std::max<size_t>(vopts_.max_rendered_poses, 2);
+  const size_t pose_stride = (num_poses_ + max_rendered - 1) / max_rendered;
+  for (size_t i = 0; i < num_poses_; i += pose_stride)
+    rendered_poses_.push_back(i);
+  if (rendered_poses_.back() != num_poses_ - 1)
+    rendered_poses_.push_back(num_poses_ - 1);
+
+  // Detect loop closures for drawing.
+  std::vector<std::pair<size_t, size_t>> loop_closures;
+  for (const RelativePoseMeasurement &m : measurements_) {
+    if (std::abs(static_cast<int>(m.j) - static_cast<int>(m.i)) != 1)
+      loop_closures.emplace_back(m.i, m.j);
+  }
+
+  // Level of detail: render at most max_rendered_poses loop closures.
+  const size_t lc_stride =
+      std::max<size_t>((loop_closures.size() + max_rendered - 1) / max_rendered,
+                       1);
+  for (size_t k = 0; k < loop_closures.size(); k += lc_stride)
+    loop_closures_.push_back(loop_closures[k]);
+  if (pose_stride > 1 || lc_stride > 1)
+    std::cout << "Rendering " << rendered_poses_.size() << " of " << num_poses_
+              << " poses and " << loop_closures_.size() << " of "
+              << loop_closures.size() << " loop closures." << std::endl;
+
+  // Start the pool of threads that round iterates on demand.
+  for (size_t t = 0; t < std::max<size_t>(vopts_.num_rounding_threads, 1); t++)
+    rounding_threads_.emplace_back(&SESyncVisualizer::RoundingWorker, this);
+
+  // Stream iterates from the solver as they are generated, rather than logging
+  // them all (log_iterates) and waiting for the solve to finish.
+  SESyncOpts solver_options = options_;
+  solver_options.log_iterates = false;
+  solver_options.user_function =
+      [this, user_function = options_.user_function](
+          double t, const Matrix &x, Scalar f, const Matrix &g,
+          const Optimization::Riemannian::LinearOperator<Matrix, Matrix,
+                                                         Matrix> &HessOp,
+          Scalar Delta, size_t num_STPCG_iters, const Matrix &h, Scalar df,
+          Scalar rho, bool accepted, Matrix &NablaF_Y) {
+        PushIterate(x);
+        bool stop = shutdown_;
+        if (user_function)
+          stop |= (*user_function)(t, x, f, g, HessOp, Delta, num_STPCG_iters,
+                                   h, df, rho, accepted, NablaF_Y);
+        return stop;
+      };
 
   // Solve.
-  result_ = SESync(*problem_, options_);
-
-  // Round all iterates using approriate rank.
-  std::cout << "Rounding iterates..." << std::endl;
-  std::vector<std::vector<Matrix>> iterates = result_.iterates;
-  size_t rank_counter = options_.r0, iter_counter = 0;
-  for (size_t l = 0; l < iterates.size(); l++) {
-    problem_->set_relaxation_rank(rank_counter);
-    for (const Matrix &Y : iterates[l]) {
-      iterates_.push_back(problem_->round_solution(Y));
-      staircase_.insert({iter_counter++, rank_counter});
+  solver_thread_ = std::thread([this, solver_options,
+                                prepared = std::move(prepared)]() {
+    SESyncResult result = SESync(*problem_, solver_options);
+    prepared.annotate(result);
+    {
+      std::lock_guard<std::mutex> lock(iterates_mutex_);
+      result_ = std::move(result);
     }
-    rank_counter++;
+    solver_done_ = true;
+  });
+}
+
+/* *************************************************************************  */
+SESyncVisualizer::~SESyncVisualizer() {
+  // Ask the solver to stop at its next iteration, and stop the rounding pool.
+  shutdown_ = true;
+  frames_cv_.notify_all();
+  for (std::thread &t : rounding_threads_) t.join();
+  if (solver_thread_.joinable()) solver_thread_.join();
+}
+
+/* *************************************************************************  */
+const SESyncResult &SESyncVisualizer::WaitForResult() {
+  if (solver_thread_.joinable()) solver_thread_.join();
+  return result_;
+}
+
+/* *************************************************************************  */
+void SESyncVisualizer::PushIterate(const Matrix &Y) {
+  std::lock_guard<std::mutex> lock(iterates_mutex_);
+  const size_t iter = num_received_++;
+
+  // Only retain every stride_-th iterate.
+  if (iter % stride_ != 0) return;
+  iterates_.push_back(
+      {iter, static_cast<size_t>(Y.rows()), std::make_shared<const Matrix>(Y)});
+
+  // Decimate the stored sequence once it exceeds the memory bound.
+  if (iterates_.size() > std::max<size_t>(vopts_.max_stored_iterates, 2)) {
+    stride_ *= 2;
+    std::deque<StreamedIterate> decimated;
+    for (StreamedIterate &it : iterates_)
+      if (it.iter % stride_ == 0) decimated.push_back(std::move(it));
+    iterates_.swap(decimated);
   }
+}
 
-  // Get problem's dimension from optimal solution.
-  dim_ = result_.xhat.rows();
+/* *************************************************************************  */
+bool SESyncVisualizer::FindIterate(const size_t iter,
+                                   StreamedIterate &iterate) const {
+  std::lock_guard<std::mutex> lock(iterates_mutex_);
+  auto it = std::lower_bound(
+      iterates_.begin(), iterates_.end(), iter,
+      [](const StreamedIterate &a, size_t i) { return a.iter < i; });
+  if (it == iterates_.end()) return false;
+  iterate = *it;
+  return true;
+}
 
-  // Parse all solutions into vectors of matrices.
-  std::cout << "Parsing rounded solutions..." << std::endl;
-  for (const Matrix &xhat : iterates_) {
-    solutions_.push_back(ParseXhatToVector(xhat));
-    solnspind_.push_back(ParseXhatToVector(RotateSolution(xhat)));
-    lcs_.push_back(std::vector<Eigen::Vector3d>());      // Empty.
-    lcspind_.push_back(std::vector<Eigen::Vector3d>());  // Empty.
+/* *************************************************************************  */
+std::shared_ptr<const SESyncVisualizer::Frame> SESyncVisualizer::RequestFrame(
+    const StreamedIterate &iterate) {
+  std::lock_guard<std::mutex> lock(frames_mutex_);
+
+  auto it = frames_.find(iterate.iter);
+  if (it != frames_.end()) {
+    // Mark this frame as most recently used.
+    frames_lru_.splice(frames_lru_.begin(), frames_lru_, it->second.second);
+    return it->second.first;
   }
-  // Cache the total number of iterates.
-  num_iters_ = solutions_.size();
 
-  // Detect loop closures for drawing.
-  std::cout << "Analyzing loop closures..." << std::endl;
-  size_t M = measurements_.size();
-  for (size_t m = 0; m < M; m++) {
-    int i = measurements_[m].i;
-    int j = measurements_[m].j;
-    if (std::abs(j - i) != 1) {
-      for (size_t v = 0; v < solutions_.size(); v++) {
-        // "Natural" solutions in the parameter space.
-        lcs_[v].push_back(
-            solutions_[v][i].block(0, 3, 3, 1));  // i-th position.
-        lcs_[v].push_back(
-            solutions_[v][j].block(0, 3, 3, 1));  // j-th position.
-        // Pinned and rotated solutions.
-        lcspind_[v].push_back(solnspind_[v][i].block(0, 3, 3, 1));
-        lcspind_[v].push_back(solnspind_[v][j].block(0, 3, 3, 1));
-      }
+  // Schedule this iterate for rounding ahead of any prefetched ones.
+  if (!rounding_.count(iterate.iter) &&
+      std::none_of(round_queue_.begin(), round_queue_.end(),
+                   [&](const StreamedIterate &q) {
+                     return q.iter == iterate.iter;
+                   })) {
+    round_queue_.push_front(iterate);
+    frames_cv_.notify_one();
+  }
+  return nullptr;
+}
+
+/* *************************************************************************  */
+void SESyncVisualizer::Prefetch(const size_t iter) {
+  // Collect the iterates following the current one.
+  std::vector<StreamedIterate> upcoming;
+  {
+    std::lock_guard<std::mutex> lock(iterates_mutex_);
+    auto it = std::upper_bound(
+        iterates_.begin(), iterates_.end(), iter,
+        [](size_t i, const StreamedIterate &a) { return i < a.iter; });
+    for (size_t k = 0; k < vopts_.prefetch && it != iterates_.end(); k++, it++)
+      upcoming.push_back(*it);
+  }
+
+  std::lock_guard<std::mutex> lock(frames_mutex_);
+
+  // Drop requests for iterates that have already been passed.
+  round_queue_.erase(
+      std::remove_if(round_queue_.begin(), round_queue_.end(),
+                     [iter](const StreamedIterate &q) { return q.iter < iter; }),
+      round_queue_.end());
+
+  for (const StreamedIterate &next : upcoming) {
+    if (frames_.count(next.iter) || rounding_.count(next.iter) ||
+        std::any_of(round_queue_.begin(), round_queue_.end(),
+                    [&](const StreamedIterate &q) {
+                      return q.iter == next.iter;
+                    }))
+      continue;
+    round_queue_.push_back(next);
+    frames_cv_.notify_one();
+  }
+}
+
+/* *************************************************************************  */
+void SESyncVisualizer::RoundingWorker() {
+  // Rounding runs concurrently with the solver, so it must not change the
+  // process-wide OpenMP and BLAS settings that the solver's phases manage.
+  ScopedThreadingBypass bypass;
+
+  std::unique_lock<std::mutex> lock(frames_mutex_);
+  while (true) {
+    frames_cv_.wait(lock, [this] { return shutdown_ || !round_queue_.empty(); });
+    if (shutdown_) return;
+
+    StreamedIterate iterate = std::move(round_queue_.front());
+    round_queue_.pop_front();
+    rounding_.insert(iterate.iter);
+
+    // Round without holding the lock.
+    lock.unlock();
+    std::shared_ptr<const Frame> frame = BuildFrame(iterate);
+    lock.lock();
+
+    rounding_.erase(iterate.iter);
+    frames_lru_.push_front(iterate.iter);
+    frames_[iterate.iter] = {frame, frames_lru_.begin()};
+    frame_ready_cv_.notify_all();
+
+    // Evict the least recently used frames.
+    while (frames_.size() > std::max<size_t>(vopts_.frame_cache_size, 1)) {
+      frames_.erase(frames_lru_.back());
+      frames_lru_.pop_back();
     }
   }
 }
 
 /* *************************************************************************  */
-SESyncVisualizer::~SESyncVisualizer() {}
+std::shared_ptr<const SESyncVisualizer::Frame> SESyncVisualizer::BuildFrame(
+    const StreamedIterate &iterate) const {
+  // round_solution() only reads the (immutable) problem data, and the rounding
+  // threads never change the threading settings (cf. RoundingWorker()), so it
+  // is safe to call concurrently with the solver.
+  const Matrix xhat = problem_->round_solution(*iterate.Y);
+
+  const Matrix xpind = RotateSolution(xhat);
+
+  auto frame = std::make_shared<Frame>();
+  frame->solution = ExtractPositions(xhat);
+  frame->pinned = ExtractPositions(xpind);
+
+  // Position of the i-th pose in a solution.
+  auto position = [this](const Matrix &x, size_t i) {
+    Eigen::Vector3f p = Eigen::Vector3f::Zero();
+    p.head(dim_) = x.block(0, i, dim_, 1).cast<float>();
+    return p;
+  };
+
+  for (const std::pair<size_t, size_t> &lc : loop_closures_) {
+    // "Natural" solutions in the parameter space.
+    frame->lcs.push_back(position(xhat, lc.first));
+    frame->lcs.push_back(position(xhat, lc.second));
+    // Pinned and rotated solutions.
+    frame->lcspind.push_back(position(xpind, lc.first));
+    frame->lcspind.push_back(position(xpind, lc.second));
+  }
+
+  return frame;
+}
+
+/* *************************************************************************  */
+std::shared_ptr<const SESyncVisualizer::Frame> SESyncVisualizer::WaitForFrame(
+    const StreamedIterate &iterate) {
+  std::shared_ptr<const Frame> frame;
+  while (!(frame = RequestFrame(iterate))) {
+    std::unique_lock<std::mutex> lock(frames_mutex_);
+    frame_ready_cv_.wait_for(lock, std::chrono::milliseconds(10));
+  }
+  return frame;
+}
+
+/* *************************************************************************  */
+void SESyncVisualizer::UploadFrame(const Frame &frame, const bool pin,
+                                   pangolin::GlBuffer &trajectory,
+                                   pangolin::GlBuffer &lcs) const {
+  // Overwrite the contents of the (fixed-size) buffers in place.
+  const std::vector<Eigen::Vector3f> &positions =
+      pin ? frame.pinned : frame.solution;
+  const std::vector<Eigen::Vector3f> &lines = pin ? frame.lcspind : frame.lcs;
+  trajectory.Upload(positions.data(), positions.size() * sizeof(Eigen::Vector3f));
+  if (!lines.empty())
+    lcs.Upload(lines.data(), lines.size() * sizeof(Eigen::Vector3f));
+}
 
 /* *************************************************************************  */
 void SESyncVisualizer::RenderSynchronization() {
@@ -117,14 +329,27 @@ void SESyncVisualizer::RenderSynchronization() {
   pangolin::RegisterKeyPressCallback('l', [&]() { loops = !loops; });
 
   bool take_screenshot = false;  // Auxiliary variable for saving frames.
-  std::string mkdir_string = "mkdir -p " + vopts_.img_dir;
+
+  // Vertex buffers holding the displayed frame, and the frame they hold.
+  pangolin::GlBuffer trajectory_vbo(pangolin::GlArrayBuffer,
+                                    rendered_poses_.size(), GL_FLOAT, 3,
+                                    GL_DYNAMIC_DRAW);
+  pangolin::GlBuffer lcs_vbo(pangolin::GlArrayBuffer,
+                             std::max<size_t>(2 * loop_closures_.size(), 1),
+                             GL_FLOAT, 3, GL_DYNAMIC_DRAW);
+  std::shared_ptr<const Frame> uploaded;
+  bool uploaded_pin = pin;
 
   // Book-keeping variables for advancing between iterates.
-  auto clock = Stopwatch::tick();
-  double time = 0;      // To keep track of elapsed time [s].
-  size_t soln_idx = 0;  // Current iterate index [-].
+  auto clock = Stopwatch::tick();  // Time at which the current iterate began.
+  size_t display_iter = 0;         // Index of the iterate to display [-].
   bool iters_complete = false;
 
+  // The most recently displayed frame, which is shown until the next one has
+  // been rounded.
+  std::shared_ptr<const Frame> frame;
+  size_t frame_iter = 0, frame_level = 0;
+
   while (!pangolin::ShouldQuit()) {
     // Clear screen and activate view to render into
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -136,23 +361,45 @@ void SESyncVisualizer::RenderSynchronization() {
       glClearColor(1.0f, 1.0f, 1.0f, 1.0f);  // White background.
     }
 
-    // Show either the "natural" solution or the rotated and pinned one.
-    if (pin) {  // Rotated and pinned.
-      DrawIterate(solnspind_[soln_idx], lcspind_[soln_idx], markers, loops);
-    } else {  // In parameter space.
-      DrawIterate(solutions_[soln_idx], lcs_[soln_idx], markers, loops);
+    // Fetch the current iterate's frame (if it has been rounded), and schedule
+    // the following ones.
+    StreamedIterate iterate;
+    if (FindIterate(display_iter, iterate)) {
+      display_iter = iterate.iter;  // Skip over decimated iterates.
+      std::shared_ptr<const Frame> next = RequestFrame(iterate);
+      if (next) {
+        frame = next;
+        frame_iter = iterate.iter;
+        frame_level = iterate.rank;
+      }
+      Prefetch(iterate.iter);
     }
 
-    // Show iterate number and staircase level.
-    if (text) DrawInfoText(soln_idx, bkgnd);
+    if (frame) {
+      // Show either the "natural" solution or the rotated and pinned one,
+      // updating the vertex buffers only if the frame has changed.
+      if (frame != uploaded || pin != uploaded_pin) {
+        UploadFrame(*frame, pin, trajectory_vbo, lcs_vbo);
+        uploaded = frame;
+        uploaded_pin = pin;
+      }
+      DrawIterate(trajectory_vbo, lcs_vbo, markers, loops);
+
+      // Show iterate number and staircase level.
+      if (text) DrawInfoText(frame_iter, frame_level, bkgnd);
+    }
 
-    // Advance to next iterate at the desired time.
-    time = Stopwatch::tock(clock);
-    if (time > (soln_idx + 1) * vopts_.delay && !iters_complete) {
-      if (take_screenshot) d_cam.SaveOnRender(GetScreenshotName(soln_idx));
-      soln_idx++;
-      if (soln_idx == num_iters_) {
-        soln_idx = num_iters_ - 1;
+    // Advance to next iterate once the current one has been shown for the
+    // desired time.
+    if (!iters_complete && frame && frame_iter == display_iter &&
+        Stopwatch::tock(clock) > vopts_.delay) {
+      StreamedIterate next;
+      if (FindIterate(display_iter + 1, next)) {
+        if (take_screenshot) d_cam.SaveOnRender(GetScreenshotName(frame_iter));
+        display_iter = next.iter;
+        clock = Stopwatch::tick();
+      } else if (solver_done_) {
+        if (take_screenshot) d_cam.SaveOnRender(GetScreenshotName(frame_iter));
         iters_complete = true;
         take_screenshot = false;
       }
@@ -162,14 +409,20 @@ void SESyncVisualizer::RenderSynchronization() {
       save = false;            // Debounce.
       restart = true;          // Trigger the restart below.
       take_screenshot = true;  // Save img at each iterate.
-      const int err = system(mkdir_string.c_str());  // Create img dir.
+      std::error_code ec;
+      std::filesystem::create_directories(vopts_.img_dir, ec);  // Create dir.
+      if (ec) {
+        std::cerr << "Could not create image directory " << vopts_.img_dir
+                  << ": " << ec.message() << std::endl;
+        take_screenshot = false;
+      }
     }
 
     if (restart) {                // Restart the iterates (toggle with 'r' key).
       restart = false;            // Debounce.
       iters_complete = false;     // Restart iterations.
       clock = Stopwatch::tick();  // Restart clock.
-      soln_idx = 0;               // Go back to beginning.
+      display_iter = 0;           // Go back to beginning.
     }
 
     pangolin::FinishFrame();  // Swap frames and process events.
@@ -177,45 +430,105 @@ void SESyncVisualizer::RenderSynchronization() {
 }
 
 /* ************************************************************************** */
-void SESyncVisualizer::DrawIterate(const Trajectory3 &trajectory,
-                                   const std::vector<Eigen::Vector3d> &lcs,
-                                   const bool marker, const bool loops) const {
-  std::vector<Eigen::Vector3d> positions;
-
-  // Get all positions.
-  for (const Eigen::Matrix4d &p : trajectory) {
-    positions.push_back(p.block<3, 1>(0, 3));
+void SESyncVisualizer::RenderToImages() {
+  std::error_code ec;
+  std::filesystem::create_directories(vopts_.img_dir, ec);  // Create img dir.
+  if (ec)
+    throw std::runtime_error("Could not create image directory " +
+                             vopts_.img_dir + ": " + ec.message());
+
+  std::cout << "Rendering iterates to " << vopts_.img_dir << "." << std::endl;
+  if (vopts_.headless) {
+    pangolin::CreateWindowAndBind("SE-Sync Super Official Viewer", w_, h_,
+                                  pangolin::Params({{"scheme", "headless"}}));
+  } else {
+    pangolin::CreateWindowAndBind("SE-Sync Super Official Viewer", w_, h_);
   }
+  glEnable(GL_DEPTH_TEST);
 
+  // Define Projection and initial ModelView matrix.
+  pangolin::OpenGlMatrix proj =
+      pangolin::ProjectionMatrix(w_, h_, f_, f_, w_ / 2.0, h_ / 2.0, 0.2, 1000);
+  pangolin::OpenGlRenderState s_cam(
+      proj,
+      pangolin::ModelViewLookAt(1.0, 1.0, 1.0, 0.0, 0.0, 0.0, pangolin::AxisZ));
+
+  // Offscreen framebuffer to render into.
+  pangolin::GlTexture color_buffer(w_, h_);
+  pangolin::GlRenderBuffer depth_buffer(w_, h_);
+  pangolin::GlFramebuffer fbo(color_buffer, depth_buffer);
+
+  // Vertex buffers holding the rendered frame.
+  pangolin::GlBuffer trajectory_vbo(pangolin::GlArrayBuffer,
+                                    rendered_poses_.size(), GL_FLOAT, 3,
+                                    GL_DYNAMIC_DRAW);
+  pangolin::GlBuffer lcs_vbo(pangolin::GlArrayBuffer,
+                             std::max<size_t>(2 * loop_closures_.size(), 1),
+                             GL_FLOAT, 3, GL_DYNAMIC_DRAW);
+
+  size_t display_iter = 0;  // Index of the next iterate to render [-].
+  while (!shutdown_) {
+    // Read the solver status *before* looking for the next iterate, so that
+    // every iterate it produced is seen before we finish.
+    const bool done = solver_done_;
+
+    StreamedIterate iterate;
+    if (!FindIterate(display_iter, iterate)) {
+      if (done) break;
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      continue;
+    }
+    Prefetch(iterate.iter);
+    std::shared_ptr<const Frame> frame = WaitForFrame(iterate);
+    UploadFrame(*frame, true, trajectory_vbo, lcs_vbo);
+
+    fbo.Bind();
+    glViewport(0, 0, w_, h_);
+    glClearColor(1.0f, 1.0f, 1.0f, 1.0f);  // White background.
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    s_cam.Apply();
+    DrawIterate(trajectory_vbo, lcs_vbo, false, true);
+    DrawInfoText(iterate.iter, iterate.rank, false);
+    fbo.Unbind();
+
+    color_buffer.Save(GetScreenshotName(iterate.iter) + ".png", false);
+    display_iter = iterate.iter + 1;
+  }
+}
+
+/* ************************************************************************** */
+void SESyncVisualizer::DrawIterate(pangolin::GlBuffer &trajectory,
+                                   pangolin::GlBuffer &lcs, const bool marker,
+                                   const bool loops) const {
   // Draw a line connecting all poses.
   glColor4f(0.2, 0.2, 1.0, 0.8);
   glLineWidth(1.0);
-  pangolin::glDrawLineStrip(positions);  // Odometry lines.
+  pangolin::RenderVbo(trajectory, GL_LINE_STRIP);  // Odometry lines.
   glPointSize(2.0);
   glColor4f(0.6, 0.6, 1.0, 0.3);
-  if (marker) pangolin::glDrawPoints(positions);  // Position points.
+  if (marker) pangolin::RenderVbo(trajectory, GL_POINTS);  // Position points.
 
   // Draw loop closures.
   glColor4f(0.7, 0.7, 1.0, 0.3);
   glLineWidth(1.0);
-  if (loops) pangolin::glDrawLines(lcs);  // Loop-closing lines.
+  if (loops && !loop_closures_.empty())
+    pangolin::RenderVbo(lcs, GL_LINES);  // Loop-closing lines.
   glLineWidth(1.0);
 }
 
 /* ************************************************************************** */
-Trajectory3 SESyncVisualizer::ParseXhatToVector(const Matrix &xhat) const {
-  Trajectory3 poses;
-  poses.reserve(num_poses_);
-
-  for (size_t i = 0; i < num_poses_; i++) {
-    Eigen::Matrix4d p = Eigen::Matrix4d::Identity();
-    p.block(0, 0, dim_, dim_) =
-        xhat.block(0, num_poses_ + i * dim_, dim_, dim_);
-    p.block(0, 3, dim_, 1) = xhat.block(0, i, dim_, 1);
-    poses.push_back(p);
+std::vector<Eigen::Vector3f> SESyncVisualizer::ExtractPositions(
+    const Matrix &xhat) const {
+  std::vector<Eigen::Vector3f> positions;
+  positions.reserve(rendered_poses_.size());
+
+  for (size_t i : rendered_poses_) {
+    Eigen::Vector3f p = Eigen::Vector3f::Zero();
+    p.head(dim_) = xhat.block(0, i, dim_, 1).cast<float>();
+    positions.push_back(p);
   }
 
-  return poses;
+  return positions;
 }
 
 /* ************************************************************************** */
@@ -224,7 +537,8 @@ Matrix SESyncVisualizer::RotateSolution(const Matrix &xhat) const {
 }
 
 /* ************************************************************************** */
-void SESyncVisualizer::DrawInfoText(const size_t iter, const bool bkgnd) const {
+void SESyncVisualizer::DrawInfoText(const size_t iter, const size_t level,
+                                    const bool bkgnd) const {
   // Save previous value.
   GLboolean gl_blend_enabled;
   glGetBooleanv(GL_BLEND, &gl_blend_enabled);
@@ -239,11 +553,18 @@ void SESyncVisualizer::DrawInfoText(const size_t iter, const bool bkgnd) const {
     glColor3f(0.0f, 0.0f, 0.0f);  // Black text on white background.
   }
 
+  size_t num_iters;
+  {
+    std::lock_guard<std::mutex> lock(iterates_mutex_);
+    num_iters = num_received_;
+  }
+
   pangolin::GlFont::I()
-      .Text("Iterate: %d/%d", iter + 1, num_iters_)
+      .Text("Iterate: %d/%d%s", static_cast<int>(iter + 1),
+            static_cast<int>(num_iters), solver_done_ ? "" : "+")
       .DrawWindow(10, 22);
   pangolin::GlFont::I()
-      .Text("Staircase level: %d", staircase_.at(iter))
+      .Text("Staircase level: %d", static_cast<int>(level))
       .DrawWindow(10, 10);
 
   // Restore previous value.
@@ -254,7 +575,10 @@ void SESyncVisualizer::DrawInfoText(const size_t iter, const bool bkgnd) const {
 std::string SESyncVisualizer::GetScreenshotName(const size_t iter,
                                                 const size_t digits) const {
   std::string numstr = std::to_string(iter);
-  std::string padstr = std::string(digits - numstr.length(), '0') + numstr;
+  std::string padstr =
+      std::string(digits > numstr.length() ? digits - numstr.length() : 0,
+                  '0') +
+      numstr;
   return vopts_.img_dir + std::string("/") + vopts_.img_name + padstr;
 }
 
@@ -0,0 +1,104 @@
+#include <algorithm>
+#include <cmath>
+
+#include "SESync/SESync_random.h"
+
+namespace SESync {
+
+/// Philox4x32-10 constants (cf. Salmon et al.)
+static constexpr uint32_t philox_M0 = 0xD2511F53;
+static constexpr uint32_t philox_M1 = 0xCD9E8D57;
+static constexpr uint32_t philox_W0 = 0x9E3779B9;
+static constexpr uint32_t philox_W1 = 0xBB67AE85;
+
+/** Number of Box-Muller pairs generated per (parallel) work item */
+static constexpr size_t pairs_per_block = 256;
+
+/** Minimum number of samples for which to parallelize sampling */
+static constexpr size_t parallel_threshold = 1 << 16;
+
+std::array<uint32_t, 4> Philox4x32(const std::array<uint32_t, 4> &counter,
+                                   const std::array<uint32_t, 2> &key) {
+  uint32_t c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+  uint32_t k0 = key[0], k1 = key[1];
+
+  for (size_t round = 0; round < 10; ++round) {
+    const uint64_t p0 = static_cast<uint64_t>(philox_M0) * c0;
+    const uint64_t p1 = static_cast<uint64_t>(philox_M1) * c2;
+
+    const uint32_t hi0 = static_cast<uint32_t>(p0 >> 32);
+    const uint32_t lo0 = static_cast<uint32_t>(p0);
+    const uint32_t hi1 = static_cast<uint32_t>(p1 >> 32);
+    const uint32_t lo1 = static_cast<uint32_t>(p1);
+
+    c0 = hi1 ^ c1 ^ k0;
+    c1 = lo1;
+    c2 = hi0 ^ c3 ^ k1;
+    c3 = lo0;
+
+    k0 += philox_W0;
+    k1 += philox_W1;
+  }
+
+  return {c0, c1, c2, c3};
+}
+
+/** Helper function:  maps 64 random bits to a uniform sample in (0, 1) */
+static inline Scalar uniform_open(uint64_t bits) {
+  return ((bits >> 11) + 0.5) * 0x1p-53;
+}
+
+void fill_standard_normal(Scalar *data, size_t size, uint64_t seed,
+                          uint64_t stream) {
+  const std::array<uint32_t, 2> key = {static_cast<uint32_t>(seed),
+                                       static_cast<uint32_t>(seed >> 32)};
+
+  // Each invocation of the generator produces 128 random bits, which the
+  // Box-Muller transform maps to a pair of normal samples; the pth pair
+  // (i.e., elements 2p and 2p + 1 of data) is generated from counter p
+  const size_t num_pairs = (size + 1) / 2;
+  const size_t num_blocks = (num_pairs + pairs_per_block - 1) / pairs_per_block;
+
+#pragma omp parallel for schedule(static) if (size >= parallel_threshold)
+  for (size_t b = 0; b < num_blocks; ++b) {
+    const size_t first = b * pairs_per_block;
+    const size_t count = std::min(pairs_per_block, num_pairs - first);
+
+    Scalar u1[pairs_per_block], u2[pairs_per_block];
+    for (size_t i = 0; i < count; ++i) {
+      const uint64_t p = first + i;
+      const std::array<uint32_t, 4> bits = Philox4x32(
+          {static_cast<uint32_t>(p), static_cast<uint32_t>(p >> 32),
+           static_cast<uint32_t>(stream), static_cast<uint32_t>(stream >> 32)},
+          key);
+      u1[i] = uniform_open((static_cast<uint64_t>(bits[0]) << 32) | bits[1]);
+      u2[i] = uniform_open((static_cast<uint64_t>(bits[2]) << 32) | bits[3]);
+    }
+
+    Scalar z1[pairs_per_block], z2[pairs_per_block];
+#pragma omp simd
+    for (size_t i = 0; i < count; ++i) {
+      const Scalar radius = std::sqrt(-2 * std::log(u1[i]));
+      const Scalar angle = 2 * M_PI * u2[i];
+      z1[i] = radius * std::cos(angle);
+      z2[i] = radius * std::sin(angle);
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+      const size_t k = 2 * (first + i);
+      data[k] = z1[i];
+      if (k + 1 < size)
+        data[k + 1] = z2[i];
+    }
+  }
+}
+
+Matrix random_normal_matrix(size_t rows, size_t cols, uint64_t seed,
+                            RandomStream stream) {
+  Matrix X(rows, cols);
+  fill_standard_normal(X.data(), X.size(), seed,
+                       static_cast<uint64_t>(stream));
+  return X;
+}
+
+} // namespace SESync
@@ -0,0 +1,152 @@
+#include <algorithm>
+
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <dlfcn.h>
+#endif
+
+#include "SESync/SESync_threading.h"
+
+namespace SESync {
+
+/** Entry points for controlling the thread pools of the supported BLAS
+ * implementations.  These are resolved at runtime (rather than link time), so
+ * that SE-Sync does not depend upon any particular BLAS vendor */
+struct BLASThreadControl {
+  BLASVendor vendor = BLASVendor::Unknown;
+  void (*set_int)(int) = nullptr;
+  int (*get_int)() = nullptr;
+  void (*set_long)(long) = nullptr;
+  long (*get_long)() = nullptr;
+};
+
+static BLASThreadControl resolve_BLAS_thread_control() {
+  BLASThreadControl control;
+
+#if defined(__unix__) || defined(__APPLE__)
+  auto lookup = [](const char *symbol) { return dlsym(RTLD_DEFAULT, symbol); };
+
+  if (void *set = lookup("openblas_set_num_threads")) {
+    control.vendor = BLASVendor::OpenBLAS;
+    control.set_int = reinterpret_cast<void (*)(int)>(set);
+    control.get_int =
+        reinterpret_cast<int (*)()>(lookup("openblas_get_num_threads"));
+  } else if (void *set = lookup("MKL_Set_Num_Threads")) {
+    control.vendor = BLASVendor::MKL;
+    control.set_int = reinterpret_cast<void (*)(int)>(set);
+    control.get_int =
+        reinterpret_cast<int (*)()>(lookup("MKL_Get_Max_Threads"));
+  } else if (void *set = lookup("bli_thread_set_num_threads")) {
+    // BLIS uses a (64-bit) signed integer type dim_t for thread counts
+    control.vendor = BLASVendor::BLIS;
+    control.set_long = reinterpret_cast<void (*)(long)>(set);
+    control.get_long =
+        reinterpret_cast<long (*)()>(lookup("bli_thread_get_num_threads"));
+  }
+#endif
+
+  return control;
+}
+
+static const BLASThreadControl &BLAS_thread_control() {
+  static const BLASThreadControl control = resolve_BLAS_thread_control();
+  return control;
+}
+
+BLASVendor BLAS_vendor() { return BLAS_thread_control().vendor; }
+
+std::string BLAS_vendor_name(BLASVendor vendor) {
+  switch (vendor) {
+  case BLASVendor::OpenBLAS:
+    return "OpenBLAS";
+  case BLASVendor::MKL:
+    return "MKL";
+  case BLASVendor::BLIS:
+    return "BLIS";
+  default:
+    return "unknown";
+  }
+}
+
+size_t BLAS_num_threads() {
+  const BLASThreadControl &control = BLAS_thread_control();
+  if (control.get_int)
+    return std::max(control.get_int(), 0);
+  if (control.get_long)
+    return std::max(control.get_long(), 0L);
+  return 0;
+}
+
+bool set_BLAS_num_threads(size_t num_threads) {
+  const BLASThreadControl &control = BLAS_thread_control();
+  num_threads = std::max<size_t>(num_threads, 1);
+
+  if (control.set_int)
+    control.set_int(static_cast<int>(num_threads));
+  else if (control.set_long)
+    control.set_long(static_cast<long>(num_threads));
+  else
+    return false;
+
+  return true;
+}
+
+void configure_cholmod_threads(cholmod_common &common, size_t num_threads) {
+  // Leave CHOLMOD's defaults alone if no thread count was specified
+  if (num_threads == 0)
+    return;
+
+  // Number of threads SPQR may use (0 means "let SPQR decide", which is
+  // precisely what we want to avoid)
+  common.SPQR_nthreads = static_cast<int>(num_threads);
+
+#if defined(CHOLMOD_MAIN_VERSION) && (CHOLMOD_MAIN_VERSION >= 4)
+  // Maximum number of OpenMP threads CHOLMOD itself may use
+  common.nthreads_max = static_cast<int>(num_threads);
+#endif
+}
+
+/** The number of ScopedThreadingBypass instances alive on this thread */
+static thread_local size_t threading_bypass_depth = 0;
+
+ScopedThreadingPhase::ScopedThreadingPhase(ThreadingPhase phase,
+                                           size_t num_threads) {
+  // Leave the current settings alone if no thread count was specified, or if
+  // this thread must not modify them
+  if (num_threads == 0 || threading_bypass_depth > 0)
+    return;
+  active_ = true;
+
+#if defined(_OPENMP)
+  prev_omp_threads_ = omp_get_max_threads();
+  omp_set_num_threads(num_threads);
+#endif
+
+  // During factorizations the threads are handed to the BLAS; during the
+  // block kernels, OpenMP owns them and the BLAS must run serially, lest
+  // every OpenMP thread spawn a full complement of BLAS threads of its own
+  prev_BLAS_threads_ = BLAS_num_threads();
+  set_BLAS_num_threads(phase == ThreadingPhase::Factorization ? num_threads
+                                                              : 1);
+}
+
+ScopedThreadingPhase::~ScopedThreadingPhase() {
+  if (!active_)
+    return;
+
+#if defined(_OPENMP)
+  omp_set_num_threads(prev_omp_threads_);
+#endif
+
+  if (prev_BLAS_threads_ > 0)
+    set_BLAS_num_threads(prev_BLAS_threads_);
+}
+
+ScopedThreadingBypass::ScopedThreadingBypass() { ++threading_bypass_depth; }
+
+ScopedThreadingBypass::~ScopedThreadingBypass() { --threading_bypass_depth; }
+
+} // namespace SESync
@@ -1,20 +1,37 @@
 #include <algorithm>
 #include <fstream>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <queue>
 #include <sstream>
 
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+
 #include <Eigen/CholmodSupport>
 #include <Eigen/Geometry>
 #include <Eigen/SPQRSupport>
 
 #include "ILDL/ILDL.h"
 #include "Optimization/LinearAlgebra/LOBPCG.h"
+#include "Optimization/Util/Stopwatch.h"
 
+#include "SESync/SESync_random.h"
+#include "SESync/SESync_threading.h"
 #include "SESync/SESync_utils.h"
+#include "SESync/SparseFactorization.h"
 
 namespace SESync {
 
-measurements_t read_g2o_file(const std::string &filename, size_t &num_poses) {
+/** Helper function: parses the passed .g2o file, returning its measurements
+ * (under their original pose IDs) and the largest pose ID they contain, and
+ * recording each vertex estimate [t_i | R_i] in the file together with the
+ * ID i of the corresponding pose */
+static measurements_t
+parse_g2o_file(const std::string &filename, size_t &max_id,
+               std::vector<std::pair<size_t, Matrix>> &vertices) {
 
   // Preallocate output vector
   measurements_t measurements;
@@ -34,10 +51,18 @@ measurements_t read_g2o_file(const std::string &filename, size_t &num_poses) {
 
   size_t i, j;
 
+  // Helper function: record the estimate of the ith pose
+  auto record_vertex = [&vertices](size_t i, const Vector &t,
+                                   const Matrix &R) {
+    Matrix pose(R.rows(), R.cols() + 1);
+    pose << t, R;
+    vertices.emplace_back(i, std::move(pose));
+  };
+
   // Open the file for reading
   std::ifstream infile(filename);
 
-  num_poses = 0;
+  max_id = 0;
 
   while (std::getline(infile, line)) {
     // Construct a stream from the string
@@ -123,9 +148,26 @@ measurements_t read_g2o_file(const std::string &filename, size_t &num_poses) {
       RotInfo << I44, I45, I46, I45, I55, I56, I46, I56, I66;
       measurement.kappa = 3 / (2 * RotInfo.inverse().trace());
 
-    } else if ((token == "VERTEX_SE2") || (token == "VERTEX_SE3:QUAT")) {
-      // This is just initialization information, so do nothing
+    } else if (token == "VERTEX_SE2") {
+      // This is a 2D pose estimate, specified in the form:
+      //
+      // VERTEX_SE2 id x y theta
+      strstrm >> i >> dx >> dy >> dtheta;
+      record_vertex(i, Eigen::Matrix<Scalar, 2, 1>(dx, dy),
+                    Eigen::Rotation2D<Scalar>(dtheta).toRotationMatrix());
       continue;
+
+    } else if (token == "VERTEX_SE3:QUAT") {
+      // This is a 3D pose estimate, specified in the form:
+      //
+      // VERTEX_SE3:QUAT id x y z qx qy qz qw
+      strstrm >> i >> dx >> dy >> dz >> dqx >> dqy >> dqz >> dqw;
+      record_vertex(i, Eigen::Matrix<Scalar, 3, 1>(dx, dy, dz),
+                    Eigen::Quaternion<Scalar>(dqw, dqx, dqy, dqz)
+                        .normalized()
+                        .toRotationMatrix());
+      continue;
+
     } else {
       std::cout << "Error: unrecognized type: " << token << "!" << std::endl;
       assert(false);
@@ -134,17 +176,339 @@ measurements_t read_g2o_file(const std::string &filename, size_t &num_poses) {
     // Update maximum value of poses found so far
     size_t max_pair = std::max<size_t>(measurement.i, measurement.j);
 
-    num_poses = ((max_pair > num_poses) ? max_pair : num_poses);
+    max_id = ((max_pair > max_id) ? max_pair : max_id);
     measurements.push_back(measurement);
   } // while
 
   infile.close();
 
+  return measurements;
+}
+
+/** Helper function: assembles the vertex estimates of the n poses of a
+ * problem with measurements of dimension d into a d x (d+1)n matrix
+ * xhat = [t | R], using 'index' to map the ID of each vertex to the index of
+ * the corresponding pose (or to n, if there is no such pose).  This returns
+ * nullopt if some pose lacks an estimate. */
+template <typename IndexFunction>
+static std::optional<Matrix> assemble_vertex_estimates(
+    const std::vector<std::pair<size_t, Matrix>> &vertices, size_t d, size_t n,
+    IndexFunction index) {
+  if (n == 0 || vertices.size() < n)
+    return std::nullopt;
+
+  Matrix xhat(d, (d + 1) * n);
+  std::vector<bool> found(n, false);
+  size_t num_found = 0;
+  for (const std::pair<size_t, Matrix> &vertex : vertices) {
+    const size_t k = index(vertex.first);
+    if (k >= n || static_cast<size_t>(vertex.second.rows()) != d)
+      continue;
+
+    xhat.col(k) = vertex.second.col(0);
+    xhat.block(0, n + k * d, d, d) = vertex.second.rightCols(d);
+    if (!found[k]) {
+      found[k] = true;
+      ++num_found;
+    }
+  }
+
+  if (num_found < n)
+    return std::nullopt;
+  return xhat;
+}
+
+measurements_t read_g2o_file(const std::string &filename, size_t &num_poses) {
+  std::optional<Matrix> vertex_estimates;
+  return read_g2o_file(filename, num_poses, vertex_estimates);
+}
+
+measurements_t read_g2o_file(const std::string &filename, size_t &num_poses,
+                             std::optional<Matrix> &vertex_estimates) {
+  std::vector<std::pair<size_t, Matrix>> vertices;
+  measurements_t measurements = parse_g2o_file(filename, num_poses, vertices);
   num_poses++; // Account for the use of zero-based indexing
 
+  vertex_estimates.reset();
+  if (!measurements.empty())
+    vertex_estimates = assemble_vertex_estimates(
+        vertices, measurements[0].t.size(), num_poses,
+        [num_poses](size_t id) { return std::min(id, num_poses); });
+
   return measurements;
 }
 
+measurements_t read_g2o_file(const std::string &filename, size_t &num_poses,
+                             std::optional<Matrix> &vertex_estimates,
+                             PoseIDMap &pose_ids) {
+  std::vector<std::pair<size_t, Matrix>> vertices;
+  size_t max_id;
+  measurements_t measurements = parse_g2o_file(filename, max_id, vertices);
+  pose_ids = compact_pose_ids(measurements);
+  num_poses = pose_ids.size();
+
+  vertex_estimates.reset();
+  if (!measurements.empty())
+    vertex_estimates = assemble_vertex_estimates(
+        vertices, measurements[0].t.size(), num_poses,
+        [&pose_ids](size_t id) { return pose_ids.find(id); });
+
+  return measurements;
+}
+
+size_t PoseIDMap::find(size_t id) const {
+  auto it = std::lower_bound(ids.begin(), ids.end(), id);
+  return ((it != ids.end() && *it == id) ? it - ids.begin() : ids.size());
+}
+
+size_t PoseIDMap::index(size_t id) const {
+  size_t k = find(id);
+  if (k == ids.size())
+    throw std::out_of_range("Pose ID " + std::to_string(id) +
+                            " does not appear in the measurements");
+  return k;
+}
+
+PoseIDMap pose_id_map(const measurements_t &measurements) {
+  PoseIDMap map;
+  std::vector<size_t> &ids = map.ids;
+
+  // Gather the IDs of the endpoints of every measurement
+  ids.resize(2 * measurements.size());
+#pragma omp parallel for schedule(static)
+  for (size_t k = 0; k < measurements.size(); ++k) {
+    ids[2 * k] = measurements[k].i;
+    ids[2 * k + 1] = measurements[k].j;
+  }
+
+  // Sort and deduplicate them, so that the dense relabeling preserves the
+  // original ordering of the poses (and hence the locality of e.g. odometry
+  // chains)
+  std::sort(ids.begin(), ids.end());
+  ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+  ids.shrink_to_fit();
+
+  return map;
+}
+
+void remap_pose_ids(measurements_t &measurements, const PoseIDMap &map) {
+  if (map.is_identity())
+    return;
+
+#pragma omp parallel for schedule(static)
+  for (size_t k = 0; k < measurements.size(); ++k) {
+    measurements[k].i = map.find(measurements[k].i);
+    measurements[k].j = map.find(measurements[k].j);
+  }
+}
+
+PoseIDMap compact_pose_ids(measurements_t &measurements) {
+  PoseIDMap map = pose_id_map(measurements);
+  remap_pose_ids(measurements, map);
+  return map;
+}
+
+const measurements_t &compacted_measurements(const measurements_t &measurements,
+                                             measurements_t &storage,
+                                             PoseIDMap &pose_ids) {
+  pose_ids = pose_id_map(measurements);
+  if (pose_ids.is_identity())
+    return measurements;
+
+  storage = measurements;
+  remap_pose_ids(storage, pose_ids);
+  return storage;
+}
+
+uint64_t measurements_fingerprint(const measurements_t &measurements) {
+  // 64-bit FNV-1a hash
+  const uint64_t prime = 0x100000001b3ULL;
+  uint64_t h = 0xcbf29ce484222325ULL;
+
+  auto hash_bytes = [&h, prime](const void *data, size_t size) {
+    const unsigned char *bytes = static_cast<const unsigned char *>(data);
+    for (size_t k = 0; k < size; ++k) {
+      h ^= bytes[k];
+      h *= prime;
+    }
+  };
+
+  uint64_t m = measurements.size();
+  hash_bytes(&m, sizeof(m));
+
+  for (const RelativePoseMeasurement &measurement : measurements) {
+    uint64_t ij[2] = {measurement.i, measurement.j};
+    hash_bytes(ij, sizeof(ij));
+    hash_bytes(measurement.R.data(), measurement.R.size() * sizeof(Scalar));
+    hash_bytes(measurement.t.data(), measurement.t.size() * sizeof(Scalar));
+    hash_bytes(&measurement.kappa, sizeof(Scalar));
+    hash_bytes(&measurement.tau, sizeof(Scalar));
+  }
+  return h;
+}
+
+/** Helper functions: advance the output (resp. input) position of a binary
+ * stream to the next multiple of binary_alignment bytes */
+static void align_binary(std::ostream &out) {
+  size_t pad = (binary_alignment - static_cast<size_t>(out.tellp()) %
+                                       binary_alignment) %
+               binary_alignment;
+  static const char zeros[binary_alignment] = {};
+  out.write(zeros, pad);
+}
+
+static void align_binary(std::istream &in) {
+  size_t pad = (binary_alignment - static_cast<size_t>(in.tellg()) %
+                                       binary_alignment) %
+               binary_alignment;
+  in.seekg(pad, std::ios_base::cur);
+}
+
+/** Helper functions: write (resp. read) an aligned array of 'count' elements
+ * of type T */
+template <typename T>
+static void write_binary_array(std::ostream &out, const T *data, size_t count) {
+  align_binary(out);
+  out.write(reinterpret_cast<const char *>(data), count * sizeof(T));
+}
+
+template <typename T>
+static void read_binary_array(std::istream &in, T *data, size_t count) {
+  align_binary(in);
+  if (!in.read(reinterpret_cast<char *>(data), count * sizeof(T)))
+    throw std::runtime_error("Unexpected end of binary stream");
+}
+
+uint64_t remaining_binary_bytes(std::istream &in) {
+  const std::streamoff position = in.tellg();
+  if (position < 0)
+    throw std::runtime_error("Unexpected end of binary stream");
+  in.seekg(0, std::ios_base::end);
+  const std::streamoff end = in.tellg();
+  in.seekg(position, std::ios_base::beg);
+  if (end < position)
+    throw std::runtime_error("Unexpected end of binary stream");
+  return static_cast<uint64_t>(end - position);
+}
+
+void write_binary(std::ostream &out, const Matrix &X) {
+  write_binary<uint64_t>(out, X.rows());
+  write_binary<uint64_t>(out, X.cols());
+  write_binary_array(out, X.data(), X.size());
+}
+
+void read_binary(std::istream &in, Matrix &X) {
+  uint64_t rows, cols;
+  read_binary(in, rows);
+  read_binary(in, cols);
+
+  // Reject dimensions that exceed the data remaining in the stream before
+  // allocating anything
+  const uint64_t max_size = remaining_binary_bytes(in) / sizeof(Scalar);
+  if (rows > max_size || (rows > 0 && cols > max_size / rows))
+    throw std::runtime_error(
+        "Invalid dense matrix dimensions in binary stream");
+
+  X.resize(rows, cols);
+  read_binary_array(in, X.data(), X.size());
+}
+
+void write_binary(std::ostream &out, const SparseMatrix &S) {
+  // Ensure that we are writing a matrix in compressed format
+  SparseMatrix C = S;
+  C.makeCompressed();
+
+  write_binary<uint64_t>(out, C.rows());
+  write_binary<uint64_t>(out, C.cols());
+  write_binary<uint64_t>(out, C.nonZeros());
+  write_binary_array(out, C.outerIndexPtr(), C.outerSize() + 1);
+  write_binary_array(out, C.innerIndexPtr(), C.nonZeros());
+  write_binary_array(out, C.valuePtr(), C.nonZeros());
+}
+
+void read_binary(std::istream &in, SparseMatrix &S) {
+  uint64_t rows, cols, nnz;
+  read_binary(in, rows);
+  read_binary(in, cols);
+  read_binary(in, nnz);
+
+  // Reject dimensions that cannot be represented by the storage index type
+  // before allocating anything
+  const uint64_t max_index =
+      std::numeric_limits<SparseMatrix::StorageIndex>::max();
+  if (rows > max_index || cols > max_index || nnz > max_index ||
+      nnz > remaining_binary_bytes(in) / sizeof(Scalar))
+    throw std::runtime_error(
+        "Invalid sparse matrix dimensions in binary stream");
+
+  S.resize(rows, cols);
+  S.resizeNonZeros(nnz);
+  read_binary_array(in, S.outerIndexPtr(), S.outerSize() + 1);
+  read_binary_array(in, S.innerIndexPtr(), nnz);
+  read_binary_array(in, S.valuePtr(), nnz);
+
+  // Validate the compressed structure, since every subsequent operation on S
+  // trusts these indices
+  const SparseMatrix::StorageIndex *outer = S.outerIndexPtr();
+  const SparseMatrix::StorageIndex *inner = S.innerIndexPtr();
+  bool valid = (outer[0] == 0) &&
+               (static_cast<uint64_t>(outer[S.outerSize()]) == nnz);
+  for (Eigen::Index k = 0; valid && k < S.outerSize(); ++k)
+    valid = (outer[k] <= outer[k + 1]);
+  for (uint64_t k = 0; valid && k < nnz; ++k)
+    valid = (inner[k] >= 0 && inner[k] < S.innerSize());
+  if (!valid)
+    throw std::runtime_error(
+        "Invalid sparse matrix structure in binary stream");
+}
+
+void write_binary(std::ostream &out, const std::string &value) {
+  write_binary<uint64_t>(out, value.size());
+  out.write(value.data(), value.size());
+}
+
+void read_binary(std::istream &in, std::string &value) {
+  value.resize(read_binary_length(in, 1));
+  if (!in.read(&value[0], value.size()))
+    throw std::runtime_error("Unexpected end of binary stream");
+}
+
+void write_binary(std::ostream &out, const std::vector<size_t> &values) {
+  write_binary<uint64_t>(out, values.size());
+  for (size_t value : values)
+    write_binary<uint64_t>(out, value);
+}
+
+void read_binary(std::istream &in, std::vector<size_t> &values) {
+  values.resize(read_binary_length(in, sizeof(uint64_t)));
+  for (size_t &value : values) {
+    uint64_t v;
+    read_binary(in, v);
+    value = v;
+  }
+}
+
+uint64_t read_binary_length(std::istream &in, size_t min_element_size) {
+  uint64_t length;
+  read_binary(in, length);
+  if (length > remaining_binary_bytes(in) / min_element_size)
+    throw std::runtime_error("Invalid vector length in binary stream");
+  return length;
+}
+
+uint64_t binary_checksum(const char *data, size_t size) {
+  // 64-bit FNV-1a hash
+  const uint64_t prime = 0x100000001b3ULL;
+  uint64_t h = 0xcbf29ce484222325ULL;
+
+  const unsigned char *bytes = reinterpret_cast<const unsigned char *>(data);
+  for (size_t k = 0; k < size; ++k) {
+    h ^= bytes[k];
+    h *= prime;
+  }
+  return h;
+}
+
 SparseMatrix construct_rotational_weight_graph_Laplacian(
     const measurements_t &measurements) {
 
@@ -564,7 +928,8 @@ SparseMatrix construct_M_matrix(const measurements_t &measurements) {
   return M;
 }
 
-Matrix chordal_initialization(size_t d, const SparseMatrix &B3) {
+Matrix chordal_initialization(size_t d, const SparseMatrix &B3,
+                              size_t num_threads) {
   size_t d2 = d * d;
   size_t num_poses = B3.cols() / d2;
 
@@ -590,8 +955,13 @@ Matrix chordal_initialization(size_t d, const SparseMatrix &B3) {
   Vector cR = B3.leftCols(d2) * Id_vec;
 
   Vector rvec;
-  Eigen::SPQR<SparseMatrix> QR(B3red);
-  rvec = -QR.solve(cR);
+  {
+    ScopedThreadingPhase threading(ThreadingPhase::Factorization, num_threads);
+    Eigen::SPQR<SparseMatrix> QR;
+    configure_cholmod_threads(*QR.cholmodCommon(), num_threads);
+    QR.compute(B3red);
+    rvec = -QR.solve(cR);
+  }
 
   Matrix Rchordal(d, d * num_poses);
   Rchordal.leftCols(d) = Id;
@@ -604,8 +974,81 @@ Matrix chordal_initialization(size_t d, const SparseMatrix &B3) {
   return Rchordal;
 }
 
+Matrix spanning_tree_initialization(const measurements_t &measurements) {
+  size_t d = (!measurements.empty() ? measurements[0].R.rows() : 0);
+  size_t num_poses = 0;
+  for (const RelativePoseMeasurement &measurement : measurements)
+    num_poses = std::max(num_poses, std::max(measurement.i, measurement.j) + 1);
+
+  // Incident measurements of each pose
+  std::vector<std::vector<size_t>> incident(num_poses);
+  for (size_t e = 0; e < measurements.size(); ++e) {
+    incident[measurements[e].i].push_back(e);
+    incident[measurements[e].j].push_back(e);
+  }
+
+  Matrix xhat = Matrix::Zero(d, (d + 1) * num_poses);
+  auto t = [&xhat](size_t k) { return xhat.col(k); };
+  auto R = [&xhat, d, num_poses](size_t k) {
+    return xhat.block(0, num_poses + k * d, d, d);
+  };
+
+  /// Grow a maximum-weight spanning tree of each connected component using
+  /// Prim's algorithm, composing the measurements along its edges:  for a
+  /// measurement x_ij of the relative transform from pose i to pose j,
+  ///
+  /// R_j = R_i * R_ij,  t_j = t_i + R_i * t_ij
+
+  std::vector<bool> reached(num_poses, false);
+
+  // Frontier measurements, ordered by decreasing rotational precision
+  typedef std::pair<Scalar, size_t> WeightedEdge;
+  std::priority_queue<WeightedEdge> frontier;
+
+  auto reach = [&](size_t k) {
+    reached[k] = true;
+    for (size_t e : incident[k]) {
+      size_t other = (measurements[e].i == k ? measurements[e].j
+                                             : measurements[e].i);
+      if (!reached[other])
+        frontier.emplace(measurements[e].kappa, e);
+    }
+  };
+
+  for (size_t root = 0; root < num_poses; ++root) {
+    if (reached[root])
+      continue;
+
+    // Fix the root of this component to the origin
+    R(root).setIdentity();
+    reach(root);
+
+    while (!frontier.empty()) {
+      const RelativePoseMeasurement &measurement =
+          measurements[frontier.top().second];
+      frontier.pop();
+
+      size_t i = measurement.i, j = measurement.j;
+      if (reached[i] && reached[j])
+        continue;
+
+      if (reached[i]) {
+        R(j) = R(i) * measurement.R;
+        t(j) = t(i) + R(i) * measurement.t;
+        reach(j);
+      } else {
+        R(i) = R(j) * measurement.R.transpose();
+        t(i) = t(j) - R(i) * measurement.t;
+        reach(i);
+      }
+    }
+  }
+
+  return xhat;
+}
+
 Matrix recover_translations(const SparseMatrix &B1, const SparseMatrix &B2,
-                            const Matrix &R) {
+                            const Matrix &R, size_t num_threads) {
   size_t d = R.rows();
   size_t n = R.cols() / d;
 
@@ -630,8 +1073,14 @@ Matrix recover_translations(const SparseMatrix &B1, const SparseMatrix &B2,
   Vector c = B2 * rvec;
 
   // Solve
-  Eigen::SPQR<SparseMatrix> QR(B1red);
-  Vector tred = -QR.solve(c);
+  Vector tred;
+  {
+    ScopedThreadingPhase threading(ThreadingPhase::Factorization, num_threads);
+    Eigen::SPQR<SparseMatrix> QR;
+    configure_cholmod_threads(*QR.cholmodCommon(), num_threads);
+    QR.compute(B1red);
+    tred = -QR.solve(c);
+  }
 
   // Reshape this result into a d x (n-1) matrix
   Eigen::Map<Matrix> tred_mat(tred.data(), d, n - 1);
@@ -712,10 +1161,220 @@ Scalar dO(const Matrix &X, const Matrix &Y, Matrix *G_O) {
   return dO;
 }
 
+Scalar Frobenius_inner_product(const Matrix &A, const Matrix &B) {
+  assert(A.rows() == B.rows() && A.cols() == B.cols());
+
+  // Since A and B have the same dimensions and storage order, tr(A' * B) is
+  // simply the dot product of their underlying (contiguous) coefficient
+  // arrays.  We split these arrays into a fixed number of contiguous chunks,
+  // compute the dot product of each pair of chunks using Eigen's vectorized
+  // kernels (in parallel), and then sum the partial results in chunk order.
+  // Since neither the chunks nor the order of this final summation depend
+  // upon the number of threads, the result is reproducible bit-for-bit
+  // regardless of the threading configuration
+  const Eigen::Index N = A.size();
+  const Scalar *a = A.data();
+  const Scalar *b = B.data();
+
+  // Minimum number of elements for which it is worthwhile to spawn threads
+  const Eigen::Index min_parallel_size = 1 << 15;
+
+  if (N < min_parallel_size)
+    return Eigen::Map<const Vector>(a, N).dot(Eigen::Map<const Vector>(b, N));
+
+  constexpr Eigen::Index num_chunks = 64;
+  Scalar partial_sums[num_chunks];
+
+#pragma omp parallel for schedule(static)
+  for (Eigen::Index chunk = 0; chunk < num_chunks; ++chunk) {
+    Eigen::Index begin = (chunk * N) / num_chunks;
+    Eigen::Index end = ((chunk + 1) * N) / num_chunks;
+
+    partial_sums[chunk] =
+        Eigen::Map<const Vector>(a + begin, end - begin)
+            .dot(Eigen::Map<const Vector>(b + begin, end - begin));
+  }
+
+  Scalar s = 0;
+  for (Eigen::Index chunk = 0; chunk < num_chunks; ++chunk)
+    s += partial_sums[chunk];
+  return s;
+}
+
+Scalar Frobenius_norm(const Matrix &A) {
+  return std::sqrt(Frobenius_inner_product(A, A));
+}
+
+Scalar block_diagonal_trace(const Matrix &blocks, size_t d) {
+  size_t n = blocks.cols() / d;
+
+  Scalar tr = 0;
+#pragma omp parallel for reduction(+ : tr)
+  for (size_t i = 0; i < n; ++i)
+    for (size_t k = 0; k < d; ++k)
+      tr += blocks(k, i * d + k);
+
+  return tr;
+}
+
+Matrix reduce_rank(const Matrix &Y, size_t min_rank, Scalar rank_tol) {
+  size_t r = Y.rows();
+  if (min_rank >= r)
+    return Y;
+
+  // The squared singular values of Y are the eigenvalues of the (small) r x r
+  // Gram matrix Y * Y', which SelfAdjointEigenSolver returns in increasing
+  // order
+  Eigen::SelfAdjointEigenSolver<Matrix> eig(Y * Y.transpose());
+  const Vector &lambdas = eig.eigenvalues();
+  Scalar threshold = rank_tol * rank_tol * std::max<Scalar>(lambdas(r - 1), 0);
+
+  size_t k = min_rank;
+  while (k < r && lambdas(r - 1 - k) > threshold)
+    ++k;
+
+  if (k == r)
+    return Y;
+
+  // Rotate Y into the eigenbasis of Y * Y', retaining only the rows
+  // corresponding to the k largest singular values
+  return eig.eigenvectors().rightCols(k).rowwise().reverse().transpose() * Y;
+}
+
+std::pair<Scalar, Scalar> Lanczos_spectrum_bounds(
+    const Optimization::LinearAlgebra::SymmetricLinearOperator<Matrix> &A,
+    size_t n, size_t num_steps, uint64_t seed) {
+  num_steps = std::max<size_t>(std::min(num_steps, n), 1);
+
+  // Tridiagonal matrix T generated by the Lanczos process
+  Vector alpha = Vector::Zero(num_steps);
+  Vector beta = Vector::Zero(num_steps);
+
+  // Random starting vector
+  Vector v(n);
+  fill_standard_normal(v.data(), n, seed,
+                       static_cast<uint64_t>(RandomStream::Lanczos));
+  v.normalize();
+
+  Vector v_prev = Vector::Zero(n);
+  size_t k = 0;
+  for (; k < num_steps; ++k) {
+    Vector w = A(v);
+    alpha(k) = v.dot(w);
+    w -= alpha(k) * v + (k > 0 ? beta(k - 1) : 0) * v_prev;
+    beta(k) = w.norm();
+
+    if (beta(k) <= 1e-12 * std::abs(alpha(k))) {
+      // We have found an invariant subspace
+      ++k;
+      break;
+    }
+
+    v_prev = v;
+    v = w / beta(k);
+  }
+
+  Matrix T = Matrix::Zero(k, k);
+  T.diagonal() = alpha.head(k);
+  for (size_t i = 0; i + 1 < k; ++i)
+    T(i, i + 1) = T(i + 1, i) = beta(i);
+
+  Eigen::SelfAdjointEigenSolver<Matrix> eig(T, Eigen::EigenvaluesOnly);
+
+  // The largest Ritz value plus the norm of the final residual provides a
+  // (practically safe) upper bound for lambda_max(A)
+  return std::make_pair(eig.eigenvalues().minCoeff(),
+                        eig.eigenvalues().maxCoeff() + std::abs(beta(k - 1)));
+}
+
+std::pair<Vector, Matrix> Chebyshev_subspace_iteration(
+    const Optimization::LinearAlgebra::SymmetricLinearOperator<Matrix> &A,
+    size_t n, size_t nx, size_t degree, size_t max_iters, size_t &num_iters,
+    const std::function<bool(const Vector &, const Matrix &)> &stopfun,
+    uint64_t seed) {
+  nx = std::min(nx, n);
+  degree = std::max<size_t>(degree, 1);
+  num_iters = 0;
+
+  /// Estimate the spectral bounds of A using a few steps of Lanczos
+
+  Scalar lower, upper;
+  std::tie(lower, upper) = Lanczos_spectrum_bounds(A, n, 20, seed);
+
+  /// Initialize the block of eigenvector estimates X
+
+  Matrix X = random_normal_matrix(n, nx, seed, RandomStream::ChebyshevFilter);
+  X = Eigen::HouseholderQR<Matrix>(X).householderQ() * Matrix::Identity(n, nx);
+
+  // Initial Ritz values
+  Matrix AX = A(X);
+  Eigen::SelfAdjointEigenSolver<Matrix> eig(X.transpose() * AX);
+  Vector Theta = eig.eigenvalues();
+  X *= eig.eigenvectors();
+
+  for (num_iters = 1; num_iters <= max_iters; ++num_iters) {
+    if (stopfun && stopfun(Theta, X))
+      break;
+
+    /// Apply the Chebyshev filter of the given degree to X, using the
+    /// three-term recurrence of the scaled Chebyshev polynomials (cf. Zhou et
+    /// al., "Self-consistent-field calculations using Chebyshev-filtered
+    /// subspace iteration").  This damps the components of X corresponding to
+    /// the interval [a, b] = [max(Theta), upper] of (unwanted) eigenvalues,
+    /// and amplifies those below a (normalized so that the component at the
+    /// lowest estimated eigenvalue a0 is preserved)
+
+    const Scalar a = Theta.maxCoeff();
+    const Scalar a0 = std::min(Theta.minCoeff(), lower);
+    if (!(upper > a) || !(a > a0))
+      break; // The filter interval has collapsed
+
+    const Scalar e = (upper - a) / 2;
+    const Scalar c = (upper + a) / 2;
+    Scalar sigma = e / (a0 - c);
+    const Scalar tau = 2 / sigma;
+
+    Matrix Y = (A(X) - c * X) * (sigma / e);
+    for (size_t k = 2; k <= degree; ++k) {
+      const Scalar sigma_next = 1 / (tau - sigma);
+      Matrix Ynext =
+          (A(Y) - c * Y) * (2 * sigma_next / e) - (sigma * sigma_next) * X;
+      X = std::move(Y);
+      Y = std::move(Ynext);
+      sigma = sigma_next;
+    }
+
+    /// Orthonormalize the filtered block and perform a Rayleigh-Ritz
+    /// projection (this is the only dense orthogonalization per degree
+    /// applications of A)
+    X = Eigen::HouseholderQR<Matrix>(Y).householderQ() *
+        Matrix::Identity(n, nx);
+    AX = A(X);
+    eig.compute(X.transpose() * AX);
+    Theta = eig.eigenvalues();
+    X *= eig.eigenvectors();
+  }
+
+  num_iters = std::min(num_iters, max_iters);
+  return std::make_pair(Theta, X);
+}
+
 bool fast_verification(const SparseMatrix &S, Scalar eta, size_t nx,
                        Scalar &theta, Vector &x, size_t &num_iters,
                        size_t max_iters, Scalar max_fill_factor,
-                       Scalar drop_tol) {
+                       Scalar drop_tol, SparseSolverBackend backend,
+                       const std::optional<Optimization::LinearAlgebra::
+                                               SymmetricLinearOperator<Matrix>>
+                           &precon,
+                       const Matrix &Z, VerificationEigensolver eigensolver,
+                       size_t Chebyshev_degree, double max_computation_time,
+                       uint64_t seed, size_t num_threads) {
+  auto verification_start_time = Stopwatch::tick();
+
+  // Whether M is to be factored directly (otherwise, the eigensolver can only
+  // search for a direction of negative curvature, and M is never certified)
+  const bool direct = (backend != SparseSolverBackend::PCG);
+
   // Don't forget to set this on input!
   num_iters = 0;
   theta = 0;
@@ -729,28 +1388,33 @@ bool fast_verification(const SparseMatrix &S, Scalar eta, size_t nx,
   Id.setIdentity();
   SparseMatrix M = S + eta * Id;
 
-  /// Test positive-semidefiniteness via direct Cholesky factorization
-  Eigen::CholmodSupernodalLLT<SparseMatrix> MChol;
-
-  /// Set various options for the factorization
-
-  // Bail out early if non-positive-semidefiniteness is detected
-  MChol.cholmod().quick_return_if_not_posdef = 1;
-
-  // We know that we might be handling a non-PSD matrix, so suppress Cholmod's
-  // printed error output
-  MChol.cholmod().print = 0;
-
-  // Calculate Cholesky decomposition!
-  MChol.compute(M);
+  bool PSD = false;
+  if (direct) {
+    /// Test positive-semidefiniteness via direct Cholesky factorization
+    std::unique_ptr<SparseFactorization> MChol =
+        make_sparse_factorization(backend);
+
+    // Bail out early (and quietly) if non-positive-semidefiniteness is
+    // detected
+    MChol->set_definiteness_test(true);
+
+    // Calculate Cholesky decomposition!
+    {
+      ScopedThreadingPhase threading(ThreadingPhase::Factorization,
+                                     num_threads);
+      MChol->set_num_threads(num_threads);
+      MChol->compute(M);
+    }
 
-  // Test whether the Cholesky decomposition succeeded
-  bool PSD = (MChol.info() == Eigen::Success);
+    // Test whether the Cholesky decomposition succeeded
+    PSD = MChol->success();
+  }
 
   if (!PSD) {
 
-    /// If control reaches here, then lambda_min(S) < -eta, so we must compute
-    /// an approximate minimum eigenpair using LOBPCG
+    /// If control reaches here, then either lambda_min(S) < -eta, or M could
+    /// not be factored directly; in either case, we must compute an
+    /// approximate minimum eigenpair using LOBPCG
 
     Vector Theta; // Vector to hold Ritz values of S
     Matrix X;     // Matrix to hold eigenvector estimates for S
@@ -763,14 +1427,38 @@ bool fast_verification(const SparseMatrix &S, Scalar eta, size_t nx,
     Optimization::LinearAlgebra::SymmetricLinearOperator<Matrix> Mop =
         [&M](const Matrix &X) -> Matrix { return M * X; };
 
+    // If we are given an orthonormal basis Z for a subspace of (known)
+    // near-null directions of S, then rather than requiring LOBPCG to
+    // rediscover these, we deflate them:  we instead operate with
+    //
+    // Md := P * M * P + sigma * Z * Z'
+    //
+    // where P := I - Z * Z' is the orthogonal projector onto the complement
+    // of span(Z), and sigma is an upper bound for lambda_max(M) (computed
+    // using Gershgorin's theorem).  Since S is symmetric, any eigenvector of S
+    // with a strictly negative eigenvalue is orthogonal to its nullspace, so
+    // the minimum eigenpair we seek is preserved, while the deflated
+    // directions are moved to the top of the spectrum
+    Scalar sigma = 0;
+    if (Z.size() != 0) {
+      sigma = (M.cwiseAbs() * Vector::Ones(n)).maxCoeff();
+
+      Mop = [&M, &Z, sigma](const Matrix &X) -> Matrix {
+        Matrix ZtX = Z.transpose() * X;
+        Matrix MPX = M * (X - Z * ZtX);
+        return MPX - Z * (Z.transpose() * MPX) + sigma * Z * ZtX;
+      };
+    }
+
     // Custom stopping criterion: terminate as soon as a direction of
     // sufficiently negative curvature is found:
     //
     // x'* S * x < - eta / 2
     //
+    // or the allotted computation time is exhausted
     Optimization::LinearAlgebra::LOBPCGUserFunction<Vector, Matrix> stopfun =
-        [&S,
-         eta](size_t i,
+        [&S, eta, &verification_start_time,
+         max_computation_time](size_t i,
               const Optimization::LinearAlgebra::SymmetricLinearOperator<Matrix>
                   &M,
               const std::optional<
@@ -781,11 +1469,36 @@ bool fast_verification(const SparseMatrix &S, Scalar eta, size_t nx,
                   &T,
               size_t nev, const Vector &Theta, const Matrix &X, const Vector &r,
               size_t nc) {
+          if (Stopwatch::tock(verification_start_time) >= max_computation_time)
+            return true;
+
           // Calculate curvature along estimated minimum eigenvector X0
           Scalar theta = X.col(0).dot(S * X.col(0));
           return (theta < -eta / 2);
         };
 
+    if (eigensolver == VerificationEigensolver::ChebyshevFilter) {
+      /// Compute a minimum eigenpair of M using Chebyshev-filtered subspace
+      /// iteration, whose work is dominated by (parallel) products with M
+      std::tie(Theta, X) = Chebyshev_subspace_iteration(
+          Mop, n, nx, Chebyshev_degree, max_iters, num_iters,
+          [&S, eta, &verification_start_time,
+           max_computation_time](const Vector &Theta, const Matrix &X) {
+            return (Stopwatch::tock(verification_start_time) >=
+                    max_computation_time) ||
+                   (X.col(0).dot(S * X.col(0)) < -eta / 2);
+          },
+          seed);
+
+      // Extract eigenvector estimate
+      x = X.col(0);
+
+      // Calculate curvature along x
+      theta = x.dot(S * x);
+
+      return PSD;
+    }
+
     /// STEP 2:  Try computing a minimum eigenpair of M using *unpreconditioned*
     /// LOBPCG.
 
@@ -805,7 +1518,8 @@ bool fast_verification(const SparseMatrix &S, Scalar eta, size_t nx,
             Optimization::LinearAlgebra::SymmetricLinearOperator<Matrix>>(),
         std::optional<
             Optimization::LinearAlgebra::SymmetricLinearOperator<Matrix>>(),
-        n, nx, 1, static_cast<size_t>(unprecon_iter_frac * max_iters),
+        random_normal_matrix(n, nx, seed, RandomStream::LOBPCG), 1,
+        static_cast<size_t>(unprecon_iter_frac * max_iters),
         num_iters, num_converged, 0.0,
         std::optional<
             Optimization::LinearAlgebra::LOBPCGUserFunction<Vector, Matrix>>(
@@ -817,7 +1531,8 @@ bool fast_verification(const SparseMatrix &S, Scalar eta, size_t nx,
     // Calculate curvature along x
     theta = x.dot(S * x);
 
-    if (!(theta < -eta / 2)) {
+    if (!(theta < -eta / 2) &&
+        Stopwatch::tock(verification_start_time) < max_computation_time) {
 
       /// STEP 3:  RUN PRECONDITIONED LOBPCG
 
@@ -828,28 +1543,52 @@ bool fast_verification(const SparseMatrix &S, Scalar eta, size_t nx,
 
       /// Set up preconditioning operator T
 
-      // Incomplete symmetric indefinite factorization of M
-
-      // Set drop tolerance and max fill factor for ILDL preconditioner
-      Preconditioners::ILDLOpts ildl_opts;
-      ildl_opts.max_fill_factor = max_fill_factor;
-      ildl_opts.drop_tol = drop_tol;
-
-      Preconditioners::ILDL Mfact(M, ildl_opts);
+      Optimization::LinearAlgebra::SymmetricLinearOperator<Matrix> T;
+      std::unique_ptr<Preconditioners::ILDL> Mfact;
+
+      if (precon) {
+        // Use the caller-supplied preconditioner, which requires no further
+        // factorization
+        T = *precon;
+      } else {
+        // Incomplete symmetric indefinite factorization of M
+
+        // Set drop tolerance and max fill factor for ILDL preconditioner
+        Preconditioners::ILDLOpts ildl_opts;
+        ildl_opts.max_fill_factor = max_fill_factor;
+        ildl_opts.drop_tol = drop_tol;
+
+        {
+          ScopedThreadingPhase threading(ThreadingPhase::Factorization,
+                                         num_threads);
+          Mfact = std::make_unique<Preconditioners::ILDL>(M, ildl_opts);
+        }
 
-      Optimization::LinearAlgebra::SymmetricLinearOperator<Matrix> T =
-          [&Mfact](const Matrix &X) -> Matrix {
-        // Preallocate output matrix TX
-        Matrix TX(X.rows(), X.cols());
+        T = [&Mfact](const Matrix &X) -> Matrix {
+          // Preallocate output matrix TX
+          Matrix TX(X.rows(), X.cols());
 
 #pragma omp parallel for
-        for (unsigned int i = 0; i < X.cols(); ++i) {
-          // Calculate TX by preconditioning the columns of X one-by-one
-          TX.col(i) = Mfact.solve(X.col(i), true);
-        }
+          for (unsigned int i = 0; i < X.cols(); ++i) {
+            // Calculate TX by preconditioning the columns of X one-by-one
+            TX.col(i) = Mfact->solve(X.col(i), true);
+          }
 
-        return TX;
-      };
+          return TX;
+        };
+      }
+
+      // Deflate the preconditioner consistently with Md: T acts as the
+      // original preconditioner on the complement of span(Z), and as (the
+      // inverse of) sigma * I on span(Z)
+      if (Z.size() != 0) {
+        Optimization::LinearAlgebra::SymmetricLinearOperator<Matrix> T0 = T;
+        T = [T0, &Z, sigma](const Matrix &X) -> Matrix {
+          Matrix ZtX = Z.transpose() * X;
+          Matrix TPX = T0(X - Z * ZtX);
+          return TPX - Z * (Z.transpose() * TPX) + (Z * ZtX) / sigma;
+        };
+      }
 
       /// Run preconditioned LOBPCG using the remaining alloted LOBPCG
       /// iterations
@@ -859,7 +1598,9 @@ bool fast_verification(const SparseMatrix &S, Scalar eta, size_t nx,
               Optimization::LinearAlgebra::SymmetricLinearOperator<Matrix>>(),
           std::optional<
               Optimization::LinearAlgebra::SymmetricLinearOperator<Matrix>>(T),
-          n, nx, 1, static_cast<size_t>((1.0 - unprecon_iter_frac) * max_iters),
+          random_normal_matrix(n, nx, seed,
+                               RandomStream::PreconditionedLOBPCG),
+          1, static_cast<size_t>((1.0 - unprecon_iter_frac) * max_iters),
           num_iters, num_converged, 0.0,
           std::optional<
               Optimization::LinearAlgebra::LOBPCGUserFunction<Vector, Matrix>>(
@@ -873,7 +1614,6 @@ bool fast_verification(const SparseMatrix &S, Scalar eta, size_t nx,
 
       num_iters += static_cast<size_t>(unprecon_iter_frac * num_iters);
     } // if (!(theta < -eta / 2))
-
   } // if(!PSD)
 
   return PSD;
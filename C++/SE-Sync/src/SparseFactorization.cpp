@@ -0,0 +1,215 @@
+#include <stdexcept>
+#include <vector>
+
+#include "SESync/SESync_threading.h"
+#include "SESync/SparseFactorization.h"
+
+namespace SESync {
+
+/// CHOLMOD
+
+size_t CholmodFactorization::memory_usage() const {
+  // Each factorization owns its own CHOLMOD Common struct, so the memory in use
+  // by that Common is precisely that required to store the factorization
+  return const_cast<Decomposition &>(chol_).cholmod().memory_inuse;
+}
+
+void CholmodFactorization::set_num_threads(size_t num_threads) {
+  configure_cholmod_threads(chol_.cholmod(), num_threads);
+}
+
+bool CholmodFactorization::export_factor(LDLTFactor &factor) const {
+  const cholmod_factor *F = chol_.factor();
+  if (!F || !success() || F->minor < F->n)
+    return false;
+
+  cholmod_common &common = const_cast<Decomposition &>(chol_).cholmod();
+
+  // Convert a copy of the factor to simplicial, packed LDL^T form, in which
+  // D is stored on the diagonal of the (otherwise unit) lower-triangular L
+  cholmod_factor *LDL =
+      cholmod_copy_factor(const_cast<cholmod_factor *>(F), &common);
+  if (!LDL)
+    return false;
+  cholmod_change_factor(CHOLMOD_REAL, false, false, true, true, LDL, &common);
+
+  const int n = static_cast<int>(LDL->n);
+  factor.permutation =
+      Eigen::Map<const Eigen::VectorXi>(static_cast<int *>(LDL->Perm), n);
+
+  cholmod_sparse *L = cholmod_factor_to_sparse(LDL, &common);
+  bool exported = (L != nullptr);
+  if (exported) {
+    Eigen::Map<const Eigen::SparseMatrix<Scalar, Eigen::ColMajor>> Lmap(
+        n, n, static_cast<int *>(L->p)[n], static_cast<int *>(L->p),
+        static_cast<int *>(L->i), static_cast<Scalar *>(L->x));
+
+    // Passing through row-major storage sorts the row indices in each column
+    factor.L = Eigen::SparseMatrix<Scalar, Eigen::RowMajor>(Lmap);
+    factor.D = factor.L.diagonal();
+    cholmod_free_sparse(&L, &common);
+  }
+
+  cholmod_free_factor(&LDL, &common);
+  return exported;
+}
+
+void CholmodFactorization::set_definiteness_test(bool test) {
+  if (test) {
+    chol_.setMode(Eigen::CholmodSupernodalLLt);
+
+    // Bail out early if non-positive-definiteness is detected
+    chol_.cholmod().quick_return_if_not_posdef = 1;
+
+    // We know that we might be handling a non-PSD matrix, so suppress
+    // Cholmod's printed error output
+    chol_.cholmod().print = 0;
+  } else {
+    chol_.setMode(Eigen::CholmodAuto);
+    chol_.cholmod().quick_return_if_not_posdef = 0;
+  }
+}
+
+/// SIMPLICIAL LDL^T
+
+void SimplicialLDLTFactorization::analyze(const SparseMatrix &A) {
+  LDLT_.analyzePattern(ColMajorSparseMatrix(A));
+}
+
+void SimplicialLDLTFactorization::factorize(const SparseMatrix &A) {
+  LDLT_.factorize(ColMajorSparseMatrix(A));
+
+  // A is positive-definite if and only if its LDL^T factorization exists and
+  // D > 0
+  positive_definite_ = (LDLT_.info() == Eigen::Success) &&
+                       (LDLT_.vectorD().size() == 0 ||
+                        LDLT_.vectorD().minCoeff() > 0);
+}
+
+bool SimplicialLDLTFactorization::export_factor(LDLTFactor &factor) const {
+  if (!positive_definite_)
+    return false;
+
+  // Eigen computes P * A * P^T = L * D * L^T, and solves by applying P^-1
+  factor.L = LDLT_.matrixL().nestedExpression();
+  factor.D = LDLT_.vectorD();
+  factor.permutation = LDLT_.permutationPinv().indices();
+  return true;
+}
+
+size_t SimplicialLDLTFactorization::memory_usage() const {
+  if (LDLT_.info() != Eigen::Success)
+    return 0;
+
+  // Compressed storage of L, the diagonal D, and the fill-reducing permutation
+  const size_t n = LDLT_.rows();
+  return LDLT_.matrixL().nestedExpression().nonZeros() *
+             (sizeof(Scalar) + sizeof(ColMajorSparseMatrix::StorageIndex)) +
+         n * (sizeof(Scalar) + 3 * sizeof(ColMajorSparseMatrix::StorageIndex));
+}
+
+/// PRECONDITIONED CONJUGATE GRADIENTS
+
+PCGSolver::PCGSolver(Scalar tolerance, size_t max_iterations) {
+  CG_.setTolerance(tolerance);
+  CG_.setMaxIterations(max_iterations);
+}
+
+void PCGSolver::factorize(const SparseMatrix &A) {
+  // Cache a copy of A, since the iteration keeps a reference to it
+  A_ = A;
+  CG_.compute(A_);
+}
+
+size_t PCGSolver::memory_usage() const {
+  typedef SparseMatrix::StorageIndex StorageIndex;
+
+  // Storage for A itself and for its incomplete Cholesky factor
+  const size_t nnz = A_.nonZeros() +
+                     CG_.preconditioner().matrixL().nonZeros();
+  return nnz * (sizeof(Scalar) + sizeof(StorageIndex)) +
+         2 * A_.rows() * sizeof(StorageIndex);
+}
+
+/// STORED LDL^T FACTORIZATION
+
+StoredLDLTFactorization::StoredLDLTFactorization(LDLTFactor factor,
+                                                 SparseSolverBackend backend)
+    : factor_(std::move(factor)), backend_(backend) {
+  const Eigen::Index n = factor_.L.rows();
+  if (factor_.L.cols() != n || factor_.D.size() != n ||
+      factor_.permutation.size() != n)
+    throw std::invalid_argument("Inconsistent dimensions in LDL^T factor");
+
+  // Verify that the stored permutation is in fact a permutation, since an
+  // invalid one would cause solve() to access out-of-range rows
+  std::vector<bool> seen(n, false);
+  for (Eigen::Index k = 0; k < n; ++k) {
+    const int i = factor_.permutation(k);
+    if (i < 0 || i >= n || seen[i])
+      throw std::invalid_argument("Invalid permutation in LDL^T factor");
+    seen[i] = true;
+  }
+}
+
+void StoredLDLTFactorization::factorize(const SparseMatrix &A) {
+  SimplicialLDLTFactorization LDLT;
+  LDLT.compute(A);
+  if (!LDLT.export_factor(factor_))
+    factor_.D.setZero();
+}
+
+Matrix StoredLDLTFactorization::solve(const Matrix &B) const {
+  const Eigen::Index n = factor_.permutation.size();
+
+  Matrix X(B.rows(), B.cols());
+  for (Eigen::Index k = 0; k < n; ++k)
+    X.row(k) = B.row(factor_.permutation(k));
+
+  factor_.L.triangularView<Eigen::UnitLower>().solveInPlace(X);
+  X = factor_.D.cwiseInverse().asDiagonal() * X;
+  factor_.L.transpose().triangularView<Eigen::UnitUpper>().solveInPlace(X);
+
+  Matrix Y(B.rows(), B.cols());
+  for (Eigen::Index k = 0; k < n; ++k)
+    Y.row(factor_.permutation(k)) = X.row(k);
+  return Y;
+}
+
+bool StoredLDLTFactorization::success() const {
+  return factor_.D.size() == 0 || factor_.D.minCoeff() > 0;
+}
+
+size_t StoredLDLTFactorization::memory_usage() const {
+  typedef Eigen::SparseMatrix<Scalar, Eigen::ColMajor>::StorageIndex
+      StorageIndex;
+
+  const size_t n = factor_.L.rows();
+  return factor_.L.nonZeros() * (sizeof(Scalar) + sizeof(StorageIndex)) +
+         n * (sizeof(Scalar) + 2 * sizeof(StorageIndex));
+}
+
+bool StoredLDLTFactorization::export_factor(LDLTFactor &factor) const {
+  if (!success())
+    return false;
+  factor = factor_;
+  return true;
+}
+
+std::unique_ptr<SparseFactorization>
+make_sparse_factorization(SparseSolverBackend backend,
+                          const SparseSolverOpts &opts) {
+  switch (backend) {
+  case SparseSolverBackend::Cholmod:
+    return std::make_unique<CholmodFactorization>();
+  case SparseSolverBackend::SimplicialLDLT:
+    return std::make_unique<SimplicialLDLTFactorization>();
+  case SparseSolverBackend::PCG:
+    return std::make_unique<PCGSolver>(opts.PCG_tolerance,
+                                       opts.PCG_max_iterations);
+  default:
+    throw std::invalid_argument("Unrecognized sparse solver backend");
+  }
+}
+
+} // namespace SESync
@@ -2,6 +2,7 @@
 #include <Eigen/QR>
 #include <Eigen/SVD>
 
+#include "SESync/SESync_random.h"
 #include "SESync/StiefelProduct.h"
 namespace SESync {
 
@@ -52,17 +53,10 @@ Matrix StiefelProduct::retract(const Matrix &Y, const Matrix &V) const {
   return project(Y + V);
 }
 
-Matrix StiefelProduct::random_sample(
-    const std::default_random_engine::result_type &seed) const {
+Matrix StiefelProduct::random_sample(uint64_t seed) const {
   // Generate a matrix of the appropriate dimension by sampling its elements
   // from the standard Gaussian
-  std::default_random_engine generator(seed);
-  std::normal_distribution<Scalar> g;
-
-  Matrix R(p_, k_ * n_);
-  for (size_t r = 0; r < p_; ++r)
-    for (size_t c = 0; c < k_ * n_; ++c)
-      R(r, c) = g(generator);
-  return project(R);
+  return project(
+      random_normal_matrix(p_, k_ * n_, seed, RandomStream::StiefelSample));
 }
 } // namespace SESync
@@ -0,0 +1,163 @@
+/** This example checks SESyncBatch against SESync(), and compares their
+ * throughput.
+ *
+ * A batch of problems is generated by perturbing the measurements of the
+ * pose-graph in the passed .g2o file (so that every problem shares its
+ * topology).  Each problem is then solved both by SESyncBatch and (one at a
+ * time) by SESync() using the Simplified formulation; the program reports the
+ * largest discrepancies between the two in the optimal value of the
+ * relaxation, the objective value of the rounded solution, and the rounded
+ * solution itself (after fixing the gauge symmetry), together with the number
+ * of problems solved per second by each.  It exits with a nonzero status if
+ * the two disagree.
+ *
+ * Copyright (C) 2016 - 2022 by David M. Rosen (dmrosen@mit.edu)
+ */
+
+#include "SESync/SESync.h"
+#include "SESync/SESyncBatch.h"
+#include "SESync/SESync_utils.h"
+
+#include "Optimization/Util/Stopwatch.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+using namespace std;
+using namespace SESync;
+
+/** Relative tolerance for the agreement of SESyncBatch and SESync() */
+const Scalar agreement_tol = 1e-4;
+
+/** Helper function:  returns a random rotation in SO(d) (the Cayley transform
+ * of a random skew-symmetric matrix whose elements have standard deviation
+ * sigma) */
+Matrix random_rotation(size_t d, Scalar sigma, mt19937 &generator) {
+  normal_distribution<Scalar> normal(0, sigma);
+  Matrix Omega = Matrix::Zero(d, d);
+  for (size_t i = 0; i < d; ++i)
+    for (size_t j = i + 1; j < d; ++j) {
+      Omega(i, j) = normal(generator);
+      Omega(j, i) = -Omega(i, j);
+    }
+  const Matrix I = Matrix::Identity(d, d);
+  return (I - .5 * Omega).lu().solve(I + .5 * Omega);
+}
+
+/** Helper function:  expresses the poses xhat = [t | R] relative to the first
+ * pose, which fixes the gauge symmetry of the synchronization problem */
+Matrix fix_gauge(const Matrix &xhat, size_t n, size_t d) {
+  const Matrix R1t = xhat.block(0, n, d, d).transpose();
+  const Vector t1 = xhat.col(0);
+
+  Matrix aligned(d, n * (d + 1));
+  for (size_t i = 0; i < n; ++i) {
+    aligned.col(i) = R1t * (xhat.col(i) - t1);
+    aligned.block(0, n + i * d, d, d) = R1t * xhat.block(0, n + i * d, d, d);
+  }
+  return aligned;
+}
+
+int main(int argc, char **argv) {
+  if (argc < 2 || argc > 4) {
+    cout << "Usage: " << argv[0]
+         << " [input .g2o file] [number of problems (default 64)]"
+         << " [noise level (default 0.05)]" << endl;
+    exit(1);
+  }
+
+  size_t num_poses;
+  measurements_t measurements = read_g2o_file(argv[1], num_poses);
+  if (measurements.size() == 0) {
+    cout << "Error: No measurements were read!"
+         << " Are you sure the file exists?" << endl;
+    exit(1);
+  }
+
+  const size_t L = (argc > 2 ? stoul(argv[2]) : 64);
+  const Scalar sigma = (argc > 3 ? stod(argv[3]) : .05);
+  const size_t d = measurements[0].R.rows();
+
+  cout << "Generating " << L << " perturbations of the " << num_poses
+       << "-pose problem in file " << argv[1] << endl
+       << endl;
+
+  mt19937 generator(0);
+  normal_distribution<Scalar> normal(0, sigma);
+  vector<measurements_t> problems(L, measurements);
+  for (measurements_t &problem : problems)
+    for (RelativePoseMeasurement &m : problem) {
+      m.R = m.R * random_rotation(d, sigma, generator);
+      for (size_t k = 0; k < d; ++k)
+        m.t(k) += normal(generator);
+    }
+
+  /// Solve using SESyncBatch
+
+  auto start_time = Stopwatch::tick();
+  SESyncBatch batch(problems);
+  vector<SESyncBatchResult> batch_results = batch.solve();
+  double batch_time = Stopwatch::tock(start_time);
+
+  /// Solve using SESync()
+
+  SESyncOpts opts;
+  opts.verbose = false;
+  opts.formulation = Formulation::Simplified;
+  opts.initialization = Initialization::Chordal;
+
+  vector<SESyncResult> results(L);
+  start_time = Stopwatch::tick();
+  for (size_t l = 0; l < L; ++l)
+    results[l] = SESync::SESync(problems[l], opts);
+  double SESync_time = Stopwatch::tock(start_time);
+
+  /// Compare
+
+  Scalar max_SDPval_err = 0, max_Fxhat_err = 0, max_xhat_err = 0;
+  size_t num_certified = 0, num_compared = 0;
+  for (size_t l = 0; l < L; ++l) {
+    if (batch_results[l].status == GlobalOpt)
+      ++num_certified;
+
+    // Only solutions that both methods certify as globally optimal are
+    // guaranteed to agree
+    if (batch_results[l].status != GlobalOpt || results[l].status != GlobalOpt)
+      continue;
+    ++num_compared;
+
+    const Scalar scale = std::max<Scalar>(1, fabs(results[l].SDPval));
+    max_SDPval_err = std::max(
+        max_SDPval_err, fabs(batch_results[l].SDPval - results[l].SDPval) /
+                            scale);
+    max_Fxhat_err = std::max(
+        max_Fxhat_err, fabs(batch_results[l].Fxhat - results[l].Fxhat) /
+                           scale);
+
+    const Matrix xhat = fix_gauge(results[l].xhat, num_poses, d);
+    max_xhat_err = std::max(
+        max_xhat_err,
+        (fix_gauge(batch_results[l].xhat, num_poses, d) - xhat).norm() /
+            std::max<Scalar>(1, xhat.norm()));
+  }
+
+  cout << "SESyncBatch: " << L / batch_time << " problems/sec ("
+       << num_certified << " of " << L << " certified globally optimal)"
+       << endl;
+  cout << "SESync():    " << L / SESync_time << " problems/sec" << endl
+       << endl;
+
+  cout << "Compared " << num_compared << " problems certified by both methods"
+       << endl;
+  cout << "Maximum relative discrepancy in SDPval: " << max_SDPval_err << endl;
+  cout << "Maximum relative discrepancy in Fxhat:  " << max_Fxhat_err << endl;
+  cout << "Maximum relative discrepancy in xhat:   " << max_xhat_err << endl;
+
+  if (num_compared < num_certified || max_SDPval_err > agreement_tol ||
+      max_Fxhat_err > agreement_tol || max_xhat_err > agreement_tol) {
+    cout << "Error: SESyncBatch and SESync() disagree!" << endl;
+    return 1;
+  }
+}
@@ -18,8 +18,13 @@ int main(int argc, char **argv) {
     exit(1);
   }
 
+  // Pose IDs are relabeled densely (pose_ids records the original IDs), so
+  // that files with sparse or non-contiguous IDs are handled efficiently
   size_t num_poses;
-  measurements_t measurements = read_g2o_file(argv[1], num_poses);
+  std::optional<Matrix> vertex_estimates;
+  PoseIDMap pose_ids;
+  measurements_t measurements =
+      read_g2o_file(argv[1], num_poses, vertex_estimates, pose_ids);
   cout << "Loaded " << measurements.size() << " measurements between "
        << num_poses << " poses from file " << argv[1] << endl
        << endl;
@@ -33,9 +38,15 @@ int main(int argc, char **argv) {
   opts.verbose = true; // Print output to stdout
 
   // Initialization method
-  // Options are:  Chordal, Random
+  // Options are:  Chordal, Random, FromFile, SpanningTree
   opts.initialization = Initialization::Chordal;
 
+  // If the file provides an initial estimate for every pose, use it instead
+  if (vertex_estimates) {
+    opts.initialization = Initialization::FromFile;
+    opts.initial_estimate = *vertex_estimates;
+  }
+
   // Specific form of the synchronization problem to solve
   // Options are: Simplified, Explicit, SOSync
   opts.formulation = Formulation::Simplified;
@@ -43,6 +54,11 @@ int main(int argc, char **argv) {
   // Initial
   opts.num_threads = 4;
 
+  // Memory budget (in bytes) for the sparse factorizations; any factorization
+  // that would exceed it is replaced by a lower-memory alternative (0 means
+  // unlimited)
+  opts.memory_budget_bytes = 0;
+
 #ifdef GPERFTOOLS
   ProfilerStart("SE-Sync.prof");
 #endif
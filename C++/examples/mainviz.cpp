@@ -11,10 +11,12 @@ using namespace SESync;
 bool write_poses = false;
 
 int main(int argc, char **argv) {
-  if (argc != 2) {
-    cout << "Usage: " << argv[0] << " [input .g2o file]" << endl;
+  if (argc < 2 || argc > 3 ||
+      (argc == 3 && std::string(argv[2]) != "--headless")) {
+    cout << "Usage: " << argv[0] << " [input .g2o file] [--headless]" << endl;
     exit(1);
   }
+  const bool headless = (argc == 3);
 
   size_t num_poses;
   measurements_t measurements = read_g2o_file(argv[1], num_poses);
@@ -35,11 +37,15 @@ int main(int argc, char **argv) {
   VisualizationOpts vopts;
   vopts.delay = 0.1;  // [s]
   vopts.img_name = "custom-img-name";
+  vopts.headless = headless;  // Render the image sequence offscreen.
   vopts.img_dir =
       "sesync-iters-" +
       std::string(std::experimental::filesystem::path(argv[1]).filename());
 
   // Run SE-Sync, and launch the visualization magic.
   SESyncVisualizer viz(num_poses, measurements, opts, vopts);
-  viz.RenderSynchronization();
+  if (headless)
+    viz.RenderToImages();
+  else
+    viz.RenderSynchronization();
 }
@@ -0,0 +1,584 @@
+/** A long-running SE-Sync solver daemon.
+ *
+ * This executable keeps a pool of persistent worker threads and a cache of
+ * fully-constructed SESyncProblem instances (keyed by a client-supplied graph
+ * ID), and serves solve requests over a Unix domain (stream) socket.  This
+ * removes the per-query cost of process startup, .g2o parsing, data matrix
+ * assembly and factorization for clients that repeatedly solve the same pose
+ * graphs.
+ *
+ * Usage: sesync-server [socket path] [num workers] [threads per worker]
+ *        [max cached problems] [memory budget per problem (bytes)]
+ *
+ * If a memory budget is given, each cached problem is constructed so as to
+ * respect it (cf. SESync/SESyncMemoryGovernor.h).
+ *
+ * Each client connection is served by its own thread, which only performs
+ * socket I/O:  problem construction and solving are both performed by the
+ * worker pool.  At most kMaxConnections connections are served at once;
+ * further connections wait in the listen backlog until one is closed.
+ *
+ * PROTOCOL
+ *
+ * All integers are unsigned and all values are transmitted in native byte
+ * order (the server and its clients are assumed to run on the same host).
+ * Each request begins with the following header:
+ *
+ *   uint32 magic         kMagic ('SESY')
+ *   uint32 type          kSolve, kMetrics, or kEvict
+ *   uint64 graph_id      Client-chosen key identifying the pose graph
+ *   uint32 formulation   0 = Simplified, 1 = Explicit, 2 = SOSync
+ *   uint32 d             Dimension of the problem (2 or 3)
+ *   uint64 m             Number of measurements that follow (may be 0)
+ *
+ * followed (for kSolve requests) by m measurement records of the form:
+ *
+ *   uint64 i, uint64 j, double R[d * d] (column-major), double t[d],
+ *   double kappa, double tau
+ *
+ * If m > 0, the server (re)constructs the problem for graph_id from these
+ * measurements and caches it; if m == 0, the previously-cached problem for
+ * graph_id is solved.  Requests with more than kMaxMeasurements measurements
+ * are rejected with kBadRequest.  Pose indices need not be contiguous:  the
+ * poses are relabeled densely (cf. SESyncProblem::pose_ids()), and the
+ * response reports the original index of each pose in xhat.
+ *
+ * Every response begins with a uint32 error code (kOK on success).  A
+ * successful kSolve response continues with:
+ *
+ *   uint32 status (SESyncStatus), uint32 cache_hit,
+ *   double SDPval, gradnorm, trLambda, Fxhat, suboptimality_bound,
+ *          total_computation_time, queue_time,
+ *   uint64 rows, uint64 cols, double xhat[rows * cols] (column-major),
+ *   uint64 num_pose_ids, uint64 pose_ids[num_pose_ids]
+ *
+ * where num_pose_ids is 0 if the pose indices were already contiguous, and
+ * otherwise pose_ids[k] is the original index of the kth pose in xhat.
+ *
+ * and a successful kMetrics response continues with:
+ *
+ *   uint64 queue_depth, active_solves, requests, cache_hits, cache_misses,
+ *   uint64 num_buckets, double bucket_upper_bounds[num_buckets] (ms),
+ *   uint64 bucket_counts[num_buckets]
+ *
+ * Copyright (C) 2016 - 2022 by David M. Rosen (dmrosen@mit.edu)
+ */
+
+#include "SESync/SESync.h"
+#include "SESync/SESync_utils.h"
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <array>
+#include <atomic>
+#include <csignal>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <limits>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+
+using namespace std;
+using namespace SESync;
+
+namespace {
+
+/// PROTOCOL CONSTANTS
+
+const uint32_t kMagic = 0x59534553; // 'SESY'
+
+enum RequestType : uint32_t { kSolve = 1, kMetrics = 2, kEvict = 3 };
+
+/** Limit on the size of the problems that clients may submit; this bounds
+ * the memory allocated on behalf of a single request */
+const uint64_t kMaxMeasurements = uint64_t(1) << 24;
+
+/** The maximum number of client connections served concurrently */
+const size_t kMaxConnections = 256;
+
+enum ErrorCode : uint32_t {
+  kOK = 0,
+  kBadRequest = 1,
+  kUnknownGraph = 2,
+  kSolverError = 3
+};
+
+/// SOCKET I/O HELPERS
+
+/** Read exactly 'size' bytes from the socket fd into buf; returns false if the
+ * connection was closed or an error occurred */
+bool read_full(int fd, void *buf, size_t size) {
+  char *p = static_cast<char *>(buf);
+  while (size > 0) {
+    ssize_t n = ::read(fd, p, size);
+    if (n <= 0)
+      return false;
+    p += n;
+    size -= n;
+  }
+  return true;
+}
+
+/** Write exactly 'size' bytes from buf to the socket fd */
+bool write_full(int fd, const void *buf, size_t size) {
+  const char *p = static_cast<const char *>(buf);
+  while (size > 0) {
+    ssize_t n = ::write(fd, p, size);
+    if (n <= 0)
+      return false;
+    p += n;
+    size -= n;
+  }
+  return true;
+}
+
+template <typename T> bool read_value(int fd, T &value) {
+  return read_full(fd, &value, sizeof(T));
+}
+
+/** A simple buffer used to assemble a complete response before sending it */
+class ResponseBuffer {
+private:
+  vector<char> data_;
+
+public:
+  template <typename T> void put(const T &value) {
+    const char *p = reinterpret_cast<const char *>(&value);
+    data_.insert(data_.end(), p, p + sizeof(T));
+  }
+
+  void put(const Scalar *values, size_t count) {
+    const char *p = reinterpret_cast<const char *>(values);
+    data_.insert(data_.end(), p, p + count * sizeof(Scalar));
+  }
+
+  bool send(int fd) const { return write_full(fd, data_.data(), data_.size()); }
+};
+
+/// SERVER STATE
+
+/** A cached problem instance.  Since SESync() modifies the relaxation rank of
+ * the problem it operates on, each problem may only be solved by one worker at
+ * a time. */
+struct CachedProblem {
+  PreparedProblem prepared; // The problem and its (memory-governed) options
+  mutex solve_mutex;
+};
+
+/** Fixed (logarithmically-spaced) latency histogram for completed solves */
+class LatencyHistogram {
+public:
+  static constexpr size_t kNumBuckets = 14;
+
+  /** Upper bounds (in milliseconds) of each bucket; the last is unbounded */
+  static constexpr array<double, kNumBuckets> kUpperBounds = {
+      1,    2,    5,    10,   20,    50,    100,
+      200,  500,  1000, 2000, 5000, 10000, numeric_limits<double>::infinity()};
+
+  void record(double ms) {
+    size_t b = 0;
+    while (ms > kUpperBounds[b])
+      ++b;
+    ++counts_[b];
+  }
+
+  uint64_t count(size_t b) const { return counts_[b]; }
+
+private:
+  array<atomic<uint64_t>, kNumBuckets> counts_{};
+};
+
+constexpr array<double, LatencyHistogram::kNumBuckets>
+    LatencyHistogram::kUpperBounds;
+
+/** A single queued solve job.  If 'measurements' is set, the worker first
+ * (re)constructs the problem for graph_id from them and caches it. */
+struct SolveJob {
+  shared_ptr<CachedProblem> entry;
+  uint64_t graph_id = 0;
+  optional<measurements_t> measurements;
+  Formulation formulation = Formulation::Simplified;
+  bool bad_request = false; // Set if the measurements define no valid problem
+  chrono::time_point<chrono::high_resolution_clock> enqueue_time;
+  promise<pair<SESyncResult, double>> result; // (result, queue time)
+};
+
+class Server {
+private:
+  /// Configuration
+  SESyncOpts opts_;
+  size_t max_cached_problems_;
+
+  /// LRU cache of constructed problems, keyed by graph ID
+  mutex cache_mutex_;
+  list<uint64_t> lru_; // Most-recently used ID at the front
+  unordered_map<uint64_t, pair<shared_ptr<CachedProblem>,
+                               list<uint64_t>::iterator>>
+      cache_;
+
+  /// Work queue
+  mutex queue_mutex_;
+  condition_variable queue_cv_;
+  deque<shared_ptr<SolveJob>> queue_;
+  vector<thread> workers_;
+
+  /// Metrics
+  atomic<uint64_t> active_solves_{0};
+  atomic<uint64_t> requests_{0};
+  atomic<uint64_t> cache_hits_{0};
+  atomic<uint64_t> cache_misses_{0};
+  LatencyHistogram latencies_;
+
+  /// Open client connections (at most kMaxConnections)
+  mutex connections_mutex_;
+  condition_variable connections_cv_;
+  size_t connections_ = 0;
+
+  /** Worker thread main loop: pop jobs from the queue and solve them */
+  void work() {
+    while (true) {
+      shared_ptr<SolveJob> job;
+      {
+        unique_lock<mutex> lock(queue_mutex_);
+        queue_cv_.wait(lock, [this] { return !queue_.empty(); });
+        job = queue_.front();
+        queue_.pop_front();
+      }
+
+      double queue_time = Stopwatch::tock(job->enqueue_time);
+      ++active_solves_;
+      try {
+        lock_guard<mutex> lock(job->entry->solve_mutex);
+        if (job->measurements)
+          construct(*job);
+        const PreparedProblem &prepared = job->entry->prepared;
+        SESyncResult result =
+            SESync::SESync(*prepared.problem, prepared.options);
+        prepared.annotate(result);
+        job->result.set_value({result, queue_time});
+      } catch (...) {
+        job->result.set_exception(current_exception());
+      }
+      --active_solves_;
+    }
+  }
+
+  /** Construct the problem for a job from its measurements, and cache it */
+  void construct(SolveJob &job) {
+    SESyncOpts opts = opts_;
+    opts.formulation = job.formulation;
+    try {
+      job.entry->prepared = prepare_problem(*job.measurements, opts);
+    } catch (const invalid_argument &e) {
+      cout << "Invalid problem for graph " << job.graph_id << ": " << e.what()
+           << endl;
+      job.bad_request = true;
+      throw;
+    } catch (const exception &e) {
+      cout << "Error constructing graph " << job.graph_id << ": " << e.what()
+           << endl;
+      throw;
+    }
+    job.measurements.reset();
+    insert(job.graph_id, job.entry);
+  }
+
+  /** Insert or replace the cache entry for graph_id, evicting the
+   * least-recently used entry if necessary */
+  void insert(uint64_t graph_id, const shared_ptr<CachedProblem> &entry) {
+    lock_guard<mutex> lock(cache_mutex_);
+    auto it = cache_.find(graph_id);
+    if (it != cache_.end())
+      lru_.erase(it->second.second);
+    lru_.push_front(graph_id);
+    cache_[graph_id] = {entry, lru_.begin()};
+
+    while (cache_.size() > max_cached_problems_) {
+      cache_.erase(lru_.back());
+      lru_.pop_back();
+    }
+  }
+
+  /** Look up the cache entry for graph_id, marking it as most-recently used;
+   * returns nullptr on a miss */
+  shared_ptr<CachedProblem> lookup(uint64_t graph_id) {
+    lock_guard<mutex> lock(cache_mutex_);
+    auto it = cache_.find(graph_id);
+    if (it == cache_.end())
+      return nullptr;
+    lru_.splice(lru_.begin(), lru_, it->second.second);
+    return it->second.first;
+  }
+
+  void evict(uint64_t graph_id) {
+    lock_guard<mutex> lock(cache_mutex_);
+    auto it = cache_.find(graph_id);
+    if (it != cache_.end()) {
+      lru_.erase(it->second.second);
+      cache_.erase(it);
+    }
+  }
+
+  /** Read m (<= kMaxMeasurements) measurement records of dimension d from the
+   * socket; returns false if the connection was closed */
+  static bool read_measurements(int fd, size_t d, size_t m,
+                                measurements_t &measurements) {
+    measurements.resize(m);
+    for (RelativePoseMeasurement &measurement : measurements) {
+      uint64_t i, j;
+      measurement.R.resize(d, d);
+      measurement.t.resize(d);
+      if (!read_value(fd, i) || !read_value(fd, j) ||
+          !read_full(fd, measurement.R.data(), d * d * sizeof(Scalar)) ||
+          !read_full(fd, measurement.t.data(), d * sizeof(Scalar)) ||
+          !read_value(fd, measurement.kappa) ||
+          !read_value(fd, measurement.tau))
+        return false;
+      measurement.i = i;
+      measurement.j = j;
+    }
+    return true;
+  }
+
+  /** Send a response consisting of the passed code alone */
+  static void send_code(int fd, ErrorCode code) {
+    ResponseBuffer response;
+    response.put<uint32_t>(code);
+    response.send(fd);
+  }
+
+  void handle_metrics(int fd) {
+    ResponseBuffer response;
+    response.put<uint32_t>(kOK);
+    {
+      lock_guard<mutex> lock(queue_mutex_);
+      response.put<uint64_t>(queue_.size());
+    }
+    response.put<uint64_t>(active_solves_);
+    response.put<uint64_t>(requests_);
+    response.put<uint64_t>(cache_hits_);
+    response.put<uint64_t>(cache_misses_);
+    response.put<uint64_t>(LatencyHistogram::kNumBuckets);
+    for (double b : LatencyHistogram::kUpperBounds)
+      response.put(b);
+    for (size_t b = 0; b < LatencyHistogram::kNumBuckets; ++b)
+      response.put<uint64_t>(latencies_.count(b));
+    response.send(fd);
+  }
+
+  /** Serve a single solve request; returns false if the connection was
+   * closed while reading it */
+  bool handle_solve(int fd, uint64_t graph_id, uint32_t formulation,
+                    uint32_t d, uint64_t m) {
+    ++requests_;
+    auto start_time = Stopwatch::tick();
+
+    auto job = make_shared<SolveJob>();
+    job->graph_id = graph_id;
+    bool cache_hit = false;
+
+    if (m > 0) {
+      // Read the measurements defining the (new) problem for graph_id
+      measurements_t measurements;
+      if (!read_measurements(fd, d, m, measurements))
+        return false;
+
+      // The problem is constructed (and cached) by the worker that solves it
+      job->entry = make_shared<CachedProblem>();
+      job->measurements = std::move(measurements);
+      job->formulation = static_cast<Formulation>(formulation);
+      ++cache_misses_;
+    } else {
+      job->entry = lookup(graph_id);
+      if (!job->entry) {
+        ++cache_misses_;
+        send_code(fd, kUnknownGraph);
+        return true;
+      }
+      cache_hit = true;
+      ++cache_hits_;
+    }
+
+    // Enqueue the solve and wait for a worker to complete it
+    job->enqueue_time = Stopwatch::tick();
+    future<pair<SESyncResult, double>> result_future = job->result.get_future();
+    {
+      lock_guard<mutex> lock(queue_mutex_);
+      queue_.push_back(job);
+    }
+    queue_cv_.notify_one();
+
+    ResponseBuffer response;
+    try {
+      pair<SESyncResult, double> output = result_future.get();
+      const SESyncResult &result = output.first;
+      latencies_.record(1000 * Stopwatch::tock(start_time));
+
+      response.put<uint32_t>(kOK);
+      response.put<uint32_t>(result.status);
+      response.put<uint32_t>(cache_hit);
+      response.put(result.SDPval);
+      response.put(result.gradnorm);
+      response.put(result.trLambda);
+      response.put(result.Fxhat);
+      response.put(result.suboptimality_bound);
+      response.put(result.total_computation_time);
+      response.put(output.second);
+      response.put<uint64_t>(result.xhat.rows());
+      response.put<uint64_t>(result.xhat.cols());
+      response.put(result.xhat.data(), result.xhat.size());
+      response.put<uint64_t>(result.pose_ids.size());
+      for (size_t id : result.pose_ids)
+        response.put<uint64_t>(id);
+    } catch (const exception &e) {
+      if (!job->bad_request && !job->measurements)
+        cout << "Error solving graph " << graph_id << ": " << e.what()
+             << endl;
+      response = ResponseBuffer();
+      response.put<uint32_t>(job->bad_request ? kBadRequest : kSolverError);
+    }
+    response.send(fd);
+    return true;
+  }
+
+  /** Serve requests on a single client connection until it is closed */
+  void handle_connection(int fd) {
+    // This runs in a detached thread, so no exception may escape it
+    try {
+      while (true) {
+        uint32_t magic, type, formulation, d;
+        uint64_t graph_id, m;
+        if (!read_value(fd, magic) || !read_value(fd, type) ||
+            !read_value(fd, graph_id) || !read_value(fd, formulation) ||
+            !read_value(fd, d) || !read_value(fd, m))
+          break;
+
+        if (magic != kMagic || formulation > 2 ||
+            (m > 0 && d != 2 && d != 3) || m > kMaxMeasurements) {
+          send_code(fd, kBadRequest);
+          break; // We cannot resynchronize with this stream
+        }
+
+        if (type == kSolve) {
+          if (!handle_solve(fd, graph_id, formulation, d, m))
+            break;
+        } else if (type == kMetrics)
+          handle_metrics(fd);
+        else if (type == kEvict) {
+          evict(graph_id);
+          send_code(fd, kOK);
+        } else {
+          send_code(fd, kBadRequest);
+          break;
+        }
+      }
+    } catch (const exception &e) {
+      cout << "Error serving connection: " << e.what() << endl;
+    } catch (...) {
+      cout << "Error serving connection" << endl;
+    }
+    ::close(fd);
+
+    {
+      lock_guard<mutex> lock(connections_mutex_);
+      --connections_;
+    }
+    connections_cv_.notify_one();
+  }
+
+public:
+  Server(const SESyncOpts &opts, size_t num_workers,
+         size_t max_cached_problems)
+      : opts_(opts), max_cached_problems_(max_cached_problems) {
+    for (size_t w = 0; w < num_workers; ++w)
+      workers_.emplace_back(&Server::work, this);
+  }
+
+  /** Accept connections on the Unix domain socket at 'path' (forever) */
+  int run(const string &path) {
+    int listen_fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd < 0) {
+      perror("socket");
+      return 1;
+    }
+
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+      cout << "Error: socket path is too long" << endl;
+      return 1;
+    }
+    strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+    ::unlink(path.c_str());
+    if (::bind(listen_fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) <
+            0 ||
+        ::listen(listen_fd, SOMAXCONN) < 0) {
+      perror("bind/listen");
+      return 1;
+    }
+
+    cout << "SE-Sync server listening on " << path << " with "
+         << workers_.size() << " workers" << endl;
+
+    while (true) {
+      // Wait for a free connection slot before accepting another client
+      {
+        unique_lock<mutex> lock(connections_mutex_);
+        connections_cv_.wait(lock,
+                             [this] { return connections_ < kMaxConnections; });
+      }
+
+      int fd = ::accept(listen_fd, nullptr, nullptr);
+      if (fd < 0)
+        continue;
+
+      {
+        lock_guard<mutex> lock(connections_mutex_);
+        ++connections_;
+      }
+      thread(&Server::handle_connection, this, fd).detach();
+    }
+    return 0;
+  }
+};
+
+} // namespace
+
+int main(int argc, char **argv) {
+  if (argc < 2 || argc > 6) {
+    cout << "Usage: " << argv[0]
+         << " [socket path] [num workers] [threads per worker] [max cached "
+            "problems] [memory budget per problem (bytes)]"
+         << endl;
+    exit(1);
+  }
+
+  size_t num_workers = (argc > 2 ? stoul(argv[2]) : 1);
+  size_t max_cached_problems = (argc > 4 ? stoul(argv[4]) : 64);
+
+  // A client that disconnects before its response is written must not kill the
+  // server; the failed write is reported by write_full() instead
+  signal(SIGPIPE, SIG_IGN);
+
+  SESyncOpts opts;
+  opts.verbose = false;
+  opts.num_threads = (argc > 3 ? stoul(argv[3]) : 1);
+  opts.memory_budget_bytes = (argc > 5 ? stoull(argv[5]) : 0);
+
+  Server server(opts, max(num_workers, size_t(1)),
+                max(max_cached_problems, size_t(1)));
+  return server.run(argv[1]);
+}
@@ -0,0 +1,165 @@
+/** This example benchmarks the alternative solver configurations offered by
+ * SE-Sync against its default configuration.
+ *
+ * Each of the passed .g2o files is solved once per configuration, and the
+ * program reports for each solve its termination status, total computation
+ * time, the time and number of LOBPCG iterations spent in solution
+ * verification, the number of rejected update steps (wasted outer
+ * iterations), and the number of Hessian-vector products (together with the
+ * additional products spent on Krylov subspace recycling).  The
+ * configurations compared are:
+ *
+ * - the default configuration, with all available threads and with one
+ *   (cf. SESyncOpts::num_threads);
+ * - LOBPCG with deflation of the known near-nullspace of the certificate
+ *   matrix (cf. SESyncOpts::LOBPCG_deflation);
+ * - LOBPCG preconditioned by the regularized Cholesky factorization rather
+ *   than by an incomplete LDL^T factorization, and Chebyshev-filtered
+ *   subspace iteration (cf. SESyncOpts::certificate_eigensolver);
+ * - the trust-region method without carrying its radius across levels of the
+ *   Riemannian Staircase (cf. SESyncOpts::carry_trust_region_radius);
+ * - the trust-region method with Krylov subspace recycling (cf.
+ *   SESyncOpts::recycle_Krylov_subspace), and L-BFGS;
+ * - a hard 200 ms deadline for the entire solve (cf.
+ *   SESyncOpts::enforce_deadline).
+ *
+ * (The batched solver is benchmarked separately by batch_benchmark.)
+ *
+ * Copyright (C) 2016 - 2022 by David M. Rosen (dmrosen@mit.edu)
+ */
+
+#include "SESync/SESync.h"
+#include "SESync/SESync_utils.h"
+
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace SESync;
+
+/** A named solver configuration */
+struct Configuration {
+  string name;
+  SESyncOpts options;
+};
+
+/** Helper function:  returns a human-readable name for the passed status */
+string status_name(SESyncStatus status) {
+  switch (status) {
+  case GlobalOpt:
+    return "GlobalOpt";
+  case SaddlePoint:
+    return "SaddlePoint";
+  case EigImprecision:
+    return "EigImprecision";
+  case MaxRank:
+    return "MaxRank";
+  case ElapsedTime:
+    return "ElapsedTime";
+  case Uncertified:
+    return "Uncertified";
+  }
+  return "Unknown";
+}
+
+/** Helper function:  returns the sum of the elements of a per-level history */
+template <typename T> T total(const vector<vector<T>> &history) {
+  T sum = 0;
+  for (const vector<T> &level : history)
+    sum = accumulate(level.begin(), level.end(), sum);
+  return sum;
+}
+
+vector<Configuration> configurations() {
+  SESyncOpts base;
+  base.verbose = false;
+
+  vector<Configuration> configs;
+  configs.push_back({"default", base});
+
+  SESyncOpts single_thread = base;
+  single_thread.num_threads = 1;
+  configs.push_back({"1 thread", single_thread});
+
+  SESyncOpts deflation = base;
+  deflation.LOBPCG_deflation = true;
+  configs.push_back({"LOBPCG deflation", deflation});
+
+  SESyncOpts Cholesky_precon = base;
+  Cholesky_precon.LOBPCG_preconditioner =
+      VerificationPreconditioner::RegularizedCholesky;
+  configs.push_back({"LOBPCG + reg. Chol.", Cholesky_precon});
+
+  SESyncOpts Chebyshev = base;
+  Chebyshev.certificate_eigensolver = VerificationEigensolver::ChebyshevFilter;
+  configs.push_back({"Chebyshev filter", Chebyshev});
+
+  SESyncOpts no_carry = base;
+  no_carry.carry_trust_region_radius = false;
+  configs.push_back({"no radius carry", no_carry});
+
+  SESyncOpts recycling = base;
+  recycling.recycle_Krylov_subspace = true;
+  configs.push_back({"Krylov recycling", recycling});
+
+  SESyncOpts LBFGS = base;
+  LBFGS.local_solver = LocalSolver::LBFGS;
+  configs.push_back({"L-BFGS", LBFGS});
+
+  SESyncOpts deadline = base;
+  deadline.enforce_deadline = true;
+  deadline.max_computation_time = .2;
+  configs.push_back({"200 ms deadline", deadline});
+
+  return configs;
+}
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    cout << "Usage: " << argv[0] << " [input .g2o file] ..." << endl;
+    exit(1);
+  }
+
+  const vector<Configuration> configs = configurations();
+
+  for (int k = 1; k < argc; ++k) {
+    size_t num_poses;
+    measurements_t measurements = read_g2o_file(argv[k], num_poses);
+    if (measurements.size() == 0) {
+      cout << "Error: No measurements were read from file " << argv[k] << endl;
+      continue;
+    }
+
+    cout << argv[k] << " (" << num_poses << " poses, " << measurements.size()
+         << " measurements)" << endl;
+    cout << left << setw(22) << "configuration" << setw(15) << "status"
+         << right << setw(10) << "time [s]" << setw(12) << "verif. [s]"
+         << setw(8) << "LOBPCG" << setw(10) << "rejected" << setw(10)
+         << "HVPs" << setw(10) << "recycl." << endl;
+
+    for (const Configuration &config : configs) {
+      SESyncResult result = SESync::SESync(measurements, config.options);
+
+      const double verification_time =
+          accumulate(result.verification_times.begin(),
+                     result.verification_times.end(), 0.0);
+      const size_t LOBPCG_iters = accumulate(
+          result.LOBPCG_iters.begin(), result.LOBPCG_iters.end(), size_t(0));
+      const size_t rejected_steps =
+          accumulate(result.rejected_steps.begin(),
+                     result.rejected_steps.end(), size_t(0));
+
+      cout << left << setw(22) << config.name << setw(15)
+           << status_name(result.status) << right << fixed << setprecision(3)
+           << setw(10) << result.total_computation_time << setw(12)
+           << verification_time << setw(8) << LOBPCG_iters << setw(10)
+           << rejected_steps << setw(10)
+           << total(result.Hessian_vector_products) << setw(10)
+           << total(result.recycling_Hessian_vector_products) << endl;
+    }
+    cout << endl;
+  }
+}
@@ -0,0 +1,126 @@
+/** Tests of the problem features computed by SE-Sync's autotuner (cf.
+ * SESync/SESyncAutotuner.h):  the symbolic count of the nonzeros in the
+ * Cholesky factor of the pose-graph Laplacian is checked against closed-form
+ * values for graphs whose fill is known, and against the factor actually
+ * computed by a numerical Cholesky factorization under the same ordering.
+ *
+ * Copyright (C) 2016 - 2022 by David M. Rosen (dmrosen@mit.edu)
+ */
+
+#include <random>
+
+#include <Eigen/OrderingMethods>
+#include <Eigen/SparseCholesky>
+
+#include "SESync/SESyncAutotuner.h"
+
+#include "test_utils.h"
+
+using namespace std;
+using namespace SESync;
+
+/** Returns a measurement of the identity between poses i and j in SE(2) */
+RelativePoseMeasurement edge(size_t i, size_t j) {
+  RelativePoseMeasurement measurement;
+  measurement.i = i;
+  measurement.j = j;
+  measurement.R = Matrix::Identity(2, 2);
+  measurement.t = Vector::Zero(2);
+  measurement.kappa = 1;
+  measurement.tau = 1;
+  return measurement;
+}
+
+/** Returns the number of nonzeros in the Cholesky factor of the (regularized)
+ * pose-graph Laplacian, computed numerically under the AMD ordering */
+size_t numerical_Cholesky_nonzeros(const measurements_t &measurements,
+                                   size_t n) {
+  vector<Eigen::Triplet<Scalar>> triplets;
+  for (size_t i = 0; i < n; ++i)
+    triplets.emplace_back(i, i, 1);
+  for (const RelativePoseMeasurement &m : measurements) {
+    triplets.emplace_back(m.i, m.i, 1);
+    triplets.emplace_back(m.j, m.j, 1);
+    triplets.emplace_back(m.i, m.j, -1);
+    triplets.emplace_back(m.j, m.i, -1);
+  }
+  SparseMatrix L(n, n);
+  L.setFromTriplets(triplets.begin(), triplets.end());
+
+  Eigen::SimplicialLLT<SparseMatrix, Eigen::Lower, Eigen::AMDOrdering<int>>
+      factorization(L);
+  SparseMatrix factor = factorization.matrixL();
+  return factor.nonZeros();
+}
+
+/** Graphs without fill:  trees, and complete graphs (whose factor is dense) */
+void test_closed_form() {
+  const size_t n = 50;
+
+  measurements_t path;
+  for (size_t i = 0; i + 1 < n; ++i)
+    path.push_back(edge(i, i + 1));
+  ProblemFeatures features = compute_problem_features(path);
+  SESYNC_CHECK(features.factor_nonzeros == 2 * n - 1);
+  SESYNC_CHECK(features.factor_fill == 1);
+
+  // Duplicate measurements do not add edges to the pose graph
+  path.push_back(edge(0, 1));
+  path.push_back(edge(1, 0));
+  SESYNC_CHECK(compute_problem_features(path).factor_nonzeros == 2 * n - 1);
+
+  // A star is fill-free only if its center is eliminated last
+  measurements_t star;
+  for (size_t i = 1; i < n; ++i)
+    star.push_back(edge(0, i));
+  SESYNC_CHECK(compute_problem_features(star).factor_nonzeros == 2 * n - 1);
+
+  const size_t k = 12;
+  measurements_t complete;
+  for (size_t i = 0; i < k; ++i)
+    for (size_t j = i + 1; j < k; ++j)
+      complete.push_back(edge(i, j));
+  features = compute_problem_features(complete);
+  SESYNC_CHECK(features.factor_nonzeros == k * (k + 1) / 2);
+  SESYNC_CHECK(features.factor_fill == 1);
+}
+
+/** Graphs with fill:  the symbolic count matches the numerical factor */
+void test_against_numerical_factorization() {
+  // A grid with random loop closures
+  const size_t w = 15, n = w * w;
+  mt19937 generator(0);
+  uniform_int_distribution<size_t> pose(0, n - 1);
+  measurements_t grid;
+  for (size_t i = 0; i < w; ++i)
+    for (size_t j = 0; j < w; ++j) {
+      if (j + 1 < w)
+        grid.push_back(edge(i * w + j, i * w + j + 1));
+      if (i + 1 < w)
+        grid.push_back(edge(i * w + j, (i + 1) * w + j));
+    }
+  for (size_t k = 0; k < 40; ++k) {
+    size_t i = pose(generator), j = pose(generator);
+    if (i != j)
+      grid.push_back(edge(i, j));
+  }
+
+  ProblemFeatures features = compute_problem_features(grid);
+  SESYNC_CHECK(features.n == n);
+  SESYNC_CHECK(features.factor_nonzeros ==
+               numerical_Cholesky_nonzeros(grid, n));
+  SESYNC_CHECK(features.factor_fill > 1);
+
+  // A real pose graph
+  size_t num_poses;
+  const measurements_t measurements =
+      read_g2o_file(SESync::test::data_file("smallGrid3D.g2o"), num_poses);
+  SESYNC_CHECK(compute_problem_features(measurements).factor_nonzeros ==
+               numerical_Cholesky_nonzeros(measurements, num_poses));
+}
+
+int main() {
+  test_closed_form();
+  test_against_numerical_factorization();
+  return SESync::test::finish("test_autotuner");
+}
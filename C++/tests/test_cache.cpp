@@ -0,0 +1,150 @@
+/** Tests of SE-Sync's solution cache (cf. SESync/SESyncCache.h):  cached
+ * solutions are keyed by the quantized measurements (irrespective of their
+ * order) and by the solver options that determine the solution (but not by
+ * those affecting only the speed of the solve), problems differing by a few
+ * measurements are warm-started from the nearest cached solution, and
+ * solutions persisted on disk are restored exactly.
+ *
+ * Copyright (C) 2016 - 2022 by David M. Rosen (dmrosen@mit.edu)
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+
+#include "SESync/SESyncCache.h"
+
+#include "test_utils.h"
+
+using namespace std;
+using namespace SESync;
+
+/** Checks that two results are identical */
+void check_equal(const SESyncResult &a, const SESyncResult &b) {
+  SESYNC_CHECK(a.Yopt == b.Yopt);
+  SESYNC_CHECK(a.SDPval == b.SDPval);
+  SESYNC_CHECK(a.gradnorm == b.gradnorm);
+  SESYNC_CHECK(a.Lambda.nonZeros() == b.Lambda.nonZeros() &&
+               SparseMatrix(a.Lambda - b.Lambda).norm() == 0);
+  SESYNC_CHECK(a.trLambda == b.trLambda);
+  SESYNC_CHECK(a.duality_gap == b.duality_gap);
+  SESYNC_CHECK(a.Fxhat == b.Fxhat);
+  SESYNC_CHECK(a.xhat == b.xhat);
+  SESYNC_CHECK(a.pose_ids == b.pose_ids);
+  SESYNC_CHECK(a.direct_verification == b.direct_verification);
+  SESYNC_CHECK(a.suboptimality_bound == b.suboptimality_bound);
+  SESYNC_CHECK(a.function_values == b.function_values);
+  SESYNC_CHECK(a.Hessian_vector_products == b.Hessian_vector_products);
+  SESYNC_CHECK(a.local_solvers == b.local_solvers);
+  SESYNC_CHECK(a.rejected_steps == b.rejected_steps);
+  SESYNC_CHECK(a.trust_region_radius == b.trust_region_radius);
+  SESYNC_CHECK(a.LOBPCG_iters == b.LOBPCG_iters);
+  SESYNC_CHECK(a.status == b.status);
+}
+
+void test_keying(const measurements_t &measurements) {
+  SESyncCache cache;
+  SESyncOpts opts;
+  opts.verbose = false;
+
+  SESyncCacheOutcome outcome;
+  const SESyncResult result = cache.solve(measurements, opts, &outcome);
+  SESYNC_CHECK(outcome == SESyncCacheOutcome::Miss);
+  SESYNC_CHECK(result.status == GlobalOpt);
+
+  // An identical problem is a hit, and returns the cached solution
+  check_equal(cache.solve(measurements, opts, &outcome), result);
+  SESYNC_CHECK(outcome == SESyncCacheOutcome::Hit);
+
+  // So is the same problem with its measurements listed in a different order,
+  // or perturbed by less than the quantization resolution
+  measurements_t permuted(measurements.rbegin(), measurements.rend());
+  cache.solve(permuted, opts, &outcome);
+  SESYNC_CHECK(outcome == SESyncCacheOutcome::Hit);
+
+  measurements_t perturbed = measurements;
+  perturbed[0].t(0) += 1e-3 * cache.options().quantization;
+  cache.solve(perturbed, opts, &outcome);
+  SESYNC_CHECK(outcome == SESyncCacheOutcome::Hit);
+
+  // Options that affect only the speed of the solve do not change the key
+  SESyncOpts faster = opts;
+  faster.num_threads = 1;
+  faster.preconditioner = Preconditioner::Jacobi;
+  cache.solve(measurements, faster, &outcome);
+  SESYNC_CHECK(outcome == SESyncCacheOutcome::Hit);
+
+  // ... but options that determine the solution do, and the problem is then
+  // warm-started from the (otherwise identical) cached problem
+  SESyncOpts tighter = opts;
+  tighter.grad_norm_tol = opts.grad_norm_tol / 10;
+  cache.solve(measurements, tighter, &outcome);
+  SESYNC_CHECK(outcome == SESyncCacheOutcome::NearHit);
+
+  // Removing a loop closure that does not involve the last pose leaves the
+  // set of poses unchanged, so the cached solution is used as a warm start
+  const size_t n = result.xhat.cols() / (result.xhat.rows() + 1);
+  measurements_t edited = measurements;
+  auto loop_closure =
+      find_if(edited.begin(), edited.end(),
+              [n](const RelativePoseMeasurement &m) {
+                return m.j != m.i + 1 && max(m.i, m.j) < n - 1;
+              });
+  SESYNC_CHECK(loop_closure != edited.end());
+  if (loop_closure != edited.end()) {
+    edited.erase(loop_closure);
+    const SESyncResult warm = cache.solve(edited, opts, &outcome);
+    SESYNC_CHECK(outcome == SESyncCacheOutcome::NearHit);
+    SESYNC_CHECK(warm.status == GlobalOpt);
+  }
+
+  SESYNC_CHECK(cache.hits() == 4);
+  SESYNC_CHECK(cache.near_hits() == 2);
+  SESYNC_CHECK(cache.misses() == 1);
+}
+
+void test_persistence(const measurements_t &measurements) {
+  const filesystem::path directory = "test_cache_entries";
+  filesystem::remove_all(directory);
+
+  SESyncCacheOpts cache_opts;
+  cache_opts.directory = directory.string();
+  SESyncOpts opts;
+  opts.verbose = false;
+
+  SESyncResult result;
+  {
+    SESyncCache cache(cache_opts);
+    result = cache.solve(measurements, opts);
+  }
+
+  // A new cache using the same directory restores the persisted solution
+  SESyncCache cache(cache_opts);
+  SESyncCacheOutcome outcome;
+  const SESyncResult restored = cache.solve(measurements, opts, &outcome);
+  SESYNC_CHECK(outcome == SESyncCacheOutcome::Hit);
+  check_equal(restored, result);
+
+  // The number of persisted entries is bounded
+  cache_opts.max_disk_entries = 1;
+  SESyncCache bounded(cache_opts);
+  SESyncOpts other = opts;
+  other.rmax = opts.rmax + 1;
+  bounded.solve(measurements, other);
+  size_t num_files = 0;
+  for (auto &file : filesystem::directory_iterator(directory)) {
+    (void)file;
+    ++num_files;
+  }
+  SESYNC_CHECK(num_files == 1);
+
+  filesystem::remove_all(directory);
+}
+
+int main() {
+  const measurements_t measurements =
+      SESync::test::read_data_file("tinyGrid3D.g2o");
+  test_keying(measurements);
+  test_persistence(measurements);
+  return SESync::test::finish("test_cache");
+}
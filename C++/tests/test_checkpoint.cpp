@@ -0,0 +1,195 @@
+/** Tests of SE-Sync's checkpointing (cf. SESync/SESyncCheckpoint.h):  a
+ * checkpoint survives a round trip through save_checkpoint() and
+ * load_checkpoint(), corrupt files are rejected, the asynchronous writer
+ * persists the most recent submission, and a solve resumed from a checkpoint
+ * written during an earlier solve reaches the same certified optimum.
+ *
+ * Copyright (C) 2016 - 2022 by David M. Rosen (dmrosen@mit.edu)
+ */
+
+#include <cmath>
+#include <fstream>
+#include <stdexcept>
+
+#include "SESync/SESync.h"
+#include "SESync/SESyncCheckpoint.h"
+#include "SESync/SESyncProblem.h"
+
+#include "test_utils.h"
+
+using namespace std;
+using namespace SESync;
+
+/** Returns a checkpoint populated with arbitrary (but distinctive) values */
+SESyncCheckpoint example_checkpoint() {
+  SESyncResult result;
+  result.initialization_time = .25;
+  result.function_values = {{3, 2, 1}, {1, .5}};
+  result.gradient_norms = {{1, .1, .01}, {.1, .001}};
+  result.preconditioned_gradient_norms = {{2, .2, .02}, {.2, .002}};
+  result.Hessian_vector_products = {{0, 5, 7}, {0, 9}};
+  result.recycling_Hessian_vector_products = {{0, 1, 1}, {0, 2}};
+  result.update_step_norms = {{.5, .25, .125}, {.5, .25}};
+  result.update_step_M_norms = {{.6, .3, .15}, {.6, .3}};
+  result.gain_ratios = {{.9, 1, 1.1}, {.8, 1}};
+  result.elapsed_optimization_times = {{.1, .2, .3}, {.4, .5}};
+  result.local_solvers = {LocalSolver::TNT, LocalSolver::LBFGS};
+  result.rejected_steps = {1, 0};
+  result.trust_region_radius = 4;
+  result.escape_direction_curvatures = {-.5};
+  result.LOBPCG_iters = {12, 3};
+  result.verification_times = {.05, .01};
+
+  SESyncCheckpoint checkpoint;
+  checkpoint.fingerprint = 0x0123456789abcdefULL;
+  checkpoint.formulation = Formulation::Explicit;
+  checkpoint.level = 7;
+  checkpoint.r = 6;
+  checkpoint.Y = Matrix::Random(6, 40);
+  checkpoint.trust_region_radius = 1.5;
+  checkpoint.TNT_iterations = 11;
+  checkpoint.elapsed_time = 2.75;
+  checkpoint.result = checkpoint_result(result);
+  return checkpoint;
+}
+
+/** Checks that two checkpoints record the same state */
+void check_equal(const SESyncCheckpoint &a, const SESyncCheckpoint &b) {
+  SESYNC_CHECK(a.fingerprint == b.fingerprint);
+  SESYNC_CHECK(a.formulation == b.formulation);
+  SESYNC_CHECK(a.level == b.level);
+  SESYNC_CHECK(a.r == b.r);
+  SESYNC_CHECK(a.Y == b.Y);
+  SESYNC_CHECK(a.trust_region_radius == b.trust_region_radius);
+  SESYNC_CHECK(a.TNT_iterations == b.TNT_iterations);
+  SESYNC_CHECK(a.elapsed_time == b.elapsed_time);
+
+  SESYNC_CHECK(a.result && b.result);
+  if (!a.result || !b.result)
+    return;
+  const SESyncResult &x = *a.result, &y = *b.result;
+  SESYNC_CHECK(x.initialization_time == y.initialization_time);
+  SESYNC_CHECK(x.function_values == y.function_values);
+  SESYNC_CHECK(x.gradient_norms == y.gradient_norms);
+  SESYNC_CHECK(x.preconditioned_gradient_norms ==
+               y.preconditioned_gradient_norms);
+  SESYNC_CHECK(x.Hessian_vector_products == y.Hessian_vector_products);
+  SESYNC_CHECK(x.recycling_Hessian_vector_products ==
+               y.recycling_Hessian_vector_products);
+  SESYNC_CHECK(x.update_step_norms == y.update_step_norms);
+  SESYNC_CHECK(x.update_step_M_norms == y.update_step_M_norms);
+  SESYNC_CHECK(x.gain_ratios == y.gain_ratios);
+  SESYNC_CHECK(x.elapsed_optimization_times == y.elapsed_optimization_times);
+  SESYNC_CHECK(x.local_solvers == y.local_solvers);
+  SESYNC_CHECK(x.rejected_steps == y.rejected_steps);
+  SESYNC_CHECK(x.trust_region_radius == y.trust_region_radius);
+  SESYNC_CHECK(x.escape_direction_curvatures ==
+               y.escape_direction_curvatures);
+  SESYNC_CHECK(x.LOBPCG_iters == y.LOBPCG_iters);
+  SESYNC_CHECK(x.verification_times == y.verification_times);
+}
+
+/** Returns true if loading the passed file throws std::runtime_error */
+bool load_fails(const string &filename) {
+  try {
+    load_checkpoint(filename);
+  } catch (const runtime_error &) {
+    return true;
+  }
+  return false;
+}
+
+void test_round_trip() {
+  const string filename = SESync::test::scratch_file("test_checkpoint.bin");
+  const SESyncCheckpoint checkpoint = example_checkpoint();
+  save_checkpoint(filename, checkpoint);
+  check_equal(checkpoint, load_checkpoint(filename));
+
+  // Truncating the file anywhere must be detected
+  ifstream in(filename, ios::binary);
+  const string contents((istreambuf_iterator<char>(in)),
+                        istreambuf_iterator<char>());
+  for (size_t length : {size_t(0), size_t(12), contents.size() / 2,
+                        contents.size() - 1}) {
+    ofstream(filename, ios::binary | ios::trunc).write(contents.data(),
+                                                       length);
+    SESYNC_CHECK(load_fails(filename));
+  }
+
+  // So must an absurd stored length (here, the row count of Y)
+  string corrupted = contents;
+  const size_t Y_rows_offset = 8 + 4 + 8 + 4 + 5 * 8;
+  for (size_t k = 0; k < 8; ++k)
+    corrupted[Y_rows_offset + k] = '\xff';
+  ofstream(filename, ios::binary | ios::trunc)
+      .write(corrupted.data(), corrupted.size());
+  SESYNC_CHECK(load_fails(filename));
+
+  remove(filename.c_str());
+}
+
+void test_writer() {
+  const string filename =
+      SESync::test::scratch_file("test_checkpoint_writer.bin");
+  SESyncCheckpoint last = example_checkpoint();
+  {
+    CheckpointWriter writer(filename);
+    for (size_t k = 0; k < 10; ++k) {
+      SESyncCheckpoint checkpoint = example_checkpoint();
+      checkpoint.TNT_iterations = k;
+      checkpoint.Y = last.Y;
+      writer.submit(std::move(checkpoint));
+    }
+    // The destructor writes the last pending checkpoint
+  }
+  last.TNT_iterations = 9;
+  check_equal(last, load_checkpoint(filename));
+  remove(filename.c_str());
+}
+
+void test_resume() {
+  const measurements_t measurements =
+      SESync::test::read_data_file("tinyGrid3D.g2o");
+  const string filename =
+      SESync::test::scratch_file("test_checkpoint_resume.bin");
+
+  SESyncOpts opts;
+  opts.verbose = false;
+  opts.checkpoint_file = filename;
+  opts.checkpoint_interval = 0; // Checkpoint at every iteration
+  SESyncResult result = SESync::SESync(measurements, opts);
+  SESYNC_CHECK(result.status == GlobalOpt);
+
+  const SESyncCheckpoint checkpoint = load_checkpoint(filename);
+  SESyncProblem problem(measurements, opts.formulation);
+  SESYNC_CHECK(checkpoint.fingerprint == problem.fingerprint());
+  SESYNC_CHECK(checkpoint.Y.cols() ==
+               static_cast<Eigen::Index>(problem.iterate_columns()));
+
+  opts.checkpoint_file.clear();
+  SESyncResult resumed = resume(problem, filename, opts);
+  SESYNC_CHECK(resumed.status == GlobalOpt);
+  SESYNC_CHECK(fabs(resumed.SDPval - result.SDPval) <=
+               1e-4 * max<Scalar>(1, fabs(result.SDPval)));
+
+  // A checkpoint cannot be resumed against a different problem
+  measurements_t other = measurements;
+  other.pop_back();
+  SESyncProblem other_problem(other, opts.formulation);
+  bool rejected = false;
+  try {
+    resume(other_problem, filename, opts);
+  } catch (const invalid_argument &) {
+    rejected = true;
+  }
+  SESYNC_CHECK(rejected);
+
+  remove(filename.c_str());
+}
+
+int main() {
+  test_round_trip();
+  test_writer();
+  test_resume();
+  return SESync::test::finish("test_checkpoint");
+}
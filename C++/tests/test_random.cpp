@@ -0,0 +1,105 @@
+/** Tests of SE-Sync's counter-based random number generation (cf.
+ * SESync/SESync_random.h):  the Philox4x32-10 bijection is checked against
+ * the known-answer vectors published with the Random123 library, and the
+ * samples drawn by fill_standard_normal() are checked to be a pure function of
+ * (seed, stream, index), independent of the number of threads.
+ *
+ * Copyright (C) 2016 - 2022 by David M. Rosen (dmrosen@mit.edu)
+ */
+
+#include <array>
+#include <cmath>
+#include <vector>
+
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+
+#include "SESync/SESync_random.h"
+
+#include "test_utils.h"
+
+using namespace std;
+using namespace SESync;
+
+/** Known-answer tests for Philox4x32-10 (from Random123's kat_vectors) */
+void test_Philox_known_answers() {
+  SESYNC_CHECK((Philox4x32({0, 0, 0, 0}, {0, 0}) ==
+                array<uint32_t, 4>{0x6627e8d5, 0xe169c58d, 0xbc57ac4c,
+                                   0x9b00dbd8}));
+  SESYNC_CHECK((Philox4x32({0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff},
+                           {0xffffffff, 0xffffffff}) ==
+                array<uint32_t, 4>{0x408f276d, 0x41c83b0e, 0xa20bc7c6,
+                                   0x6d5451fd}));
+  SESYNC_CHECK((Philox4x32({0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344},
+                           {0xa4093822, 0x299f31d0}) ==
+                array<uint32_t, 4>{0xd16cfe09, 0x94fdcceb, 0x5001e420,
+                                   0x24126ea1}));
+}
+
+/** Samples are reproducible, and depend upon the seed and stream */
+void test_reproducibility() {
+  const size_t N = 1000;
+  vector<Scalar> a(N), b(N), c(N), e(N);
+  fill_standard_normal(a.data(), N, 42, 0);
+  fill_standard_normal(b.data(), N, 42, 0);
+  fill_standard_normal(c.data(), N, 43, 0);
+  fill_standard_normal(e.data(), N, 42, 1);
+
+  SESYNC_CHECK(a == b);
+  SESYNC_CHECK(a != c);
+  SESYNC_CHECK(a != e);
+
+  // The kth sample does not depend upon the length of the array being filled
+  vector<Scalar> prefix(N / 3);
+  fill_standard_normal(prefix.data(), prefix.size(), 42, 0);
+  SESYNC_CHECK(equal(prefix.begin(), prefix.end(), a.begin()));
+
+  const Matrix X =
+      random_normal_matrix(7, 11, 42, RandomStream::StiefelSample);
+  const Matrix Y =
+      random_normal_matrix(7, 11, 42, RandomStream::StiefelSample);
+  const Matrix Z = random_normal_matrix(7, 11, 42, RandomStream::Lanczos);
+  SESYNC_CHECK(X == Y);
+  SESYNC_CHECK(X != Z);
+}
+
+/** Large arrays (which are filled in parallel) are bitwise-identical for
+ * every number of threads */
+void test_thread_independence() {
+  const size_t N = 1 << 20;
+  vector<Scalar> serial(N);
+#if defined(_OPENMP)
+  const int max_threads = omp_get_max_threads();
+  omp_set_num_threads(1);
+#endif
+  fill_standard_normal(serial.data(), N, 7, 3);
+
+#if defined(_OPENMP)
+  for (int threads : {2, 3, 8}) {
+    omp_set_num_threads(threads);
+    vector<Scalar> parallel(N);
+    fill_standard_normal(parallel.data(), N, 7, 3);
+    SESYNC_CHECK(parallel == serial);
+  }
+  omp_set_num_threads(max_threads);
+#endif
+
+  // The samples are (approximately) standard normal
+  Scalar mean = 0, second_moment = 0;
+  for (Scalar x : serial) {
+    mean += x;
+    second_moment += x * x;
+  }
+  mean /= N;
+  second_moment /= N;
+  SESYNC_CHECK(fabs(mean) < 1e-2);
+  SESYNC_CHECK(fabs(second_moment - 1) < 1e-2);
+}
+
+int main() {
+  test_Philox_known_answers();
+  test_reproducibility();
+  test_thread_independence();
+  return SESync::test::finish("test_random");
+}
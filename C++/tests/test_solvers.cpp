@@ -0,0 +1,137 @@
+/** Regression tests of SE-Sync's solvers on a small pose graph:  every local
+ * solver (the truncated-Newton trust-region method, with and without Krylov
+ * subspace recycling, and L-BFGS), and every certificate eigensolver, must
+ * recover the same certified global optimum, and so must the batched solver
+ * (cf. SESync/SESyncBatch.h) for each problem of a batch.
+ *
+ * Copyright (C) 2016 - 2022 by David M. Rosen (dmrosen@mit.edu)
+ */
+
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "SESync/SESync.h"
+#include "SESync/SESyncBatch.h"
+
+#include "test_utils.h"
+
+using namespace std;
+using namespace SESync;
+
+/** Relative tolerance for the agreement of optimal values */
+const Scalar agreement_tol = 1e-4;
+
+/** Returns true if a and b agree to within agreement_tol */
+bool agree(Scalar a, Scalar b) {
+  return fabs(a - b) <= agreement_tol * max<Scalar>(1, fabs(b));
+}
+
+/** A named solver configuration */
+struct Configuration {
+  string name;
+  SESyncOpts options;
+};
+
+vector<Configuration> configurations() {
+  SESyncOpts base;
+  base.verbose = false;
+
+  vector<Configuration> configs;
+  configs.push_back({"TNT", base});
+
+  SESyncOpts recycling = base;
+  recycling.recycle_Krylov_subspace = true;
+  configs.push_back({"TNT with Krylov recycling", recycling});
+
+  SESyncOpts LBFGS = base;
+  LBFGS.local_solver = LocalSolver::LBFGS;
+  configs.push_back({"L-BFGS", LBFGS});
+
+  SESyncOpts schedule = base;
+  schedule.local_solver_schedule = {LocalSolver::LBFGS, LocalSolver::TNT};
+  configs.push_back({"L-BFGS / TNT schedule", schedule});
+
+  // Starting from a random point at the lowest level exercises the escape
+  // from saddle points, and hence each certificate eigensolver
+  SESyncOpts staircase = base;
+  staircase.initialization = Initialization::Random;
+  staircase.r0 = 3;
+  configs.push_back({"Staircase (LOBPCG)", staircase});
+
+  SESyncOpts deflation = staircase;
+  deflation.LOBPCG_deflation = true;
+  configs.push_back({"Staircase (LOBPCG with deflation)", deflation});
+
+  SESyncOpts Chebyshev = staircase;
+  Chebyshev.certificate_eigensolver = VerificationEigensolver::ChebyshevFilter;
+  configs.push_back({"Staircase (Chebyshev filter)", Chebyshev});
+
+  return configs;
+}
+
+void test_local_solvers(const measurements_t &measurements) {
+  Scalar reference = 0;
+  for (const Configuration &config : configurations()) {
+    const SESyncResult result = SESync::SESync(measurements, config.options);
+    const bool certified = (result.status == GlobalOpt);
+    SESYNC_CHECK(certified);
+    if (!certified) {
+      cerr << config.name << " terminated with status " << result.status
+           << endl;
+      continue;
+    }
+
+    if (config.name == "TNT")
+      reference = result.SDPval;
+    SESYNC_CHECK(agree(result.SDPval, reference));
+    SESYNC_CHECK(result.suboptimality_bound >= -agreement_tol);
+
+    // The per-level histories are consistent
+    SESYNC_CHECK(result.local_solvers.size() ==
+                 result.Hessian_vector_products.size());
+    SESYNC_CHECK(result.recycling_Hessian_vector_products.size() ==
+                 result.Hessian_vector_products.size());
+    for (size_t k = 0; k < result.Hessian_vector_products.size(); ++k)
+      SESYNC_CHECK(result.recycling_Hessian_vector_products[k].size() ==
+                   result.Hessian_vector_products[k].size());
+    if (!config.options.local_solver_schedule.empty())
+      SESYNC_CHECK(result.local_solvers.front() == LocalSolver::LBFGS);
+  }
+}
+
+void test_batch(const measurements_t &measurements) {
+  const size_t L = 8;
+  const Scalar sigma = .01;
+  const size_t d = measurements[0].R.rows();
+
+  // Perturb the translational measurements of each problem
+  mt19937 generator(0);
+  normal_distribution<Scalar> normal(0, sigma);
+  vector<measurements_t> problems(L, measurements);
+  for (measurements_t &problem : problems)
+    for (RelativePoseMeasurement &m : problem)
+      for (size_t k = 0; k < d; ++k)
+        m.t(k) += normal(generator);
+
+  const vector<SESyncBatchResult> results = SESyncBatch(problems).solve();
+  SESYNC_CHECK(results.size() == L);
+
+  SESyncOpts opts;
+  opts.verbose = false;
+  for (size_t l = 0; l < results.size(); ++l) {
+    SESYNC_CHECK(results[l].status == GlobalOpt);
+    const SESyncResult reference = SESync::SESync(problems[l], opts);
+    if (results[l].status == GlobalOpt && reference.status == GlobalOpt)
+      SESYNC_CHECK(agree(results[l].SDPval, reference.SDPval));
+  }
+}
+
+int main() {
+  const measurements_t measurements =
+      SESync::test::read_data_file("tinyGrid3D.g2o");
+  test_local_solvers(measurements);
+  test_batch(measurements);
+  return SESync::test::finish("test_solvers");
+}
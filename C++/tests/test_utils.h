@@ -0,0 +1,72 @@
+/** This file provides a few minimal helpers shared by SE-Sync's unit tests.
+ *
+ * Each test is a standalone executable that reports every failed check on
+ * stderr and returns a nonzero exit status if any check failed (cf.
+ * tests/CMakeLists.txt).
+ *
+ * Copyright (C) 2016 - 2022 by David M. Rosen (dmrosen@mit.edu)
+ */
+
+#pragma once
+
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+#include "SESync/RelativePoseMeasurement.h"
+#include "SESync/SESync_utils.h"
+
+namespace SESync {
+namespace test {
+
+/** The number of checks that have failed so far */
+inline size_t &failures() {
+  static size_t count = 0;
+  return count;
+}
+
+/** Records the outcome of a single check */
+inline void check(bool condition, const char *expression, const char *file,
+                  int line) {
+  if (!condition) {
+    std::cerr << file << ":" << line << ": check failed: " << expression
+              << std::endl;
+    ++failures();
+  }
+}
+
+/** Returns the exit status of a test program, after reporting a summary */
+inline int finish(const char *name) {
+  if (failures() == 0)
+    std::cout << name << ": all checks passed" << std::endl;
+  else
+    std::cerr << name << ": " << failures() << " check(s) failed"
+              << std::endl;
+  return failures() == 0 ? 0 : 1;
+}
+
+/** Returns the path of the passed file in the data/ directory of the
+ * SE-Sync repository (cf. SESYNC_DATA_DIR in tests/CMakeLists.txt) */
+inline std::string data_file(const std::string &name) {
+  return std::string(SESYNC_DATA_DIR) + "/" + name;
+}
+
+/** Returns the path of a scratch file (in the directory in which the tests
+ * are run) with the passed name, removing any existing file of that name */
+inline std::string scratch_file(const std::string &name) {
+  std::remove(name.c_str());
+  return name;
+}
+
+/** Reads the measurements of the passed .g2o file in data/ */
+inline measurements_t read_data_file(const std::string &name) {
+  size_t num_poses;
+  return read_g2o_file(data_file(name), num_poses);
+}
+
+} // namespace test
+} // namespace SESync
+
+/** Checks the passed condition, recording (but not aborting on) failure */
+#define SESYNC_CHECK(condition)                                                \
+  SESync::test::check((condition), #condition, __FILE__, __LINE__)
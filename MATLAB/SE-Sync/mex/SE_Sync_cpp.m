@@ -0,0 +1,55 @@
+function [SDPval, Yopt, xhat, Fxhat, SE_Sync_info, Lambda] = SE_Sync_cpp(measurements, SE_Sync_opts, Y0)
+%function [SDPval, Yopt, xhat, Fxhat, SE_Sync_info, Lambda] = SE_Sync_cpp(measurements, SE_Sync_opts, Y0)
+%
+% This function runs the C++ implementation of SE-Sync (through the MEX
+% gateway sesync_mex) on the passed measurements.  Its inputs and outputs
+% mirror those of SE_Sync(), except that the Manopt options are omitted
+% (the C++ implementation uses its own trust-region solver), and that the
+% final output is the Lagrange multiplier matrix Lambda computed in the
+% verification step, in place of the problem data struct.
+%
+% INPUTS:
+%   measurements:  A MATLAB struct containing the data describing the
+%       special Euclidean synchronization problem (cf. load_g2o_data()).
+%   SE_Sync_opts [optional]:  A MATLAB struct whose fields are named after
+%       the members of the C++ SESyncOpts struct (e.g. r0, rmax,
+%       grad_norm_tol, formulation, preconditioner, verbose, ...);
+%       enumerated options are passed as strings (e.g. formulation =
+%       'Explicit').  Any options not set take their default values.
+%   Y0 [optional]:  An initial point on the manifold St(d, r)^n at which to
+%       initialize the first level of the Riemannian Staircase; if this is
+%       supplied, the initial level r0 of the Staircase is set to
+%       size(Y0, 1).
+%
+% OUTPUTS:
+%   SDPval:  The optimal value of the semidefinite relaxation
+%   Yopt:  A symmetric factor of an optimal solution Zopt = Yopt' * Yopt
+%       for the semidefinite relaxation.
+%   xhat: A struct containing the estimate for the special Euclidean
+%       synchronization problem.  It has the following two fields:
+%       R:  A d x dn matrix whose (dxd)-block elements give the
+%           rotational state estimates.
+%       t: a d x n matrix whose ith column gives the translational
+%           state estimate for the ith pose (empty if the SO-Sync
+%           formulation was solved).
+%   Fxhat:  The objective value of the rounded solution xhat.
+%   SE_Sync_info:  A MATLAB struct containing various possibly-interesting
+%       bits of information about the execution of the SE-Sync algorithm
+%       (cf. SESyncResult).
+%   Lambda:  The (sparse, symmetric) Lagrange multiplier matrix computed in
+%       the verification step.
+
+% Copyright (C) 2016 - 2022 by David M. Rosen
+
+if nargin < 2
+    SE_Sync_opts = struct;
+end
+
+if nargin < 3
+    Y0 = [];
+end
+
+[Yopt, xhat, Lambda, SE_Sync_info] = sesync_mex('solve', measurements, SE_Sync_opts, Y0);
+
+SDPval = SE_Sync_info.SDPval;
+Fxhat = SE_Sync_info.Fxhat;
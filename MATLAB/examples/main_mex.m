@@ -0,0 +1,76 @@
+% This file contains a minimum working example demonstrating the use of the
+% C++ implementation of SE-Sync from MATLAB or Octave, through its MEX
+% gateway (see the README for instructions on building this gateway)
+%
+% Copyright (C) 2016 - 2022 by David M. Rosen
+
+%% Reset environment
+clear all;
+close all;
+clc;
+
+%% Import SE-Sync
+run('../import_SE_Sync.m');
+
+
+%% Select dataset to run
+data_dir = '../../data/';  % Relative path to directory containing example datasets
+
+% 3D datasets
+sphere2500 = 'sphere2500';
+torus = 'torus3D';
+grid = 'grid3D';
+garage = 'parking-garage';
+cubicle = 'cubicle';
+rim = 'rim';
+
+% 2D datasets
+CSAIL = 'CSAIL';
+manhattan = 'manhattan';
+city10000 = 'city10000';
+intel = 'intel';
+ais = 'ais2klinik';
+
+
+% Pick the dataset to run here
+file = sphere2500;
+
+g2o_file = strcat(data_dir, file, '.g2o');
+
+%% Read in .g2o file
+tic();
+fprintf('Loading file: %s ...\n', g2o_file);
+measurements = load_g2o_data(g2o_file);
+t = toc();
+num_poses = max(max(measurements.edges));
+num_measurements = length(measurements.kappa);
+d = length(measurements.t{1});
+fprintf('Processed input file %s in %g seconds\n', g2o_file, t);
+fprintf('Number of poses: %d\n', num_poses);
+fprintf('Number of measurements: %d\n', num_measurements);
+
+%% Set SE-Sync options (if desired)
+SE_Sync_opts.r0 = 5;  % Initial level of the Riemannian Staircase
+SE_Sync_opts.rmax = 10;  % Maximum level of the Riemannian Staircase
+SE_Sync_opts.grad_norm_tol = 1e-2;  % Stopping tolerance for the norm of the Riemannian gradient
+SE_Sync_opts.formulation = 'Simplified';  % Select the problem formulation: {Simplified, Explicit, SOSync}
+SE_Sync_opts.initialization = 'Chordal';  % Select the initialization method: {Chordal, Random}
+SE_Sync_opts.verbose = true;
+
+%% Run SE-Sync
+[SDPval, Yopt, xhat, Fxhat, SE_Sync_info, Lambda] = SE_Sync_cpp(measurements, SE_Sync_opts);
+
+% ... or ...
+
+% Use default settings for everything
+%[SDPval, Yopt, xhat, Fxhat, SE_Sync_info, Lambda] = SE_Sync_cpp(measurements);
+
+%% Plot resulting solution
+plot_loop_closures = true;
+
+if plot_loop_closures
+    plot_poses(xhat.t, xhat.R, measurements.edges, '-b', .25);
+else
+    plot_poses(xhat.t, xhat.R);
+end
+axis tight;
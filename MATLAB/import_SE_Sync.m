@@ -2,4 +2,6 @@ cd SE-Sync/manopt
 importmanopt;
 cd ../lib
 addpath(pwd);
+cd ../mex
+addpath(pwd);
 cd ../..
@@ -0,0 +1,147 @@
+% This file tests the MEX gateway to the C++ implementation of SE-Sync
+% (sesync_mex) from MATLAB or Octave.  It checks that the C++ solver
+% attains the same optimal value as the MATLAB implementation SE_Sync() on
+% a bundled dataset, and that the problem operators exposed by 'create'
+% are mutually consistent.  Run it from this directory (after building the
+% gateway; see the README); it raises an error if any check fails.
+%
+% Copyright (C) 2016 - 2022 by David M. Rosen
+
+%% Reset environment
+clear all;
+close all;
+
+%% Import SE-Sync
+run('../import_SE_Sync.m');
+
+%% Load dataset
+data_dir = '../../data/';  % Relative path to directory containing example datasets
+g2o_file = strcat(data_dir, 'tinyGrid3D', '.g2o');
+
+measurements = load_g2o_data(g2o_file);
+n = max(max(measurements.edges));
+d = length(measurements.t{1});
+
+tol = 1e-4;  % Relative tolerance for agreement
+
+%% Compare the C++ solver against SE_Sync()
+SE_Sync_opts.r0 = 5;
+SE_Sync_opts.rmax = 10;
+SE_Sync_opts.grad_norm_tol = 1e-6;
+SE_Sync_opts.formulation = 'Simplified';
+SE_Sync_opts.verbose = false;
+
+Manopt_opts.tolgradnorm = 1e-6;
+Manopt_opts.verbosity = 0;
+[SDPval_ref, ~, ~, Fxhat_ref] = SE_Sync(measurements, Manopt_opts);
+
+[SDPval, Yopt, xhat, Fxhat, SE_Sync_info, Lambda] = SE_Sync_cpp(measurements, SE_Sync_opts);
+
+assert(abs(SDPval - SDPval_ref) <= tol * max(1, abs(SDPval_ref)), ...
+    'SDPval disagrees with SE_Sync(): %g vs. %g', SDPval, SDPval_ref);
+assert(abs(Fxhat - Fxhat_ref) <= tol * max(1, abs(Fxhat_ref)), ...
+    'Fxhat disagrees with SE_Sync(): %g vs. %g', Fxhat, Fxhat_ref);
+assert(isequal(size(xhat.t), [d, n]) && isequal(size(xhat.R), [d, d*n]), ...
+    'xhat has the wrong dimensions');
+assert(issparse(Lambda) && isequal(size(Lambda), [d*n, d*n]), ...
+    'Lambda has the wrong dimensions');
+assert(Fxhat >= SDPval - tol * max(1, abs(SDPval)), ...
+    'The rounded solution attains a lower value than the relaxation');
+
+%% Construct a problem instance and check its accessors
+handle = sesync_mex('create', measurements, SE_Sync_opts);
+cleanup = onCleanup(@() sesync_mex('destroy', handle));
+
+assert(sesync_mex('num_states', handle) == n, 'num_states is incorrect');
+assert(sesync_mex('dimension', handle) == d, 'dimension is incorrect');
+assert(sesync_mex('relaxation_rank', handle) == SE_Sync_opts.r0, ...
+    'relaxation_rank is incorrect');
+
+r = size(Yopt, 1);
+sesync_mex('set_relaxation_rank', handle, r);
+assert(sesync_mex('relaxation_rank', handle) == r, ...
+    'set_relaxation_rank had no effect');
+
+%% Operator round-trips
+scale = max(1, abs(SDPval));
+
+% The objective is tr(S Y' Y), and agrees with the value returned by 'solve'
+F = sesync_mex('evaluate_objective', handle, Yopt);
+SY = sesync_mex('data_matrix_product', handle, Yopt);
+assert(abs(F - trace(SY * Yopt')) <= tol * scale, ...
+    'evaluate_objective disagrees with data_matrix_product');
+assert(abs(F - SDPval) <= tol * scale, ...
+    'evaluate_objective disagrees with SDPval');
+
+% The Euclidean gradient is 2 Y S
+G = sesync_mex('Euclidean_gradient', handle, Yopt);
+assert(norm(G - 2 * SY, 'fro') <= tol * max(1, norm(G, 'fro')), ...
+    'Euclidean_gradient disagrees with data_matrix_product');
+
+% Yopt is a first-order critical point
+gradY = sesync_mex('Riemannian_gradient', handle, Yopt);
+assert(norm(gradY, 'fro') <= 1e-4, 'Yopt is not a critical point');
+
+% Retracting along the zero vector is the identity
+Z = zeros(size(Yopt));
+assert(norm(sesync_mex('retract', handle, Yopt, Z) - Yopt, 'fro') <= 1e-10, ...
+    'retract does not fix Y along the zero tangent vector');
+
+% Tangent-space projection is idempotent, and the Hessian-vector product
+% and preconditioner map into the tangent space
+Y = sesync_mex('random_sample', handle, 1);
+assert(isequal(size(Y), size(Yopt)), 'random_sample has the wrong dimensions');
+V = sesync_mex('tangent_space_projection', handle, Y, randn(size(Y)));
+PV = sesync_mex('tangent_space_projection', handle, Y, V);
+assert(norm(PV - V, 'fro') <= 1e-10 * max(1, norm(V, 'fro')), ...
+    'tangent_space_projection is not idempotent');
+
+HV = sesync_mex('Riemannian_Hessian_vector_product', handle, Y, V);
+assert(norm(sesync_mex('tangent_space_projection', handle, Y, HV) - HV, 'fro') ...
+    <= 1e-8 * max(1, norm(HV, 'fro')), ...
+    'Riemannian_Hessian_vector_product does not lie in the tangent space');
+
+MV = sesync_mex('precondition', handle, Y, V);
+assert(norm(sesync_mex('tangent_space_projection', handle, Y, MV) - MV, 'fro') ...
+    <= 1e-8 * max(1, norm(MV, 'fro')), ...
+    'precondition does not lie in the tangent space');
+
+% Retractions remain on the manifold, and rounding a lifted estimate
+% recovers that estimate
+Yr = sesync_mex('retract', handle, Y, V);
+for i = 1:n
+    Yi = Yr(:, (i-1)*d + 1 : i*d);
+    assert(norm(Yi' * Yi - eye(d), 'fro') <= 1e-10, ...
+        'retract does not return a point on the Stiefel manifold');
+end
+
+xhat2 = sesync_mex('round_solution', handle, Yopt);
+assert(norm(xhat2.R - xhat.R, 'fro') <= tol * max(1, norm(xhat.R, 'fro')), ...
+    'round_solution disagrees with the solution returned by solve');
+Ylift = sesync_mex('lift_estimate', handle, xhat2);
+xhat3 = sesync_mex('round_solution', handle, Ylift);
+assert(norm(xhat3.R - xhat2.R, 'fro') <= 1e-8 * max(1, norm(xhat2.R, 'fro')), ...
+    'round_solution does not invert lift_estimate');
+
+% The multiplier matrix matches that returned by solve
+Lambda2 = sesync_mex('compute_Lambda', handle, Yopt);
+assert(norm(Lambda2 - Lambda, 'fro') <= tol * max(1, norm(Lambda, 'fro')), ...
+    'compute_Lambda disagrees with the Lambda returned by solve');
+
+%% Verification
+[PSD, theta] = sesync_mex('verify_solution', handle, Yopt, 1e-5, 10);
+assert(PSD, 'verify_solution failed to certify Yopt (theta = %g)', theta);
+
+%% Malformed input is rejected
+bad_measurements = measurements;
+bad_measurements.edges(1, 1) = bad_measurements.edges(1, 1) + .5;
+threw = false;
+try
+    sesync_mex('create', bad_measurements, SE_Sync_opts);
+catch
+    threw = true;
+end
+assert(threw, 'Non-integer pose indices were not rejected');
+
+clear cleanup;  % Releases the problem instance
+fprintf('All sesync_mex tests passed\n');